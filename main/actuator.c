@@ -0,0 +1,468 @@
+// actuator.c
+#include "actuator.h"
+#include "cycle.h"
+#include "executor.h"
+#include "pressure_sensor.h"
+#include "rpm_sensor.h"
+#include "power.h"
+#include <math.h>
+#include <string.h>
+#include "cJSON.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "actuator";
+
+// ====================== SELF-TEST LIMITS ======================
+#define ACT_BASELINE_SAMPLES   4       // pressure conversions averaged before each ON
+#define ACT_HOLD_MS            1000    // stay ON this long after the response
+#define ACT_VALVE_MAX_ON_MS    8000    // give up on a valve with no pressure response
+#define ACT_MOTOR_MAX_ON_MS    4000
+#define ACT_DRAIN_MAX_ON_MS    30000   // drain runs until the level is back near empty
+#define ACT_OFF_WINDOW_MS      3000    // pressure watched after OFF
+#define ACT_MOTOR_STOP_MS      8000    // RPM watched after OFF
+#define ACT_SETTLE_HZ          2.0f    // smaller pressure moves count as settled
+#define ACT_RPM_PERIOD_MS      20      // RPM sample period
+#define ACT_TRACE_LEN          1024    // captured samples, all actuators together
+
+#define ACT_NVS_NAMESPACE      "actuator"
+#define ACT_NVS_KEY_TABLE      "lat"
+#define ACT_NVS_KEY_COMP       "comp"
+
+extern const gpio_num_t all_pins[NUM_COMPONENTS];
+
+typedef enum {
+    SENSE_PRESSURE,
+    SENSE_RPM
+} ActuatorSense;
+
+typedef struct {
+    const char   *name;         // compId in cycle JSON
+    gpio_num_t    pin;
+    ActuatorSense sense;
+    uint32_t      max_on_ms;
+    bool          compensated;  // OFF events may be moved earlier (see actuator.h)
+} ActuatorInfo;
+
+static const ActuatorInfo ACTUATORS[ACTUATOR_COUNT] = {
+    [ACTUATOR_COLD_VALVE]      = { "Cold Valve",      COLD_VALVE_PIN,      SENSE_PRESSURE, ACT_VALVE_MAX_ON_MS, true  },
+    [ACTUATOR_HOT_VALVE]       = { "Hot Valve",       HOT_VALVE_PIN,       SENSE_PRESSURE, ACT_VALVE_MAX_ON_MS, true  },
+    [ACTUATOR_DETERGENT_VALVE] = { "Detergent Valve", DETERGENT_VALVE_PIN, SENSE_PRESSURE, ACT_VALVE_MAX_ON_MS, true  },
+    [ACTUATOR_SOFT_VALVE]      = { "Soft Valve",      SOFT_VALVE_PIN,      SENSE_PRESSURE, ACT_VALVE_MAX_ON_MS, true  },
+    [ACTUATOR_MOTOR]           = { "Motor",           MOTOR_ON_PIN,        SENSE_RPM,      ACT_MOTOR_MAX_ON_MS, false },
+    [ACTUATOR_DRAIN_PUMP]      = { "Drain Pump",      DRAIN_PUMP_PIN,      SENSE_PRESSURE, ACT_DRAIN_MAX_ON_MS, false },
+};
+
+typedef enum {
+    CHAR_IDLE,
+    CHAR_RUNNING,
+    CHAR_DONE,
+    CHAR_ABORTED
+} CharState;
+
+static const char *const CHAR_STATE_NAMES[] = { "idle", "running", "done", "aborted" };
+
+// Outcome for one actuator in the last self-test
+typedef struct {
+    bool     tested;
+    bool     responded;
+    uint32_t on_ms;
+    uint32_t off_ms;
+    float    baseline;          // sensor before ON (Hz or RPM)
+    float    peak;              // furthest from baseline while ON
+    uint16_t trace_start;
+    uint16_t trace_len;
+} ActuatorResult;
+
+// One captured sample, timed from the executor write it follows
+typedef struct {
+    uint16_t t_ms;
+    uint8_t  act;               // ActuatorId
+    uint8_t  after_off;         // 0: after the ON write, 1: after the OFF write
+    float    value;             // Hz or RPM
+} ActuatorSample;
+
+// ====================== STATE ======================
+static ActuatorLatency s_table[ACTUATOR_COUNT];     // stored in NVS
+static bool s_compensate = false;                   // stored in NVS
+
+static volatile CharState s_state = CHAR_IDLE;
+static volatile bool s_abort = false;
+static ActuatorCharConfig s_cfg;
+static ActuatorResult s_results[ACTUATOR_COUNT];
+static ActuatorSample s_trace[ACT_TRACE_LEN];
+static size_t s_trace_len = 0;
+static bool s_trace_truncated = false;
+static bool s_drained = false;                      // drain brought the level back to empty
+static uint32_t s_run_ms = 0;
+static esp_err_t s_store_err = ESP_OK;
+static uint32_t s_edge_cursor = 0;                  // executor edge log, self-test task only
+
+// ====================== NVS ======================
+static esp_err_t nvs_store(void)
+{
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(ACT_NVS_NAMESPACE, NVS_READWRITE, &h);
+    if (err != ESP_OK) return err;
+    err = nvs_set_blob(h, ACT_NVS_KEY_TABLE, s_table, sizeof(s_table));
+    if (err == ESP_OK) err = nvs_set_u8(h, ACT_NVS_KEY_COMP, s_compensate ? 1 : 0);
+    if (err == ESP_OK) err = nvs_commit(h);
+    nvs_close(h);
+    return err;
+}
+
+esp_err_t actuator_init(void)
+{
+    // Same recovery as the Wi-Fi bring-up, which initializes NVS again later (no-op then)
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        nvs_flash_erase();
+        err = nvs_flash_init();
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "NVS unavailable (%s), actuator latencies not loaded", esp_err_to_name(err));
+        return err;
+    }
+
+    nvs_handle_t h;
+    err = nvs_open(ACT_NVS_NAMESPACE, NVS_READONLY, &h);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        ESP_LOGI(TAG, "No actuator characterization stored");
+        return ESP_OK;
+    }
+    if (err != ESP_OK) return err;
+
+    size_t len = sizeof(s_table);
+    if (nvs_get_blob(h, ACT_NVS_KEY_TABLE, s_table, &len) != ESP_OK || len != sizeof(s_table)) {
+        memset(s_table, 0, sizeof(s_table));    // missing or from another layout
+    }
+    uint8_t comp = 0;
+    nvs_get_u8(h, ACT_NVS_KEY_COMP, &comp);
+    s_compensate = (comp != 0);
+    nvs_close(h);
+
+    for (int a = 0; a < ACTUATOR_COUNT; a++) {
+        if (s_table[a].valid) {
+            ESP_LOGI(TAG, "%s: on %u ms, off %u ms", ACTUATORS[a].name, s_table[a].on_ms, s_table[a].off_ms);
+        }
+    }
+    ESP_LOGI(TAG, "OFF compensation %s", s_compensate ? "on" : "off");
+    return ESP_OK;
+}
+
+// ====================== CAPTURE ======================
+static uint32_t all_off_mask(void)
+{
+    uint32_t mask = 0;
+    for (int i = 0; i < NUM_COMPONENTS; i++) {
+        mask |= 1UL << all_pins[i];
+    }
+    return mask;
+}
+
+// Drive outputs through the executor; returns the esp_timer time of its register write
+static int64_t write_stamped(uint32_t set_mask, uint32_t clr_mask)
+{
+    ExecutorEdge edge;
+    while (executor_read_edges(&s_edge_cursor, &edge, 1, NULL) == 1) {}   // skip older edges
+    executor_write_outputs(set_mask, clr_mask);
+    if (executor_read_edges(&s_edge_cursor, &edge, 1, NULL) == 1) {
+        return edge.time_us;
+    }
+    return esp_timer_get_time();    // level did not change, no edge logged
+}
+
+// Next sample at the sensor's own rate (one HX710 conversion, or one RPM period)
+static float sample(ActuatorSense sense)
+{
+    if (sense == SENSE_RPM) {
+        vTaskDelay(pdMS_TO_TICKS(ACT_RPM_PERIOD_MS));
+        return rpm_sensor_get_rpm();
+    }
+    return pressure_sensor_read_frequency_once();
+}
+
+static float pressure_level(void)
+{
+    float sum = 0.0f;
+    for (int i = 0; i < ACT_BASELINE_SAMPLES; i++) {
+        sum += pressure_sensor_read_frequency_once();
+    }
+    return sum / ACT_BASELINE_SAMPLES;
+}
+
+static void record(ActuatorId a, bool after_off, int64_t since_us, float value)
+{
+    if (s_trace_len >= ACT_TRACE_LEN) {
+        s_trace_truncated = true;
+        return;
+    }
+    int64_t ms = since_us / 1000;
+    ActuatorSample *s = &s_trace[s_trace_len++];
+    s->t_ms = (ms > UINT16_MAX) ? UINT16_MAX : (uint16_t)ms;
+    s->act = (uint8_t)a;
+    s->after_off = after_off ? 1 : 0;
+    s->value = value;
+    s_results[a].trace_len++;
+}
+
+static bool responding(const ActuatorInfo *ai, float v, float baseline)
+{
+    if (ai->sense == SENSE_RPM) return v >= s_cfg.rpm_threshold;
+    return fabsf(v - baseline) >= s_cfg.press_delta_hz;
+}
+
+// ====================== SELF-TEST ======================
+static void run_actuator(ActuatorId a, float empty_hz)
+{
+    const ActuatorInfo *ai = &ACTUATORS[a];
+    ActuatorResult *r = &s_results[a];
+    uint32_t bit = 1UL << ai->pin;
+    bool rpm = (ai->sense == SENSE_RPM);
+
+    r->tested = true;
+    r->baseline = rpm ? rpm_sensor_get_rpm() : pressure_level();
+    r->peak = r->baseline;
+    r->trace_start = (uint16_t)s_trace_len;
+
+    // ON until the response plus ACT_HOLD_MS; the drain until the level is back near empty
+    int64_t t_on = write_stamped(0, bit);               // active-low: clear = ON
+    int64_t limit_us = (int64_t)ai->max_on_ms * 1000;
+    int64_t resp_us = -1;
+    float last = r->baseline;
+    while (!s_abort) {
+        float v = sample(ai->sense);
+        int64_t dt = esp_timer_get_time() - t_on;
+        record(a, false, dt, v);
+        last = v;
+        if (fabsf(v - r->baseline) > fabsf(r->peak - r->baseline)) r->peak = v;
+
+        if (resp_us < 0 && responding(ai, v, r->baseline)) {
+            resp_us = dt;
+            if (a != ACTUATOR_DRAIN_PUMP && dt + ACT_HOLD_MS * 1000LL < limit_us) {
+                limit_us = dt + ACT_HOLD_MS * 1000LL;
+            }
+        }
+        if (a == ACTUATOR_DRAIN_PUMP && resp_us >= 0 && fabsf(v - empty_hz) < s_cfg.press_delta_hz / 2) {
+            s_drained = true;
+            break;
+        }
+        if (dt >= limit_us) break;
+    }
+
+    // OFF until the response is over: RPM below the threshold, or the
+    // pressure no longer moving by more than ACT_SETTLE_HZ
+    int64_t t_off = write_stamped(bit, 0);
+    int64_t window_us = (int64_t)(rpm ? ACT_MOTOR_STOP_MS : ACT_OFF_WINDOW_MS) * 1000;
+    int64_t over_us = rpm ? -1 : 0;
+    float ref = last;
+    while (!s_abort) {
+        float v = sample(ai->sense);
+        int64_t dt = esp_timer_get_time() - t_off;
+        record(a, true, dt, v);
+        if (rpm) {
+            if (v < s_cfg.rpm_threshold) {
+                over_us = dt;
+                break;
+            }
+        } else if (fabsf(v - ref) >= ACT_SETTLE_HZ) {
+            ref = v;
+            over_us = dt;
+        }
+        if (dt >= window_us) break;
+    }
+
+    if (s_abort || resp_us < 0) return;
+    r->responded = true;
+    r->on_ms = (uint32_t)(resp_us / 1000);
+    r->off_ms = (uint32_t)(((over_us < 0) ? window_us : over_us) / 1000);
+}
+
+static void char_task(void *pvParameter)
+{
+    int64_t t0 = esp_timer_get_time();
+    ESP_LOGI(TAG, "=== ACTUATOR SELF-TEST START (pressure delta %.1f Hz, RPM threshold %.0f) ===",
+             s_cfg.press_delta_hz, s_cfg.rpm_threshold);
+
+    power_cycle_active(true);
+    pressure_sensor_set_tub_empty(false);
+    float empty_hz = pressure_level();
+
+    for (int a = 0; a < ACTUATOR_COUNT && !s_abort; a++) {
+        run_actuator((ActuatorId)a, empty_hz);
+        const ActuatorResult *r = &s_results[a];
+        if (r->responded) {
+            ESP_LOGI(TAG, "%s: on %lu ms, off %lu ms (baseline %.1f, peak %.1f, %u samples)",
+                     ACTUATORS[a].name, (unsigned long)r->on_ms, (unsigned long)r->off_ms,
+                     r->baseline, r->peak, r->trace_len);
+        } else if (!s_abort) {
+            ESP_LOGW(TAG, "%s: no response within %lu ms (baseline %.1f, peak %.1f)",
+                     ACTUATORS[a].name, (unsigned long)ACTUATORS[a].max_on_ms, r->baseline, r->peak);
+        }
+    }
+    executor_write_outputs(all_off_mask(), 0);
+
+    // Only a complete run updates the table; actuators without a response keep their old entry
+    if (!s_abort) {
+        size_t measured = 0;
+        for (int a = 0; a < ACTUATOR_COUNT; a++) {
+            const ActuatorResult *r = &s_results[a];
+            if (!r->responded) continue;
+            s_table[a].valid = true;
+            s_table[a].on_ms = (r->on_ms > UINT16_MAX) ? UINT16_MAX : (uint16_t)r->on_ms;
+            s_table[a].off_ms = (r->off_ms > UINT16_MAX) ? UINT16_MAX : (uint16_t)r->off_ms;
+            measured++;
+        }
+        if (measured) {
+            s_store_err = nvs_store();
+            if (s_store_err != ESP_OK) {
+                ESP_LOGE(TAG, "Storing actuator latencies failed: %s", esp_err_to_name(s_store_err));
+            }
+        }
+    }
+
+    pressure_sensor_set_tub_empty(s_drained);
+    power_cycle_active(false);
+    s_run_ms = (uint32_t)((esp_timer_get_time() - t0) / 1000);
+    ESP_LOGI(TAG, "=== ACTUATOR SELF-TEST %s after %lu ms (%zu samples%s) ===",
+             s_abort ? "ABORTED" : "DONE", (unsigned long)s_run_ms, s_trace_len,
+             s_trace_truncated ? ", trace truncated" : "");
+    s_state = s_abort ? CHAR_ABORTED : CHAR_DONE;
+    vTaskDelete(NULL);
+}
+
+esp_err_t actuator_char_start(const ActuatorCharConfig *cfg)
+{
+    if (s_state == CHAR_RUNNING || cycle_is_running() || executor_output_sequence_active()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    ActuatorCharConfig c = cfg ? *cfg : (ActuatorCharConfig){ 0 };
+    if (c.press_delta_hz < 0 || c.rpm_threshold < 0) return ESP_ERR_INVALID_ARG;
+    if (c.press_delta_hz == 0) c.press_delta_hz = ACTUATOR_DEFAULT_PRESS_DELTA_HZ;
+    if (c.rpm_threshold == 0) c.rpm_threshold = ACTUATOR_DEFAULT_RPM_THRESHOLD;
+
+    s_cfg = c;
+    memset(s_results, 0, sizeof(s_results));
+    s_trace_len = 0;
+    s_trace_truncated = false;
+    s_drained = false;
+    s_run_ms = 0;
+    s_store_err = ESP_OK;
+    s_abort = false;
+    s_state = CHAR_RUNNING;
+
+    // Same priority as the cycle runner; the sampling loops block on the sensor or a delay
+    if (xTaskCreate(char_task, "act_char", 4096, NULL, 2, NULL) != pdPASS) {
+        s_state = CHAR_IDLE;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void actuator_char_abort(void)
+{
+    if (s_state == CHAR_RUNNING) {
+        s_abort = true;
+        ESP_LOGW(TAG, "Actuator self-test abort requested");
+    }
+}
+
+bool actuator_char_running(void)
+{
+    return s_state == CHAR_RUNNING;
+}
+
+// ====================== TABLE / COMPENSATION ======================
+ActuatorLatency actuator_latency(ActuatorId id)
+{
+    ActuatorLatency none = { 0 };
+    return (id < ACTUATOR_COUNT) ? s_table[id] : none;
+}
+
+esp_err_t actuator_set_compensation(bool enabled)
+{
+    s_compensate = enabled;
+    ESP_LOGI(TAG, "OFF compensation %s", enabled ? "on" : "off");
+    return nvs_store();
+}
+
+bool actuator_compensation_enabled(void)
+{
+    return s_compensate;
+}
+
+uint32_t actuator_off_lead_ms(gpio_num_t pin, uint32_t on_ms)
+{
+    if (!s_compensate) return 0;
+    for (int a = 0; a < ACTUATOR_COUNT; a++) {
+        if (ACTUATORS[a].pin != pin) continue;
+        if (!ACTUATORS[a].compensated || !s_table[a].valid) return 0;
+        uint32_t lead = s_table[a].off_ms;
+        return (lead > on_ms / 2) ? on_ms / 2 : lead;
+    }
+    return 0;
+}
+
+// ====================== REPORT ======================
+char *actuator_to_json(bool with_trace)
+{
+    cJSON *root = cJSON_CreateObject();
+    if (!root) return NULL;
+
+    cJSON_AddStringToObject(root, "type", "actuator_char");
+    cJSON_AddStringToObject(root, "state", CHAR_STATE_NAMES[s_state]);
+    cJSON_AddBoolToObject(root, "compensation", s_compensate);
+    if (s_state != CHAR_IDLE) {
+        cJSON_AddNumberToObject(root, "press_delta_hz", s_cfg.press_delta_hz);
+        cJSON_AddNumberToObject(root, "rpm_threshold", s_cfg.rpm_threshold);
+        cJSON_AddNumberToObject(root, "run_ms", s_run_ms);
+        cJSON_AddBoolToObject(root, "drained", s_drained);
+        cJSON_AddBoolToObject(root, "stored", s_store_err == ESP_OK);
+        cJSON_AddNumberToObject(root, "samples", (double)s_trace_len);
+        cJSON_AddBoolToObject(root, "trace_truncated", s_trace_truncated);
+    }
+
+    cJSON *list = cJSON_AddArrayToObject(root, "actuators");
+    for (int a = 0; a < ACTUATOR_COUNT; a++) {
+        const ActuatorInfo *ai = &ACTUATORS[a];
+        cJSON *o = cJSON_CreateObject();
+        cJSON_AddStringToObject(o, "name", ai->name);
+        cJSON_AddNumberToObject(o, "pin", ai->pin);
+        cJSON_AddStringToObject(o, "sensor", ai->sense == SENSE_RPM ? "rpm" : "pressure");
+        cJSON_AddBoolToObject(o, "valid", s_table[a].valid);
+        cJSON_AddNumberToObject(o, "on_ms", s_table[a].on_ms);
+        cJSON_AddNumberToObject(o, "off_ms", s_table[a].off_ms);
+        cJSON_AddBoolToObject(o, "compensated", ai->compensated);
+
+        const ActuatorResult *r = &s_results[a];
+        if (r->tested) {
+            cJSON *last = cJSON_AddObjectToObject(o, "last");
+            cJSON_AddBoolToObject(last, "responded", r->responded);
+            cJSON_AddNumberToObject(last, "on_ms", r->on_ms);
+            cJSON_AddNumberToObject(last, "off_ms", r->off_ms);
+            cJSON_AddNumberToObject(last, "baseline", r->baseline);
+            cJSON_AddNumberToObject(last, "peak", r->peak);
+            cJSON_AddNumberToObject(last, "samples", r->trace_len);
+            if (with_trace) {
+                // [t_ms, 0 = after ON / 1 = after OFF, value]
+                cJSON *trace = cJSON_AddArrayToObject(last, "trace");
+                for (size_t i = r->trace_start; i < (size_t)r->trace_start + r->trace_len && i < ACT_TRACE_LEN; i++) {
+                    cJSON *s = cJSON_CreateArray();
+                    cJSON_AddItemToArray(s, cJSON_CreateNumber(s_trace[i].t_ms));
+                    cJSON_AddItemToArray(s, cJSON_CreateNumber(s_trace[i].after_off));
+                    cJSON_AddItemToArray(s, cJSON_CreateNumber(roundf(s_trace[i].value * 10.0f) / 10.0f));
+                    cJSON_AddItemToArray(trace, s);
+                }
+            }
+        }
+        cJSON_AddItemToArray(list, o);
+    }
+
+    char *json_str = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    return json_str;
+}
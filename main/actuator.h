@@ -0,0 +1,75 @@
+// actuator.h
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+
+// Actuator response characterization. A self-test switches every actuator
+// that has a sensor behind it ON and OFF through the executor, samples that
+// sensor at its native rate with times taken from the executor's own
+// register-write timestamps, and derives per actuator:
+//   on_ms  - ON write  -> response (pressure moved by press_delta_hz, RPM above rpm_threshold)
+//   off_ms - OFF write -> response over (pressure stopped moving, RPM below rpm_threshold)
+// Pressure samples are single HX710 conversions, so both figures carry up to
+// one conversion period of quantization.
+//
+// The table is kept in NVS. With compensation on, the timeline builder
+// schedules a valve's OFF event off_ms earlier (at most half its ON time) so
+// the water still arriving after the close lands inside the programmed time.
+// Motor and drain pump figures are measured and stored but not compensated:
+// shifting motor OFF by its run-down would cut every agitation step short.
+
+typedef enum {
+    ACTUATOR_COLD_VALVE,
+    ACTUATOR_HOT_VALVE,
+    ACTUATOR_DETERGENT_VALVE,
+    ACTUATOR_SOFT_VALVE,
+    ACTUATOR_MOTOR,
+    ACTUATOR_DRAIN_PUMP,        // last: empties what the valves let in
+    ACTUATOR_COUNT
+} ActuatorId;
+
+typedef struct {
+    bool     valid;             // measured at least once
+    uint16_t on_ms;
+    uint16_t off_ms;
+} ActuatorLatency;
+
+// Self-test thresholds (0 = default)
+typedef struct {
+    float press_delta_hz;       // pressure counts as responding once it moved this far
+    float rpm_threshold;        // motor counts as running above this
+} ActuatorCharConfig;
+
+#define ACTUATOR_DEFAULT_PRESS_DELTA_HZ  20.0f
+#define ACTUATOR_DEFAULT_RPM_THRESHOLD   30.0f
+
+// Load the latency table and compensation setting from NVS (call once at boot)
+esp_err_t actuator_init(void);
+
+// Start the self-test in its own task. ESP_ERR_INVALID_STATE while a cycle,
+// an output sequence or another self-test runs. The outputs really switch:
+// the valves fill the tub and the drain pump empties it again.
+esp_err_t actuator_char_start(const ActuatorCharConfig *cfg);
+
+// Stop a running self-test; every output is switched OFF, nothing is stored
+void actuator_char_abort(void);
+bool actuator_char_running(void);
+
+// Current table entry (valid = false if never measured)
+ActuatorLatency actuator_latency(ActuatorId id);
+
+// Enable/disable OFF-event compensation (stored in NVS, used from the next phase build)
+esp_err_t actuator_set_compensation(bool enabled);
+bool actuator_compensation_enabled(void);
+
+// How much earlier the timeline builder should schedule the OFF event of an
+// on_ms long ON period on pin (0 when compensation is off, the pin is not
+// compensated or was never measured; never more than on_ms / 2)
+uint32_t actuator_off_lead_ms(gpio_num_t pin, uint32_t on_ms);
+
+// {"type":"actuator_char",...}: state, table and per-actuator results of the
+// last self-test; with_trace adds the captured samples. Caller frees.
+char *actuator_to_json(bool with_trace);
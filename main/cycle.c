@@ -7,13 +7,20 @@
 
     #include "freertos/FreeRTOS.h"
     #include "freertos/task.h"
-    #include "freertos/semphr.h"
 
     #include "fs.h"
     #include "cJSON.h"
     #include "rpm_sensor.h"      // for rpm_sensor_reset(), rpm_sensor_get_rpm()
     #include "pressure_sensor.h" // for pressure_sensor_reset(), pressure_sensor_read_frequency()
     #include "ws_cycle.h"        // for ws_update_cycle_data_cache()
+    #include "executor.h"        // merged single-timer executor for all tracks
+    #include "power.h"           // block light sleep while a cycle runs
+    #include "telemetry.h"       // telemetry_notify_change() on phase transitions
+    #include "actuator.h"        // measured valve latencies for OFF compensation
+    #include "motor_mon.h"       // motor/tach fault windows while the cycle runs
+    #include "imbalance.h"       // spin ripple metric for Imbalance triggers
+    #include "flow_meter.h"      // pulse-exact Volume triggers
+    #include <stdlib.h>          // qsort
 
     static const char *TAG = "cycle";
 
@@ -35,6 +42,11 @@ uint64_t phase_start_us = 0;  // track phase start time (non-static for telemetr
 bool cycle_running = false;  // non-static for telemetry access
 const char *current_phase_name = "N/A";  // non-static for telemetry access
 static int target_phase_index = -1;  // -1 means no skip, -2 means stop cycle, otherwise jump to this phase
+static TaskHandle_t s_cycle_task = NULL;  // cycle_runner task while a cycle is running
+static int64_t s_start_request_us = -1; // esp_timer time of the last start request (cycle_run_loaded_cycle), -1 if none
+static uint32_t s_flow_start[MAX_TRACKS];   // flow meter count when each track's phase started
+static uint32_t s_flow_target[MAX_TRACKS];  // pulses a Volume trigger waits for
+static uint32_t s_flow_end = 0;             // flow meter count when the last cycle ended
 int current_phase_index = 0;  // track which phase we're currently running (accessible to telemetry)
 
 // Global state for loaded cycle (for cycle_load_from_json_str + cycle_run_loaded_cycle)
@@ -47,26 +59,417 @@ size_t g_num_phases = 0;  // non-static for telemetry access    // -------------
         HOT_VALVE_PIN, SOFT_VALVE_PIN, MOTOR_ON_PIN, MOTOR_DIRECTION_PIN
     };
 
-    // ------------------ PHASE RUN CONTEXT ------------------
-    #define BATCH_SIZE 200  // Max timers to create at once (heap-friendly)
-    
+    // ------------------ PROGRAM (phase-level repeat / call) ------------------
+    // The "phases" list is compiled into g_program so repeated blocks and
+    // subroutines are stored once and replayed by the runner with a small
+    // control stack instead of being duplicated at upload.
+    ProgramOp g_program[MAX_PROGRAM_OPS];
+    size_t g_program_len = 0;
+
+    // Concurrent tracks sharing the cycle timeline ("phases" is track 0)
+    CycleTrack g_tracks[MAX_TRACKS];
+    size_t g_num_tracks = 0;
+
     typedef struct {
-        TimelineEvent events[MAX_EVENTS_PER_PHASE];
-        esp_timer_handle_t timers[BATCH_SIZE];  // Only store current batch timers
-        size_t num_events;
-        size_t remaining_events;     
-        bool   active;
+        Phase          *phases;
+        size_t          max_phases;
+        PhaseComponent *components_pool;
+        size_t          max_components_per_phase;
+        size_t          num_phases;
+        const cJSON    *subroutines;                    // "subroutines" object (may be NULL)
+        uint16_t        sub_entry[MAX_SUBROUTINES];     // first op of each subroutine
+    } ProgramBuilder;
+
+    // Typed field readers: a missing field or one of the wrong type reads as the default,
+    // so a malformed upload never dereferences valuestring on a non-string node
+    static const char *json_str(const cJSON *obj, const char *key, const char *def)
+    {
+        const cJSON *v = cJSON_GetObjectItem(obj, key);
+        return cJSON_IsString(v) ? v->valuestring : def;
+    }
+
+    static uint32_t json_uint(const cJSON *obj, const char *key, uint32_t def)
+    {
+        const cJSON *v = cJSON_GetObjectItem(obj, key);
+        return (cJSON_IsNumber(v) && v->valuedouble >= 0) ? (uint32_t)v->valueint : def;
+    }
+
+    // Parse one phase object (components, motor configs, sensor trigger) into p.
+    static void parse_phase_json(const cJSON *pjson,
+                                 Phase *p,
+                                 PhaseComponent *phase_comps,
+                                 size_t max_components_per_phase)
+    {
+        cJSON *components= cJSON_GetObjectItem(pjson, "components");
+
+        p->id   = json_str(pjson, "id", NULL);
+        p->start_time_ms = json_uint(pjson, "startTime", 0);
+
+        p->components = phase_comps;
+        p->num_components = 0;
+
+        // Parse each component (walk the list once: cJSON_GetArrayItem(i) restarts from the head)
+        cJSON *comp_list = cJSON_IsArray(components) ? components : NULL;
+        cJSON *cjson;
+        cJSON_ArrayForEach(cjson, comp_list) {
+            if (p->num_components >= max_components_per_phase) break;
+            PhaseComponent *c = &phase_comps[p->num_components++];
+
+            cJSON *motorCfg = cJSON_GetObjectItem(cjson, "motorConfig");
+
+            c->id          = json_str(cjson, "id", NULL);
+            c->compId      = json_str(cjson, "compId", NULL);
+            c->start_ms    = json_uint(cjson, "start", 0);
+            c->duration_ms = json_uint(cjson, "duration", 0);
+            c->has_motor   = false;
+            c->motor_cfg   = NULL;
+
+            // optional motorConfig
+            if (cJSON_IsObject(motorCfg)) {
+                // make sure we have room
+                if (g_motor_cfg_used < MAX_MOTOR_CONFIGS) {
+                    MotorConfig *mc = &g_motor_cfg_pool[g_motor_cfg_used++];
+                    memset(mc, 0, sizeof(MotorConfig));
+
+                    // repeatTimes
+                    mc->repeat_times = (int)json_uint(motorCfg, "repeatTimes", 1);
+
+                    // pattern array
+                    cJSON *pattern = cJSON_GetObjectItem(motorCfg, "pattern");
+                    if (pattern && cJSON_IsArray(pattern)) {
+                        int pattern_len = cJSON_GetArraySize(pattern);
+                        if (pattern_len > 0) {
+                            ESP_LOGI(TAG, "Processing motor pattern with %d steps (repeat: %d), steps pool: %zu/%d", 
+                                    pattern_len, mc->repeat_times, g_motor_steps_used, MAX_MOTOR_STEPS);
+                            
+                            // remember where this motor's steps start in the global steps pool
+                            size_t steps_start = g_motor_steps_used;
+                            int si = 0;
+                            cJSON *step_json;
+                            cJSON_ArrayForEach(step_json, pattern) {
+                                if (g_motor_steps_used >= MAX_MOTOR_STEPS) {
+                                    ESP_LOGE(TAG, "Motor steps pool exhausted! Used: %zu, Max: %d. Pattern truncated at step %d/%d", 
+                                            g_motor_steps_used, MAX_MOTOR_STEPS, si, pattern_len);
+                                    break;
+                                }
+                                si++;
+                                MotorPatternStep *step = &g_motor_steps_pool[g_motor_steps_used++];
+
+                                step->step_time_ms  = json_uint(step_json, "stepTime", 1000);
+                                step->pause_time_ms = json_uint(step_json, "pauseTime", 0);
+                                step->direction     = json_str(step_json, "direction", "cw");
+                            }
+
+                            // now point the motor config to its slice of steps
+                            mc->pattern     = &g_motor_steps_pool[steps_start];
+                            mc->pattern_len = g_motor_steps_used - steps_start;
+                            
+                            ESP_LOGI(TAG, "Motor pattern stored: %zu steps from pool[%zu]", 
+                                    mc->pattern_len, steps_start);
+                        }
+                    }
+
+                    // finally hook this component to this motor config
+                    c->has_motor = true;
+                    c->motor_cfg = mc;
+                } else {
+                    ESP_LOGW(TAG, "motorConfig present but motor cfg pool is full");
+                }
+            }
+        }
+
+        // Parse optional sensorTrigger for this phase
+        cJSON *sensorTrigger = cJSON_GetObjectItem(pjson, "sensorTrigger");
+        p->sensor_trigger = NULL;  // default: no trigger
         
-        // Batch tracking
-        size_t current_batch_idx;       // Which batch are we on (0, 1, 2, ...)
-        size_t batches_total;           // Total number of batches
-        size_t next_batch_start_event;  // Index of first event in next batch
-        esp_timer_handle_t batch_timer; // Timer that signals batch completion
-        uint64_t batch_start_us;        // When this batch started (for timing)
-        SemaphoreHandle_t batch_sem;    // semaphore used to notify task to load next batch
-    } PhaseRunContext;
+        if (cJSON_IsObject(sensorTrigger)) {
+            if (g_sensor_trigger_used < MAX_SENSOR_TRIGGERS) {
+                SensorTrigger *st = &g_sensor_trigger_pool[g_sensor_trigger_used++];
+                memset(st, 0, sizeof(SensorTrigger));
+                
+                // Parse sensor type (absent: RPM; present but not a string: unknown)
+                cJSON *type = cJSON_GetObjectItem(sensorTrigger, "type");
+                const char *type_str = !type ? "RPM" : (cJSON_IsString(type) ? type->valuestring : "");
+                if (strcmp(type_str, "RPM") == 0) {
+                    st->type = SENSOR_TYPE_RPM;
+                } else if (strcmp(type_str, "Pressure") == 0) {
+                    st->type = SENSOR_TYPE_PRESSURE;
+                } else if (strcmp(type_str, "Imbalance") == 0) {
+                    st->type = SENSOR_TYPE_IMBALANCE;
+                } else if (strcmp(type_str, "Volume") == 0) {
+                    st->type = SENSOR_TYPE_VOLUME;      // threshold in mL
+                } else {
+                    st->type = SENSOR_TYPE_UNKNOWN;
+                }
+                
+                // Parse threshold
+                st->threshold = json_uint(sensorTrigger, "threshold", 0);
+                
+                // Parse trigger direction
+                cJSON *triggerAbove = cJSON_GetObjectItem(sensorTrigger, "triggerAbove");
+                st->trigger_above = triggerAbove ? triggerAbove->type == cJSON_True : true;
+                
+                // Track that trigger hasn't fired yet
+                st->has_triggered = false;
+                
+                p->sensor_trigger = st;
+                ESP_LOGI(TAG, "Phase '%s': sensor trigger configured (type=%d, threshold=%u, above=%d)",
+                         p->id ? p->id : "unknown", st->type, st->threshold, st->trigger_above);
+            } else {
+                ESP_LOGW(TAG, "sensor_trigger pool full, ignoring trigger for phase '%s'", p->id ? p->id : "unknown");
+            }
+        }
+    }
+
+    // Append one op to g_program. Returns its index, or -1 if the program is full.
+    static int program_emit(ProgramOpType op, uint16_t arg, uint16_t target)
+    {
+        if (g_program_len >= MAX_PROGRAM_OPS) {
+            ESP_LOGE(TAG, "Program op pool exhausted (max %d ops)", MAX_PROGRAM_OPS);
+            return -1;
+        }
+        g_program[g_program_len].op     = op;
+        g_program[g_program_len].arg    = arg;
+        g_program[g_program_len].target = target;
+        return (int)g_program_len++;
+    }
 
-    static PhaseRunContext g_phase_ctx;   // current / latest phase
+    // Index of a named subroutine inside the "subroutines" object, or -1
+    static int find_subroutine(const ProgramBuilder *b, const char *name)
+    {
+        int idx = 0;
+        const cJSON *sub;
+        if (!b->subroutines || !name) return -1;
+        cJSON_ArrayForEach(sub, b->subroutines) {
+            if (idx >= MAX_SUBROUTINES) break;
+            if (sub->string && strcmp(sub->string, name) == 0) return idx;
+            idx++;
+        }
+        return -1;
+    }
+
+    // Compile a "phases" list. Entries are either a phase object,
+    // { "repeat": N, "phases": [...] } or { "call": "<subroutine>" }.
+    static esp_err_t compile_phase_list(ProgramBuilder *b, const cJSON *list, int depth)
+    {
+        if (depth > MAX_CONTROL_DEPTH) {
+            ESP_LOGE(TAG, "Repeat blocks nested deeper than %d", MAX_CONTROL_DEPTH);
+            return ESP_FAIL;
+        }
+
+        const cJSON *item;
+        cJSON_ArrayForEach(item, list) {
+            cJSON *repeat = cJSON_GetObjectItem(item, "repeat");
+            cJSON *call   = cJSON_GetObjectItem(item, "call");
+
+            if (cJSON_IsNumber(repeat)) {
+                cJSON *body = cJSON_GetObjectItem(item, "phases");
+                if (!cJSON_IsArray(body)) {
+                    ESP_LOGE(TAG, "repeat block without a 'phases' array");
+                    return ESP_FAIL;
+                }
+                if (repeat->valuedouble != (double)repeat->valueint ||
+                    repeat->valueint < 1 || repeat->valueint > MAX_REPEAT_COUNT) {
+                    ESP_LOGE(TAG, "repeat count must be an integer in 1..%d", MAX_REPEAT_COUNT);
+                    return ESP_FAIL;
+                }
+                int rep = program_emit(PROG_OP_REPEAT, (uint16_t)repeat->valueint, 0);
+                if (rep < 0) return ESP_FAIL;
+                if (compile_phase_list(b, body, depth + 1) != ESP_OK) return ESP_FAIL;
+                int next = program_emit(PROG_OP_NEXT, 0, (uint16_t)(rep + 1));
+                if (next < 0) return ESP_FAIL;
+                g_program[rep].target = (uint16_t)(next + 1);  // where a zero-count loop skips to
+            } else if (cJSON_IsString(call)) {
+                int sub = find_subroutine(b, call->valuestring);
+                if (sub < 0) {
+                    ESP_LOGE(TAG, "call to unknown subroutine '%s'", call->valuestring);
+                    return ESP_FAIL;
+                }
+                if (program_emit(PROG_OP_CALL, (uint16_t)sub, 0) < 0) return ESP_FAIL;
+            } else {
+                if (b->num_phases >= b->max_phases) {
+                    ESP_LOGW(TAG, "Phase limit reached (%zu), ignoring extra phases", b->max_phases);
+                    continue;
+                }
+                size_t pi = b->num_phases++;
+                parse_phase_json(item, &b->phases[pi],
+                                 &b->components_pool[pi * b->max_components_per_phase],
+                                 b->max_components_per_phase);
+                if (program_emit(PROG_OP_PHASE, (uint16_t)pi, 0) < 0) return ESP_FAIL;
+            }
+        }
+        return ESP_OK;
+    }
+
+    // Phases executed from *pc until the END, RETURN or NEXT that closes the
+    // sequence, with repeats and calls expanded; *pc is left on that op.
+    // Returns -1 for a repeat body or subroutine that runs no phase (the runner
+    // would loop without yielding), nesting beyond the runner's control stack,
+    // or more than MAX_PHASE_RUNS phases.
+    static int32_t program_phase_runs(size_t *pc, int depth)
+    {
+        int32_t runs = 0;
+
+        for (; *pc < g_program_len; (*pc)++) {
+            const ProgramOp *op = &g_program[*pc];
+            if (op->op == PROG_OP_END || op->op == PROG_OP_RETURN || op->op == PROG_OP_NEXT) break;
+
+            int32_t n = 1;
+            if (op->op == PROG_OP_REPEAT || op->op == PROG_OP_CALL) {
+                if (depth >= MAX_CONTROL_DEPTH) {
+                    ESP_LOGE(TAG, "Repeat/call frames nested deeper than %d at op %zu", MAX_CONTROL_DEPTH, *pc);
+                    return -1;
+                }
+                size_t at = *pc;
+                size_t body_pc = (op->op == PROG_OP_REPEAT) ? at + 1 : op->target;
+                n = program_phase_runs(&body_pc, depth + 1);
+                if (n < 0) return -1;
+                if (n == 0) {
+                    ESP_LOGE(TAG, "%s at op %zu runs no phase",
+                             op->op == PROG_OP_REPEAT ? "repeat block" : "subroutine", at);
+                    return -1;
+                }
+                if (op->op == PROG_OP_REPEAT) {
+                    n *= op->arg;       // both factors are capped, no overflow
+                    *pc = body_pc;      // continue after the closing NEXT
+                }
+            }
+            if (n > MAX_PHASE_RUNS - runs) {
+                ESP_LOGE(TAG, "Program runs more than %d phases", MAX_PHASE_RUNS);
+                return -1;
+            }
+            runs += n;
+        }
+        return runs;
+    }
+
+    static size_t count_phase_events(const Phase *phase);
+
+    // Largest timeline of any phase reachable from pc (following calls), so the
+    // executor can give each track a big enough slice of the event pool.
+    static size_t max_events_from(const Phase *phases, size_t pc, int depth)
+    {
+        size_t max_events = 0;
+        if (depth > MAX_CONTROL_DEPTH) return 0;
+
+        for (; pc < g_program_len; pc++) {
+            const ProgramOp *op = &g_program[pc];
+            if (op->op == PROG_OP_END || op->op == PROG_OP_RETURN) break;
+
+            size_t n = 0;
+            if (op->op == PROG_OP_PHASE) {
+                n = count_phase_events(&phases[op->arg]);
+            } else if (op->op == PROG_OP_CALL) {
+                n = max_events_from(phases, op->target, depth + 1);
+            }
+            if (n > max_events) max_events = n;
+        }
+        return max_events;
+    }
+
+    // Compile one track's sequence, terminated by END
+    static esp_err_t compile_track(ProgramBuilder *b, const char *id, const cJSON *list)
+    {
+        if (g_num_tracks >= MAX_TRACKS) {
+            ESP_LOGE(TAG, "Too many tracks (max %d)", MAX_TRACKS);
+            return ESP_FAIL;
+        }
+        CycleTrack *tr = &g_tracks[g_num_tracks++];
+        tr->id = id;
+        tr->entry_pc = (uint16_t)g_program_len;
+        tr->max_phase_events = 0;
+
+        if (compile_phase_list(b, list, 0) != ESP_OK) return ESP_FAIL;
+        if (program_emit(PROG_OP_END, 0, 0) < 0) return ESP_FAIL;
+        return ESP_OK;
+    }
+
+    // Compile the main "phases" list and any "tracks", followed by every
+    // subroutine body, then resolve CALL targets to subroutine entry ops.
+    static esp_err_t load_program_from_root(const cJSON *root,
+                                            Phase *phases,
+                                            size_t max_phases,
+                                            PhaseComponent *components_pool,
+                                            size_t max_components_per_phase,
+                                            size_t *out_num_phases)
+    {
+        cJSON *phases_arr = cJSON_GetObjectItem(root, "phases");
+        cJSON *tracks_arr = cJSON_GetObjectItem(root, "tracks");
+        if (!cJSON_IsArray(phases_arr) && !cJSON_IsArray(tracks_arr)) {
+            ESP_LOGE(TAG, "'phases' is missing or not an array");
+            return ESP_FAIL;
+        }
+
+        ProgramBuilder b = {
+            .phases = phases,
+            .max_phases = max_phases,
+            .components_pool = components_pool,
+            .max_components_per_phase = max_components_per_phase,
+            .num_phases = 0,
+            .subroutines = NULL,
+        };
+
+        cJSON *subs = cJSON_GetObjectItem(root, "subroutines");
+        if (cJSON_IsObject(subs)) {
+            b.subroutines = subs;
+            if (cJSON_GetArraySize(subs) > MAX_SUBROUTINES) {
+                ESP_LOGE(TAG, "Too many subroutines (max %d)", MAX_SUBROUTINES);
+                return ESP_FAIL;
+            }
+        }
+
+        g_program_len = 0;
+        g_num_tracks = 0;
+        if (cJSON_IsArray(phases_arr)) {
+            if (compile_track(&b, "main", phases_arr) != ESP_OK) return ESP_FAIL;
+        }
+
+        const cJSON *track;
+        cJSON_ArrayForEach(track, tracks_arr) {
+            cJSON *tid    = cJSON_GetObjectItem(track, "id");
+            cJSON *tlist  = cJSON_GetObjectItem(track, "phases");
+            if (!cJSON_IsArray(tlist)) {
+                ESP_LOGE(TAG, "track without a 'phases' array");
+                return ESP_FAIL;
+            }
+            if (compile_track(&b, cJSON_IsString(tid) ? tid->valuestring : "track", tlist) != ESP_OK) {
+                return ESP_FAIL;
+            }
+        }
+
+        int si = 0;
+        const cJSON *sub;
+        cJSON_ArrayForEach(sub, b.subroutines) {
+            if (!cJSON_IsArray(sub)) {
+                ESP_LOGE(TAG, "subroutine '%s' is not an array", sub->string ? sub->string : "?");
+                return ESP_FAIL;
+            }
+            b.sub_entry[si++] = (uint16_t)g_program_len;
+            if (compile_phase_list(&b, sub, 0) != ESP_OK) return ESP_FAIL;
+            if (program_emit(PROG_OP_RETURN, 0, 0) < 0) return ESP_FAIL;
+        }
+
+        for (size_t i = 0; i < g_program_len; i++) {
+            if (g_program[i].op == PROG_OP_CALL) {
+                g_program[i].target = b.sub_entry[g_program[i].arg];
+            }
+        }
+
+        // Bound the expanded length of every track before anything runs it
+        for (size_t t = 0; t < g_num_tracks; t++) {
+            size_t pc = g_tracks[t].entry_pc;
+            if (program_phase_runs(&pc, 0) < 0) return ESP_FAIL;
+        }
+
+        for (size_t t = 0; t < g_num_tracks; t++) {
+            g_tracks[t].max_phase_events = max_events_from(phases, g_tracks[t].entry_pc, 0);
+        }
+
+        *out_num_phases = b.num_phases;
+        ESP_LOGI(TAG, "Program compiled: %zu distinct phases, %zu tracks, %zu ops, %d subroutines",
+                 b.num_phases, g_num_tracks, g_program_len, si);
+        return ESP_OK;
+    }
 
     esp_err_t load_cycle_from_json_str(const char *json_str,
                                     Phase *phases,
@@ -90,157 +493,12 @@ size_t g_num_phases = 0;  // non-static for telemetry access    // -------------
             return ESP_FAIL;
         }
 
-        cJSON *phases_arr = cJSON_GetObjectItem(root, "phases");
-        if (!cJSON_IsArray(phases_arr)) {
-            ESP_LOGE(TAG, "'phases' is missing or not an array");
+        if (load_program_from_root(root, phases, max_phases, components_pool,
+                                   max_components_per_phase, out_num_phases) != ESP_OK) {
             cJSON_Delete(root);
             return ESP_FAIL;
         }
 
-        size_t num_phases = cJSON_GetArraySize(phases_arr);
-        if (num_phases > max_phases) {
-            num_phases = max_phases;
-        }
-
-        for (size_t pi = 0; pi < num_phases; pi++) {
-            cJSON *pjson = cJSON_GetArrayItem(phases_arr, pi);
-            Phase *p = &phases[pi];
-
-            cJSON *id        = cJSON_GetObjectItem(pjson, "id");
-            cJSON *startTime = cJSON_GetObjectItem(pjson, "startTime");
-            cJSON *components= cJSON_GetObjectItem(pjson, "components");
-
-            p->id   = id   ? id->valuestring   : NULL;
-            p->start_time_ms = startTime ? (uint32_t)startTime->valueint : 0;
-
-            size_t comp_count = cJSON_IsArray(components) ? cJSON_GetArraySize(components) : 0;
-            if (comp_count > max_components_per_phase) {
-                comp_count = max_components_per_phase;
-            }
-
-            PhaseComponent *phase_comps = &components_pool[pi * max_components_per_phase];
-            p->components = phase_comps;
-            p->num_components = comp_count;
-
-            for (size_t ci = 0; ci < comp_count; ci++) {
-                cJSON *cjson = cJSON_GetArrayItem(components, ci);
-                PhaseComponent *c = &phase_comps[ci];
-
-                cJSON *cid      = cJSON_GetObjectItem(cjson, "id");
-                cJSON *start    = cJSON_GetObjectItem(cjson, "start");
-                cJSON *compId   = cJSON_GetObjectItem(cjson, "compId");
-                cJSON *duration = cJSON_GetObjectItem(cjson, "duration");
-                cJSON *motorCfg = cJSON_GetObjectItem(cjson, "motorConfig");
-
-                c->id          = cid      ? cid->valuestring      : NULL;
-                c->compId      = compId   ? compId->valuestring   : NULL;
-                c->start_ms    = start    ? (uint32_t)start->valueint    : 0;
-                c->duration_ms = duration ? (uint32_t)duration->valueint : 0;
-                c->has_motor   = false;
-                c->motor_cfg   = NULL;
-
-                // optional motorConfig
-            if (motorCfg && !cJSON_IsNull(motorCfg)) {
-                    // make sure we have room
-                    if (g_motor_cfg_used < MAX_MOTOR_CONFIGS) {
-                        MotorConfig *mc = &g_motor_cfg_pool[g_motor_cfg_used++];
-                        memset(mc, 0, sizeof(MotorConfig));
-
-                        // repeatTimes
-                        cJSON *repeatTimes  = cJSON_GetObjectItem(motorCfg, "repeatTimes");
-                        mc->repeat_times = repeatTimes ? repeatTimes->valueint : 1;
-
-                        // pattern array
-                        cJSON *pattern = cJSON_GetObjectItem(motorCfg, "pattern");
-                        if (pattern && cJSON_IsArray(pattern)) {
-                            int pattern_len = cJSON_GetArraySize(pattern);
-                            if (pattern_len > 0) {
-                                ESP_LOGI(TAG, "Processing motor pattern with %d steps (repeat: %d), steps pool: %zu/%d", 
-                                        pattern_len, mc->repeat_times, g_motor_steps_used, MAX_MOTOR_STEPS);
-                                
-                                // Calculate total steps needed including repeats
-                                int total_steps_needed = pattern_len * mc->repeat_times;
-                                
-                                // remember where this motor's steps start in the global steps pool
-                                size_t steps_start = g_motor_steps_used;
-                                for (int si = 0; si < pattern_len; si++) {
-                                    if (g_motor_steps_used >= MAX_MOTOR_STEPS) {
-                                        ESP_LOGE(TAG, "Motor steps pool exhausted! Used: %zu, Max: %d. Pattern truncated at step %d/%d", 
-                                                g_motor_steps_used, MAX_MOTOR_STEPS, si, pattern_len);
-                                        break;
-                                    }
-                                    cJSON *step_json = cJSON_GetArrayItem(pattern, si);
-                                    MotorPatternStep *step = &g_motor_steps_pool[g_motor_steps_used++];
-
-                                    cJSON *stepTime  = cJSON_GetObjectItem(step_json, "stepTime");
-                                    cJSON *pauseTime = cJSON_GetObjectItem(step_json, "pauseTime");
-                                    cJSON *direction = cJSON_GetObjectItem(step_json, "direction");
-
-                                    step->step_time_ms  = stepTime  ? (uint32_t)stepTime->valueint  : 1000;
-                                    step->pause_time_ms = pauseTime ? (uint32_t)pauseTime->valueint : 0;
-                                    step->direction     = direction ? direction->valuestring        : "cw";
-                                }
-
-                                // now point the motor config to its slice of steps
-                                mc->pattern     = &g_motor_steps_pool[steps_start];
-                                mc->pattern_len = g_motor_steps_used - steps_start;
-                                
-                                ESP_LOGI(TAG, "Motor pattern stored: %zu steps from pool[%zu], total would be %d with repeats", 
-                                        mc->pattern_len, steps_start, total_steps_needed);
-                            }
-                        }
-
-                        // finally hook this component to this motor config
-                        c->has_motor = true;
-                        c->motor_cfg = mc;
-                    } else {
-                        ESP_LOGW(TAG, "motorConfig present but motor cfg pool is full");
-                    }
-                }
-            }
-
-            // Parse optional sensorTrigger for this phase
-            cJSON *sensorTrigger = cJSON_GetObjectItem(pjson, "sensorTrigger");
-            p->sensor_trigger = NULL;  // default: no trigger
-            
-            if (sensorTrigger && !cJSON_IsNull(sensorTrigger)) {
-                if (g_sensor_trigger_used < MAX_SENSOR_TRIGGERS) {
-                    SensorTrigger *st = &g_sensor_trigger_pool[g_sensor_trigger_used++];
-                    memset(st, 0, sizeof(SensorTrigger));
-                    
-                    // Parse sensor type
-                    cJSON *type = cJSON_GetObjectItem(sensorTrigger, "type");
-                    const char *type_str = type ? type->valuestring : "RPM";
-                    if (strcmp(type_str, "RPM") == 0) {
-                        st->type = SENSOR_TYPE_RPM;
-                    } else if (strcmp(type_str, "Pressure") == 0) {
-                        st->type = SENSOR_TYPE_PRESSURE;
-                    } else {
-                        st->type = SENSOR_TYPE_UNKNOWN;
-                    }
-                    
-                    // Parse threshold
-                    cJSON *threshold = cJSON_GetObjectItem(sensorTrigger, "threshold");
-                    st->threshold = threshold ? (uint32_t)threshold->valueint : 0;
-                    
-                    // Parse trigger direction
-                    cJSON *triggerAbove = cJSON_GetObjectItem(sensorTrigger, "triggerAbove");
-                    st->trigger_above = triggerAbove ? triggerAbove->type == cJSON_True : true;
-                    
-                    // Track that trigger hasn't fired yet
-                    st->has_triggered = false;
-                    
-                    p->sensor_trigger = st;
-                    ESP_LOGI(TAG, "Phase '%s': sensor trigger configured (type=%d, threshold=%u, above=%d)",
-                             p->id ? p->id : "unknown", st->type, st->threshold, st->trigger_above);
-                } else {
-                    ESP_LOGW(TAG, "sensor_trigger pool full, ignoring trigger for phase '%s'", p->id ? p->id : "unknown");
-                }
-            }
-        }
-
-        *out_num_phases = num_phases;
-
         // Store the JSON root globally so we can free it later when unloading
         // The string pointers in structs are borrowed from this JSON tree
         g_loaded_cycle_json = root;
@@ -266,156 +524,12 @@ size_t g_num_phases = 0;  // non-static for telemetry access    // -------------
 
         ESP_LOGI(TAG, "Pools reset. MAX_MOTOR_STEPS=%d, MAX_PHASES=%d", MAX_MOTOR_STEPS, MAX_PHASES);
 
-        // Extract phases array from root
-        cJSON *phases_arr = cJSON_GetObjectItem(root_json, "phases");
-        if (!cJSON_IsArray(phases_arr)) {
-            ESP_LOGE(TAG, "'phases' is missing or not an array in root");
+        if (load_program_from_root(root_json, g_phases, MAX_PHASES, g_components_pool,
+                                   MAX_COMPONENTS_PER_PHASE, &g_num_phases) != ESP_OK) {
+            cycle_unload();
             return ESP_FAIL;
         }
 
-        size_t num_phases = cJSON_GetArraySize(phases_arr);
-        if (num_phases > MAX_PHASES) {
-            num_phases = MAX_PHASES;
-        }
-
-        // Parse each phase
-        for (size_t pi = 0; pi < num_phases; pi++) {
-            cJSON *pjson = cJSON_GetArrayItem(phases_arr, pi);
-            Phase *p = &g_phases[pi];
-
-            cJSON *id        = cJSON_GetObjectItem(pjson, "id");
-            cJSON *startTime = cJSON_GetObjectItem(pjson, "startTime");
-            cJSON *components= cJSON_GetObjectItem(pjson, "components");
-
-            p->id   = id   ? id->valuestring   : NULL;
-            p->start_time_ms = startTime ? (uint32_t)startTime->valueint : 0;
-
-            size_t comp_count = cJSON_IsArray(components) ? cJSON_GetArraySize(components) : 0;
-            if (comp_count > MAX_COMPONENTS_PER_PHASE) {
-                comp_count = MAX_COMPONENTS_PER_PHASE;
-            }
-
-            PhaseComponent *phase_comps = &g_components_pool[pi * MAX_COMPONENTS_PER_PHASE];
-            p->components = phase_comps;
-            p->num_components = comp_count;
-
-            // Parse each component
-            for (size_t ci = 0; ci < comp_count; ci++) {
-                cJSON *cjson = cJSON_GetArrayItem(components, ci);
-                PhaseComponent *c = &phase_comps[ci];
-
-                cJSON *cid      = cJSON_GetObjectItem(cjson, "id");
-                cJSON *start    = cJSON_GetObjectItem(cjson, "start");
-                cJSON *compId   = cJSON_GetObjectItem(cjson, "compId");
-                cJSON *duration = cJSON_GetObjectItem(cjson, "duration");
-                cJSON *motorCfg = cJSON_GetObjectItem(cjson, "motorConfig");
-
-                c->id          = cid      ? cid->valuestring      : NULL;
-                c->compId      = compId   ? compId->valuestring   : NULL;
-                c->start_ms    = start    ? (uint32_t)start->valueint    : 0;
-                c->duration_ms = duration ? (uint32_t)duration->valueint : 0;
-                c->has_motor   = false;
-                c->motor_cfg   = NULL;
-
-                // optional motorConfig
-                if (motorCfg && !cJSON_IsNull(motorCfg)) {
-                    // make sure we have room
-                    if (g_motor_cfg_used < MAX_MOTOR_CONFIGS) {
-                        MotorConfig *mc = &g_motor_cfg_pool[g_motor_cfg_used++];
-                        memset(mc, 0, sizeof(MotorConfig));
-
-                        // repeatTimes
-                        cJSON *repeatTimes  = cJSON_GetObjectItem(motorCfg, "repeatTimes");
-                        mc->repeat_times = repeatTimes ? repeatTimes->valueint : 1;
-
-                        // pattern array
-                        cJSON *pattern = cJSON_GetObjectItem(motorCfg, "pattern");
-                        if (pattern && cJSON_IsArray(pattern)) {
-                            int pattern_len = cJSON_GetArraySize(pattern);
-                            if (pattern_len > 0) {
-                                ESP_LOGI(TAG, "Processing motor pattern with %d steps (repeat: %d), steps pool: %zu/%d", 
-                                        pattern_len, mc->repeat_times, g_motor_steps_used, MAX_MOTOR_STEPS);
-                                
-                                // remember where this motor's steps start in the global steps pool
-                                size_t steps_start = g_motor_steps_used;
-                                for (int si = 0; si < pattern_len; si++) {
-                                    if (g_motor_steps_used >= MAX_MOTOR_STEPS) {
-                                        ESP_LOGE(TAG, "Motor steps pool exhausted! Used: %zu, Max: %d. Pattern truncated at step %d/%d", 
-                                                g_motor_steps_used, MAX_MOTOR_STEPS, si, pattern_len);
-                                        break;
-                                    }
-                                    cJSON *step_json = cJSON_GetArrayItem(pattern, si);
-                                    MotorPatternStep *step = &g_motor_steps_pool[g_motor_steps_used++];
-
-                                    cJSON *stepTime  = cJSON_GetObjectItem(step_json, "stepTime");
-                                    cJSON *pauseTime = cJSON_GetObjectItem(step_json, "pauseTime");
-                                    cJSON *direction = cJSON_GetObjectItem(step_json, "direction");
-
-                                    step->step_time_ms  = stepTime  ? (uint32_t)stepTime->valueint  : 1000;
-                                    step->pause_time_ms = pauseTime ? (uint32_t)pauseTime->valueint : 0;
-                                    step->direction     = direction ? direction->valuestring        : "cw";
-                                }
-
-                                // now point the motor config to its slice of steps
-                                mc->pattern     = &g_motor_steps_pool[steps_start];
-                                mc->pattern_len = g_motor_steps_used - steps_start;
-                                
-                                ESP_LOGI(TAG, "Motor pattern stored: %zu steps from pool[%zu]", 
-                                        mc->pattern_len, steps_start);
-                            }
-                        }
-
-                        // finally hook this component to this motor config
-                        c->has_motor = true;
-                        c->motor_cfg = mc;
-                    } else {
-                        ESP_LOGW(TAG, "motorConfig present but motor cfg pool is full");
-                    }
-                }
-            }
-
-            // Parse optional sensorTrigger for this phase
-            cJSON *sensorTrigger = cJSON_GetObjectItem(pjson, "sensorTrigger");
-            p->sensor_trigger = NULL;  // default: no trigger
-            
-            if (sensorTrigger && !cJSON_IsNull(sensorTrigger)) {
-                if (g_sensor_trigger_used < MAX_SENSOR_TRIGGERS) {
-                    SensorTrigger *st = &g_sensor_trigger_pool[g_sensor_trigger_used++];
-                    memset(st, 0, sizeof(SensorTrigger));
-                    
-                    // Parse sensor type
-                    cJSON *type = cJSON_GetObjectItem(sensorTrigger, "type");
-                    const char *type_str = type ? type->valuestring : "RPM";
-                    if (strcmp(type_str, "RPM") == 0) {
-                        st->type = SENSOR_TYPE_RPM;
-                    } else if (strcmp(type_str, "Pressure") == 0) {
-                        st->type = SENSOR_TYPE_PRESSURE;
-                    } else {
-                        st->type = SENSOR_TYPE_UNKNOWN;
-                    }
-                    
-                    // Parse threshold
-                    cJSON *threshold = cJSON_GetObjectItem(sensorTrigger, "threshold");
-                    st->threshold = threshold ? (uint32_t)threshold->valueint : 0;
-                    
-                    // Parse trigger direction
-                    cJSON *triggerAbove = cJSON_GetObjectItem(sensorTrigger, "triggerAbove");
-                    st->trigger_above = triggerAbove ? triggerAbove->type == cJSON_True : true;
-                    
-                    // Track that trigger hasn't fired yet
-                    st->has_triggered = false;
-                    
-                    p->sensor_trigger = st;
-                    ESP_LOGI(TAG, "Phase '%s': sensor trigger configured (type=%d, threshold=%u, above=%d)",
-                             p->id ? p->id : "unknown", st->type, st->threshold, st->trigger_above);
-                } else {
-                    ESP_LOGW(TAG, "sensor_trigger pool full, ignoring trigger for phase '%s'", p->id ? p->id : "unknown");
-                }
-            }
-        }
-
-        g_num_phases = num_phases;
-
         // CRITICAL: Store the root JSON object so all borrowed string pointers remain valid
         // The phases and components contain string pointers (id, compId, etc.) that point
         // into this cJSON tree. We must keep the tree alive for the lifetime of the cycle.
@@ -467,6 +581,7 @@ size_t g_num_phases = 0;  // non-static for telemetry access    // -------------
 
     static gpio_num_t resolve_pin(const char *compId)
     {
+        if (!compId) return GPIO_NUM_NC;
         for (size_t i = 0; i < COMPONENT_PIN_MAP_LEN; i++) {
             if (strcmp(compId, COMPONENT_PIN_MAP[i].compId) == 0) {
                 return COMPONENT_PIN_MAP[i].pin;
@@ -537,6 +652,16 @@ size_t g_num_phases = 0;  // non-static for telemetry access    // -------------
     }
 
     // ------------------------- TIMELINE BUILDER -------------------------
+    static int compare_events(const void *a, const void *b)
+    {
+        const TimelineEvent *ea = (const TimelineEvent *)a;
+        const TimelineEvent *eb = (const TimelineEvent *)b;
+        if (ea->fire_time_us != eb->fire_time_us) {
+            return (ea->fire_time_us < eb->fire_time_us) ? -1 : 1;
+        }
+        return (int)ea->seq - (int)eb->seq;
+    }
+
     size_t build_timeline_from_phase(const Phase *phase,
                                     TimelineEvent *out_events,
                                     size_t max_events)
@@ -566,7 +691,7 @@ size_t g_num_phases = 0;  // non-static for telemetry access    // -------------
             // normal component branch
             gpio_num_t pin = resolve_pin(c->compId);
             if (pin == GPIO_NUM_NC) {
-                ESP_LOGW(TAG, "Unknown compId: %s", c->compId);
+                ESP_LOGW(TAG, "Unknown compId: %s", c->compId ? c->compId : "(none)");
                 continue;
             }
 
@@ -580,9 +705,10 @@ size_t g_num_phases = 0;  // non-static for telemetry access    // -------------
                 idx++;
             }
 
-            // OFF
+            // OFF, earlier by the valve's measured close latency when compensation is on
             if (idx < max_events) {
-                uint32_t off_ms = phase->start_time_ms + c->start_ms + c->duration_ms;
+                uint32_t off_ms = phase->start_time_ms + c->start_ms + c->duration_ms
+                                - actuator_off_lead_ms(pin, c->duration_ms);
                 out_events[idx].fire_time_us =
                     (uint64_t)off_ms * 1000ULL;
                 out_events[idx].type  = EVENT_OFF;
@@ -592,269 +718,102 @@ size_t g_num_phases = 0;  // non-static for telemetry access    // -------------
             }
         }
 
+        // The executor walks the timeline in order, so sort by fire time.
+        // seq keeps same-time events (direction before motor ON) in build order.
+        for (size_t i = 0; i < idx; i++) {
+            out_events[i].seq = (uint16_t)i;
+        }
+        qsort(out_events, idx, sizeof(TimelineEvent), compare_events);
+
         // Summary log only - detailed event logging removed for performance
         ESP_LOGI(TAG, "Built timeline: %zu events (motor: %zu, regular: %zu)", 
                  idx, motor_events, idx - motor_events);
 
         return idx;
     }
-    // ------------------------- TIMER CALLBACK -------------------------
-    static void event_timer_cb(void *arg)
-    {
-        TimelineEvent *ev = (TimelineEvent *)arg;
-        if (ev->pin == GPIO_NUM_NC) return;
-
-        gpio_set_level(ev->pin, ev->level);
 
-        // update shadow
-        for (int i = 0; i < NUM_COMPONENTS; i++) {
-            if (all_pins[i] == ev->pin) {
-                gpio_shadow[i] = ev->level;
-                break;
-            }
-        }
-        // ---- mark event done ----
-        if (g_phase_ctx.remaining_events > 0) {
-            g_phase_ctx.remaining_events--;
-            if (g_phase_ctx.remaining_events == 0) {
-                // all scheduled events have fired
-                g_phase_ctx.active = false;
-                ESP_LOGI(TAG, "Phase finished (all events fired).");
-            }
-        }
-    }
-
-    // Called when a batch of timers completes. This callback now only signals the
-    // cycle task (via semaphore) to perform deletion and creation of the next batch
-    // in task context. Doing heavy allocation (esp_timer_create) inside the timer
-    // task can cause heap pressure and fragmentation leading to ESP_ERR_NO_MEM.
-    static void load_next_batch_timer_cb(void *arg)
+    // Number of events build_timeline_from_phase() would produce (no pool limit)
+    static size_t count_phase_events(const Phase *phase)
     {
-        (void)arg;
-        if (g_phase_ctx.batch_sem) {
-            BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-            // We're in timer task context, use xSemaphoreGiveFromISR semantics
-            xSemaphoreGiveFromISR(g_phase_ctx.batch_sem, &xHigherPriorityTaskWoken);
-            // yield if needed
-            if (xHigherPriorityTaskWoken == pdTRUE) {
-                portYIELD_FROM_ISR();
+        size_t n = 0;
+        for (size_t i = 0; i < phase->num_components; i++) {
+            const PhaseComponent *c = &phase->components[i];
+            if (c->has_motor && c->motor_cfg != NULL) {
+                if (c->motor_cfg->repeat_times > 0) {
+                    n += (size_t)c->motor_cfg->repeat_times * c->motor_cfg->pattern_len * 3;
+                }
+            } else if (resolve_pin(c->compId) != GPIO_NUM_NC) {
+                n += 2;
             }
-        } else {
-            ESP_LOGW(TAG, "Batch timer fired but no batch semaphore present");
         }
+        return n;
     }
 
+    // A phase whose planned start is further in the past than this is started
+    // now instead of replaying its overdue events in a burst (counted as drift).
+    // Never more than half the critical deadline budget.
+    #define MAX_PHASE_CATCHUP_US 10000
+
     // ------------------------------------------------------------
-    // PUBLIC: run one phase with esp_timers using batching
-    // For large event counts (up to 1600), load events in batches of 200
-    // to avoid heap exhaustion from creating too many timer handles at once
+    // Build a phase timeline into track t's slice of the event pool and hand
+    // it to the executor, anchored at start_us (its planned start on the cycle
+    // timeline, which may already be a few ms in the past), or at the current
+    // time once the track is more than the catch-up window behind.
     // ------------------------------------------------------------
-    void run_phase_with_esp_timer(const Phase *phase)
+    void run_phase_on_track(size_t t, size_t phase_index, uint64_t start_us)
     {
-        // clear previous context
-        memset(&g_phase_ctx, 0, sizeof(g_phase_ctx));
-        // create semaphore used for signaling batch loads
-        g_phase_ctx.batch_sem = xSemaphoreCreateBinary();
-        if (!g_phase_ctx.batch_sem) {
-            ESP_LOGW(TAG, "Failed to create batch semaphore, batching may be unsafe");
-        }
-        g_phase_ctx.active = true;
+        TrackRun *tr = executor_track(t);
+        const Phase *phase = &g_phases[phase_index];
 
-        //set current phase name
-        current_phase_name = phase->id ? phase->id : "Unknown"; 
-        
-        
-        // build timeline into context
-        size_t n = build_timeline_from_phase(phase,
-                                            g_phase_ctx.events,
-                                            MAX_EVENTS_PER_PHASE);
-        g_phase_ctx.num_events = n;
-        g_phase_ctx.remaining_events = n;
-
-        uint64_t base_us = esp_timer_get_time();
-        phase_start_us = base_us;   // so monitor prints from this phase start
-        g_phase_ctx.batch_start_us = base_us;
-
-        // Calculate number of batches needed
-        g_phase_ctx.batches_total = (n + BATCH_SIZE - 1) / BATCH_SIZE;
-        g_phase_ctx.current_batch_idx = 0;
-
-        ESP_LOGI(TAG, "Phase '%s': %zu events in %zu batches (batch_size=%u)", 
-                 phase->id, n, g_phase_ctx.batches_total, BATCH_SIZE);
-
-        // Load first batch using task-context helper logic (see below)
-        size_t batch_start_idx = 0;
-        size_t batch_end_idx = (BATCH_SIZE < n) ? BATCH_SIZE : n;
-        size_t events_in_batch = batch_end_idx - batch_start_idx;
-
-        ESP_LOGI(TAG, "Loading batch 1/%zu (%zu events)", g_phase_ctx.batches_total, events_in_batch);
-
-        // Create timers for first batch (task context)
-        for (size_t i = 0; i < events_in_batch; i++) {
-            const TimelineEvent *ev = &g_phase_ctx.events[batch_start_idx + i];
-
-            const esp_timer_create_args_t args = {
-                .callback = event_timer_cb,
-                .arg = (void *)ev,
-                .name = "cycle_evt"
-            };
-
-            esp_timer_handle_t tmr;
-            esp_err_t err = esp_timer_create(&args, &tmr);
-            if (err != ESP_OK) {
-                ESP_LOGE(TAG, "esp_timer_create failed: %s", esp_err_to_name(err));
-                continue;
-            }
-
-            // compute delay
-            uint64_t now_us   = esp_timer_get_time();
-            uint64_t elapsed  = now_us - base_us;
-            uint64_t delay_us;
-            if (ev->fire_time_us > elapsed) {
-                delay_us = ev->fire_time_us - elapsed;
-            } else {
-                delay_us = 1000; // late: fire asap
-            }
+        size_t n = build_timeline_from_phase(phase, tr->events, tr->capacity);
+        size_t wanted = count_phase_events(phase);
 
-            esp_timer_start_once(tmr, delay_us);
-            g_phase_ctx.timers[i] = tmr;
+        // Decide the anchor only now that the timeline is built, and log after
+        // the phase is armed: nothing slow sits between the two
+        uint64_t catchup_us = executor_get_deadline_budget(DEADLINE_CLASS_CRITICAL) / 2;
+        if (catchup_us > MAX_PHASE_CATCHUP_US) catchup_us = MAX_PHASE_CATCHUP_US;
+        uint64_t planned_us = start_us;
+        uint64_t now_us = esp_timer_get_time();
+        if (now_us > start_us + catchup_us) {
+            start_us = now_us;
         }
 
-        // If there are more batches, set up batch timer for next load
-        if (g_phase_ctx.batches_total > 1) {
-            uint64_t last_event_time_us = g_phase_ctx.events[batch_end_idx - 1].fire_time_us;
-            uint64_t delay_to_next_batch = last_event_time_us + 1000; // 1ms after last event
-
-            const esp_timer_create_args_t batch_args = {
-                .callback = load_next_batch_timer_cb,
-                .arg = NULL,
-                .name = "batch_load"
-            };
-
-            esp_err_t err = esp_timer_create(&batch_args, &g_phase_ctx.batch_timer);
-            if (err == ESP_OK) {
-                esp_timer_start_once(g_phase_ctx.batch_timer, delay_to_next_batch);
-                ESP_LOGI(TAG, "Batch loader timer scheduled for %.3f seconds", delay_to_next_batch / 1000000.0);
-            } else {
-                ESP_LOGE(TAG, "Failed to create batch timer: %s", esp_err_to_name(err));
-            }
+        if (t == 0 || g_num_tracks == 1) {
+            //set current phase name
+            current_phase_name = phase->id ? phase->id : "Unknown";
+            current_phase_index = (int)phase_index + 1;  // update current phase index for telemetry
+            phase_start_us = start_us;   // so monitor prints from this phase start
         }
 
-        ESP_LOGI(TAG, "Scheduled %zu events for phase %s in batches", n, phase->id);
-
-        // If we have multiple batches, handle subsequent batches in task context
-        while (g_phase_ctx.current_batch_idx + 1 < g_phase_ctx.batches_total && g_phase_ctx.active) {
-            // Wait for the batch completion signal from timer callback
-            if (g_phase_ctx.batch_sem) {
-                xSemaphoreTake(g_phase_ctx.batch_sem, portMAX_DELAY);
-            } else {
-                // No semaphore: fall back to busy-waiting until batch_timer fires
-                // (shouldn't happen normally)
-                while (g_phase_ctx.current_batch_idx + 1 < g_phase_ctx.batches_total && g_phase_ctx.active) {
-                    vTaskDelay(pdMS_TO_TICKS(50));
-                }
-                break;
-            }
-
-            // Delete previous batch timers (they should have fired)
-            for (size_t i = 0; i < BATCH_SIZE; i++) {
-                if (g_phase_ctx.timers[i]) {
-                    esp_timer_stop(g_phase_ctx.timers[i]);
-                    esp_timer_delete(g_phase_ctx.timers[i]);
-                    g_phase_ctx.timers[i] = NULL;
-                }
-            }
-
-            // stop and delete previous batch_timer if present
-            if (g_phase_ctx.batch_timer) {
-                esp_timer_stop(g_phase_ctx.batch_timer);
-                esp_timer_delete(g_phase_ctx.batch_timer);
-                g_phase_ctx.batch_timer = NULL;
-            }
-
-            // Move to next batch index and create timers for it (task context)
-            g_phase_ctx.current_batch_idx++;
-            size_t next_batch_start = g_phase_ctx.current_batch_idx * BATCH_SIZE;
-            size_t next_batch_end = (next_batch_start + BATCH_SIZE < g_phase_ctx.num_events) ?
-                                    next_batch_start + BATCH_SIZE : g_phase_ctx.num_events;
-            size_t next_events = next_batch_end - next_batch_start;
+        executor_begin_phase(t, (int)phase_index, n, start_us);
+        telemetry_notify_change();
 
-            ESP_LOGI(TAG, "Loading batch %zu/%zu (%zu events)", 
-                     g_phase_ctx.current_batch_idx + 1, g_phase_ctx.batches_total, next_events);
-
-            uint64_t now_us2 = esp_timer_get_time();
-            uint64_t batch_start_us2 = g_phase_ctx.batch_start_us;
-
-            for (size_t i = 0; i < next_events; i++) {
-                const TimelineEvent *ev = &g_phase_ctx.events[next_batch_start + i];
-
-                const esp_timer_create_args_t args = {
-                    .callback = event_timer_cb,
-                    .arg = (void *)ev,
-                    .name = "cycle_evt"
-                };
-
-                esp_timer_handle_t tmr;
-                esp_err_t err = esp_timer_create(&args, &tmr);
-                if (err != ESP_OK) {
-                    ESP_LOGE(TAG, "esp_timer_create failed for batch event: %s", esp_err_to_name(err));
-                    continue;
-                }
-
-                uint64_t time_since_phase_start = now_us2 - batch_start_us2;
-                uint64_t delay_us;
-                if (ev->fire_time_us > time_since_phase_start) {
-                    delay_us = ev->fire_time_us - time_since_phase_start;
-                } else {
-                    delay_us = 1000;
-                }
-
-                esp_timer_start_once(tmr, delay_us);
-                g_phase_ctx.timers[i] = tmr;
-            }
-
-            // schedule next batch loader timer
-            if (next_events > 0) {
-                uint64_t last_event_time_us = g_phase_ctx.events[next_batch_end - 1].fire_time_us;
-                uint64_t time_since_phase_start = now_us2 - batch_start_us2;
-                uint64_t delay_to_next_batch;
-                if (last_event_time_us > time_since_phase_start) {
-                    delay_to_next_batch = (last_event_time_us - time_since_phase_start) + 1000;
-                } else {
-                    delay_to_next_batch = 1000;
-                }
-
-                const esp_timer_create_args_t batch_args = {
-                    .callback = load_next_batch_timer_cb,
-                    .arg = NULL,
-                    .name = "batch_load"
-                };
-
-                esp_err_t err = esp_timer_create(&batch_args, &g_phase_ctx.batch_timer);
-                if (err == ESP_OK) {
-                    esp_timer_start_once(g_phase_ctx.batch_timer, delay_to_next_batch);
-                    ESP_LOGI(TAG, "Batch timer set for %.3f seconds", delay_to_next_batch / 1000000.0);
-                } else {
-                    ESP_LOGE(TAG, "Failed to create batch timer: %s", esp_err_to_name(err));
-                }
-            }
+        if (start_us != planned_us) {
+            ESP_LOGW(TAG, "Track %zu was %llu ms behind plan, started phase %s now",
+                     t, (start_us - planned_us) / 1000, phase->id);
+        }
+        if (n < wanted) {
+            ESP_LOGE(TAG, "Track %zu: phase %s needs %zu events, only %zu fit - %zu dropped",
+                     t, phase->id, wanted, n, wanted - n);
+            executor_note_dropped(wanted - n);
         }
+        ESP_LOGI(TAG, "Track %zu: scheduled %zu events for phase %s", t, n, phase->id);
     }
 
     // ------------------------------------------------------------
     // Check if current phase's sensor trigger should fire
     // Returns true if threshold met and phase should skip
     // ------------------------------------------------------------
-    static bool check_phase_sensor_trigger(void)
+    static bool check_phase_sensor_trigger(size_t t)
     {
         #define PHASE_SENSOR_COOLDOWN_MS 15000
         
-        if (!cycle_running || current_phase_index <= 0 || current_phase_index > (int)g_num_phases) {
+        if (!cycle_running || !executor_track_active(t)) {
             return false;
         }
 
-        // Get current phase (current_phase_index is 1-based)
-        int phase_idx = current_phase_index - 1;
+        TrackRun *tr = executor_track(t);
+        int phase_idx = tr->phase_index;
         if (phase_idx < 0 || phase_idx >= (int)g_num_phases) {
             return false;
         }
@@ -871,9 +830,22 @@ size_t g_num_phases = 0;  // non-static for telemetry access    // -------------
             return false;
         }
 
+        // Volume counts from the phase start, so it needs no cooldown. The flow
+        // meter ISR wakes this task on the pulse that reaches the target.
+        if (trigger->type == SENSOR_TYPE_VOLUME) {
+            uint32_t pulses = flow_meter_count() - s_flow_start[t];
+            if (pulses < s_flow_target[t]) {
+                return false;
+            }
+            trigger->has_triggered = true;
+            ESP_LOGI(TAG, "Volume trigger FIRED on track %zu: %lu mL (%lu pulses) >= %u mL",
+                     t, (unsigned long)flow_meter_pulses_to_ml(pulses), (unsigned long)pulses, trigger->threshold);
+            return true;
+        }
+
         // COOLDOWN: Skip first 15 seconds of phase to avoid false triggers during transitions
         uint64_t now_us = esp_timer_get_time();
-        uint64_t phase_elapsed_ms = (now_us >= phase_start_us) ? (now_us - phase_start_us) / 1000 : 0;
+        uint64_t phase_elapsed_ms = (now_us >= tr->phase_start_us) ? (now_us - tr->phase_start_us) / 1000 : 0;
         if (phase_elapsed_ms < PHASE_SENSOR_COOLDOWN_MS) {
             return false;  // Still in cooldown period
         }
@@ -884,6 +856,11 @@ size_t g_num_phases = 0;  // non-static for telemetry access    // -------------
             sensor_value = (uint32_t)rpm_sensor_get_rpm();
         } else if (trigger->type == SENSOR_TYPE_PRESSURE) {
             sensor_value = (uint32_t)pressure_sensor_read_frequency();
+        } else if (trigger->type == SENSOR_TYPE_IMBALANCE) {
+            ImbalanceResult ir;
+            imbalance_get(&ir);
+            if (!ir.valid) return false;    // not spinning steadily: no reading either way
+            sensor_value = ir.imbalance_pm;
         } else {
             return false;  // Unknown sensor type
         }
@@ -898,9 +875,10 @@ size_t g_num_phases = 0;  // non-static for telemetry access    // -------------
 
         if (should_trigger) {
             trigger->has_triggered = true;
-            const char *sensor_name = (trigger->type == SENSOR_TYPE_RPM) ? "RPM" : "Pressure";
-            ESP_LOGI(TAG, "Sensor trigger FIRED: %s=%u %s threshold=%u (phase elapsed: %llu ms)",
-                     sensor_name, sensor_value,
+            const char *sensor_name = (trigger->type == SENSOR_TYPE_RPM) ? "RPM" :
+                                      (trigger->type == SENSOR_TYPE_IMBALANCE) ? "Imbalance" : "Pressure";
+            ESP_LOGI(TAG, "Sensor trigger FIRED on track %zu: %s=%u %s threshold=%u (phase elapsed: %llu ms)",
+                     t, sensor_name, sensor_value,
                      trigger->trigger_above ? ">" : "<",
                      trigger->threshold, phase_elapsed_ms);
         }
@@ -919,41 +897,13 @@ size_t g_num_phases = 0;  // non-static for telemetry access    // -------------
 
     void cycle_skip_current_phase(bool force_off_all)
     {
-        if (!g_phase_ctx.active) {
+        if (!cycle_running) {
             return;
         }
 
-        // stop all pending timers in current batch
-        for (size_t i = 0; i < BATCH_SIZE; i++) {
-            if (g_phase_ctx.timers[i]) {
-                esp_timer_stop(g_phase_ctx.timers[i]);
-                esp_timer_delete(g_phase_ctx.timers[i]);
-                g_phase_ctx.timers[i] = NULL;
-            }
-        }
-
-        // stop batch loader timer if it exists
-        if (g_phase_ctx.batch_timer) {
-            esp_timer_stop(g_phase_ctx.batch_timer);
-            esp_timer_delete(g_phase_ctx.batch_timer);
-            g_phase_ctx.batch_timer = NULL;
-        }
-
-        // Delete batch semaphore if present
-        if (g_phase_ctx.batch_sem) {
-            vSemaphoreDelete(g_phase_ctx.batch_sem);
-            g_phase_ctx.batch_sem = NULL;
-        }
+        // drop the remaining events on every track; run_cycle() advances each one
+        executor_end_all(force_off_all);
 
-        if (force_off_all) {
-            // turn OFF everything (active-low → 1)
-            for (int i = 0; i < NUM_COMPONENTS; i++) {
-                gpio_set_level(all_pins[i], 1);
-                gpio_shadow[i] = 1;
-            }
-        }
-
-        g_phase_ctx.active = false;
         // NOTE: do NOT set cycle_running = false here; let run_cycle() control it
         ESP_LOGW(TAG, "Current phase skipped/cancelled.");
     }
@@ -964,10 +914,20 @@ size_t g_num_phases = 0;  // non-static for telemetry access    // -------------
             ESP_LOGW(TAG, "cycle_skip_to_phase: no cycle running");
             return;
         }
+        // Out of range (including client values that would alias the -1/-2 sentinels)
+        if (phase_index >= g_num_phases) {
+            ESP_LOGW(TAG, "cycle_skip_to_phase: index %zu out of bounds (%zu phases)", phase_index, g_num_phases);
+            return;
+        }
 
         // Set target phase and skip current
         target_phase_index = (int)phase_index;
-        cycle_skip_current_phase(true);
+        if (g_num_tracks > 1) {
+            // run_cycle() ends only the track that owns the target phase
+            if (s_cycle_task) xTaskNotifyGive(s_cycle_task);
+        } else {
+            cycle_skip_current_phase(true);
+        }
         ESP_LOGI(TAG, "Skipping to phase %zu", phase_index);
     }
 
@@ -985,15 +945,168 @@ size_t g_num_phases = 0;  // non-static for telemetry access    // -------------
     }
 
 
+    // ------------------------------------------------------------
+    // Program control stack: repeat frames loop back to their body,
+    // call frames remember where to resume after a subroutine returns.
+    // Every track walks its own sequence with its own cursor.
+    // ------------------------------------------------------------
+    typedef struct {
+        bool     is_call;
+        uint16_t return_pc;   // call frame: op after the CALL
+        uint16_t remaining;   // loop frame: iterations left including the current one
+    } ControlFrame;
+
+    typedef struct {
+        size_t       pc;
+        ControlFrame stack[MAX_CONTROL_DEPTH];
+        size_t       depth;
+        bool         finished;
+    } TrackCursor;
+
+    // Find the first op that runs phase_index. Main sequences are searched
+    // track by track; a phase only reachable through a subroutine goes to track 0.
+    static int find_phase_op(size_t phase_index, size_t *out_track)
+    {
+        *out_track = 0;
+        for (size_t t = 0; t < g_num_tracks; t++) {
+            for (size_t i = g_tracks[t].entry_pc; i < g_program_len && g_program[i].op != PROG_OP_END; i++) {
+                if (g_program[i].op == PROG_OP_PHASE && g_program[i].arg == phase_index) {
+                    *out_track = t;
+                    return (int)i;
+                }
+            }
+        }
+        for (size_t i = 0; i < g_program_len; i++) {
+            if (g_program[i].op == PROG_OP_PHASE && g_program[i].arg == phase_index) {
+                return (int)i;
+            }
+        }
+        return -1;
+    }
+
+    // Step a track's cursor to its next phase. Returns the phase index,
+    // or -1 once the track's sequence has ended.
+    static int advance_track(TrackCursor *cur)
+    {
+        while (!cur->finished && cur->pc < g_program_len) {
+            const ProgramOp *op = &g_program[cur->pc];
+
+            if (op->op == PROG_OP_PHASE) {
+                cur->pc++;
+                if (op->arg < g_num_phases) {
+                    return op->arg;
+                }
+            } else if (op->op == PROG_OP_REPEAT) {
+                if (op->arg == 0) {
+                    cur->pc = op->target;
+                    continue;
+                }
+                if (cur->depth >= MAX_CONTROL_DEPTH) {
+                    ESP_LOGE(TAG, "Control stack overflow at op %zu, ending track", cur->pc);
+                    break;
+                }
+                cur->stack[cur->depth].is_call = false;
+                cur->stack[cur->depth].remaining = op->arg;
+                cur->depth++;
+                cur->pc++;
+            } else if (op->op == PROG_OP_NEXT) {
+                ControlFrame *top = cur->depth > 0 ? &cur->stack[cur->depth - 1] : NULL;
+                if (top && !top->is_call && --top->remaining > 0) {
+                    cur->pc = op->target;
+                } else {
+                    if (top && !top->is_call) cur->depth--;
+                    cur->pc++;
+                }
+            } else if (op->op == PROG_OP_CALL) {
+                if (cur->depth >= MAX_CONTROL_DEPTH) {
+                    ESP_LOGE(TAG, "Control stack overflow at op %zu, ending track", cur->pc);
+                    break;
+                }
+                cur->stack[cur->depth].is_call = true;
+                cur->stack[cur->depth].return_pc = (uint16_t)(cur->pc + 1);
+                cur->depth++;
+                cur->pc = op->target;
+            } else if (op->op == PROG_OP_RETURN) {
+                // unwind any loop frames left open by a skip into the subroutine
+                while (cur->depth > 0 && !cur->stack[cur->depth - 1].is_call) cur->depth--;
+                if (cur->depth == 0) break;  // entered via skip_to_phase: nothing to return to
+                cur->pc = cur->stack[--cur->depth].return_pc;
+            } else {
+                break;  // PROG_OP_END
+            }
+        }
+        cur->finished = true;
+        return -1;
+    }
+
+    // How long the cycle task may block. Phase ends and skip/stop requests
+    // notify it, so it only needs to wake for sensor trigger polling and to
+    // check the next event's deadline - long valve intervals cost no wakeups.
+    #define CYCLE_TRIGGER_POLL_MS   100
+    #define CYCLE_MAX_WAIT_MS       1000
+
+    static TickType_t cycle_wait_ticks(void)
+    {
+        uint64_t now_us = esp_timer_get_time();
+        uint64_t wake_us = now_us + CYCLE_MAX_WAIT_MS * 1000ULL;
+
+        for (size_t t = 0; t < g_num_tracks; t++) {
+            TrackRun *tr = executor_track(t);
+            if (!tr->active || tr->phase_index < 0) continue;
+            const SensorTrigger *trig = g_phases[tr->phase_index].sensor_trigger;
+            if (!trig || trig->has_triggered || trig->type == SENSOR_TYPE_VOLUME) continue;   // volume wakes us itself
+
+            // poll once the trigger cooldown is over
+            uint64_t armed_us = tr->phase_start_us + PHASE_SENSOR_COOLDOWN_MS * 1000ULL;
+            uint64_t poll_us = (armed_us > now_us) ? armed_us : now_us + CYCLE_TRIGGER_POLL_MS * 1000ULL;
+            if (poll_us < wake_us) wake_us = poll_us;
+        }
+
+        uint64_t next_due_us = executor_next_due_us();
+        if (next_due_us != UINT64_MAX) {
+            uint64_t check_us = next_due_us + executor_get_deadline_budget(DEADLINE_CLASS_CRITICAL);
+            if (check_us < wake_us) wake_us = check_us;
+        }
+
+        TickType_t ticks = pdMS_TO_TICKS((wake_us > now_us ? wake_us - now_us : 0) / 1000 + 1);
+        return ticks ? ticks : 1;
+    }
+
     void run_cycle(Phase *phases, size_t num_phases)
     {
         cycle_running = true;
         target_phase_index = -1;
+
+        TrackCursor cursors[MAX_TRACKS];
+        memset(cursors, 0, sizeof(cursors));
+        for (size_t t = 0; t < g_num_tracks; t++) {
+            cursors[t].pc = g_tracks[t].entry_pc;
+        }
+        size_t phases_run = 0;
+        bool completed = false;     // every track ran to its end (not stopped, skipped out or tripped)
         
         size_t heap_at_start = esp_get_free_heap_size();
-        ESP_LOGI(TAG, "=== CYCLE START: Free heap = %zu bytes ===", heap_at_start);
+        ESP_LOGI(TAG, "=== CYCLE START: %zu track(s), Free heap = %zu bytes ===", g_num_tracks, heap_at_start);
+
+        s_cycle_task = xTaskGetCurrentTaskHandle();
+        power_cycle_active(true);
+        executor_start(s_cycle_task);
+        motor_mon_start();
+
+        // Every phase is placed on one cycle-wide timeline: epoch + the planned
+        // durations before it, so notify latency and timeline build time are
+        // absorbed instead of pushing every later phase back.
+        uint64_t epoch_us = esp_timer_get_time();
+        uint64_t plan_us[MAX_TRACKS];        // planned start of each track's next phase
+        uint64_t actual_end_us[MAX_TRACKS];  // when each track's last phase actually finished
+        bool     phase_pending[MAX_TRACKS];  // a started phase whose end is not yet accounted
+        for (size_t t = 0; t < MAX_TRACKS; t++) {
+            plan_us[t] = epoch_us;
+            actual_end_us[t] = epoch_us;
+            phase_pending[t] = false;
+        }
 
-        for (size_t i = 0; i < num_phases; i++) {
+        while (1) {
             // Check if we should stop the entire cycle
             if (target_phase_index == -2) {
                 ESP_LOGW(TAG, "Cycle stop signal detected, breaking out of cycle loop");
@@ -1001,76 +1114,173 @@ size_t g_num_phases = 0;  // non-static for telemetry access    // -------------
                 break;
             }
 
-            // Check if we should skip to a different phase
+            // Check if we should skip to a different phase (drops that track's repeat/call state)
             if (target_phase_index >= 0) {
-                if (target_phase_index >= (int)num_phases) {
+                size_t t = 0;
+                int op = (target_phase_index < (int)num_phases) ? find_phase_op(target_phase_index, &t) : -1;
+                if (op < 0) {
                     ESP_LOGW(TAG, "skip_to_phase index out of bounds (%d >= %zu)", target_phase_index, num_phases);
                     target_phase_index = -1;
                     break;
                 }
-                i = target_phase_index - 1;  // -1 because loop will increment
+                executor_end_phase(t, true);
+                cursors[t].pc = (size_t)op;
+                cursors[t].depth = 0;
+                cursors[t].finished = false;
                 target_phase_index = -1;
-                continue;
             }
-            
-            // Log heap before each phase
-            size_t heap_before_phase = esp_get_free_heap_size();
-            ESP_LOGI(TAG, "Phase %zu start - Free heap: %zu bytes (delta: %ld)", 
-                     i+1, heap_before_phase, (long)heap_before_phase - (long)heap_at_start);
-
-            current_phase_index = (int)i + 1;  // update current phase index for telemetry
-            Phase *p = &phases[i];
-
-            ESP_LOGI(TAG, "=== Running phase %d: %s ===", (int)i + 1, p->id);
-            run_phase_with_esp_timer(p);
-
-            // Wait for phase to complete, checking sensor triggers and yielding to other tasks
-            while (g_phase_ctx.active) {
-                // Check if sensor trigger should skip this phase
-                if (check_phase_sensor_trigger()) {
-                    cycle_skip_current_phase(true);
-                    break;  // Exit wait loop, phase will be skipped
+
+            bool any_running = false;
+            for (size_t t = 0; t < g_num_tracks; t++) {
+                TrackCursor *cur = &cursors[t];
+
+                // A sensor trigger ends only this track's phase
+                if (check_phase_sensor_trigger(t)) {
+                    executor_end_phase(t, true);
                 }
-                
-                vTaskDelay(pdMS_TO_TICKS(100));  // Check sensor every 100ms
-                // Explicitly yield to let higher priority tasks run (e.g., WebSocket)
-                taskYIELD();
-            }
 
-            // Ensure all timers from this phase are cleaned up before moving to next
-            // Clean up current batch timers
-            for (size_t j = 0; j < BATCH_SIZE; j++) {
-                if (g_phase_ctx.timers[j]) {
-                    esp_timer_stop(g_phase_ctx.timers[j]);
-                    esp_timer_delete(g_phase_ctx.timers[j]);
-                    g_phase_ctx.timers[j] = NULL;
+                while (!cur->finished && !executor_track_active(t)) {
+                    // Account for the phase that just ended. An early end (trigger
+                    // or skip) is intentional, so the plan follows the actual time.
+                    TrackRun *tr = executor_track(t);
+                    if (phase_pending[t]) {
+                        plan_us[t] = tr->ended_early ? tr->last_event_us
+                                                     : plan_us[t] + (tr->planned_end_us - tr->phase_start_us);
+                        actual_end_us[t] = tr->last_event_us;
+                        phase_pending[t] = false;
+                    }
+
+                    int i = advance_track(cur);
+                    if (i < 0) {
+                        ESP_LOGI(TAG, "Track %zu (%s) finished", t, g_tracks[t].id ? g_tracks[t].id : "main");
+                        break;
+                    }
+
+                    Phase *p = &phases[i];
+
+                    // a repeated phase must be able to trigger again on every pass
+                    if (p->sensor_trigger) {
+                        p->sensor_trigger->has_triggered = false;
+                    }
+
+                    // Metered water counts from here; a Volume trigger is armed
+                    // in the flow meter so its last pulse wakes this task
+                    s_flow_start[t] = flow_meter_count();
+                    if (p->sensor_trigger && p->sensor_trigger->type == SENSOR_TYPE_VOLUME) {
+                        s_flow_target[t] = flow_meter_ml_to_pulses(p->sensor_trigger->threshold);
+                        flow_meter_arm(t, s_flow_start[t] + s_flow_target[t], s_cycle_task);
+                    } else {
+                        flow_meter_disarm(t);
+                    }
+
+                    // the plan is the anchor; run_phase_on_track() catches up a late track
+                    run_phase_on_track(t, (size_t)i, plan_us[t]);
+                    phase_pending[t] = true;
+
+                    // logged once the phase is armed, so the console does not delay its first events
+                    size_t heap_before_phase = esp_get_free_heap_size();
+                    ESP_LOGI(TAG, "=== Track %zu running phase %d: %s (step %zu) ===", t, i + 1, p->id, ++phases_run);
+                    ESP_LOGI(TAG, "Phase %d start - Free heap: %zu bytes (delta: %ld)",
+                             i+1, heap_before_phase, (long)heap_before_phase - (long)heap_at_start);
+                }
+
+                if (!cur->finished) {
+                    any_running = true;
                 }
             }
-            
-            // Clean up batch loader timer
-            if (g_phase_ctx.batch_timer) {
-                esp_timer_stop(g_phase_ctx.batch_timer);
-                esp_timer_delete(g_phase_ctx.batch_timer);
-                g_phase_ctx.batch_timer = NULL;
+
+            if (!any_running) {
+                completed = true;
+                break;
+            }
+
+            // Woken by the executor when a track's phase completes; the timeout
+            // is the next sensor poll or deadline check (see cycle_wait_ticks).
+            ulTaskNotifyTake(pdTRUE, cycle_wait_ticks());
+            executor_sync_shadow();
+
+            executor_check_deadlines();
+            if (executor_safe_tripped()) {
+                DeadlineStats ds;
+                executor_deadline_stats(&ds);
+                if (ds.safe_tripped) {
+                    ESP_LOGE(TAG, "!!! DEADLINE ALARM: GPIO %d event %ld us late - all outputs OFF, cycle aborted !!!",
+                             ds.trip_pin, (long)ds.trip_late_us);
+                } else {
+                    ESP_LOGE(TAG, "!!! MOTOR FAULT: %s - all outputs OFF, cycle aborted !!!",
+                             motor_mon_fault_name(motor_mon_fault()));
+                }
+                break;
             }
-        
-            // Delete batch semaphore if present
-            if (g_phase_ctx.batch_sem) {
-                vSemaphoreDelete(g_phase_ctx.batch_sem);
-                g_phase_ctx.batch_sem = NULL;
+        }
+
+        // Planned-vs-actual completion (only plan changes from triggers/skips are excused)
+        uint64_t planned_end_us = epoch_us, actual_cycle_end_us = epoch_us;
+        for (size_t t = 0; t < g_num_tracks; t++) {
+            TrackRun *tr = executor_track(t);
+            if (phase_pending[t]) {
+                // stopped mid-phase: compare against where the plan was at that point
+                actual_end_us[t] = tr->last_event_us;
+                if (!tr->ended_early) {
+                    plan_us[t] += tr->planned_end_us - tr->phase_start_us;
+                } else {
+                    plan_us[t] = tr->last_event_us;
+                }
             }
-            
-            // Small delay to allow other tasks to run (especially WebSocket)
-            vTaskDelay(pdMS_TO_TICKS(10));
-            taskYIELD();  // Ensure other tasks get a chance
+            ESP_LOGI(TAG, "Track %zu timing: planned %llu ms, actual %llu ms, drift %lld us", t,
+                     (plan_us[t] - epoch_us) / 1000, (actual_end_us[t] - epoch_us) / 1000,
+                     (long long)(actual_end_us[t] - plan_us[t]));
+            if (plan_us[t] > planned_end_us) planned_end_us = plan_us[t];
+            if (actual_end_us[t] > actual_cycle_end_us) actual_cycle_end_us = actual_end_us[t];
         }
+        ESP_LOGI(TAG, "=== CYCLE TIMING: planned %llu ms, actual %llu ms, drift %lld us ===",
+                 (planned_end_us - epoch_us) / 1000, (actual_cycle_end_us - epoch_us) / 1000,
+                 (long long)(actual_cycle_end_us - planned_end_us));
+
+        ExecutorTraceStats lat;
+        executor_trace_stats(&lat);
+        ESP_LOGI(TAG, "Output latency (%s mode, %zu writes): min %ld us, p50 %ld us, p99 %ld us, max %ld us",
+                 executor_mode_name(lat.mode), lat.samples,
+                 (long)lat.min_us, (long)lat.p50_us, (long)lat.p99_us, (long)lat.max_us);
+        ESP_LOGI(TAG, "Start latency (request to first output): %lld us", (long long)cycle_start_latency_us());
+
+        DeadlineStats ds;
+        executor_deadline_stats(&ds);
+        ESP_LOGI(TAG, "Deadlines: critical %lu/%lu missed (worst %ld us, budget %lu us), "
+                 "normal %lu/%lu missed (worst %ld us, budget %lu us), %lu dropped%s",
+                 (unsigned long)ds.misses[DEADLINE_CLASS_CRITICAL], (unsigned long)ds.events[DEADLINE_CLASS_CRITICAL],
+                 (long)ds.worst_late_us[DEADLINE_CLASS_CRITICAL],
+                 (unsigned long)executor_get_deadline_budget(DEADLINE_CLASS_CRITICAL),
+                 (unsigned long)ds.misses[DEADLINE_CLASS_NORMAL], (unsigned long)ds.events[DEADLINE_CLASS_NORMAL],
+                 (long)ds.worst_late_us[DEADLINE_CLASS_NORMAL],
+                 (unsigned long)executor_get_deadline_budget(DEADLINE_CLASS_NORMAL),
+                 (unsigned long)ds.dropped, ds.safe_tripped ? " - SAFE STATE TRIPPED" : "");
+
+        flow_meter_disarm_all();
+        s_flow_end = flow_meter_count();
+        motor_mon_stop();
+        MotorMonStats mm;
+        motor_mon_stats(&mm);
+        ESP_LOGI(TAG, "Motor monitor (%s): %lu checks, avg %lu ns, max %lu ns, fault %s (%lu reported)",
+                 motor_mon_mode_name(mm.cfg.mode), (unsigned long)mm.checks,
+                 (unsigned long)mm.avg_ns, (unsigned long)mm.max_ns, motor_mon_fault_name(mm.fault),
+                 (unsigned long)mm.cycle_faults);
+        executor_stop();
+        power_cycle_active(false);
+        s_cycle_task = NULL;
+
+        // A cycle that ran to its end finished with its drain, so the tub is
+        // empty again and the pressure baseline may follow the sensor. After a
+        // stop or an alarm the water level is unknown: keep the last baseline.
+        pressure_sensor_set_tub_empty(completed);
 
         size_t heap_at_end = esp_get_free_heap_size();
-        ESP_LOGI(TAG, "=== CYCLE COMPLETED - Free heap: %zu bytes (delta: %ld) ===", 
-                 heap_at_end, (long)heap_at_end - (long)heap_at_start);
+        ESP_LOGI(TAG, "=== CYCLE COMPLETED - %zu phase runs, Free heap: %zu bytes (delta: %ld) ===", 
+                 phases_run, heap_at_end, (long)heap_at_end - (long)heap_at_start);
 
         cycle_running = false;
         current_phase_index = 0;
+        telemetry_notify_change();
     }
 
     // Free memory from previously loaded cycle
@@ -1090,9 +1300,12 @@ size_t g_num_phases = 0;  // non-static for telemetry access    // -------------
         g_motor_steps_used = 0;
         g_sensor_trigger_used = 0;
         g_num_phases = 0;
+        g_program_len = 0;
+        g_num_tracks = 0;
         
         // Clear static arrays
         memset(g_phases, 0, sizeof(g_phases));
+        memset(g_tracks, 0, sizeof(g_tracks));
         memset(g_components_pool, 0, sizeof(g_components_pool));
         memset(g_sensor_trigger_pool, 0, sizeof(g_sensor_trigger_pool));
         memset(g_motor_cfg_pool, 0, sizeof(g_motor_cfg_pool));
@@ -1139,6 +1352,20 @@ size_t g_num_phases = 0;  // non-static for telemetry access    // -------------
     }
 
 
+    int64_t cycle_start_latency_us(void)
+    {
+        int64_t first_us = executor_first_write_us();
+        if (s_start_request_us < 0 || first_us < s_start_request_us) return -1;
+        return first_us - s_start_request_us;
+    }
+
+    uint32_t cycle_phase_volume_ml(size_t track)
+    {
+        if (track >= MAX_TRACKS) return 0;
+        uint32_t now_count = cycle_running ? flow_meter_count() : s_flow_end;
+        return flow_meter_pulses_to_ml(now_count - s_flow_start[track]);
+    }
+
     // Task to run the cycle in the background (non-blocking)
     static void cycle_task(void *pvParameter)
     {
@@ -1153,13 +1380,21 @@ size_t g_num_phases = 0;  // non-static for telemetry access    // -------------
             return;
         }
 
-        ESP_LOGI(TAG, "Running loaded cycle (%zu phases) in background task", g_num_phases);
+        if (executor_init() != ESP_OK) {
+            ESP_LOGE(TAG, "cycle_run_loaded_cycle: executor unavailable");
+            return;
+        }
+
+        ESP_LOGI(TAG, "Running loaded cycle (%zu phases, %zu tracks) in background task", g_num_phases, g_num_tracks);
         
-        // Reset sensors before starting new cycle for clean data
-        ESP_LOGI(TAG, "Resetting sensors before starting cycle...");
+        s_start_request_us = esp_timer_get_time();
+
+        // Reset sensors before starting new cycle for clean data. Both are
+        // snapshots (the pressure zero is the tracked empty-tub baseline), so
+        // the web server is not held up by sensor reads here.
         rpm_sensor_reset();
+        pressure_sensor_set_tub_empty(false);
         pressure_sensor_reset();
-        ESP_LOGI(TAG, "Sensors reset complete");
         
         // Create a background task to run the cycle so WebSocket stays responsive
         // Use priority 2 to avoid starving WebSocket task (which runs at ~1-2)
@@ -16,7 +16,7 @@
 #define SOFT_VALVE_PIN       GPIO_NUM_18
 #define MOTOR_ON_PIN         GPIO_NUM_4
 #define MOTOR_DIRECTION_PIN  GPIO_NUM_10
-#define FLOW_SENSOR_PIN      GPIO_NUM_0
+#define FLOW_SENSOR_PIN      GPIO_NUM_6   // GPIO 0 is the RPM sensor
 #define NUM_COMPONENTS       8
 
 // ------------------------- SYSTEM LIMITS -------------------------
@@ -34,6 +34,14 @@
 // Timeline execution limits
 #define MAX_EVENTS_PER_PHASE      3400  // Reduced from 1024 - should handle largest motor patterns
 
+// Program limits (phase-level repeat/call constructs)
+#define MAX_PROGRAM_OPS           64    // Compiled ops for main sequence + subroutines
+#define MAX_SUBROUTINES           8     // Named entries in "subroutines"
+#define MAX_CONTROL_DEPTH         8     // Nested repeat/call frames in the runner
+#define MAX_REPEAT_COUNT          100   // Iterations of one repeat block
+#define MAX_PHASE_RUNS            1000  // Phases one track may execute, repeats and calls expanded
+#define MAX_TRACKS                3     // Concurrent phase tracks (e.g. water, motor, dosing)
+
 // -------------------- MOTOR TYPES --------------------
 // one entry in "pattern": { stepTime, pauseTime, direction }
 typedef struct {
@@ -46,11 +54,13 @@ typedef struct {
 typedef enum {
     SENSOR_TYPE_RPM,
     SENSOR_TYPE_PRESSURE,
+    SENSOR_TYPE_IMBALANCE,            // spin ripple at the drum frequency, per-mille
+    SENSOR_TYPE_VOLUME,               // metered water since the phase started, mL
     SENSOR_TYPE_UNKNOWN
 } SensorTriggerType;
 
 typedef struct {
-    SensorTriggerType type;           // RPM or PRESSURE
+    SensorTriggerType type;           // RPM, PRESSURE, IMBALANCE or VOLUME
     uint32_t threshold;               // Threshold value
     bool trigger_above;               // true: trigger when > threshold, false: trigger when < threshold
     bool has_triggered;               // Track if already triggered in this phase
@@ -81,6 +91,32 @@ typedef struct {
     SensorTrigger  *sensor_trigger;  // Optional: nullptr if no trigger
 } Phase;
 
+// -------------------- PROGRAM TYPES --------------------
+// The "phases" list is compiled into a flat op sequence. Repeat blocks and
+// subroutines reference each distinct phase once; the runner replays them.
+typedef enum {
+    PROG_OP_PHASE,      // run g_phases[arg]
+    PROG_OP_REPEAT,     // push loop frame (arg = times); target = op after matching NEXT
+    PROG_OP_NEXT,       // jump back to target (loop body) while iterations remain
+    PROG_OP_CALL,       // push return frame, jump to target (subroutine entry)
+    PROG_OP_RETURN,     // pop return frame
+    PROG_OP_END         // end of main sequence
+} ProgramOpType;
+
+typedef struct {
+    ProgramOpType op;
+    uint16_t      arg;
+    uint16_t      target;
+} ProgramOp;
+
+// One concurrent track: its own phase sequence on the shared cycle timeline.
+// A plain "phases" list is track 0; extra sequences come from "tracks".
+typedef struct {
+    const char *id;
+    uint16_t    entry_pc;           // first op of this track's sequence in g_program
+    size_t      max_phase_events;   // largest timeline of any phase the track can run
+} CycleTrack;
+
 typedef enum {
     EVENT_ON,
     EVENT_OFF
@@ -91,6 +127,7 @@ typedef struct {
     EventType   type;
     gpio_num_t  pin;
         int         level;     // for motor direction
+    uint16_t    seq;       // build order, keeps same-time events stable when sorted
 } TimelineEvent;
 
 
@@ -110,7 +147,11 @@ esp_err_t load_cycle_from_cjson(cJSON *root_json);
 // -------------------- GLOBAL STATE (accessible to WebSocket/telemetry) --------------------
 extern Phase g_phases[MAX_PHASES];  // All loaded phases
 extern size_t g_num_phases;         // Number of loaded phases
-extern uint64_t phase_start_us;     // Start time of current phase
+extern ProgramOp g_program[MAX_PROGRAM_OPS];  // Compiled phase sequence
+extern size_t g_program_len;        // Number of ops in g_program
+extern CycleTrack g_tracks[MAX_TRACKS];  // Concurrent tracks of the loaded cycle
+extern size_t g_num_tracks;         // Number of tracks (>= 1 once loaded)
+extern uint64_t phase_start_us;     // Start time of current phase (track 0)
 extern bool cycle_running;          // Current cycle execution state
 extern const char *current_phase_name;  // Name of current phase
 extern int current_phase_index;     // Index of current phase
@@ -123,9 +164,14 @@ void cycle_skip_current_phase(bool force_off_all);
 void cycle_skip_to_phase(size_t phase_index);
 void cycle_stop(void);
 bool cycle_is_running(void);
+// Start request to the first output write of the current/last cycle (µs), -1 if none yet.
+// Includes the first event's own offset when the cycle does not open with an output at 0 ms.
+int64_t cycle_start_latency_us(void);
+// Water metered since the track's current/last phase started (mL)
+uint32_t cycle_phase_volume_ml(size_t track);
 void cycle_unload(void);  // Free memory from previously loaded cycle
 
 
 // ------------------------- API -------------------------
-void run_phase_with_esp_timer(const Phase *phase);
+void run_phase_on_track(size_t track, size_t phase_index, uint64_t start_us);
 void run_cycle(Phase *phases, size_t num_phases);
\ No newline at end of file
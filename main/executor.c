@@ -0,0 +1,821 @@
+// executor.c
+#include "executor.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "driver/gptimer.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+// The ISR path must keep running while the flash cache is off (SPIFFS/NVS
+// writes, flash logging): its handler, gptimer_set_alarm_action() and
+// esp_timer_get_time() all have to live in IRAM.
+#if !CONFIG_GPTIMER_ISR_CACHE_SAFE || !CONFIG_GPTIMER_CTRL_FUNC_IN_IRAM || !CONFIG_ESP_TIMER_IN_IRAM
+#warning "ISR executor is not cache-safe: enable GPTIMER_ISR_CACHE_SAFE, GPTIMER_CTRL_FUNC_IN_IRAM and ESP_TIMER_IN_IRAM"
+#endif
+
+static const char *TAG = "executor";
+
+// Events that fall due within this window are applied in the same callback
+#define EXECUTOR_SLACK_US   200
+
+// ISR mode: an alarm closer than this to "now" is pushed out so it cannot be missed
+#define EXECUTOR_ISR_MIN_LEAD_US  5
+
+// GPIO pin list and shadow (from cycle.c)
+extern const gpio_num_t all_pins[NUM_COMPONENTS];
+extern int gpio_shadow[NUM_COMPONENTS];
+
+// Static data is in internal DRAM (.data/.bss), so the dispatch path can reach
+// it while the flash cache is disabled. DRAM_ATTR marks the initialised tables
+// and locks the ISR reads, keeping them out of flash-mapped .rodata if they are
+// ever made const. Zero-initialised buffers stay in .bss: DRAM_ATTR would copy
+// them into the loaded image for nothing.
+
+// Shared event pool, partitioned between tracks at executor_start()
+static TimelineEvent s_event_pool[MAX_EVENTS_PER_PHASE];
+
+static TrackRun s_tracks[MAX_TRACKS];
+static size_t s_num_tracks = 0;
+
+static esp_timer_handle_t s_timer = NULL;
+static gptimer_handle_t s_gptimer = NULL;
+static bool s_gptimer_running = false;   // enabled only during a cycle (holds a PM lock)
+static ExecutorMode s_mode = EXECUTOR_MODE_TASK;
+static TaskHandle_t s_notify_task = NULL;
+static DRAM_ATTR portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Safe state: every component output OFF (active-low → 1)
+#define EXECUTOR_SAFE_SET_MASK  ((1UL << RETRACTOR_PIN) | (1UL << DETERGENT_VALVE_PIN) | \
+                                 (1UL << COLD_VALVE_PIN) | (1UL << DRAIN_PUMP_PIN) |      \
+                                 (1UL << HOT_VALVE_PIN) | (1UL << SOFT_VALVE_PIN) |       \
+                                 (1UL << MOTOR_ON_PIN) | (1UL << MOTOR_DIRECTION_PIN))
+
+// Output levels as last written by the executor (bit = gpio num) and the bits
+// changed since gpio_shadow[] was last synced. The dispatch path only touches
+// these words; the per-pin shadow is updated later from task context. The
+// mirror starts all-OFF, matching init_all_gpio(), so the first write logs
+// only real edges; executor_init() re-seeds it from the output register.
+static DRAM_ATTR volatile uint32_t s_out_levels = EXECUTOR_SAFE_SET_MASK;
+static volatile uint32_t s_out_dirty = 0;
+
+// Deadline monitor state (reset per cycle) and per-pin class/budget tables
+static DRAM_ATTR DeadlineStats s_deadlines = { .trip_pin = -1 };
+static volatile bool s_fault_tripped = false;   // safe state forced by executor_trip_fault()
+static DRAM_ATTR uint32_t s_budget_us[DEADLINE_CLASS_COUNT] = {
+    [DEADLINE_CLASS_NORMAL]   = DEADLINE_BUDGET_NORMAL_US,
+    [DEADLINE_CLASS_CRITICAL] = DEADLINE_BUDGET_CRITICAL_US,
+};
+static DRAM_ATTR uint8_t s_pin_class[32] = {
+    [COLD_VALVE_PIN]      = DEADLINE_CLASS_CRITICAL,
+    [HOT_VALVE_PIN]       = DEADLINE_CLASS_CRITICAL,
+    [SOFT_VALVE_PIN]      = DEADLINE_CLASS_CRITICAL,
+    [DETERGENT_VALVE_PIN] = DEADLINE_CLASS_CRITICAL,
+    [DRAIN_PUMP_PIN]      = DEADLINE_CLASS_CRITICAL,
+    [MOTOR_ON_PIN]        = DEADLINE_CLASS_CRITICAL,
+};
+
+// Manual output sequence (executor_run_output_sequence), played from its own esp_timer
+static esp_timer_handle_t s_seq_timer = NULL;
+static ExecutorOutputStep s_seq[EXECUTOR_SEQ_MAX_STEPS];
+static size_t s_seq_len = 0;
+static volatile size_t s_seq_next = 0;
+static int64_t s_seq_start_us = 0;
+
+// Lateness trace: one entry per dispatch (register write time - earliest due time)
+static int32_t s_trace[EXECUTOR_TRACE_LEN];
+static volatile uint32_t s_trace_count = 0;   // total entries ever written (wraps the ring)
+static volatile int64_t s_first_write_us = 0;  // first timeline write since executor_start, 0 if none
+
+// Output edges for the serial telemetry stream
+static ExecutorEdge s_edges[EXECUTOR_EDGE_LOG_LEN];
+static volatile uint32_t s_edge_count = 0;    // total edges ever logged (wraps the ring)
+
+// ------------------------- OUTPUT -------------------------
+// Write a set/clear mask pair straight to the GPIO output registers.
+// Caller holds s_lock.
+static inline IRAM_ATTR void write_outputs(uint32_t set_mask, uint32_t clr_mask)
+{
+    if (set_mask) REG_WRITE(GPIO_OUT_W1TS_REG, set_mask);
+    if (clr_mask) REG_WRITE(GPIO_OUT_W1TC_REG, clr_mask);
+    uint32_t levels = (s_out_levels | set_mask) & ~clr_mask;
+    if (levels != s_out_levels) {
+        ExecutorEdge *e = &s_edges[s_edge_count % EXECUTOR_EDGE_LOG_LEN];
+        e->time_us = esp_timer_get_time();
+        e->changed = levels ^ s_out_levels;
+        e->levels = levels;
+        s_edge_count++;
+    }
+    s_out_levels = levels;
+    s_out_dirty |= set_mask | clr_mask;
+}
+
+// Drive every pin in mask OFF (active-low → 1)
+static void force_off_pins(uint32_t mask)
+{
+    portENTER_CRITICAL(&s_lock);
+    write_outputs(mask, 0);
+    portEXIT_CRITICAL(&s_lock);
+    executor_sync_shadow();
+}
+
+// ------------------------- DEADLINES -------------------------
+// Time an event's lateness is measured from: its due time, or the moment its
+// phase was queued when the phase started behind plan
+static inline IRAM_ATTR uint64_t deadline_ref_us(const TrackRun *tr, uint64_t due_us)
+{
+    return (due_us > tr->queued_us) ? due_us : tr->queued_us;
+}
+
+// Record a missed deadline. Returns true when it is the critical miss that
+// trips the safe state. Caller holds s_lock.
+static inline IRAM_ATTR bool deadline_miss(gpio_num_t pin, int32_t late_us)
+{
+    DeadlineClass cls = (DeadlineClass)s_pin_class[pin];
+    s_deadlines.misses[cls]++;
+    if (cls != DEADLINE_CLASS_CRITICAL || s_deadlines.safe_tripped) return false;
+
+    s_deadlines.safe_tripped = true;
+    s_deadlines.trip_pin = pin;
+    s_deadlines.trip_late_us = late_us;
+    return true;
+}
+
+// Account an applied event. already_missed: the cycle task counted it while pending.
+static inline IRAM_ATTR bool deadline_applied(gpio_num_t pin, int64_t late_us, bool already_missed)
+{
+    DeadlineClass cls = (DeadlineClass)s_pin_class[pin];
+    int32_t late = (late_us > INT32_MAX) ? INT32_MAX : (int32_t)late_us;
+
+    s_deadlines.events[cls]++;
+    if (late > s_deadlines.worst_late_us[cls]) s_deadlines.worst_late_us[cls] = late;
+    if (already_missed || late_us <= (int64_t)s_budget_us[cls]) return false;
+    return deadline_miss(pin, late);
+}
+
+// Stop every track and drive the safe output mask. Caller holds s_lock.
+static IRAM_ATTR void enter_safe_state_locked(uint64_t now_us)
+{
+    for (size_t t = 0; t < s_num_tracks; t++) {
+        TrackRun *tr = &s_tracks[t];
+        if (tr->active) {
+            tr->active = false;
+            tr->ended_early = true;
+            tr->last_event_us = now_us;
+        }
+        tr->next_event = tr->num_events;
+    }
+    write_outputs(EXECUTOR_SAFE_SET_MASK, 0);
+}
+
+// ------------------------- DISPATCH -------------------------
+// Apply everything that is due on every track as one output mask write and
+// return the earliest pending due time (UINT64_MAX when nothing is left).
+// Shared by both modes, so it only touches DRAM state and GPIO registers.
+static IRAM_ATTR uint64_t executor_dispatch(bool *phase_done)
+{
+    uint64_t now_us = esp_timer_get_time();
+    uint64_t next_due_us = UINT64_MAX;
+    uint64_t first_due_us = UINT64_MAX;
+    uint32_t set_mask = 0, clr_mask = 0;
+    bool tripped = false;
+
+    portENTER_CRITICAL_SAFE(&s_lock);
+    for (size_t t = 0; t < s_num_tracks; t++) {
+        TrackRun *tr = &s_tracks[t];
+        if (!tr->active) continue;
+
+        while (tr->next_event < tr->num_events) {
+            const TimelineEvent *ev = &tr->events[tr->next_event];
+            uint64_t due_us = tr->phase_start_us + ev->fire_time_us;
+            if (due_us > now_us + EXECUTOR_SLACK_US) {
+                if (due_us < next_due_us) next_due_us = due_us;
+                break;
+            }
+            if (ev->pin != GPIO_NUM_NC) {
+                if (deadline_applied(ev->pin, (int64_t)(now_us - deadline_ref_us(tr, due_us)),
+                                     tr->next_event == tr->overdue_event)) {
+                    tripped = true;
+                }
+
+                // later events win over earlier ones for the same pin
+                uint32_t bit = 1UL << ev->pin;
+                if (ev->level) {
+                    set_mask |= bit;
+                    clr_mask &= ~bit;
+                } else {
+                    clr_mask |= bit;
+                    set_mask &= ~bit;
+                }
+            }
+            if (due_us < first_due_us) first_due_us = due_us;
+            tr->next_event++;
+        }
+
+        if (tr->next_event >= tr->num_events) {
+            tr->active = false;
+            tr->last_event_us = now_us;
+            *phase_done = true;
+        }
+    }
+
+    if (tripped) {
+        // a critical deadline was blown: the late edges are not applied
+        enter_safe_state_locked(now_us);
+        next_due_us = UINT64_MAX;
+        *phase_done = true;
+    } else if (set_mask | clr_mask) {
+        write_outputs(set_mask, clr_mask);
+        int64_t written_us = esp_timer_get_time();
+        if (s_first_write_us == 0) s_first_write_us = written_us;
+        int64_t late_us = (int64_t)(written_us - first_due_us);
+        s_trace[s_trace_count % EXECUTOR_TRACE_LEN] = (late_us > INT32_MAX) ? INT32_MAX : (int32_t)late_us;
+        s_trace_count++;
+    }
+    portEXIT_CRITICAL_SAFE(&s_lock);
+
+    return next_due_us;
+}
+
+// ------------------------- TASK MODE (esp_timer task) -------------------------
+static void executor_timer_cb(void *arg)
+{
+    (void)arg;
+    bool phase_done = false;
+    uint64_t next_due_us = executor_dispatch(&phase_done);
+
+    if (phase_done && s_notify_task) {
+        xTaskNotifyGive(s_notify_task);
+    }
+
+    if (next_due_us != UINT64_MAX) {
+        uint64_t now_us = esp_timer_get_time();
+        esp_timer_start_once(s_timer, next_due_us > now_us ? next_due_us - now_us : 1);
+    }
+}
+
+// ------------------------- ISR MODE (gptimer alarm) -------------------------
+// The gptimer counts in µs and is loaded with esp_timer time at executor_start(),
+// so alarm counts are absolute esp_timer timestamps.
+static IRAM_ATTR void isr_arm(uint64_t due_us)
+{
+    if (due_us == UINT64_MAX) {
+        gptimer_set_alarm_action(s_gptimer, NULL);
+        return;
+    }
+
+    uint64_t earliest_us = esp_timer_get_time() + EXECUTOR_ISR_MIN_LEAD_US;
+    gptimer_alarm_config_t alarm = {
+        .alarm_count = (due_us > earliest_us) ? due_us : earliest_us,
+    };
+    gptimer_set_alarm_action(s_gptimer, &alarm);
+}
+
+static IRAM_ATTR bool executor_alarm_isr(gptimer_handle_t timer,
+                                         const gptimer_alarm_event_data_t *edata,
+                                         void *arg)
+{
+    (void)timer; (void)edata; (void)arg;
+    bool phase_done = false;
+    BaseType_t woken = pdFALSE;
+
+    uint64_t next_due_us = executor_dispatch(&phase_done);
+    isr_arm(next_due_us);
+
+    // everything else (shadow sync, phase bookkeeping) runs in the cycle task
+    if (phase_done && s_notify_task) {
+        vTaskNotifyGiveFromISR(s_notify_task, &woken);
+    }
+    return woken == pdTRUE;
+}
+
+static esp_err_t isr_timer_create(void)
+{
+    if (s_gptimer) return ESP_OK;
+
+    const gptimer_config_t cfg = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = 1000000,   // 1 tick = 1 µs, same unit as esp_timer
+    };
+    const gptimer_event_callbacks_t cbs = {
+        .on_alarm = executor_alarm_isr,
+    };
+
+    // enabled/started per cycle in executor_start() so it doesn't block light sleep when idle
+    esp_err_t err = gptimer_new_timer(&cfg, &s_gptimer);
+    if (err == ESP_OK) err = gptimer_register_event_callbacks(s_gptimer, &cbs, NULL);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set up ISR executor timer: %s", esp_err_to_name(err));
+        if (s_gptimer) {
+            gptimer_del_timer(s_gptimer);
+            s_gptimer = NULL;
+        }
+    }
+    return err;
+}
+
+// Re-evaluate the schedule right away (after a track's timeline changed)
+static void executor_kick(void)
+{
+    if (s_mode == EXECUTOR_MODE_ISR) {
+        isr_arm(0);   // clamped to now + EXECUTOR_ISR_MIN_LEAD_US
+        return;
+    }
+    esp_timer_stop(s_timer);  // ESP_ERR_INVALID_STATE if idle, that's fine
+    esp_timer_start_once(s_timer, 1);
+}
+
+// ------------------------- MANUAL OUTPUTS -------------------------
+static bool output_masks_valid(uint32_t set_mask, uint32_t clr_mask)
+{
+    return !((set_mask | clr_mask) & ~EXECUTOR_SAFE_SET_MASK) && !(set_mask & clr_mask);
+}
+
+// Apply every step that is due and re-arm for the next one
+static void seq_timer_cb(void *arg)
+{
+    int64_t elapsed_us = esp_timer_get_time() - s_seq_start_us;
+
+    while (s_seq_next < s_seq_len && (int64_t)s_seq[s_seq_next].at_ms * 1000 <= elapsed_us) {
+        const ExecutorOutputStep *st = &s_seq[s_seq_next++];
+        portENTER_CRITICAL(&s_lock);
+        write_outputs(st->set_mask, st->clr_mask);
+        portEXIT_CRITICAL(&s_lock);
+    }
+    if (s_seq_next < s_seq_len) {
+        int64_t wait_us = (int64_t)s_seq[s_seq_next].at_ms * 1000 - elapsed_us;
+        esp_timer_start_once(s_seq_timer, wait_us > 0 ? wait_us : 1);
+    }
+}
+
+static void seq_cancel(void)
+{
+    if (s_seq_timer) esp_timer_stop(s_seq_timer);
+    s_seq_len = 0;
+    s_seq_next = 0;
+}
+
+// ------------------------- PUBLIC API -------------------------
+esp_err_t executor_init(void)
+{
+    if (s_timer) return ESP_OK;
+
+    // Pins were driven by init_all_gpio(); take their real levels before the edge log is read
+    s_out_levels = REG_READ(GPIO_OUT_REG) & EXECUTOR_SAFE_SET_MASK;
+
+    const esp_timer_create_args_t args = {
+        .callback = executor_timer_cb,
+        .arg = NULL,
+        .name = "cycle_exec"
+    };
+
+    esp_err_t err = esp_timer_create(&args, &s_timer);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create executor timer: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    // Prefer the cache-safe ISR path; the esp_timer task stalls during flash writes
+    if (isr_timer_create() == ESP_OK) {
+        s_mode = EXECUTOR_MODE_ISR;
+    } else {
+        ESP_LOGW(TAG, "ISR executor unavailable, falling back to task mode");
+    }
+    ESP_LOGI(TAG, "Executor mode: %s", executor_mode_name(s_mode));
+    return ESP_OK;
+}
+
+esp_err_t executor_set_mode(ExecutorMode mode)
+{
+    if (mode == s_mode) return ESP_OK;
+    if (s_notify_task) {
+        ESP_LOGW(TAG, "Cannot change executor mode while a cycle is running");
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (mode == EXECUTOR_MODE_ISR) {
+        esp_err_t err = isr_timer_create();
+        if (err != ESP_OK) return err;
+    }
+
+    s_mode = mode;
+    executor_trace_reset();
+    ESP_LOGI(TAG, "Executor mode: %s", executor_mode_name(mode));
+    return ESP_OK;
+}
+
+ExecutorMode executor_get_mode(void)
+{
+    return s_mode;
+}
+
+const char *executor_mode_name(ExecutorMode mode)
+{
+    return (mode == EXECUTOR_MODE_ISR) ? "isr" : "task";
+}
+
+void executor_start(TaskHandle_t notify_task)
+{
+    executor_stop();
+    seq_cancel();   // the cycle owns the outputs from here
+
+    if (s_mode == EXECUTOR_MODE_ISR) {
+        gptimer_enable(s_gptimer);
+        gptimer_set_raw_count(s_gptimer, esp_timer_get_time());
+        gptimer_start(s_gptimer);
+        s_gptimer_running = true;
+    }
+
+    size_t needed = 0;
+    s_num_tracks = g_num_tracks;
+    for (size_t t = 0; t < s_num_tracks; t++) {
+        needed += g_tracks[t].max_phase_events;
+    }
+
+    // Each track gets room for its largest phase; scale down if the pool is short
+    size_t offset = 0;
+    for (size_t t = 0; t < s_num_tracks; t++) {
+        size_t cap = g_tracks[t].max_phase_events;
+        if (needed > MAX_EVENTS_PER_PHASE) {
+            cap = (size_t)(((uint64_t)cap * MAX_EVENTS_PER_PHASE) / needed);
+        }
+        s_tracks[t].events = &s_event_pool[offset];
+        s_tracks[t].capacity = cap;
+        s_tracks[t].phase_index = -1;
+        offset += cap;
+        ESP_LOGI(TAG, "Track %zu '%s': %zu event slots", t, g_tracks[t].id ? g_tracks[t].id : "main", cap);
+    }
+    if (needed > MAX_EVENTS_PER_PHASE) {
+        ESP_LOGW(TAG, "Tracks need %zu event slots, pool has %d - largest phases will be truncated",
+                 needed, MAX_EVENTS_PER_PHASE);
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    memset(&s_deadlines, 0, sizeof(s_deadlines));
+    s_deadlines.trip_pin = -1;
+    s_fault_tripped = false;
+    s_first_write_us = 0;
+    portEXIT_CRITICAL(&s_lock);
+
+    s_notify_task = notify_task;
+}
+
+void executor_stop(void)
+{
+    if (s_timer) {
+        esp_timer_stop(s_timer);
+    }
+    if (s_gptimer_running) {
+        gptimer_set_alarm_action(s_gptimer, NULL);
+        gptimer_stop(s_gptimer);
+        gptimer_disable(s_gptimer);
+        s_gptimer_running = false;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    for (size_t t = 0; t < MAX_TRACKS; t++) {
+        s_tracks[t].active = false;
+        s_tracks[t].num_events = 0;
+        s_tracks[t].next_event = 0;
+        s_tracks[t].phase_index = -1;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    s_notify_task = NULL;
+    executor_sync_shadow();
+}
+
+TrackRun *executor_track(size_t t)
+{
+    return (t < MAX_TRACKS) ? &s_tracks[t] : NULL;
+}
+
+void executor_begin_phase(size_t t, int phase_index, size_t num_events, uint64_t start_us)
+{
+    if (t >= s_num_tracks) return;
+    TrackRun *tr = &s_tracks[t];
+
+    uint32_t mask = 0;
+    for (size_t i = 0; i < num_events; i++) {
+        if (tr->events[i].pin != GPIO_NUM_NC) {
+            mask |= 1UL << tr->events[i].pin;
+        }
+    }
+
+    uint64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&s_lock);
+    tr->num_events = num_events;
+    tr->next_event = 0;
+    tr->phase_start_us = start_us;
+    tr->queued_us = now_us;
+    tr->planned_end_us = start_us + (num_events ? tr->events[num_events - 1].fire_time_us : 0);
+    tr->last_event_us = tr->planned_end_us;
+    tr->ended_early = false;
+    tr->pin_mask = mask;
+    tr->phase_index = phase_index;
+    tr->overdue_event = SIZE_MAX;
+    tr->active = (num_events > 0) && !s_deadlines.safe_tripped && !s_fault_tripped;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (tr->active) {
+        executor_kick();
+    }
+}
+
+void executor_end_phase(size_t t, bool force_off)
+{
+    if (t >= s_num_tracks) return;
+    TrackRun *tr = &s_tracks[t];
+
+    portENTER_CRITICAL(&s_lock);
+    bool was_active = tr->active;
+    tr->active = false;
+    tr->next_event = tr->num_events;
+    if (was_active) {
+        tr->ended_early = true;
+        tr->last_event_us = esp_timer_get_time();
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (force_off) {
+        force_off_pins(tr->pin_mask);
+    }
+
+    if (was_active) {
+        ESP_LOGW(TAG, "Track %zu phase ended early", t);
+        if (s_notify_task) {
+            xTaskNotifyGive(s_notify_task);
+        }
+    }
+}
+
+void executor_end_all(bool force_off_all)
+{
+    for (size_t t = 0; t < s_num_tracks; t++) {
+        executor_end_phase(t, false);
+    }
+
+    if (force_off_all) {
+        // turn OFF everything (active-low → 1)
+        uint32_t mask = 0;
+        for (int i = 0; i < NUM_COMPONENTS; i++) {
+            mask |= 1UL << all_pins[i];
+        }
+        force_off_pins(mask);
+    }
+}
+
+bool executor_track_active(size_t t)
+{
+    return (t < s_num_tracks) && s_tracks[t].active;
+}
+
+uint64_t executor_next_due_us(void)
+{
+    uint64_t next_due_us = UINT64_MAX;
+
+    portENTER_CRITICAL(&s_lock);
+    for (size_t t = 0; t < s_num_tracks; t++) {
+        const TrackRun *tr = &s_tracks[t];
+        if (!tr->active || tr->next_event >= tr->num_events) continue;
+        uint64_t due_us = tr->phase_start_us + tr->events[tr->next_event].fire_time_us;
+        if (due_us < next_due_us) next_due_us = due_us;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    return next_due_us;
+}
+
+void executor_set_deadline_budget(DeadlineClass cls, uint32_t budget_us)
+{
+    if (cls >= DEADLINE_CLASS_COUNT) return;
+    s_budget_us[cls] = budget_us;
+}
+
+uint32_t executor_get_deadline_budget(DeadlineClass cls)
+{
+    return (cls < DEADLINE_CLASS_COUNT) ? s_budget_us[cls] : 0;
+}
+
+void executor_check_deadlines(void)
+{
+    uint64_t now_us = esp_timer_get_time();
+    bool tripped = false;
+
+    portENTER_CRITICAL(&s_lock);
+    for (size_t t = 0; t < s_num_tracks; t++) {
+        TrackRun *tr = &s_tracks[t];
+        if (!tr->active || tr->next_event >= tr->num_events) continue;
+        if (tr->next_event == tr->overdue_event) continue;   // already counted
+
+        const TimelineEvent *ev = &tr->events[tr->next_event];
+        uint64_t due_us = deadline_ref_us(tr, tr->phase_start_us + ev->fire_time_us);
+        if (ev->pin == GPIO_NUM_NC || now_us <= due_us + s_budget_us[s_pin_class[ev->pin]]) continue;
+
+        // still pending past its budget: the dispatch path is not running
+        tr->overdue_event = tr->next_event;
+        int64_t late_us = (int64_t)(now_us - due_us);
+        if (deadline_miss(ev->pin, (late_us > INT32_MAX) ? INT32_MAX : (int32_t)late_us)) {
+            tripped = true;
+        }
+    }
+    if (tripped) {
+        enter_safe_state_locked(now_us);
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (tripped) {
+        executor_sync_shadow();
+    }
+}
+
+void executor_note_dropped(size_t count)
+{
+    portENTER_CRITICAL(&s_lock);
+    s_deadlines.dropped += count;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void executor_deadline_stats(DeadlineStats *out)
+{
+    portENTER_CRITICAL(&s_lock);
+    *out = s_deadlines;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+bool executor_safe_tripped(void)
+{
+    return s_deadlines.safe_tripped || s_fault_tripped;
+}
+
+void executor_trip_fault(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    bool first = !s_fault_tripped;
+    s_fault_tripped = true;
+    enter_safe_state_locked(esp_timer_get_time());
+    TaskHandle_t task = s_notify_task;
+    portEXIT_CRITICAL(&s_lock);
+
+    executor_sync_shadow();
+    if (first && task) {
+        xTaskNotifyGive(task);
+    }
+}
+
+void executor_set_output(gpio_num_t pin, int level)
+{
+    if (pin < 0 || pin >= 32) return;
+    uint32_t bit = 1UL << pin;
+
+    portENTER_CRITICAL(&s_lock);
+    write_outputs(level ? bit : 0, level ? 0 : bit);
+    portEXIT_CRITICAL(&s_lock);
+    executor_sync_shadow();
+}
+
+esp_err_t executor_write_outputs(uint32_t set_mask, uint32_t clr_mask)
+{
+    if (!output_masks_valid(set_mask, clr_mask)) return ESP_ERR_INVALID_ARG;
+
+    portENTER_CRITICAL(&s_lock);
+    write_outputs(set_mask, clr_mask);
+    portEXIT_CRITICAL(&s_lock);
+    executor_sync_shadow();
+    return ESP_OK;
+}
+
+esp_err_t executor_run_output_sequence(const ExecutorOutputStep *steps, size_t n)
+{
+    if (!steps || n == 0 || n > EXECUTOR_SEQ_MAX_STEPS) return ESP_ERR_INVALID_ARG;
+    for (size_t i = 0; i < n; i++) {
+        if (!output_masks_valid(steps[i].set_mask, steps[i].clr_mask) ||
+            steps[i].at_ms > EXECUTOR_SEQ_MAX_MS || (i && steps[i].at_ms < steps[i - 1].at_ms)) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    if (s_notify_task || executor_output_sequence_active()) return ESP_ERR_INVALID_STATE;
+
+    if (!s_seq_timer) {
+        const esp_timer_create_args_t args = {
+            .callback = seq_timer_cb,
+            .arg = NULL,
+            .name = "out_seq"
+        };
+        esp_err_t err = esp_timer_create(&args, &s_seq_timer);
+        if (err != ESP_OK) return err;
+    }
+
+    memcpy(s_seq, steps, n * sizeof(*steps));
+    s_seq_len = n;
+    s_seq_next = 0;
+    s_seq_start_us = esp_timer_get_time();
+    seq_timer_cb(NULL);     // steps at 0 ms go out now
+    executor_sync_shadow();
+    return ESP_OK;
+}
+
+bool executor_output_sequence_active(void)
+{
+    return s_seq_next < s_seq_len;
+}
+
+uint32_t executor_output_levels(void)
+{
+    return REG_READ(GPIO_OUT_REG) & EXECUTOR_SAFE_SET_MASK;
+}
+
+void executor_sync_shadow(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    uint32_t dirty = s_out_dirty;
+    uint32_t levels = s_out_levels;
+    s_out_dirty = 0;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (!dirty) return;
+    for (int i = 0; i < NUM_COMPONENTS; i++) {
+        uint32_t bit = 1UL << all_pins[i];
+        if (dirty & bit) {
+            gpio_shadow[i] = (levels & bit) ? 1 : 0;
+        }
+    }
+}
+
+// ------------------------- LATENCY TRACE -------------------------
+static int compare_i32(const void *a, const void *b)
+{
+    int32_t x = *(const int32_t *)a, y = *(const int32_t *)b;
+    return (x > y) - (x < y);
+}
+
+int64_t executor_first_write_us(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    int64_t t = s_first_write_us;
+    portEXIT_CRITICAL(&s_lock);
+    return t;
+}
+
+void executor_trace_reset(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    s_trace_count = 0;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void executor_trace_stats(ExecutorTraceStats *out)
+{
+    static int32_t sorted[EXECUTOR_TRACE_LEN];
+
+    memset(out, 0, sizeof(*out));
+    out->mode = s_mode;
+
+    portENTER_CRITICAL(&s_lock);
+    uint32_t total = s_trace_count;
+    size_t n = (total < EXECUTOR_TRACE_LEN) ? total : EXECUTOR_TRACE_LEN;
+    memcpy(sorted, s_trace, n * sizeof(int32_t));
+    portEXIT_CRITICAL(&s_lock);
+
+    out->total = total;
+    out->samples = n;
+    if (n == 0) return;
+
+    qsort(sorted, n, sizeof(int32_t), compare_i32);
+    out->min_us = sorted[0];
+    out->p50_us = sorted[n / 2];
+    out->p99_us = sorted[(n * 99) / 100];
+    out->max_us = sorted[n - 1];
+}
+
+size_t executor_read_edges(uint32_t *cursor, ExecutorEdge *out, size_t max, uint32_t *lost)
+{
+    size_t n = 0;
+
+    portENTER_CRITICAL(&s_lock);
+    uint32_t total = s_edge_count;
+    uint32_t from = *cursor;
+    uint32_t skipped = 0;
+    if (total - from > EXECUTOR_EDGE_LOG_LEN) {
+        skipped = total - from - EXECUTOR_EDGE_LOG_LEN;
+        from = total - EXECUTOR_EDGE_LOG_LEN;
+    }
+    for (; from != total && n < max; from++) {
+        out[n++] = s_edges[from % EXECUTOR_EDGE_LOG_LEN];
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    *cursor = from;
+    if (lost) *lost = skipped;
+    return n;
+}
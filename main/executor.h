@@ -0,0 +1,188 @@
+// executor.h
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "cycle.h"
+
+// Single merged executor: one timer walks the live phase timeline of every
+// track and re-arms itself for the earliest pending event, so running several
+// concurrent tracks costs no extra timers. Everything due at once is written
+// to the GPIO output registers as a single set/clear mask.
+//
+// Two dispatch modes:
+//   EXECUTOR_MODE_TASK - esp_timer callback in the esp_timer task. Latency
+//                        depends on what else is runnable (httpd, SPIFFS) and
+//                        it stalls while the flash cache is off.
+//   EXECUTOR_MODE_ISR  - gptimer alarm ISR applies the due mask directly; the
+//                        per-pin shadow and phase bookkeeping run in the cycle task.
+//                        IRAM-resident and cache-safe, so it keeps timing during
+//                        flash writes. Default when the gptimer is available.
+
+typedef enum {
+    EXECUTOR_MODE_TASK,
+    EXECUTOR_MODE_ISR
+} ExecutorMode;
+
+// Lateness trace ring (one entry per output write)
+#define EXECUTOR_TRACE_LEN  512
+
+typedef struct {
+    ExecutorMode mode;
+    uint32_t     total;     // writes traced since the last reset
+    size_t       samples;   // entries the stats below are computed from (last EXECUTOR_TRACE_LEN)
+    int32_t      min_us;
+    int32_t      p50_us;
+    int32_t      p99_us;
+    int32_t      max_us;
+} ExecutorTraceStats;
+
+// Output edge log (one entry per executor write that changed a level)
+#define EXECUTOR_EDGE_LOG_LEN  64
+
+typedef struct {
+    int64_t  time_us;       // esp_timer time of the register write
+    uint32_t changed;       // gpio bits that changed
+    uint32_t levels;        // all executor-driven levels after the write (bit = gpio num)
+} ExecutorEdge;
+
+// Live state of the phase currently running on one track
+typedef struct {
+    TimelineEvent *events;          // this track's slice of the shared event pool
+    size_t         capacity;        // slice size (events)
+    size_t         num_events;      // events in the current phase (sorted by time)
+    size_t         next_event;      // first event not yet applied
+    uint64_t       phase_start_us;  // esp_timer time the phase timeline is anchored to
+    uint64_t       queued_us;       // when executor_begin_phase() armed it (deadline floor)
+    uint64_t       planned_end_us;  // phase_start_us + time of the last event
+    uint64_t       last_event_us;   // when the phase actually finished (last event applied or ended)
+    uint32_t       pin_mask;        // GPIOs touched by the current phase (bit = gpio num)
+    int            phase_index;     // index into g_phases, -1 when idle
+    bool           active;          // phase has events left to apply
+    bool           ended_early;     // ended by trigger/skip instead of running out of events
+    size_t         overdue_event;   // event already counted as missed while still pending (SIZE_MAX if none)
+} TrackRun;
+
+// Deadline monitor: every applied event is checked against the budget of its
+// pin class, and the cycle task checks pending events that never fire. An
+// event that was already due when its phase was queued (the phase started
+// behind plan) is measured from the queue time: the executor could not have
+// applied it earlier, and the drift is accounted by the cycle timing. A miss
+// on a critical pin (water valves, drain pump, motor enable) drives every
+// output OFF, stops all tracks and raises an alarm.
+typedef enum {
+    DEADLINE_CLASS_NORMAL,      // retractor, motor direction
+    DEADLINE_CLASS_CRITICAL,    // valves, drain pump, motor enable
+    DEADLINE_CLASS_COUNT
+} DeadlineClass;
+
+#define DEADLINE_BUDGET_NORMAL_US    100000
+#define DEADLINE_BUDGET_CRITICAL_US  20000
+
+typedef struct {
+    uint32_t events[DEADLINE_CLASS_COUNT];
+    uint32_t misses[DEADLINE_CLASS_COUNT];
+    int32_t  worst_late_us[DEADLINE_CLASS_COUNT];
+    uint32_t dropped;           // events that never made it into a timeline
+    bool     safe_tripped;
+    int      trip_pin;          // GPIO whose deadline tripped the safe state, -1 if none
+    int32_t  trip_late_us;
+} DeadlineStats;
+
+// Create the executor timer (call once before the first cycle)
+esp_err_t executor_init(void);
+
+// Select the dispatch mode (not while a cycle is running). Resets the trace.
+esp_err_t executor_set_mode(ExecutorMode mode);
+ExecutorMode executor_get_mode(void);
+const char *executor_mode_name(ExecutorMode mode);
+
+// Partition the event pool between g_tracks and arm the executor for a new cycle.
+// notify_task is woken (task notification) whenever a track's phase completes.
+void executor_start(TaskHandle_t notify_task);
+
+// Stop the executor timer and drop every pending event
+void executor_stop(void);
+
+// Live state for a track (valid for t < g_num_tracks)
+TrackRun *executor_track(size_t t);
+
+// Arm track t with the num_events already built into its slice, anchored at start_us
+void executor_begin_phase(size_t t, int phase_index, size_t num_events, uint64_t start_us);
+
+// Drop the remaining events of track t. With force_off the pins that phase
+// drives are switched OFF; other tracks keep running untouched.
+void executor_end_phase(size_t t, bool force_off);
+
+// End the phase on every track; force_off_all switches every output OFF
+void executor_end_all(bool force_off_all);
+
+bool executor_track_active(size_t t);
+
+// Earliest pending event time on any track (esp_timer µs), UINT64_MAX when idle
+uint64_t executor_next_due_us(void);
+
+// Deadline budgets (µs) per pin class; take effect immediately
+void executor_set_deadline_budget(DeadlineClass cls, uint32_t budget_us);
+uint32_t executor_get_deadline_budget(DeadlineClass cls);
+
+// Count pending events that are already past their budget (cycle task, periodic).
+// Catches deadlines the dispatch path never got to run for.
+void executor_check_deadlines(void);
+
+// Record events lost before execution (timeline truncated by the pool size)
+void executor_note_dropped(size_t count);
+
+// Miss statistics for the current (or last) cycle, reset by executor_start()
+void executor_deadline_stats(DeadlineStats *out);
+
+// True once the cycle was forced into the safe state (deadline or fault trip)
+bool executor_safe_tripped(void);
+
+// Force the safe state from outside the deadline monitor (e.g. a motor fault):
+// every output OFF, all tracks stopped, no further phase starts and the cycle
+// task woken. Not counted as a deadline miss; cleared by executor_start().
+void executor_trip_fault(void);
+
+// Drive one output through the executor so its view of the pins stays current
+void executor_set_output(gpio_num_t pin, int level);
+
+// Manual output steps: set/clear masks (gpio bits, component outputs only)
+#define EXECUTOR_SEQ_MAX_STEPS  16
+#define EXECUTOR_SEQ_MAX_MS     10000
+
+typedef struct {
+    uint32_t at_ms;         // offset from the start of the sequence (non-decreasing)
+    uint32_t set_mask;
+    uint32_t clr_mask;
+} ExecutorOutputStep;
+
+// Apply several outputs in one dispatch write (same path as due timeline events).
+// ESP_ERR_INVALID_ARG if a mask names a non-output pin or set and clear overlap.
+esp_err_t executor_write_outputs(uint32_t set_mask, uint32_t clr_mask);
+
+// Play a short timed sequence of masks from the executor's own timer.
+// ESP_ERR_INVALID_STATE while a cycle or another sequence is running.
+esp_err_t executor_run_output_sequence(const ExecutorOutputStep *steps, size_t n);
+bool executor_output_sequence_active(void);
+
+// Current level of every component output (gpio bits, read from the output register)
+uint32_t executor_output_levels(void);
+
+// Copy output changes made by the executor into gpio_shadow[] (task context)
+void executor_sync_shadow(void);
+
+// Lateness distribution of output writes (write time - due time)
+void executor_trace_stats(ExecutorTraceStats *out);
+void executor_trace_reset(void);
+
+// esp_timer time of the first timeline output write since executor_start(), 0 if none yet
+int64_t executor_first_write_us(void);
+
+// Copy edges logged since *cursor (advanced past them); *lost counts entries
+// overwritten before they were read. Returns the number copied.
+size_t executor_read_edges(uint32_t *cursor, ExecutorEdge *out, size_t max, uint32_t *lost);
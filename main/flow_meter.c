@@ -0,0 +1,144 @@
+// flow_meter.c
+#include "flow_meter.h"
+#include "cycle.h"          // FLOW_SENSOR_PIN
+#include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "flow_meter";
+
+typedef struct {
+    bool         armed;
+    uint32_t     count;
+    TaskHandle_t task;
+} FlowTarget;
+
+// shared state between ISR and readers
+static DRAM_ATTR portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static DRAM_ATTR volatile uint32_t s_count = 0;
+static DRAM_ATTR volatile int64_t s_pulse_us[FLOW_RATE_PULSES];    // indexed by count % FLOW_RATE_PULSES
+static DRAM_ATTR FlowTarget s_targets[FLOW_MAX_TARGETS];
+
+static float s_pulses_per_l = FLOW_DEFAULT_PULSES_PER_L;
+
+// ISR: count, stamp, and wake whoever waits for this count
+static void IRAM_ATTR flow_gpio_isr(void *arg)
+{
+    int64_t now = esp_timer_get_time();
+    BaseType_t woken = pdFALSE;
+
+    portENTER_CRITICAL_ISR(&s_lock);
+    uint32_t c = s_count + 1;
+    s_count = c;
+    s_pulse_us[c % FLOW_RATE_PULSES] = now;
+    for (int i = 0; i < FLOW_MAX_TARGETS; i++) {
+        FlowTarget *tg = &s_targets[i];
+        if (tg->armed && (int32_t)(c - tg->count) >= 0) {
+            tg->armed = false;
+            if (tg->task) vTaskNotifyGiveFromISR(tg->task, &woken);
+        }
+    }
+    portEXIT_CRITICAL_ISR(&s_lock);
+
+    if (woken) portYIELD_FROM_ISR();
+}
+
+esp_err_t flow_meter_init(void)
+{
+    gpio_config_t io_conf = {
+        .intr_type = GPIO_INTR_POSEDGE,
+        .mode = GPIO_MODE_INPUT,
+        .pin_bit_mask = (1ULL << FLOW_SENSOR_PIN),
+        .pull_up_en = 1,
+    };
+    esp_err_t err = gpio_config(&io_conf);
+    if (err != ESP_OK) return err;
+
+    // the ISR service may already be installed (RPM sensor)
+    err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) return err;
+
+    err = gpio_isr_handler_add(FLOW_SENSOR_PIN, flow_gpio_isr, NULL);
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "Flow meter on GPIO %d, %.1f pulses/L", FLOW_SENSOR_PIN, s_pulses_per_l);
+    }
+    return err;
+}
+
+esp_err_t flow_meter_set_pulses_per_litre(float ppl)
+{
+    if (!(ppl > 0.0f)) return ESP_ERR_INVALID_ARG;
+    s_pulses_per_l = ppl;
+    return ESP_OK;
+}
+
+float flow_meter_get_pulses_per_litre(void)
+{
+    return s_pulses_per_l;
+}
+
+uint32_t flow_meter_count(void)
+{
+    return s_count;
+}
+
+float flow_meter_rate_lpm(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    uint32_t c = s_count;
+    int64_t last = s_pulse_us[c % FLOW_RATE_PULSES];
+    uint32_t span = (c < FLOW_RATE_PULSES) ? c : FLOW_RATE_PULSES;   // pulses with a stored time
+    int64_t first = span ? s_pulse_us[(c - span + 1) % FLOW_RATE_PULSES] : 0;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (span < 2 || esp_timer_get_time() - last > FLOW_TIMEOUT_MS * 1000LL || last <= first) {
+        return 0.0f;
+    }
+    // span - 1 intervals between the oldest and newest stored pulse
+    float litres = (float)(span - 1) / s_pulses_per_l;
+    return litres * 60e6f / (float)(last - first);
+}
+
+uint32_t flow_meter_pulses_to_ml(uint32_t pulses)
+{
+    return (uint32_t)((float)pulses * 1000.0f / s_pulses_per_l);
+}
+
+uint32_t flow_meter_ml_to_pulses(uint32_t ml)
+{
+    float p = (float)ml * s_pulses_per_l / 1000.0f;
+    uint32_t n = (uint32_t)p;
+    return ((float)n < p) ? n + 1 : n;
+}
+
+void flow_meter_arm(size_t slot, uint32_t target_count, TaskHandle_t task)
+{
+    if (slot >= FLOW_MAX_TARGETS) return;
+
+    portENTER_CRITICAL(&s_lock);
+    s_targets[slot].count = target_count;
+    s_targets[slot].task = task;
+    s_targets[slot].armed = true;
+    bool reached = (int32_t)(s_count - target_count) >= 0;     // already there (zero volume)
+    if (reached) s_targets[slot].armed = false;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (reached && task) xTaskNotifyGive(task);
+}
+
+void flow_meter_disarm(size_t slot)
+{
+    if (slot >= FLOW_MAX_TARGETS) return;
+
+    portENTER_CRITICAL(&s_lock);
+    s_targets[slot].armed = false;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void flow_meter_disarm_all(void)
+{
+    for (size_t i = 0; i < FLOW_MAX_TARGETS; i++) {
+        flow_meter_disarm(i);
+    }
+}
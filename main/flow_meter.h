@@ -0,0 +1,45 @@
+// flow_meter.h
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Hall-effect flow meter on FLOW_SENSOR_PIN. The C3 has no pulse counter
+// peripheral, so a minimal IRAM edge interrupt does the counting: it
+// increments a 32-bit count and keeps the last few pulse times for the rate.
+// The count wraps; every consumer works on differences (count - start), which
+// stay correct across the wrap.
+//
+// Volume targets are armed as an absolute count. The interrupt wakes the
+// given task on the exact pulse that reaches the target, so a fill stops at
+// pulse resolution without the task polling.
+
+#define FLOW_DEFAULT_PULSES_PER_L  450.0f   // YF-S201 class sensors
+#define FLOW_RATE_PULSES           8        // pulse times kept for the rate
+#define FLOW_TIMEOUT_MS            2000     // no pulse for this long: rate 0
+#define FLOW_MAX_TARGETS           3        // one per cycle track
+
+esp_err_t flow_meter_init(void);
+
+// Calibration (pulses per litre), > 0
+esp_err_t flow_meter_set_pulses_per_litre(float ppl);
+float flow_meter_get_pulses_per_litre(void);
+
+// Raw pulse count since boot (wraps at 2^32)
+uint32_t flow_meter_count(void);
+
+// Flow over the last FLOW_RATE_PULSES pulses (L/min), 0 after FLOW_TIMEOUT_MS without a pulse
+float flow_meter_rate_lpm(void);
+
+// Conversions at the current calibration
+uint32_t flow_meter_pulses_to_ml(uint32_t pulses);
+uint32_t flow_meter_ml_to_pulses(uint32_t ml);      // rounded up: the target is never short
+
+// Wake task (xTaskNotifyGive) once the count reaches target_count. One target per slot.
+void flow_meter_arm(size_t slot, uint32_t target_count, TaskHandle_t task);
+void flow_meter_disarm(size_t slot);
+void flow_meter_disarm_all(void);
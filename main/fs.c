@@ -1,9 +1,17 @@
 // fs.c
 #include "fs.h"
+#include "executor.h"
 #include "esp_spiffs.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 static const char *TAG = "fs";
 
@@ -68,4 +76,221 @@ esp_err_t fs_write_file(const char *path, const char *data, size_t len)
     size_t w = fwrite(data, 1, len, f);
     fclose(f);
     return (w == len) ? ESP_OK : ESP_FAIL;
-}
\ No newline at end of file
+}
+
+esp_err_t fs_write_filler(const char *path, size_t len)
+{
+    static char chunk[1024];
+    memset(chunk, 0xA5, sizeof(chunk));
+
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        return ESP_FAIL;
+    }
+
+    size_t written = 0;
+    while (written < len) {
+        size_t n = (len - written < sizeof(chunk)) ? len - written : sizeof(chunk);
+        if (fwrite(chunk, 1, n, f) != n) break;
+        written += n;
+    }
+    fclose(f);
+    return (written == len) ? ESP_OK : ESP_FAIL;
+}
+
+// ====================== SCHEDULED WRITES ======================
+#define FS_SECTOR_SIZE        4096
+#define FS_WRITE_BUDGET_US    25000   // expected worst sector erase + write
+#define FS_WRITE_GUARD_US     2000    // start this long after an event at the earliest
+#define FS_MAX_DEFER_MS       3000    // give up waiting for a window after this
+#define FS_WRITE_QUEUE_LEN    4
+
+typedef struct {
+    char  *path;
+    char  *data;        // NULL: remove path
+    size_t len;
+} FsWriteJob;
+
+static QueueHandle_t s_write_queue = NULL;
+static FsWriteStats s_write_stats = {0};
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Block until no output event is due within the expected flash op time.
+// Returns the esp_timer time of the next event (UINT64_MAX if none).
+static uint64_t wait_for_quiet_window(void)
+{
+    int64_t wait_start_us = esp_timer_get_time();
+    bool deferred = false;
+
+    while (1) {
+        uint64_t budget_us = FS_WRITE_BUDGET_US;
+        if (s_write_stats.worst_op_us > budget_us) budget_us = s_write_stats.worst_op_us;
+
+        uint64_t now_us = esp_timer_get_time();
+        uint64_t next_due_us = executor_next_due_us();
+        uint32_t waited_ms = (uint32_t)((now_us - wait_start_us) / 1000);
+
+        bool quiet = (next_due_us == UINT64_MAX) || (next_due_us > now_us + budget_us);
+        bool forced = !quiet && waited_ms >= FS_MAX_DEFER_MS;
+        if (quiet || forced) {
+            portENTER_CRITICAL(&s_stats_lock);
+            if (deferred) {
+                s_write_stats.deferred_ops++;
+                s_write_stats.total_defer_ms += waited_ms;
+            }
+            if (forced) s_write_stats.forced_ops++;
+            portEXIT_CRITICAL(&s_stats_lock);
+            return next_due_us;
+        }
+
+        // sleep until just past the upcoming event, then look again
+        deferred = true;
+        uint64_t sleep_us = (next_due_us > now_us ? next_due_us - now_us : 0) + FS_WRITE_GUARD_US;
+        TickType_t ticks = pdMS_TO_TICKS((sleep_us + 999) / 1000);
+        vTaskDelay(ticks ? ticks : 1);
+    }
+}
+
+// Account one flash op that started when next_due_us was the next event
+static void record_flash_op(uint64_t next_due_us, int64_t start_us)
+{
+    int64_t end_us = esp_timer_get_time();
+    uint32_t op_us = (uint32_t)(end_us - start_us);
+
+    portENTER_CRITICAL(&s_stats_lock);
+    s_write_stats.ops++;
+    if (op_us > s_write_stats.worst_op_us) s_write_stats.worst_op_us = op_us;
+    if (next_due_us != UINT64_MAX && next_due_us <= (uint64_t)end_us) s_write_stats.conflicts++;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+static esp_err_t write_job(const FsWriteJob *job)
+{
+    uint64_t next_due_us = wait_for_quiet_window();
+    int64_t start_us = esp_timer_get_time();
+    if (!job->data) {
+        int r = unlink(job->path);
+        record_flash_op(next_due_us, start_us);
+        return (r == 0) ? ESP_OK : ESP_FAIL;
+    }
+
+    int fd = open(job->path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    record_flash_op(next_due_us, start_us);
+    if (fd < 0) {
+        return ESP_FAIL;
+    }
+
+    size_t written = 0;
+    while (written < job->len) {
+        size_t n = job->len - written;
+        if (n > FS_SECTOR_SIZE) n = FS_SECTOR_SIZE;
+
+        next_due_us = wait_for_quiet_window();
+        start_us = esp_timer_get_time();
+        ssize_t w = write(fd, job->data + written, n);
+        record_flash_op(next_due_us, start_us);
+        if (w != (ssize_t)n) break;
+        written += n;
+    }
+
+    // SPIFFS flushes its cache on close, so that is a flash op too
+    next_due_us = wait_for_quiet_window();
+    start_us = esp_timer_get_time();
+    close(fd);
+    record_flash_op(next_due_us, start_us);
+
+    portENTER_CRITICAL(&s_stats_lock);
+    s_write_stats.bytes += written;
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    return (written == job->len) ? ESP_OK : ESP_FAIL;
+}
+
+static void fs_writer_task(void *arg)
+{
+    FsWriteJob job;
+    while (1) {
+        if (xQueueReceive(s_write_queue, &job, portMAX_DELAY) != pdTRUE) continue;
+
+        esp_err_t err = write_job(&job);
+
+        portENTER_CRITICAL(&s_stats_lock);
+        if (err == ESP_OK) s_write_stats.jobs++; else s_write_stats.failed_jobs++;
+        portEXIT_CRITICAL(&s_stats_lock);
+
+        if (err == ESP_OK) {
+            ESP_LOGI(TAG, "Scheduled %s done: %s (%zu bytes)", job.data ? "write" : "remove", job.path, job.len);
+        } else {
+            ESP_LOGE(TAG, "Scheduled %s failed: %s", job.data ? "write" : "remove", job.path);
+        }
+        free(job.path);
+        free(job.data);
+    }
+}
+
+esp_err_t fs_start_write_scheduler(void)
+{
+    if (s_write_queue) return ESP_OK;
+
+    s_write_queue = xQueueCreate(FS_WRITE_QUEUE_LEN, sizeof(FsWriteJob));
+    if (!s_write_queue) {
+        ESP_LOGE(TAG, "Failed to create write queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // priority 1, below the cycle runner (2): flash work only ever fills gaps
+    // and never preempts the runner while it plans the next phase
+    if (xTaskCreate(fs_writer_task, "fs_writer", 3072, NULL, 1, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create writer task");
+        vQueueDelete(s_write_queue);
+        s_write_queue = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t fs_write_file_scheduled(const char *path, char *data, size_t len)
+{
+    if (!s_write_queue) {
+        esp_err_t err = fs_write_file(path, data, len);
+        free(data);
+        return err;
+    }
+
+    FsWriteJob job = { .path = strdup(path), .data = data, .len = len };
+    if (!job.path || xQueueSend(s_write_queue, &job, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Write queue full, dropping write to %s", path);
+        portENTER_CRITICAL(&s_stats_lock);
+        s_write_stats.dropped_jobs++;
+        portEXIT_CRITICAL(&s_stats_lock);
+        free(job.path);
+        free(data);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t fs_remove_file_scheduled(const char *path)
+{
+    if (!s_write_queue) {
+        return (unlink(path) == 0) ? ESP_OK : ESP_FAIL;
+    }
+
+    FsWriteJob job = { .path = strdup(path), .data = NULL, .len = 0 };
+    if (!job.path || xQueueSend(s_write_queue, &job, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Write queue full, dropping remove of %s", path);
+        portENTER_CRITICAL(&s_stats_lock);
+        s_write_stats.dropped_jobs++;
+        portEXIT_CRITICAL(&s_stats_lock);
+        free(job.path);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void fs_get_write_stats(FsWriteStats *out)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    *out = s_write_stats;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
@@ -9,4 +9,35 @@ esp_err_t fs_init_spiffs(void);
 // read an entire file into a heap buffer
 // remember to free() the returned pointer
 char *fs_read_file(const char *path);
-esp_err_t fs_write_file(const char *path, const char *data, size_t len);
\ No newline at end of file
+esp_err_t fs_write_file(const char *path, const char *data, size_t len);
+
+// Scheduled writes: a background writer performs flash operations (open,
+// each 4 KB sector, close) only in quiet windows between executor events,
+// postponing them up to a limit so erases/writes don't land on an output edge.
+typedef struct {
+    uint32_t jobs;            // files written
+    uint32_t failed_jobs;     // open/write errors
+    uint32_t dropped_jobs;    // queue full
+    uint32_t bytes;
+    uint32_t ops;             // flash operations (open, sector writes, close)
+    uint32_t deferred_ops;    // ops that waited for a quiet window
+    uint32_t forced_ops;      // ops run without a window after FS_MAX_DEFER_MS
+    uint32_t conflicts;       // ops during which an output event fell due
+    uint32_t total_defer_ms;
+    uint32_t worst_op_us;     // slowest flash op seen (also the window size needed)
+} FsWriteStats;
+
+// start the background writer (after fs_init_spiffs)
+esp_err_t fs_start_write_scheduler(void);
+
+// queue a write; takes ownership of data (malloc'd) and frees it when done.
+// Falls back to fs_write_file() when the writer is not running.
+esp_err_t fs_write_file_scheduled(const char *path, char *data, size_t len);
+
+// queue a delete through the same writer (SPIFFS may erase on unlink)
+esp_err_t fs_remove_file_scheduled(const char *path);
+
+void fs_get_write_stats(FsWriteStats *out);
+
+// write len bytes of filler to path in 1 KB chunks (flash write load for timing tests)
+esp_err_t fs_write_filler(const char *path, size_t len);
\ No newline at end of file
@@ -0,0 +1,195 @@
+// imbalance.c
+#include "imbalance.h"
+#include <math.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "rpm_sensor.h"
+
+static const char *TAG = "imbalance";
+
+#define GOERTZEL_COEFF_SHIFT  14        // coefficients 2cos(w) in Q14
+#define STEADY_RATIO          2         // every interval within mean/2 .. 2*mean
+#define STOPPED_INTERVALS     4         // no pulse for this many mean intervals = stopped
+
+static SemaphoreHandle_t s_mutex = NULL;
+static uint32_t s_ppr_cfg = 0;          // 0 = follow the RPM sensor
+static ImbalanceResult s_result;
+static uint32_t s_analysed_count = 0;   // rpm_sensor_interval_count() at the last window
+
+// Work buffers (under s_mutex)
+static uint32_t s_intervals[IMBALANCE_WINDOW];
+static int32_t  s_x[IMBALANCE_WINDOW];
+static uint32_t s_coeff_ppr = 0;        // pulses per rev s_coeff was built for
+static int32_t  s_coeff[IMBALANCE_HARMONICS];
+static uint32_t s_harmonics = 0;        // below Nyquist for s_coeff_ppr
+
+static uint32_t effective_ppr(void)
+{
+    if (s_ppr_cfg) return s_ppr_cfg;
+    return (uint32_t)lroundf(rpm_sensor_get_pulses_per_rev());
+}
+
+static void build_coeffs(uint32_t ppr)
+{
+    s_coeff_ppr = ppr;
+    s_harmonics = 0;
+    for (uint32_t h = 1; h <= IMBALANCE_HARMONICS && 2 * h < ppr; h++) {
+        float w = 2.0f * (float)M_PI * (float)h / (float)ppr;
+        s_coeff[h - 1] = (int32_t)lroundf(2.0f * cosf(w) * (1 << GOERTZEL_COEFF_SHIFT));
+        s_harmonics = h;
+    }
+}
+
+static uint32_t isqrt64(uint64_t v)
+{
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+    while (bit > v) bit >>= 2;
+    while (bit) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+// Normalise s_intervals[0..n) to Q15 deviation from their mean and run the
+// Goertzel recurrences for every harmonic in one pass. Returns false when the
+// window is not steady (a pause, a glitch or a speed step inside it).
+static bool analyse(uint32_t n, ImbalanceResult *r)
+{
+    uint64_t sum = 0;
+    uint32_t lo = UINT32_MAX, hi = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t v = s_intervals[i];
+        sum += v;
+        if (v < lo) lo = v;
+        if (v > hi) hi = v;
+    }
+    uint32_t mean = (uint32_t)(sum / n);
+    if (mean == 0 || hi > mean * STEADY_RATIO || lo < mean / STEADY_RATIO) return false;
+
+    // x = (v - mean) / mean in Q15, with one division for the whole window
+    uint32_t inv = (uint32_t)((1ULL << 31) / mean);
+    for (uint32_t i = 0; i < n; i++) {
+        int32_t x = (int32_t)(((int64_t)((int32_t)(s_intervals[i] - mean)) * inv) >> 16);
+        s_x[i] = (x > INT16_MAX) ? INT16_MAX : (x < -INT16_MAX) ? -INT16_MAX : x;
+    }
+
+    int32_t s1[IMBALANCE_HARMONICS] = {0}, s2[IMBALANCE_HARMONICS] = {0};
+    for (uint32_t i = 0; i < n; i++) {
+        int32_t x = s_x[i];
+        for (uint32_t h = 0; h < s_harmonics; h++) {
+            int32_t s0 = x + (int32_t)(((int64_t)s_coeff[h] * s1[h]) >> GOERTZEL_COEFF_SHIFT) - s2[h];
+            s2[h] = s1[h];
+            s1[h] = s0;
+        }
+    }
+
+    memset(r->ripple_pm, 0, sizeof(r->ripple_pm));
+    for (uint32_t h = 0; h < s_harmonics; h++) {
+        int64_t p = (int64_t)s1[h] * s1[h] + (int64_t)s2[h] * s2[h] -
+                    (((int64_t)s_coeff[h] * s1[h]) >> GOERTZEL_COEFF_SHIFT) * s2[h];
+        // sinusoid amplitude = 2|X| / n (Q15) -> per-mille
+        uint32_t amp_q15 = (uint32_t)(2ULL * isqrt64(p > 0 ? (uint64_t)p : 0) / n);
+        uint32_t pm = (amp_q15 * 1000u) >> 15;
+        r->ripple_pm[h] = (pm > UINT16_MAX) ? UINT16_MAX : (uint16_t)pm;
+    }
+    r->imbalance_pm = r->ripple_pm[0];
+    r->mean_interval_us = mean;
+    r->rpm = 60e6f / ((float)mean * (float)s_coeff_ppr);
+    return true;
+}
+
+static void update_locked(void)
+{
+    uint32_t ppr = effective_ppr();
+    int64_t now_us = esp_timer_get_time();
+
+    // Stopped since the last window?
+    uint64_t pulse_us;
+    uint32_t period_us;
+    rpm_sensor_last_pulse(&pulse_us, &period_us);
+    if (s_result.valid &&
+        (uint64_t)now_us - pulse_us > (uint64_t)s_result.mean_interval_us * STOPPED_INTERVALS) {
+        s_result.valid = false;
+    }
+
+    s_result.pulses_per_rev = ppr;
+    if (ppr < IMBALANCE_MIN_PPR || ppr > IMBALANCE_MAX_PPR) {
+        s_result.valid = false;
+        return;
+    }
+    if (ppr != s_coeff_ppr) {
+        build_coeffs(ppr);
+        s_result.valid = false;
+        s_analysed_count = 0;
+    }
+
+    uint32_t n = (IMBALANCE_WINDOW / ppr) * ppr;
+    uint32_t count = rpm_sensor_interval_count();
+    if (count < s_analysed_count) s_analysed_count = 0;      // sensor was reset
+    if (count - s_analysed_count < n / 2 && s_analysed_count) return;
+    if (rpm_sensor_read_intervals(s_intervals, n) < n) return;
+    if ((uint64_t)now_us - pulse_us > (uint64_t)s_intervals[n - 1] * STOPPED_INTERVALS) return;
+    s_analysed_count = count;
+
+    uint32_t c0 = esp_cpu_get_cycle_count();
+    bool ok = analyse(n, &s_result);
+    uint32_t cycles = esp_cpu_get_cycle_count() - c0;
+
+    uint32_t ticks_per_us = esp_rom_get_cpu_ticks_per_us();
+    s_result.last_ns = (uint32_t)((uint64_t)cycles * 1000 / (ticks_per_us ? ticks_per_us : 1));
+    if (s_result.last_ns > s_result.max_ns) s_result.max_ns = s_result.last_ns;
+    s_result.windows++;
+    s_result.valid = ok;
+    s_result.samples = n;
+    s_result.time_us = now_us;
+}
+
+esp_err_t imbalance_init(void)
+{
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex) return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Ripple analysis: %d-interval windows, %d harmonics", IMBALANCE_WINDOW, IMBALANCE_HARMONICS);
+    return ESP_OK;
+}
+
+esp_err_t imbalance_set_pulses_per_rev(uint32_t ppr)
+{
+    if (ppr && (ppr < IMBALANCE_MIN_PPR || ppr > IMBALANCE_MAX_PPR)) return ESP_ERR_INVALID_ARG;
+    if (!s_mutex) return ESP_ERR_INVALID_STATE;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_ppr_cfg = ppr;
+    xSemaphoreGive(s_mutex);
+    return ESP_OK;
+}
+
+uint32_t imbalance_get_pulses_per_rev(void)
+{
+    return s_ppr_cfg;
+}
+
+void imbalance_get(ImbalanceResult *out)
+{
+    if (!s_mutex) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    update_locked();
+    *out = s_result;
+    xSemaphoreGive(s_mutex);
+}
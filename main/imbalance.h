@@ -0,0 +1,49 @@
+// imbalance.h
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Spin imbalance from tach ripple. An out-of-balance load speeds the drum up
+// and slows it down once per revolution, so the pulse intervals captured by
+// the RPM ISR carry a ripple at the rotation frequency (the load's shape adds
+// harmonics). Each interval is one sample in the angle domain: with P pulses
+// per drum revolution the h-th harmonic sits at h/P cycles per sample at any
+// speed. A window takes whole revolutions (at most IMBALANCE_WINDOW
+// intervals), so every line falls exactly on its bin. The intervals are
+// normalised to Q15 relative deviation and fed to one fixed-point Goertzel
+// per harmonic: integer only, because the C3 has no FPU.
+//
+// The 1x line needs P >= IMBALANCE_MIN_PPR (below Nyquist); harmonics at or
+// above P/2 are reported as 0.
+
+#define IMBALANCE_WINDOW         128     // max intervals per window
+#define IMBALANCE_HARMONICS      3
+#define IMBALANCE_MIN_PPR        3
+#define IMBALANCE_MAX_PPR        64      // at least two revolutions per window
+
+typedef struct {
+    bool     valid;                 // a steady window at the current speed was analysed
+    uint32_t pulses_per_rev;        // in use
+    uint32_t samples;               // intervals in the window (whole revolutions)
+    uint32_t mean_interval_us;
+    float    rpm;                   // drum speed over the window
+    uint16_t ripple_pm[IMBALANCE_HARMONICS];    // amplitude per harmonic, per-mille of mean speed
+    uint16_t imbalance_pm;          // the 1x line: ripple_pm[0]
+    int64_t  time_us;               // when the window was analysed
+    uint32_t windows;               // analysed since boot
+    uint32_t last_ns;               // CPU time of the last window
+    uint32_t max_ns;
+} ImbalanceResult;
+
+esp_err_t imbalance_init(void);
+
+// Pulses per drum revolution for the analysis; 0 = the RPM sensor's setting
+// (rounded). ESP_ERR_INVALID_ARG outside IMBALANCE_MIN_PPR..IMBALANCE_MAX_PPR.
+esp_err_t imbalance_set_pulses_per_rev(uint32_t ppr);
+uint32_t imbalance_get_pulses_per_rev(void);
+
+// Latest result. A new window is analysed first once half a window of new
+// intervals has arrived; valid drops as soon as the tach stops. Any task.
+void imbalance_get(ImbalanceResult *out);
@@ -10,8 +10,14 @@
 #include "wifi_sta.h"
 #include "ws_cycle.h"
 #include "telemetry.h"
+#include "sysmon.h"
+#include "power.h"
+#include "serial_telemetry.h"
 #include "rpm_sensor.h"
 #include "pressure_sensor.h"
+#include "actuator.h"
+#include "imbalance.h"
+#include "flow_meter.h"
 
 
 static const char *TAG = "main";
@@ -61,23 +67,46 @@ void app_main(void)
     // 1) hardware ready
     init_all_gpio();
 
+    // 1b) tickless idle + light sleep while idle (outputs keep their level)
+    power_init();
+
     // 2) initialize RPM sensor (GPIO 0 with rising-edge detection)
     rpm_sensor_init();
 
+    // 2b) spin imbalance from the tach pulse intervals
+    imbalance_init();
+
+    // 2c) flow meter (GPIO 6) for metered fills
+    if (flow_meter_init() != ESP_OK) {
+        ESP_LOGW(TAG, "Flow meter init failed - Volume triggers will not fire");
+    }
+
     // 3) initialize pressure sensor (HX711 on GPIO 2/3)
     pressure_sensor_init();
+
+    // 3b) measured actuator latencies (NVS), used by the timeline builder
+    actuator_init();
     
 
     // 4) start telemetry system (gathers GPIO, sensors, cycle info)
     telemetry_init(1000);  // update every 1000ms (increased from 100ms to reduce heap fragmentation)
 
+    // 4a) runtime stats (per-task CPU / stack), published on request over WS
+    sysmon_init();
+
     // 4b) register telemetry callback for WebSocket broadcast (will be activated after ws_cycle_start)
     ws_register_telemetry_callback();
 
+    // 4c) binary telemetry on the USB-Serial-JTAG console, off until the host sends "ct start"
+    serial_telemetry_init();
+
     // 5) mount SPIFFS
     if (fs_init_spiffs() != ESP_OK) {
         ESP_LOGE(TAG, "SPIFFS init failed");
         // we can still continue for websocket-only testing
+    } else {
+        // flash writes go through the writer so they land between output events
+        fs_start_write_scheduler();
     }
 
     // 6) try to load existing cycle.json, but DO NOT run it yet
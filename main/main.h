@@ -10,6 +10,6 @@
 #define SOFT_VALVE_PIN       GPIO_NUM_18
 #define MOTOR_ON_PIN         GPIO_NUM_4
 #define MOTOR_DIRECTION_PIN  GPIO_NUM_10
-#define FLOW_SENSOR_PIN      GPIO_NUM_0
+#define FLOW_SENSOR_PIN      GPIO_NUM_6   // GPIO 0 is the RPM sensor
 
 void init_all_gpio(void);
\ No newline at end of file
@@ -0,0 +1,322 @@
+// motor_mon.c
+#include "motor_mon.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#include "freertos/FreeRTOS.h"
+#include "cycle.h"          // MOTOR_ON_PIN, MOTOR_DIRECTION_PIN
+#include "executor.h"       // edge log, output levels, executor_trip_fault()
+#include "rpm_sensor.h"     // raw tach pulse times
+#include "actuator.h"       // measured motor latencies for the default windows
+
+static const char *TAG = "motor_mon";
+
+#define MOTOR_ON_BIT      (1UL << MOTOR_ON_PIN)
+#define MOTOR_DIR_BIT     (1UL << MOTOR_DIRECTION_PIN)
+#define EDGES_PER_CHECK   8
+
+static const char *const s_fault_names[MOTOR_FAULT_COUNT] = {
+    [MOTOR_FAULT_NONE]    = "none",
+    [MOTOR_FAULT_NO_SPIN] = "no_spin",
+    [MOTOR_FAULT_RUN_ON]  = "run_on",
+    [MOTOR_FAULT_STALL]   = "stall",
+};
+
+static esp_timer_handle_t s_timer = NULL;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static MotorMonConfig s_cfg = { .mode = MOTOR_MON_ALARM };
+static MotorMonStats s_stats;               // guarded by s_lock
+
+// Check state: written by motor_mon_start() before the timer runs, then by the timer only
+static MotorMonMode s_run_mode = MOTOR_MON_OFF;
+static uint32_t s_edge_cursor = 0;
+static bool     s_motor_on = false;
+static int64_t  s_on_since_us = 0;          // last motor ON edge
+static int64_t  s_off_since_us = 0;         // last motor OFF edge, 0 = not run yet this cycle
+static int64_t  s_dir_since_us = 0;         // last direction change
+static int64_t  s_start_window_us = 0;
+static int64_t  s_stop_window_us = 0;
+static int64_t  s_stall_min_us = 0;
+static int64_t  s_reported_us[MOTOR_FAULT_COUNT];   // window expiry of the last report per fault
+static uint64_t s_cost_cycles = 0;          // sum over this cycle's checks (s_lock)
+static uint32_t s_cost_max_cycles = 0;
+
+// ------------------------- EDGE TRACKING -------------------------
+static void follow_edge(const ExecutorEdge *e)
+{
+    if (e->changed & MOTOR_ON_BIT) {
+        s_motor_on = !(e->levels & MOTOR_ON_BIT);     // active-low
+        if (s_motor_on) {
+            s_on_since_us = e->time_us;
+        } else {
+            s_off_since_us = e->time_us;
+        }
+    }
+    if (e->changed & MOTOR_DIR_BIT) {
+        s_dir_since_us = e->time_us;
+    }
+}
+
+// Edges were overwritten before we read them: take the state from the outputs
+// and restart every window from now, so a lost edge never raises a fault.
+static void resync(int64_t now_us)
+{
+    s_motor_on = !(executor_output_levels() & MOTOR_ON_BIT);
+    s_on_since_us = now_us;
+    s_dir_since_us = now_us;
+    if (!s_motor_on) s_off_since_us = now_us;
+}
+
+// ------------------------- WINDOWS -------------------------
+// Returns the fault whose window has expired (and *expired_us when it did), or NONE
+static MotorFault evaluate(int64_t now_us, int64_t *expired_us)
+{
+    uint64_t pulse;
+    uint32_t period_us;
+    rpm_sensor_last_pulse(&pulse, &period_us);
+    int64_t pulse_us = (int64_t)pulse;
+
+    if (s_motor_on) {
+        if (pulse_us <= s_on_since_us) {
+            *expired_us = s_on_since_us + s_start_window_us;
+            return (now_us > *expired_us) ? MOTOR_FAULT_NO_SPIN : MOTOR_FAULT_NONE;
+        }
+
+        // Speed changes freely within a start window of ON or a direction change
+        int64_t settled_us = ((s_on_since_us > s_dir_since_us) ? s_on_since_us : s_dir_since_us) + s_start_window_us;
+        if (now_us <= settled_us) return MOTOR_FAULT_NONE;
+
+        // Next pulse overdue; the gap never exceeds a start window so a slow
+        // run-up period cannot push detection out indefinitely
+        int64_t gap_us = (int64_t)period_us * MOTOR_MON_STALL_FACTOR;
+        if (gap_us < s_stall_min_us) gap_us = s_stall_min_us;
+        if (gap_us > s_start_window_us || period_us == 0) gap_us = s_start_window_us;
+        *expired_us = pulse_us + gap_us;
+        if (*expired_us < settled_us) *expired_us = settled_us;
+        return (now_us > *expired_us) ? MOTOR_FAULT_STALL : MOTOR_FAULT_NONE;
+    }
+
+    // Motor OFF: still pulsing after the stop window is only a fault while the
+    // drum holds its speed; coasting down, the period keeps lengthening
+    if (!s_off_since_us || !period_us) return MOTOR_FAULT_NONE;
+    int64_t stop_by_us = s_off_since_us + s_stop_window_us;
+    if (pulse_us - (int64_t)period_us <= stop_by_us) return MOTOR_FAULT_NONE;
+
+    uint32_t iv[MOTOR_MON_RUN_ON_SPAN];
+    if (rpm_sensor_read_intervals(iv, MOTOR_MON_RUN_ON_SPAN) < MOTOR_MON_RUN_ON_SPAN ||
+        iv[MOTOR_MON_RUN_ON_SPAN - 1] != period_us) {
+        return MOTOR_FAULT_NONE;        // too few, or a pulse landed in between: next check
+    }
+    int64_t first_us = pulse_us;
+    for (int i = 0; i < MOTOR_MON_RUN_ON_SPAN; i++) {
+        first_us -= iv[i];
+    }
+    if (first_us <= stop_by_us || iv[MOTOR_MON_RUN_ON_SPAN - 1] > iv[0]) return MOTOR_FAULT_NONE;
+
+    *expired_us = stop_by_us;
+    return MOTOR_FAULT_RUN_ON;
+}
+
+static void motor_mon_check(void *arg)
+{
+    uint32_t c0 = esp_cpu_get_cycle_count();
+    int64_t now_us = esp_timer_get_time();
+
+    ExecutorEdge edges[EDGES_PER_CHECK];
+    uint32_t lost = 0, lost_total = 0;
+    size_t n;
+    do {
+        n = executor_read_edges(&s_edge_cursor, edges, EDGES_PER_CHECK, &lost);
+        lost_total += lost;
+        for (size_t i = 0; i < n; i++) {
+            follow_edge(&edges[i]);
+        }
+    } while (n == EDGES_PER_CHECK);
+    if (lost_total) resync(now_us);
+
+    // Abort mode stops at the first fault; alarm mode keeps checking and
+    // reports each expired window once
+    MotorFault fault = MOTOR_FAULT_NONE;
+    int64_t expired_us = now_us;
+    if (s_run_mode != MOTOR_MON_ABORT || s_stats.fault == MOTOR_FAULT_NONE) {
+        fault = evaluate(now_us, &expired_us);
+    }
+    if (fault != MOTOR_FAULT_NONE) {
+        if (s_reported_us[fault] == expired_us) {
+            fault = MOTOR_FAULT_NONE;
+        } else {
+            s_reported_us[fault] = expired_us;
+        }
+    }
+    if (fault != MOTOR_FAULT_NONE && s_run_mode == MOTOR_MON_ABORT) {
+        executor_trip_fault();
+    }
+
+    uint32_t cost = esp_cpu_get_cycle_count() - c0;
+
+    portENTER_CRITICAL(&s_lock);
+    s_cost_cycles += cost;
+    if (cost > s_cost_max_cycles) s_cost_max_cycles = cost;
+    s_stats.checks++;
+    s_stats.edges_lost += lost_total;
+    if (fault != MOTOR_FAULT_NONE) {
+        if (s_stats.fault == MOTOR_FAULT_NONE) {
+            s_stats.fault = fault;
+            s_stats.fault_us = now_us;
+            s_stats.fault_late_us = (uint32_t)(now_us - expired_us);
+        }
+        s_stats.last_fault = fault;
+        s_stats.cycle_faults++;
+        s_stats.faults[fault]++;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (fault != MOTOR_FAULT_NONE) {
+        ESP_LOGE(TAG, "Motor fault: %s, detected %lu us after its window%s",
+                 s_fault_names[fault], (unsigned long)(now_us - expired_us),
+                 (s_run_mode == MOTOR_MON_ABORT) ? " - outputs OFF" : "");
+    }
+}
+
+// ------------------------- PUBLIC API -------------------------
+static bool window_ok(uint32_t ms)
+{
+    return ms == 0 || (ms >= MOTOR_MON_MIN_WINDOW_MS && ms <= MOTOR_MON_MAX_WINDOW_MS);
+}
+
+esp_err_t motor_mon_configure(const MotorMonConfig *cfg)
+{
+    if (!cfg || cfg->mode > MOTOR_MON_ABORT || !window_ok(cfg->start_window_ms) ||
+        !window_ok(cfg->stop_window_ms) || !window_ok(cfg->stall_min_ms)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&s_lock);
+    s_cfg = *cfg;
+    portEXIT_CRITICAL(&s_lock);
+    return ESP_OK;
+}
+
+void motor_mon_get_config(MotorMonConfig *out)
+{
+    portENTER_CRITICAL(&s_lock);
+    *out = s_cfg;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+// Configured window, else twice the measured latency, else the default
+static uint32_t window_ms(uint32_t configured, bool measured, uint16_t latency_ms, uint32_t def)
+{
+    if (configured) return configured;
+    if (!measured) return def;
+    uint32_t ms = 2u * latency_ms;
+    if (ms < MOTOR_MON_MIN_WINDOW_MS) ms = MOTOR_MON_MIN_WINDOW_MS;
+    return ms;
+}
+
+void motor_mon_start(void)
+{
+    motor_mon_stop();
+
+    MotorMonConfig cfg;
+    motor_mon_get_config(&cfg);
+    ActuatorLatency lat = actuator_latency(ACTUATOR_MOTOR);
+    uint32_t start_ms = window_ms(cfg.start_window_ms, lat.valid, lat.on_ms, MOTOR_MON_DEFAULT_START_MS);
+    uint32_t stop_ms = window_ms(cfg.stop_window_ms, lat.valid, lat.off_ms, MOTOR_MON_DEFAULT_STOP_MS);
+
+    ExecutorEdge skip[EDGES_PER_CHECK];
+    while (executor_read_edges(&s_edge_cursor, skip, EDGES_PER_CHECK, NULL) == EDGES_PER_CHECK) {}
+
+    int64_t now_us = esp_timer_get_time();
+    s_run_mode = cfg.mode;
+    s_motor_on = !(executor_output_levels() & MOTOR_ON_BIT);
+    s_on_since_us = now_us;
+    s_dir_since_us = now_us;
+    s_off_since_us = 0;
+    s_start_window_us = (int64_t)start_ms * 1000;
+    s_stop_window_us = (int64_t)stop_ms * 1000;
+    s_stall_min_us = (int64_t)(cfg.stall_min_ms ? cfg.stall_min_ms : MOTOR_MON_DEFAULT_STALL_MS) * 1000;
+    memset(s_reported_us, 0, sizeof(s_reported_us));
+
+    portENTER_CRITICAL(&s_lock);
+    s_cost_cycles = 0;
+    s_cost_max_cycles = 0;
+    s_stats.start_window_ms = start_ms;
+    s_stats.stop_window_ms = stop_ms;
+    s_stats.fault = MOTOR_FAULT_NONE;
+    s_stats.fault_us = 0;
+    s_stats.fault_late_us = 0;
+    s_stats.last_fault = MOTOR_FAULT_NONE;
+    s_stats.cycle_faults = 0;
+    s_stats.checks = 0;
+    s_stats.edges_lost = 0;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (cfg.mode == MOTOR_MON_OFF) return;
+
+    if (!s_timer) {
+        const esp_timer_create_args_t args = {
+            .callback = motor_mon_check,
+            .arg = NULL,
+            .name = "motor_mon"
+        };
+        if (esp_timer_create(&args, &s_timer) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to create check timer - motor monitor disabled");
+            return;
+        }
+    }
+    esp_timer_start_periodic(s_timer, MOTOR_MON_PERIOD_US);
+
+    portENTER_CRITICAL(&s_lock);
+    s_stats.active = true;
+    portEXIT_CRITICAL(&s_lock);
+    ESP_LOGI(TAG, "Monitoring (%s): start window %lu ms, stop window %lu ms%s", motor_mon_mode_name(cfg.mode),
+             (unsigned long)start_ms, (unsigned long)stop_ms, lat.valid ? " (measured)" : "");
+}
+
+void motor_mon_stop(void)
+{
+    if (s_timer && esp_timer_is_active(s_timer)) {
+        esp_timer_stop(s_timer);
+    }
+    portENTER_CRITICAL(&s_lock);
+    s_stats.active = false;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+MotorFault motor_mon_fault(void)
+{
+    return s_stats.fault;
+}
+
+void motor_mon_stats(MotorMonStats *out)
+{
+    uint32_t ticks_per_us = esp_rom_get_cpu_ticks_per_us();
+
+    portENTER_CRITICAL(&s_lock);
+    *out = s_stats;
+    out->cfg = s_cfg;
+    uint64_t sum = s_cost_cycles;
+    uint32_t max = s_cost_max_cycles;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (ticks_per_us == 0) ticks_per_us = 1;
+    out->avg_ns = out->checks ? (uint32_t)(sum * 1000 / ticks_per_us / out->checks) : 0;
+    out->max_ns = (uint32_t)((uint64_t)max * 1000 / ticks_per_us);
+}
+
+const char *motor_mon_fault_name(MotorFault fault)
+{
+    return (fault >= 0 && fault < MOTOR_FAULT_COUNT) ? s_fault_names[fault] : "unknown";
+}
+
+const char *motor_mon_mode_name(MotorMonMode mode)
+{
+    switch (mode) {
+        case MOTOR_MON_OFF:   return "off";
+        case MOTOR_MON_ALARM: return "alarm";
+        case MOTOR_MON_ABORT: return "abort";
+        default:              return "unknown";
+    }
+}
@@ -0,0 +1,90 @@
+// motor_mon.h
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Motor/tach fault detector. While a cycle runs, a MOTOR_MON_PERIOD_US
+// esp_timer check follows the motor ON and direction edges from the executor
+// edge log and the raw tach pulse times from the RPM ISR, and compares them
+// against expected-response windows:
+//   NO_SPIN - motor ON, no tach pulse within start_window_ms
+//   RUN_ON  - motor OFF, still pulsing after stop_window_ms and not slowing
+//             down: the newest of the last MOTOR_MON_RUN_ON_SPAN intervals
+//             (all after the window) is no longer than the oldest. A drum
+//             coasting down from a spin decelerates, so its period keeps
+//             lengthening however long the coast-down takes.
+//   STALL   - motor ON and turning, the next pulse is overdue by
+//             MOTOR_MON_STALL_FACTOR periods (at least stall_min_ms) with no
+//             direction change commanded in the last start window. A single
+//             tach channel cannot see direction, so an unexpected reversal
+//             shows up here as the pulses stopping through zero speed.
+// Detection happens at most one check period after a window expires. In
+// abort mode the first fault drives the executor's safe state (every output
+// OFF, cycle stopped). In alarm mode every fault is reported, once per
+// expired window, and checking goes on for the rest of the cycle.
+
+#define MOTOR_MON_PERIOD_US           5000
+#define MOTOR_MON_STALL_FACTOR        3
+#define MOTOR_MON_RUN_ON_SPAN         3       // tach intervals compared for run-on
+#define MOTOR_MON_DEFAULT_START_MS    1500    // no measured motor latency
+#define MOTOR_MON_DEFAULT_STOP_MS     6000
+#define MOTOR_MON_DEFAULT_STALL_MS    150
+#define MOTOR_MON_MIN_WINDOW_MS       100
+#define MOTOR_MON_MAX_WINDOW_MS       60000
+
+typedef enum {
+    MOTOR_MON_OFF,
+    MOTOR_MON_ALARM,            // report only
+    MOTOR_MON_ABORT,            // report and force the safe state
+} MotorMonMode;
+
+typedef enum {
+    MOTOR_FAULT_NONE,
+    MOTOR_FAULT_NO_SPIN,
+    MOTOR_FAULT_RUN_ON,
+    MOTOR_FAULT_STALL,
+    MOTOR_FAULT_COUNT
+} MotorFault;
+
+// Windows of 0 = derived at cycle start: twice the measured motor on/off
+// latency (actuator self-test), else the defaults above
+typedef struct {
+    MotorMonMode mode;
+    uint32_t start_window_ms;
+    uint32_t stop_window_ms;
+    uint32_t stall_min_ms;
+} MotorMonConfig;
+
+typedef struct {
+    MotorMonConfig cfg;
+    bool       active;              // checking (cycle running, mode not off)
+    uint32_t   start_window_ms;     // in effect for the current/last cycle
+    uint32_t   stop_window_ms;
+    MotorFault fault;               // first fault of the current/last cycle
+    int64_t    fault_us;            // esp_timer time it was detected
+    uint32_t   fault_late_us;       // detection - window expiry
+    MotorFault last_fault;          // latest fault of the current/last cycle
+    uint32_t   cycle_faults;        // faults reported in the current/last cycle
+    uint32_t   faults[MOTOR_FAULT_COUNT];   // since boot
+    uint32_t   checks;              // current/last cycle
+    uint32_t   avg_ns;              // CPU time per check
+    uint32_t   max_ns;
+    uint32_t   edges_lost;          // edge log overruns (state resynced from the outputs)
+} MotorMonStats;
+
+// Reject out-of-range windows or an unknown mode with ESP_ERR_INVALID_ARG
+esp_err_t motor_mon_configure(const MotorMonConfig *cfg);
+void motor_mon_get_config(MotorMonConfig *out);
+
+// Cycle task: bracket the cycle (after executor_start / before executor_stop)
+void motor_mon_start(void);
+void motor_mon_stop(void);
+
+// First fault of the current/last cycle (MOTOR_FAULT_NONE if none)
+MotorFault motor_mon_fault(void);
+void motor_mon_stats(MotorMonStats *out);
+
+const char *motor_mon_fault_name(MotorFault fault);
+const char *motor_mon_mode_name(MotorMonMode mode);
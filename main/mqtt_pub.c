@@ -0,0 +1,782 @@
+// mqtt_pub.c
+#include "mqtt_pub.h"
+#include "fs.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "mqtt_client.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "mqtt_pub";
+
+#define SEGMENT_DIR          "/spiffs"
+#define SEGMENT_PATH_FMT     SEGMENT_DIR "/mq_%lu.txt"
+#define SEGMENT_MISSING_MS   15000   // a segment not on flash by then was lost (writer queue full)
+#define RATE_WINDOW_MS       10000
+#define EVENT_QUEUE_LEN      32
+
+typedef enum {
+    TOPIC_TELEMETRY,
+    TOPIC_PHASE,
+    TOPIC_COUNT
+} MqTopic;
+
+static const char *s_topic_names[TOPIC_COUNT] = { "telemetry", "phase" };
+
+typedef enum {
+    ENTRY_QUEUED,
+    ENTRY_SENT,         // published, waiting for the broker's ack
+    ENTRY_ACKED         // acked out of order, released once it reaches the head
+} EntryState;
+
+typedef struct {
+    uint32_t   id;
+    uint16_t   off;     // payload offset in s_arena
+    uint16_t   len;
+    uint8_t    topic;   // MqTopic
+    uint8_t    state;   // EntryState
+    int        msg_id;
+} MqEntry;
+
+// MQTT client events are handed to the publisher task, so queue state is only
+// changed there and in the producer, never from the client's own task
+typedef struct {
+    int32_t id;         // esp_mqtt_event_id_t
+    int     msg_id;
+} MqEvent;
+
+// RAM queue: entries in order, payloads packed into a byte ring (s_lock)
+static uint8_t s_arena[MQTT_PUB_RAM_BYTES];
+static MqEntry s_q[MQTT_PUB_QUEUE_LEN];
+static size_t s_q_head = 0;
+static size_t s_q_count = 0;
+static uint32_t s_next_entry_id = 0;
+
+// Flash spill segments s_seg_first .. s_seg_next-1, oldest first (s_lock)
+static uint32_t s_seg_first = 0;
+static uint32_t s_seg_next = 0;
+static uint16_t s_seg_msgs[MQTT_PUB_MAX_SEGMENTS];     // messages per segment, 0 if unknown
+
+// Publisher task only
+static int s_replay_pending = -1;       // acks outstanding for segment s_seg_first, -1 when idle
+static int64_t s_seg_missing_since = 0;
+static uint32_t s_rate_published = 0;
+static int64_t s_rate_start_us = 0;
+
+static SemaphoreHandle_t s_lock = NULL;
+static QueueHandle_t s_events = NULL;
+static TaskHandle_t s_task = NULL;
+static esp_mqtt_client_handle_t s_client = NULL;
+static volatile bool s_running = false;
+static MqttPubStats s_stats = {0};
+
+static char s_device[13];
+static char s_topics[TOPIC_COUNT][64];
+static char s_status_topic[64];
+static uint32_t s_boot_id = 0;
+
+// Producer (telemetry task) state
+typedef struct {
+    bool     active;
+    uint32_t index;
+    char     name[32];
+    uint64_t start_ms;
+    uint32_t samples;
+    float    rpm_max;
+    float    rpm_sum;
+    float    p_min;
+    float    p_max;
+    uint32_t misses_at_start;
+} PhaseAcc;
+
+static char s_batch[MQTT_PUB_BATCH_BYTES - 192];   // samples; the rest is the message header
+static size_t s_batch_len = 0;
+static int s_batch_samples = 0;
+static int64_t s_batch_start_us = 0;
+static char s_pins_json[48];
+static PhaseAcc s_phase = {0};
+static uint32_t s_run = 0;
+static uint32_t s_msg_seq = 0;
+
+// ====================== RAM QUEUE (s_lock held) ======================
+
+static MqEntry *q_at(size_t i)
+{
+    return &s_q[(s_q_head + i) % MQTT_PUB_QUEUE_LEN];
+}
+
+static bool arena_alloc(size_t len, uint16_t *off)
+{
+    if (s_q_count == MQTT_PUB_QUEUE_LEN || len > sizeof(s_arena)) return false;
+    if (s_q_count == 0) {
+        *off = 0;
+        return true;
+    }
+
+    size_t first = q_at(0)->off;
+    const MqEntry *last = q_at(s_q_count - 1);
+    size_t end = last->off + last->len;
+    if (last->off >= first) {
+        // used [first, end): free space after it, then from the start
+        if (end + len <= sizeof(s_arena)) { *off = (uint16_t)end; return true; }
+        if (len <= first)                 { *off = 0; return true; }
+        return false;
+    }
+    // wrapped: free space is [end, first)
+    if (end + len <= first) { *off = (uint16_t)end; return true; }
+    return false;
+}
+
+static void q_pop_head(void)
+{
+    s_stats.queue_bytes -= q_at(0)->len;
+    s_q_head = (s_q_head + 1) % MQTT_PUB_QUEUE_LEN;
+    s_q_count--;
+    s_stats.queue_depth = s_q_count;
+}
+
+static MqEntry *q_find(uint32_t id)
+{
+    for (size_t i = 0; i < s_q_count; i++) {
+        if (q_at(i)->id == id) return q_at(i);
+    }
+    return NULL;
+}
+
+// ====================== PRODUCER ======================
+
+static void enqueue(MqTopic topic, const char *payload, size_t len)
+{
+    if (!s_lock || len == 0) return;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    uint16_t off;
+    bool ok = true;
+    while (!arena_alloc(len, &off)) {
+        // full: the oldest message that is not on the wire makes room
+        if (s_q_count == 0 || q_at(0)->state != ENTRY_QUEUED) {
+            ok = false;
+            break;
+        }
+        q_pop_head();
+        s_stats.dropped++;
+    }
+    if (ok) {
+        memcpy(&s_arena[off], payload, len);
+        MqEntry *e = q_at(s_q_count);
+        e->id = s_next_entry_id++;
+        e->off = off;
+        e->len = (uint16_t)len;
+        e->topic = topic;
+        e->state = ENTRY_QUEUED;
+        e->msg_id = -1;
+        s_q_count++;
+        s_stats.enqueued++;
+        s_stats.queue_depth = s_q_count;
+        s_stats.queue_bytes += len;
+        if (s_q_count > s_stats.max_queue_depth) s_stats.max_queue_depth = s_q_count;
+    } else {
+        s_stats.dropped++;
+    }
+    xSemaphoreGive(s_lock);
+
+    if (s_task) xTaskNotifyGive(s_task);
+}
+
+// Phase names go into JSON and the tab/newline separated spill files unescaped
+static void copy_name(char *dst, size_t cap, const char *src)
+{
+    size_t i = 0;
+    for (; src && src[i] && i + 1 < cap; i++) {
+        char c = src[i];
+        dst[i] = (c == '"' || c == '\\' || (unsigned char)c < 0x20) ? '_' : c;
+    }
+    dst[i] = '\0';
+}
+
+static void flush_batch(void)
+{
+    if (s_batch_samples == 0) return;
+
+    static char msg[MQTT_PUB_BATCH_BYTES];
+    int len = snprintf(msg, sizeof(msg),
+                       "{\"device\":\"%s\",\"boot\":%lu,\"seq\":%lu,\"pins\":[%s],\"samples\":[%.*s]}",
+                       s_device, (unsigned long)s_boot_id, (unsigned long)++s_msg_seq, s_pins_json,
+                       (int)s_batch_len, s_batch);
+    if (len > 0 && len < (int)sizeof(msg)) {
+        enqueue(TOPIC_TELEMETRY, msg, len);
+    }
+    s_batch_len = 0;
+    s_batch_samples = 0;
+}
+
+static void batch_add(const TelemetryPacket *packet)
+{
+    uint32_t out = 0;
+    for (int i = 0; i < packet->gpio.num_pins && i < MAX_GPIO_PINS; i++) {
+        if (packet->gpio.pins[i].state) out |= 1u << i;
+    }
+
+    char sample[128];
+    int n = snprintf(sample, sizeof(sample),
+                     "{\"t\":%llu,\"out\":%lu,\"rpm\":%.0f,\"p\":%.2f,\"ph\":%lu,\"el\":%lu}",
+                     (unsigned long long)packet->packet_timestamp_ms, (unsigned long)out,
+                     packet->sensors.rpm, packet->sensors.pressure_freq,
+                     (unsigned long)(packet->cycle.cycle_running ? packet->cycle.current_phase_index : 0),
+                     (unsigned long)packet->cycle.phase_elapsed_ms);
+    if (n <= 0 || n >= (int)sizeof(sample)) return;
+
+    if (s_batch_samples > 0 && s_batch_len + 1 + n > sizeof(s_batch)) flush_batch();
+
+    if (s_batch_samples == 0) {
+        s_batch_start_us = esp_timer_get_time();
+        size_t p = 0;
+        for (int i = 0; i < packet->gpio.num_pins && i < MAX_GPIO_PINS; i++) {
+            p += snprintf(s_pins_json + p, sizeof(s_pins_json) - p, "%s%u", i ? "," : "",
+                          packet->gpio.pins[i].pin_number);
+            if (p >= sizeof(s_pins_json)) break;
+        }
+    } else {
+        s_batch[s_batch_len++] = ',';
+    }
+    memcpy(s_batch + s_batch_len, sample, n);
+    s_batch_len += n;
+    s_batch_samples++;
+
+    if (s_batch_samples >= MQTT_PUB_BATCH_SAMPLES ||
+        esp_timer_get_time() - s_batch_start_us >= (int64_t)MQTT_PUB_BATCH_MAX_MS * 1000) {
+        flush_batch();
+    }
+}
+
+static void emit_phase_summary(const TelemetryPacket *packet, const char *end)
+{
+    char msg[384];
+    uint32_t misses = packet->cycle.deadline_misses - s_phase.misses_at_start;
+    int len = snprintf(msg, sizeof(msg),
+                       "{\"device\":\"%s\",\"boot\":%lu,\"seq\":%lu,\"run\":%lu,\"index\":%lu,\"phase\":\"%s\","
+                       "\"duration_ms\":%llu,\"samples\":%lu,\"rpm_max\":%.0f,\"rpm_avg\":%.0f,"
+                       "\"p_min\":%.2f,\"p_max\":%.2f,\"deadline_misses\":%lu,\"end\":\"%s\"}",
+                       s_device, (unsigned long)s_boot_id, (unsigned long)++s_msg_seq, (unsigned long)s_run,
+                       (unsigned long)s_phase.index, s_phase.name,
+                       (unsigned long long)(packet->packet_timestamp_ms - s_phase.start_ms),
+                       (unsigned long)s_phase.samples, s_phase.rpm_max,
+                       s_phase.samples ? s_phase.rpm_sum / s_phase.samples : 0.0f,
+                       s_phase.p_min, s_phase.p_max, (unsigned long)misses, end);
+    if (len > 0 && len < (int)sizeof(msg)) {
+        enqueue(TOPIC_PHASE, msg, len);
+    }
+}
+
+static void phase_track(const TelemetryPacket *packet)
+{
+    const CycleTelemetry *cy = &packet->cycle;
+    bool running = cy->cycle_running;
+
+    if (s_phase.active && (!running || cy->current_phase_index != s_phase.index)) {
+        const char *end = running ? "next" : (cy->deadline_alarm ? "alarm" : "cycle_end");
+        emit_phase_summary(packet, end);
+        s_phase.active = false;
+        if (!running) flush_batch();    // the cycle's last samples go out with it
+    }
+
+    if (running && !s_phase.active) {
+        if (cy->current_phase_index <= 1 || s_run == 0) s_run++;
+        memset(&s_phase, 0, sizeof(s_phase));
+        s_phase.active = true;
+        s_phase.index = cy->current_phase_index;
+        copy_name(s_phase.name, sizeof(s_phase.name), cy->current_phase_name);
+        s_phase.start_ms = packet->packet_timestamp_ms;
+        s_phase.misses_at_start = cy->deadline_misses;
+        s_phase.p_min = packet->sensors.pressure_freq;
+        s_phase.p_max = packet->sensors.pressure_freq;
+    }
+
+    if (s_phase.active) {
+        float rpm = packet->sensors.rpm;
+        float p = packet->sensors.pressure_freq;
+        s_phase.samples++;
+        s_phase.rpm_sum += rpm;
+        if (rpm > s_phase.rpm_max) s_phase.rpm_max = rpm;
+        if (p < s_phase.p_min) s_phase.p_min = p;
+        if (p > s_phase.p_max) s_phase.p_max = p;
+    }
+}
+
+void mqtt_pub_on_telemetry(const TelemetryPacket *packet)
+{
+    if (!s_running || !packet) return;
+
+    phase_track(packet);
+    batch_add(packet);
+}
+
+// ====================== FLASH SPILL / REPLAY ======================
+
+static void segment_path(char *path, size_t cap, uint32_t seg)
+{
+    snprintf(path, cap, SEGMENT_PATH_FMT, (unsigned long)seg);
+}
+
+// Move the oldest RAM messages into one flash segment (offline only)
+static void spill_oldest(void)
+{
+    char *buf = malloc(MQTT_PUB_SEGMENT_BYTES);
+    if (!buf) return;
+
+    char path[32];
+    size_t len = 0;
+    uint16_t msgs = 0;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    while (s_q_count > 0 && q_at(0)->state == ENTRY_QUEUED) {
+        const MqEntry *e = q_at(0);
+        const char *tname = s_topic_names[e->topic];
+        size_t tlen = strlen(tname);
+        if (len + tlen + 1 + e->len + 1 > MQTT_PUB_SEGMENT_BYTES) break;
+
+        memcpy(buf + len, tname, tlen);
+        len += tlen;
+        buf[len++] = '\t';
+        memcpy(buf + len, &s_arena[e->off], e->len);
+        len += e->len;
+        buf[len++] = '\n';
+        q_pop_head();
+        msgs++;
+    }
+
+    if (msgs == 0) {
+        xSemaphoreGive(s_lock);
+        free(buf);
+        return;
+    }
+
+    if (s_seg_next - s_seg_first >= MQTT_PUB_MAX_SEGMENTS) {
+        // flash budget used up: the oldest segment goes
+        segment_path(path, sizeof(path), s_seg_first);
+        fs_remove_file_scheduled(path);
+        s_stats.dropped += s_seg_msgs[s_seg_first % MQTT_PUB_MAX_SEGMENTS];
+        s_seg_first++;
+    }
+    uint32_t seg = s_seg_next++;
+    s_seg_msgs[seg % MQTT_PUB_MAX_SEGMENTS] = msgs;
+    s_stats.segments = s_seg_next - s_seg_first;
+    s_stats.spilled += msgs;
+    xSemaphoreGive(s_lock);
+
+    segment_path(path, sizeof(path), seg);
+    if (fs_write_file_scheduled(path, buf, len) != ESP_OK) {
+        // writer queue full: the segment is never written, the replay skips it
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        s_stats.dropped += msgs;
+        xSemaphoreGive(s_lock);
+    }
+    ESP_LOGI(TAG, "Broker offline: spilled %u message(s) to %s", msgs, path);
+}
+
+static void finish_segment(void)
+{
+    char path[32];
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    segment_path(path, sizeof(path), s_seg_first);
+    s_seg_msgs[s_seg_first % MQTT_PUB_MAX_SEGMENTS] = 0;
+    s_seg_first++;
+    s_stats.segments = s_seg_next - s_seg_first;
+    xSemaphoreGive(s_lock);
+
+    fs_remove_file_scheduled(path);
+    s_replay_pending = -1;
+    s_seg_missing_since = 0;
+}
+
+static MqTopic topic_from_name(const char *name, size_t len)
+{
+    for (int t = 0; t < TOPIC_COUNT; t++) {
+        if (strlen(s_topic_names[t]) == len && strncmp(s_topic_names[t], name, len) == 0) return (MqTopic)t;
+    }
+    return TOPIC_COUNT;
+}
+
+// Publish the oldest flash segment; it is deleted once every message is acked
+static void replay_segment(void)
+{
+    char path[32];
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    uint32_t seg = s_seg_first;
+    xSemaphoreGive(s_lock);
+    segment_path(path, sizeof(path), seg);
+
+    char *data = fs_read_file(path);
+    if (!data) {
+        // still in the writer queue, or never written
+        int64_t now = esp_timer_get_time();
+        if (!s_seg_missing_since) s_seg_missing_since = now;
+        if (now - s_seg_missing_since > (int64_t)SEGMENT_MISSING_MS * 1000) {
+            ESP_LOGW(TAG, "Spill segment %s missing, skipped", path);
+            finish_segment();
+        }
+        return;
+    }
+    s_seg_missing_since = 0;
+
+    int lines = 0;
+    for (const char *p = data; *p; p++) {
+        if (*p == '\n') lines++;
+    }
+    s_replay_pending = (s_stats.qos > 0) ? lines : 0;
+
+    int sent = 0;
+    for (char *line = data; *line; ) {
+        char *nl = strchr(line, '\n');
+        if (!nl) break;
+        char *tab = memchr(line, '\t', nl - line);
+        MqTopic t = tab ? topic_from_name(line, tab - line) : TOPIC_COUNT;
+        if (t != TOPIC_COUNT) {
+            int msg_id = esp_mqtt_client_publish(s_client, s_topics[t], tab + 1, nl - tab - 1, s_stats.qos, 0);
+            if (msg_id < 0) {
+                // link went down mid-segment: the whole segment is sent again later
+                s_replay_pending = -1;
+                free(data);
+                return;
+            }
+            xSemaphoreTake(s_lock, portMAX_DELAY);
+            s_stats.bytes_published += nl - tab - 1;
+            if (s_stats.qos == 0) {
+                s_stats.published++;
+                s_stats.replayed++;
+            }
+            xSemaphoreGive(s_lock);
+            sent++;
+        } else if (s_stats.qos > 0) {
+            s_replay_pending--;     // unreadable line, no ack coming
+        }
+        line = nl + 1;
+    }
+    free(data);
+
+    ESP_LOGI(TAG, "Replayed %d message(s) from %s", sent, path);
+    if (s_replay_pending <= 0) finish_segment();
+}
+
+// ====================== PUBLISHER TASK ======================
+
+static void publish_ram(void)
+{
+    static char tx[MQTT_PUB_BATCH_BYTES];
+
+    while (s_running) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        MqEntry *e = NULL;
+        int inflight = 0;
+        for (size_t i = 0; i < s_q_count; i++) {
+            MqEntry *c = q_at(i);
+            if (c->state == ENTRY_SENT) inflight++;
+            else if (c->state == ENTRY_QUEUED && !e) e = c;
+        }
+        s_stats.inflight = inflight;
+        if (!e || (s_stats.qos > 0 && inflight >= MQTT_PUB_INFLIGHT)) {
+            xSemaphoreGive(s_lock);
+            return;
+        }
+        uint32_t id = e->id;
+        MqTopic topic = (MqTopic)e->topic;
+        size_t len = e->len;
+        memcpy(tx, &s_arena[e->off], len);
+        e->state = ENTRY_SENT;      // also keeps it from being evicted while on the wire
+        xSemaphoreGive(s_lock);
+
+        int msg_id = esp_mqtt_client_publish(s_client, s_topics[topic], tx, len, s_stats.qos, 0);
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        e = q_find(id);
+        if (e) {
+            if (msg_id < 0) {
+                e->state = ENTRY_QUEUED;
+            } else if (s_stats.qos == 0) {
+                // nothing to wait for; with QoS 0 nothing is in flight, so e is the head
+                e->state = ENTRY_ACKED;
+                s_stats.published++;
+                s_stats.bytes_published += len;
+                while (s_q_count > 0 && q_at(0)->state == ENTRY_ACKED) q_pop_head();
+            } else {
+                e->msg_id = msg_id;
+            }
+        }
+        xSemaphoreGive(s_lock);
+        if (msg_id < 0) return;
+    }
+}
+
+static void on_ack(int msg_id)
+{
+    bool found = false;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (size_t i = 0; i < s_q_count; i++) {
+        MqEntry *e = q_at(i);
+        if (e->state == ENTRY_SENT && e->msg_id == msg_id) {
+            e->state = ENTRY_ACKED;
+            s_stats.published++;
+            s_stats.bytes_published += e->len;
+            found = true;
+            break;
+        }
+    }
+    while (s_q_count > 0 && q_at(0)->state == ENTRY_ACKED) q_pop_head();
+    if (!found && s_replay_pending > 0) {
+        s_stats.published++;
+        s_stats.replayed++;
+    }
+    xSemaphoreGive(s_lock);
+
+    if (!found && s_replay_pending > 0 && --s_replay_pending == 0) {
+        finish_segment();
+    }
+}
+
+static void on_disconnected(void)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_stats.connected = false;
+    for (size_t i = 0; i < s_q_count; i++) {
+        if (q_at(i)->state == ENTRY_SENT) q_at(i)->state = ENTRY_QUEUED;   // resent after reconnect
+    }
+    s_stats.inflight = 0;
+    xSemaphoreGive(s_lock);
+    s_replay_pending = -1;
+}
+
+static void process_events(void)
+{
+    MqEvent ev;
+    while (xQueueReceive(s_events, &ev, 0) == pdTRUE) {
+        switch (ev.id) {
+        case MQTT_EVENT_CONNECTED:
+            xSemaphoreTake(s_lock, portMAX_DELAY);
+            s_stats.connected = true;
+            s_stats.reconnects++;
+            xSemaphoreGive(s_lock);
+            esp_mqtt_client_publish(s_client, s_status_topic, "online", 0, 0, 1);
+            ESP_LOGI(TAG, "Connected, %lu queued, %lu segment(s) to replay",
+                     (unsigned long)s_stats.queue_depth, (unsigned long)s_stats.segments);
+            break;
+        case MQTT_EVENT_DISCONNECTED:
+            on_disconnected();
+            ESP_LOGW(TAG, "Broker disconnected, buffering");
+            break;
+        case MQTT_EVENT_PUBLISHED:
+            on_ack(ev.msg_id);
+            break;
+        case MQTT_EVENT_ERROR:
+            // acks were lost (event queue overflow): put everything in flight back
+            on_disconnected();
+            xSemaphoreTake(s_lock, portMAX_DELAY);
+            s_stats.connected = (ev.msg_id == 1);
+            xSemaphoreGive(s_lock);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+static void update_rate(void)
+{
+    int64_t now = esp_timer_get_time();
+    if (now - s_rate_start_us < (int64_t)RATE_WINDOW_MS * 1000) return;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_stats.msgs_per_s = (s_stats.published - s_rate_published) * 1e6f / (float)(now - s_rate_start_us);
+    s_rate_published = s_stats.published;
+    xSemaphoreGive(s_lock);
+    s_rate_start_us = now;
+}
+
+static void mqtt_pub_task(void *arg)
+{
+    s_rate_start_us = esp_timer_get_time();
+
+    while (s_running) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(200));
+        process_events();
+
+        if (s_stats.connected) {
+            if (s_seg_first != s_seg_next) {
+                if (s_replay_pending < 0) replay_segment();   // older than anything in RAM
+            } else {
+                publish_ram();
+            }
+        } else if (s_q_count * 100 >= MQTT_PUB_QUEUE_LEN * MQTT_PUB_SPILL_PCT ||
+                   s_stats.queue_bytes * 100 >= sizeof(s_arena) * MQTT_PUB_SPILL_PCT) {
+            spill_oldest();
+        }
+
+        update_rate();
+    }
+
+    s_task = NULL;
+    vTaskDelete(NULL);
+}
+
+static void mqtt_event_handler(void *arg, esp_event_base_t base, int32_t event_id, void *event_data)
+{
+    esp_mqtt_event_handle_t event = event_data;
+    MqEvent ev = { .id = event_id, .msg_id = event ? event->msg_id : -1 };
+
+    if (event_id != MQTT_EVENT_CONNECTED && event_id != MQTT_EVENT_DISCONNECTED &&
+        event_id != MQTT_EVENT_PUBLISHED) {
+        return;
+    }
+    if (xQueueSend(s_events, &ev, 0) != pdTRUE) {
+        // overflow: tell the task to resend what is in flight
+        MqEvent reset = { .id = MQTT_EVENT_ERROR, .msg_id = (event_id != MQTT_EVENT_DISCONNECTED) };
+        xQueueReset(s_events);
+        xQueueSend(s_events, &reset, 0);
+    }
+    if (s_task) xTaskNotifyGive(s_task);
+}
+
+// ====================== PUBLIC API ======================
+
+// Pick up spill segments left on flash by an earlier outage (e.g. before a reboot)
+static void scan_segments(void)
+{
+    DIR *dir = opendir(SEGMENT_DIR);
+    if (!dir) return;
+
+    bool found = false;
+    uint32_t lo = UINT32_MAX, hi = 0;
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL) {
+        unsigned long seg;
+        if (sscanf(de->d_name, "mq_%lu.txt", &seg) == 1) {
+            found = true;
+            if (seg < lo) lo = seg;
+            if (seg > hi) hi = seg;
+        }
+    }
+    closedir(dir);
+
+    if (found && s_seg_first == s_seg_next && hi - lo < MQTT_PUB_MAX_SEGMENTS * 4) {
+        s_seg_first = lo;
+        s_seg_next = hi + 1;
+        s_stats.segments = s_seg_next - s_seg_first;
+        ESP_LOGI(TAG, "%lu spill segment(s) from an earlier outage to replay", (unsigned long)s_stats.segments);
+    }
+}
+
+esp_err_t mqtt_pub_start(const char *uri, uint8_t qos)
+{
+    if (!uri || !uri[0] || qos > 2) return ESP_ERR_INVALID_ARG;
+
+    mqtt_pub_stop();
+
+    if (!s_lock) {
+        s_lock = xSemaphoreCreateMutex();
+        s_events = xQueueCreate(EVENT_QUEUE_LEN, sizeof(MqEvent));
+        if (!s_lock || !s_events) return ESP_ERR_NO_MEM;
+
+        uint8_t mac[6];
+        esp_read_mac(mac, ESP_MAC_WIFI_STA);
+        snprintf(s_device, sizeof(s_device), "%02x%02x%02x%02x%02x%02x",
+                 mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+        for (int t = 0; t < TOPIC_COUNT; t++) {
+            snprintf(s_topics[t], sizeof(s_topics[t]), "%s/%s/%s", MQTT_PUB_TOPIC_PREFIX, s_device, s_topic_names[t]);
+        }
+        snprintf(s_status_topic, sizeof(s_status_topic), "%s/%s/status", MQTT_PUB_TOPIC_PREFIX, s_device);
+        s_boot_id = esp_random();
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    snprintf(s_stats.uri, sizeof(s_stats.uri), "%s", uri);
+    s_stats.qos = qos;
+    s_stats.connected = false;
+    xSemaphoreGive(s_lock);
+    scan_segments();
+
+    const esp_mqtt_client_config_t cfg = {
+        .broker.address.uri = s_stats.uri,
+        .session.keepalive = 30,
+        .session.last_will = {
+            .topic = s_status_topic,
+            .msg = "offline",
+            .msg_len = 7,
+            .qos = 1,
+            .retain = 1,
+        },
+        .network.reconnect_timeout_ms = 5000,
+        .buffer.size = MQTT_PUB_BATCH_BYTES + 128,
+    };
+    s_client = esp_mqtt_client_init(&cfg);
+    if (!s_client) return ESP_FAIL;
+    esp_mqtt_client_register_event(s_client, (esp_mqtt_event_id_t)ESP_EVENT_ANY_ID, mqtt_event_handler, NULL);
+
+    s_running = true;
+    s_stats.enabled = true;
+    if (xTaskCreate(mqtt_pub_task, "mqtt_pub", 4096, NULL, 3, &s_task) != pdPASS) {
+        s_running = false;
+        s_stats.enabled = false;
+        esp_mqtt_client_destroy(s_client);
+        s_client = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t err = esp_mqtt_client_start(s_client);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "esp_mqtt_client_start failed: %s", esp_err_to_name(err));
+        mqtt_pub_stop();
+        return err;
+    }
+
+    ESP_LOGI(TAG, "Publishing to %s as %s/%s (QoS %u)", uri, MQTT_PUB_TOPIC_PREFIX, s_device, qos);
+    return ESP_OK;
+}
+
+void mqtt_pub_stop(void)
+{
+    if (!s_client) return;
+
+    // Stopping the client first makes a publish blocked on the socket return
+    s_running = false;
+    esp_mqtt_client_stop(s_client);
+    if (s_task) xTaskNotifyGive(s_task);
+    while (s_task) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    esp_mqtt_client_destroy(s_client);
+    s_client = NULL;
+
+    // Unsent messages stay queued for the next start
+    on_disconnected();
+    xQueueReset(s_events);
+    s_stats.enabled = false;
+    ESP_LOGI(TAG, "MQTT publisher stopped (%lu message(s) kept queued)", (unsigned long)s_stats.queue_depth);
+}
+
+bool mqtt_pub_active(void)
+{
+    return s_running;
+}
+
+void mqtt_pub_get_stats(MqttPubStats *out)
+{
+    if (!out) return;
+    if (!s_lock) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *out = s_stats;
+    xSemaphoreGive(s_lock);
+}
@@ -0,0 +1,62 @@
+// mqtt_pub.h
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "telemetry.h"
+
+// MQTT publisher for the shop message bus: batched telemetry and one summary
+// per finished phase. Messages go through a bounded RAM queue; while the
+// broker is unreachable the oldest entries spill to SPIFFS segments, which are
+// replayed (oldest first, before newer RAM entries) once the link is back.
+// Delivery is at-least-once: every message carries "boot" (random per boot)
+// and a per-device "seq" so consumers can drop duplicates after a reconnect.
+//
+// Topics: <prefix>/<device>/telemetry  {"device","boot","seq","pins":[..],"samples":[{"t","out","rpm","p","ph","el"},..]}
+//         <prefix>/<device>/phase      {"device","boot","seq","run","index","phase","duration_ms","samples",
+//                                       "rpm_max","rpm_avg","p_min","p_max","deadline_misses","end"}
+//         <prefix>/<device>/status     "online" / "offline" (retained, last will)
+
+#define MQTT_PUB_TOPIC_PREFIX      "cycleoptima"
+#define MQTT_PUB_DEFAULT_QOS       1
+#define MQTT_PUB_BATCH_SAMPLES     10       // telemetry samples per message
+#define MQTT_PUB_BATCH_MAX_MS      10000    // publish a partial batch after this
+#define MQTT_PUB_BATCH_BYTES       1280     // largest telemetry message
+#define MQTT_PUB_RAM_BYTES         16384    // RAM queue arena
+#define MQTT_PUB_QUEUE_LEN         64       // RAM queue entries
+#define MQTT_PUB_SPILL_PCT         75       // spill to flash above this fill while offline
+#define MQTT_PUB_INFLIGHT          4        // unacknowledged QoS 1/2 publishes
+#define MQTT_PUB_SEGMENT_BYTES     4096     // flash spill segment (one SPIFFS write)
+#define MQTT_PUB_MAX_SEGMENTS      8        // 32 KB of flash; the oldest segment is dropped beyond
+
+typedef struct {
+    bool     enabled;
+    bool     connected;
+    char     uri[96];
+    uint8_t  qos;
+    uint32_t queue_depth;       // messages in RAM
+    uint32_t queue_bytes;
+    uint32_t max_queue_depth;
+    uint32_t segments;          // spill segments on flash
+    uint32_t inflight;
+    uint32_t enqueued;          // messages produced
+    uint32_t published;         // acknowledged (QoS 0: handed to the client)
+    uint32_t replayed;          // of those, sent from flash segments
+    uint32_t spilled;           // messages moved to flash
+    uint32_t dropped;           // lost because RAM and flash were full
+    uint32_t reconnects;
+    uint32_t bytes_published;
+    float    msgs_per_s;        // published, last 10 s
+} MqttPubStats;
+
+// Connect to uri (mqtt://host:port) and start publishing; restarts if running.
+// Spill segments left on flash from an earlier outage are replayed first.
+esp_err_t mqtt_pub_start(const char *uri, uint8_t qos);
+void mqtt_pub_stop(void);
+bool mqtt_pub_active(void);
+
+// Feed one telemetry packet (telemetry task): batches samples, emits phase summaries
+void mqtt_pub_on_telemetry(const TelemetryPacket *packet);
+
+void mqtt_pub_get_stats(MqttPubStats *out);
@@ -0,0 +1,119 @@
+// power.c
+#include "power.h"
+
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+#include "cycle.h"
+
+static const char *TAG = "power";
+
+#define POWER_MAX_FREQ_MHZ  160
+#define POWER_MIN_FREQ_MHZ  40      // XTAL, used between wakeups when light sleep is blocked
+
+extern const gpio_num_t all_pins[NUM_COMPONENTS];
+
+static esp_pm_lock_handle_t s_cycle_lock = NULL;
+static bool s_light_sleep = false;
+
+// updated from the light sleep callbacks (critical section, IRAM)
+static DRAM_ATTR volatile uint32_t s_sleeps = 0;
+static DRAM_ATTR volatile uint64_t s_asleep_us = 0;
+
+// previous window snapshot
+static uint32_t s_prev_sleeps = 0;
+static uint64_t s_prev_asleep_us = 0;
+static int64_t s_prev_time_us = 0;
+
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+static IRAM_ATTR esp_err_t on_light_sleep_exit(int64_t sleep_time_us, void *arg)
+{
+    s_sleeps++;
+    s_asleep_us += (uint64_t)sleep_time_us;
+    return ESP_OK;
+}
+#endif
+
+esp_err_t power_init(void)
+{
+#if CONFIG_PM_ENABLE
+    // keep relay outputs driven exactly as they are while the chip sleeps
+    for (int i = 0; i < NUM_COMPONENTS; i++) {
+        gpio_sleep_sel_dis(all_pins[i]);
+    }
+
+    esp_err_t err = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "cycle", &s_cycle_lock);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create PM lock: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    const esp_pm_config_t cfg = {
+        .max_freq_mhz = POWER_MAX_FREQ_MHZ,
+        .min_freq_mhz = POWER_MIN_FREQ_MHZ,
+        .light_sleep_enable = true,
+    };
+    err = esp_pm_configure(&cfg);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "esp_pm_configure failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    s_light_sleep = true;
+
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+    esp_pm_sleep_cbs_register_config_t cbs = {
+        .exit_cb = on_light_sleep_exit,
+        .exit_cb_prior = 0,
+    };
+    if (esp_pm_light_sleep_register_cbs(&cbs) != ESP_OK) {
+        ESP_LOGW(TAG, "Light sleep callbacks unavailable - sleep stats will read 0");
+    }
+#endif
+
+    s_prev_time_us = esp_timer_get_time();
+    ESP_LOGI(TAG, "Light sleep enabled when idle (%d-%d MHz)", POWER_MIN_FREQ_MHZ, POWER_MAX_FREQ_MHZ);
+    return ESP_OK;
+#else
+    ESP_LOGW(TAG, "CONFIG_PM_ENABLE is off - running without light sleep");
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void power_cycle_active(bool active)
+{
+    if (!s_cycle_lock) return;
+
+    if (active) {
+        esp_pm_lock_acquire(s_cycle_lock);
+    } else {
+        esp_pm_lock_release(s_cycle_lock);
+    }
+}
+
+void power_get_stats(PowerStats *out)
+{
+    int64_t now_us = esp_timer_get_time();
+
+    portDISABLE_INTERRUPTS();
+    uint32_t sleeps = s_sleeps;
+    uint64_t asleep_us = s_asleep_us;
+    portENABLE_INTERRUPTS();
+
+    uint32_t window_ms = (uint32_t)((now_us - s_prev_time_us) / 1000);
+    out->light_sleep = s_light_sleep;
+    out->window_ms = window_ms;
+    out->sleeps = sleeps - s_prev_sleeps;
+    out->asleep_ms = (uint32_t)((asleep_us - s_prev_asleep_us) / 1000);
+    out->wakeups_per_s = window_ms ? out->sleeps * 1000.0f / window_ms : 0;
+    out->asleep_pct = window_ms ? 100.0f * out->asleep_ms / window_ms : 0;
+    out->total_sleeps = sleeps;
+    out->total_asleep_ms = asleep_us / 1000;
+
+    s_prev_sleeps = sleeps;
+    s_prev_asleep_us = asleep_us;
+    s_prev_time_us = now_us;
+}
@@ -0,0 +1,32 @@
+// power.h
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Power management: tickless idle with automatic light sleep while the machine
+// is idle. The CPU sleeps until the next esp_timer alarm, FreeRTOS timeout or
+// Wi-Fi DTIM beacon. While a cycle runs light sleep is blocked (GPIO edge
+// capture and the ISR executor need the APB clock); tickless idle still
+// removes the periodic tick wakeups then.
+
+typedef struct {
+    bool     light_sleep;       // light sleep configured successfully
+    uint32_t window_ms;         // measurement window (since the previous query)
+    uint32_t sleeps;            // light sleep entries in the window (= wakeups from sleep)
+    uint32_t asleep_ms;         // time spent in light sleep in the window
+    float    wakeups_per_s;
+    float    asleep_pct;
+    uint32_t total_sleeps;      // since boot
+    uint64_t total_asleep_ms;
+} PowerStats;
+
+// Configure DFS + light sleep (call once, early)
+esp_err_t power_init(void);
+
+// Block light sleep while a cycle runs
+void power_cycle_active(bool active);
+
+// Stats since the previous call (starts a new window)
+void power_get_stats(PowerStats *out);
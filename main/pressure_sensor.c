@@ -21,6 +21,14 @@ static volatile float s_kpa_to_cmh2o = 10.197f;   // conversion factor: 1 kPa =
 #define PRESS_AVG_SAMPLES     10
 #define PRESS_CAPTURE_SAMPLES 20
 
+// Empty-tub baseline, tracked from the regular averaged reads (telemetry) so a
+// reset is a snapshot instead of a fresh PRESS_CAPTURE_SAMPLES capture.
+// Exponential average with weight 1/2^PRESS_BASELINE_SHIFT per read.
+#define PRESS_BASELINE_SHIFT  4
+static volatile long  s_raw_baseline = 0;
+static volatile bool  s_tub_empty = true;       // baseline follows reads only while set
+static volatile uint32_t s_baseline_updates = 0;
+
 // ------------------------------------------------------------------
 // low-level helpers
 // ------------------------------------------------------------------
@@ -37,10 +45,17 @@ static long read_raw_once(void)
 {
     unsigned long value = 0;
 
-    wait_ready();
+    // Several tasks read the sensor (telemetry, cycle triggers, actuator
+    // characterization): re-check DOUT inside the critical section so a
+    // conversion another task clocked out in between is not read as data
+    vPortEnterCritical();
+    while (gpio_get_level(PRESS_DOUT_PIN) == 1) {
+        vPortExitCritical();
+        wait_ready();
+        vPortEnterCritical();
+    }
 
     // same read sequence as before
-    vPortEnterCritical();
     for (int i = 0; i < 24; i++) {
         gpio_set_level(PRESS_SCK_PIN, 1);
         esp_rom_delay_us(1);
@@ -71,6 +86,15 @@ static long read_raw_averaged(int n)
     return (long)(sum / n);
 }
 
+// Fold one averaged read into the baseline while the tub is known empty
+static void track_baseline(long raw)
+{
+    if (!s_tub_empty) return;
+    long base = s_raw_baseline;
+    s_raw_baseline = base + (raw - base) / (1L << PRESS_BASELINE_SHIFT);
+    s_baseline_updates++;
+}
+
 static float raw_to_kpa(long raw)
 {
     // Not used anymore - we calculate frequency directly from raw
@@ -115,12 +139,14 @@ void pressure_sensor_init(void)
 
     // take an initial zero capture
     s_raw_zero = read_raw_averaged(PRESS_CAPTURE_SAMPLES);
+    s_raw_baseline = s_raw_zero;
     ESP_LOGI(TAG, "pressure init: zero=%ld", s_raw_zero);
 }
 
 float pressure_sensor_read_kpa(void)
 {
     long raw = read_raw_averaged(PRESS_AVG_SAMPLES);
+    track_baseline(raw);
     float kpa = raw_to_kpa(raw);
     return kpa;
 }
@@ -133,12 +159,25 @@ long pressure_sensor_read_raw(void)
 float pressure_sensor_read_frequency(void)
 {
     long raw = read_raw_averaged(PRESS_AVG_SAMPLES);
+    track_baseline(raw);
     float freq = raw_to_frequency(raw);
     return freq;
 }
 
+float pressure_sensor_read_frequency_once(void)
+{
+    return raw_to_frequency(read_raw_once());
+}
+
 void pressure_sensor_reset(void)
 {
-    s_raw_zero = read_raw_averaged(PRESS_CAPTURE_SAMPLES);
-    ESP_LOGI(TAG, "pressure reset: zero=%ld", s_raw_zero);
+    // Snapshot only: no sensor reads, so this never blocks the caller (httpd)
+    s_raw_zero = s_raw_baseline;
+    ESP_LOGI(TAG, "pressure reset: zero=%ld (baseline, %lu updates)",
+             s_raw_zero, (unsigned long)s_baseline_updates);
+}
+
+void pressure_sensor_set_tub_empty(bool empty)
+{
+    s_tub_empty = empty;
 }
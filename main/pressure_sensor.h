@@ -15,10 +15,18 @@ float pressure_sensor_read_kpa(void);
 // Uses formula: Freq = 28116.48 - 0.0014180 × Raw - 7 × 10^-11 × Raw²
 float pressure_sensor_read_frequency(void);
 
+// one conversion, no averaging and no baseline tracking (high-rate capture);
+// blocks until the converter's next sample is ready
+float pressure_sensor_read_frequency_once(void);
+
 // optional: get raw 24-bit value (if monitor wants to log it)
 long pressure_sensor_read_raw(void);
 
-// reset calibration / zero
+// reset calibration / zero: takes the tracked empty-tub baseline, returns immediately
 void pressure_sensor_reset(void);
 
+// the tub is known empty (idle after a completed cycle, or at boot): while set,
+// every averaged read also updates the baseline used by pressure_sensor_reset()
+void pressure_sensor_set_tub_empty(bool empty);
+
 #endif // PRESSURE_SENSOR_H
@@ -13,12 +13,17 @@
 #define RPM_TIMEOUT_MS          2000        // if no pulse for 2s -> rpm = 0
 #define RPM_TS_COUNT            3           // 3-sample for simpler, more reliable calculation
 #define RPM_MAX_LIMIT           1500.0f     // Maximum realistic RPM - ignore readings above this
+#define RPM_INTERVAL_LEN        256         // pulse interval history for ripple analysis (power of two)
 
 // shared state between ISR and readers
 static volatile uint64_t s_timestamps[RPM_TS_COUNT] = {0};
 static volatile int      s_ts_index = 0;
 static volatile uint64_t s_last_pulse_us = 0;
 
+// pulse-to-pulse intervals, oldest overwritten (s_interval_count % RPM_INTERVAL_LEN = next slot)
+static volatile uint32_t s_intervals[RPM_INTERVAL_LEN];
+static volatile uint32_t s_interval_count = 0;
+
 // normalization
 static volatile float s_pulses_per_rev = 1.0f;
 
@@ -34,6 +39,11 @@ static void IRAM_ATTR rpm_gpio_isr(void *arg)
     if ((now - s_last_pulse_us) < RPM_DEBOUNCE_US) {
         return;
     }
+    if (s_last_pulse_us != 0) {
+        uint64_t interval = now - s_last_pulse_us;
+        s_intervals[s_interval_count % RPM_INTERVAL_LEN] = (interval > UINT32_MAX) ? UINT32_MAX : (uint32_t)interval;
+        s_interval_count++;
+    }
     s_last_pulse_us = now;
 
     // rotate circular buffer
@@ -73,10 +83,48 @@ void rpm_sensor_reset(void)
     }
     s_ts_index = 0;
     s_last_pulse_us = 0;
+    s_interval_count = 0;
     s_last_avg_rpm = 0.0f;  // Reset last RPM tracking
     vPortExitCritical();
 }
 
+void rpm_sensor_last_pulse(uint64_t *pulse_us, uint32_t *period_us)
+{
+    vPortEnterCritical();
+    int idx = s_ts_index;
+    uint64_t last = s_timestamps[idx];
+    uint64_t prev = s_timestamps[(idx - 1 + RPM_TS_COUNT) % RPM_TS_COUNT];
+    vPortExitCritical();
+
+    *pulse_us = last;
+    *period_us = (last && prev && last > prev) ? (uint32_t)(last - prev) : 0;
+}
+
+uint32_t rpm_sensor_read_intervals(uint32_t *out, uint32_t n)
+{
+    if (n > RPM_INTERVAL_LEN) n = RPM_INTERVAL_LEN;
+
+    vPortEnterCritical();
+    uint32_t count = s_interval_count;
+    uint32_t avail = (count < n) ? count : n;
+    for (uint32_t i = 0; i < avail; i++) {
+        out[i] = s_intervals[(count - avail + i) % RPM_INTERVAL_LEN];
+    }
+    vPortExitCritical();
+
+    return avail;
+}
+
+uint32_t rpm_sensor_interval_count(void)
+{
+    return s_interval_count;
+}
+
+float rpm_sensor_get_pulses_per_rev(void)
+{
+    return s_pulses_per_rev;
+}
+
 /**
  * Check if the new RPM reading is within acceptable acceleration limits
  * compared to the last reading to prevent unrealistic jumps
@@ -14,11 +14,28 @@ void rpm_sensor_init(void);
  */
 float rpm_sensor_get_rpm(void);
 
+/**
+ * Raw tach timing for fast fault checks (no RPM math, no timeout):
+ * - *pulse_us  = esp_timer time of the latest pulse, 0 if none since reset
+ * - *period_us = interval before that pulse, 0 if fewer than two pulses
+ */
+void rpm_sensor_last_pulse(uint64_t *pulse_us, uint32_t *period_us);
+
+/**
+ * Pulse interval history for ripple analysis (up to 256 entries):
+ * - copies the newest min(n, available) intervals (µs) into out, oldest first
+ * - returns the number copied
+ * rpm_sensor_interval_count() is the running total, to tell new data apart.
+ */
+uint32_t rpm_sensor_read_intervals(uint32_t *out, uint32_t n);
+uint32_t rpm_sensor_interval_count(void);
+
 /**
  * Optionally set pulses per revolution.
  * Default = 1.0f
  */
 void rpm_sensor_set_pulses_per_rev(float ppr);
+float rpm_sensor_get_pulses_per_rev(void);
 
 /**
  * Reset internal state (clear timestamps, rpm)
@@ -0,0 +1,365 @@
+// serial_telemetry.c
+#include "serial_telemetry.h"
+#include "cycle.h"
+#include "executor.h"
+#include "telemetry.h"
+#include "rpm_sensor.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/usb_serial_jtag.h"
+#include "driver/usb_serial_jtag_vfs.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "serial_tel";
+
+#define FRAME_HDR_LEN     7
+#define FRAME_MAX_BODY    (12 + SERIAL_TELEMETRY_NAME_MAX)
+#define FRAME_MAX_RAW     (FRAME_HDR_LEN + FRAME_MAX_BODY + 2)
+#define FRAME_MAX_WIRE    (FRAME_MAX_RAW + FRAME_MAX_RAW / 254 + 3)   // COBS + two delimiters
+#define STATUS_PERIOD_US  1000000
+#define EDGES_PER_TICK    16
+
+typedef enum {
+    PHASE_EVT_CYCLE_START = 0,
+    PHASE_EVT_PHASE_START = 1,
+    PHASE_EVT_CYCLE_END   = 2,
+    PHASE_EVT_ALARM       = 3,
+} PhaseEvent;
+
+extern const gpio_num_t all_pins[NUM_COMPONENTS];
+
+static TaskHandle_t s_stream_task = NULL;
+static volatile bool s_running = false;
+static volatile uint32_t s_period_ms = SERIAL_TELEMETRY_DEFAULT_PERIOD_MS;
+static uint16_t s_seq = 0;
+static uint32_t s_edge_cursor = 0;
+static SerialTelemetryStats s_stats = {0};
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// ====================== FRAMING ======================
+
+static inline void put_u16(uint8_t *p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+static inline void put_u32(uint8_t *p, uint32_t v) { p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24; }
+static inline void put_f32(uint8_t *p, float f) { uint32_t v; memcpy(&v, &f, 4); put_u32(p, v); }
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF); binascii.crc_hqx(data, 0xFFFF) on the host
+static uint16_t crc16_ccitt(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// Consistent overhead byte stuffing: out has no zero bytes, len + len/254 + 1 long
+static size_t cobs_encode(const uint8_t *in, size_t len, uint8_t *out)
+{
+    size_t code_at = 0;
+    size_t o = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] == 0) {
+            out[code_at] = code;
+            code_at = o++;
+            code = 1;
+        } else {
+            out[o++] = in[i];
+            if (++code == 0xFF) {
+                out[code_at] = code;
+                code_at = o++;
+                code = 1;
+            }
+        }
+    }
+    out[code_at] = code;
+    return o;
+}
+
+// Frame body (already at raw + FRAME_HDR_LEN) is body_len long; stamp, stuff, send
+static void send_frame(SerialFrameType type, uint32_t time_us, uint8_t *raw, size_t body_len)
+{
+    uint8_t wire[FRAME_MAX_WIRE];
+
+    raw[0] = (uint8_t)type;
+    put_u16(&raw[1], s_seq++);
+    put_u32(&raw[3], time_us);
+    size_t len = FRAME_HDR_LEN + body_len;
+    put_u16(&raw[len], crc16_ccitt(raw, len));
+    len += 2;
+
+    // Leading delimiter: log text written between frames never merges into one
+    wire[0] = 0x00;
+    size_t n = 1 + cobs_encode(raw, len, &wire[1]);
+    wire[n++] = 0x00;
+
+    // The driver queues whole writes, so log lines can only land between frames
+    int written = usb_serial_jtag_write_bytes(wire, n, 0);
+
+    portENTER_CRITICAL(&s_stats_lock);
+    if (written == (int)n) {
+        s_stats.frames++;
+        s_stats.bytes += n;
+    } else {
+        s_stats.dropped++;      // host not reading: the seq gap shows it
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+// ====================== FRAME BUILDERS ======================
+
+// gpio-number bit mask -> pin-index bit mask (order of all_pins)
+static uint16_t pin_mask(uint32_t gpio_bits)
+{
+    uint16_t out = 0;
+    for (int i = 0; i < NUM_COMPONENTS; i++) {
+        if (gpio_bits & (1UL << all_pins[i])) out |= (uint16_t)(1u << i);
+    }
+    return out;
+}
+
+// Pressure comes from the telemetry task, which owns the HX710; RPM is read here
+static void send_sample(uint32_t now_us, float pressure_freq, bool pressure_new)
+{
+    uint8_t raw[FRAME_MAX_RAW];
+    uint8_t *b = &raw[FRAME_HDR_LEN];
+
+    put_f32(&b[0], rpm_sensor_get_rpm());
+    put_f32(&b[4], pressure_freq);
+    put_u16(&b[8], pin_mask(REG_READ(GPIO_OUT_REG)));
+    b[10] = cycle_running ? (uint8_t)(current_phase_index + 1) : 0;
+    b[11] = (cycle_running ? 0x01 : 0) | (executor_safe_tripped() ? 0x02 : 0) | (pressure_new ? 0x04 : 0);
+    send_frame(SERIAL_FRAME_SAMPLE, now_us, raw, 12);
+}
+
+static void send_edges(void)
+{
+    ExecutorEdge edges[EDGES_PER_TICK];
+    uint32_t lost = 0;
+    size_t n;
+
+    do {
+        n = executor_read_edges(&s_edge_cursor, edges, EDGES_PER_TICK, &lost);
+        if (lost) {
+            portENTER_CRITICAL(&s_stats_lock);
+            s_stats.lost_edges += lost;
+            portEXIT_CRITICAL(&s_stats_lock);
+        }
+        for (size_t i = 0; i < n; i++) {
+            uint16_t changed = pin_mask(edges[i].changed);
+            if (!changed) continue;     // not a component output
+            uint8_t raw[FRAME_MAX_RAW];
+            put_u16(&raw[FRAME_HDR_LEN], changed);
+            put_u16(&raw[FRAME_HDR_LEN + 2], pin_mask(edges[i].levels));
+            send_frame(SERIAL_FRAME_EDGE, (uint32_t)edges[i].time_us, raw, 4);
+        }
+    } while (n == EDGES_PER_TICK);
+}
+
+static void send_phase(uint32_t now_us, PhaseEvent event)
+{
+    uint8_t raw[FRAME_MAX_RAW];
+    uint8_t *b = &raw[FRAME_HDR_LEN];
+    const char *name = (event == PHASE_EVT_PHASE_START && current_phase_name) ? current_phase_name : "";
+    size_t name_len = strnlen(name, SERIAL_TELEMETRY_NAME_MAX);
+
+    b[0] = (uint8_t)event;
+    b[1] = (uint8_t)(current_phase_index + 1);
+    b[2] = (uint8_t)g_num_phases;
+    b[3] = (uint8_t)name_len;
+    memcpy(&b[4], name, name_len);
+    send_frame(SERIAL_FRAME_PHASE, now_us, raw, 4 + name_len);
+}
+
+static void send_status(uint32_t now_us)
+{
+    uint8_t raw[FRAME_MAX_RAW];
+    uint8_t *b = &raw[FRAME_HDR_LEN];
+    SerialTelemetryStats st;
+    serial_telemetry_get_stats(&st);
+
+    b[0] = SERIAL_TELEMETRY_VERSION;
+    put_u16(&b[1], (uint16_t)s_period_ms);
+    put_u32(&b[3], st.dropped);
+    put_u32(&b[7], st.lost_edges);
+    b[11] = NUM_COMPONENTS;
+    for (int i = 0; i < NUM_COMPONENTS; i++) {
+        b[12 + i] = (uint8_t)all_pins[i];
+    }
+    send_frame(SERIAL_FRAME_STATUS, now_us, raw, 12 + NUM_COMPONENTS);
+}
+
+// ====================== TASKS ======================
+
+static void stream_task(void *arg)
+{
+    bool was_running = false;
+    bool was_tripped = false;
+    int last_phase = -1;
+    uint64_t last_pressure_ms = 0;
+    int64_t next_status_us = 0;
+
+    // only edges from now on
+    ExecutorEdge skip[EDGES_PER_TICK];
+    while (executor_read_edges(&s_edge_cursor, skip, EDGES_PER_TICK, NULL) == EDGES_PER_TICK) {}
+
+    TickType_t last_wake = xTaskGetTickCount();
+    while (s_running) {
+        int64_t now = esp_timer_get_time();
+        uint32_t now_us = (uint32_t)now;
+
+        send_edges();
+
+        bool running = cycle_running;
+        bool tripped = executor_safe_tripped();
+        if (running && !was_running) {
+            send_phase(now_us, PHASE_EVT_CYCLE_START);
+            last_phase = -1;
+        }
+        if (running && current_phase_index != last_phase) {
+            send_phase(now_us, PHASE_EVT_PHASE_START);
+            last_phase = current_phase_index;
+        }
+        if (tripped && !was_tripped) {
+            send_phase(now_us, PHASE_EVT_ALARM);
+        }
+        if (!running && was_running) {
+            send_phase(now_us, PHASE_EVT_CYCLE_END);
+        }
+        was_running = running;
+        was_tripped = tripped;
+
+        SensorTelemetry sensors = telemetry_get_latest().sensors;
+        send_sample(now_us, sensors.pressure_freq, sensors.timestamp_ms != last_pressure_ms);
+        last_pressure_ms = sensors.timestamp_ms;
+
+        if (now >= next_status_us) {
+            send_status(now_us);
+            next_status_us = now + STATUS_PERIOD_US;
+        }
+
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(s_period_ms));
+    }
+
+    s_stream_task = NULL;
+    vTaskDelete(NULL);
+}
+
+// "ct start [period_ms]" / "ct stop", one per line from the host
+static void handle_command(char *line)
+{
+    unsigned long period = SERIAL_TELEMETRY_DEFAULT_PERIOD_MS;
+    char verb[8] = {0};
+
+    if (sscanf(line, "ct %7s %lu", verb, &period) < 1) return;
+    if (strcmp(verb, "start") == 0) {
+        serial_telemetry_start((uint32_t)period);
+    } else if (strcmp(verb, "stop") == 0) {
+        serial_telemetry_stop();
+    }
+}
+
+static void command_task(void *arg)
+{
+    char line[32];
+    size_t len = 0;
+
+    while (1) {
+        uint8_t c;
+        // blocks until the host sends something: no periodic wakeups while idle
+        if (usb_serial_jtag_read_bytes(&c, 1, portMAX_DELAY) != 1) continue;
+
+        if (c == '\n' || c == '\r') {
+            line[len] = '\0';
+            if (len) handle_command(line);
+            len = 0;
+        } else if (len + 1 < sizeof(line)) {
+            line[len++] = (char)c;
+        } else {
+            len = 0;    // overlong line, not a command
+        }
+    }
+}
+
+// ====================== PUBLIC API ======================
+
+esp_err_t serial_telemetry_init(void)
+{
+    if (usb_serial_jtag_is_driver_installed()) return ESP_OK;
+
+    usb_serial_jtag_driver_config_t cfg = USB_SERIAL_JTAG_DRIVER_CONFIG_DEFAULT();
+    cfg.tx_buffer_size = SERIAL_TELEMETRY_TX_BUFFER;
+    esp_err_t err = usb_serial_jtag_driver_install(&cfg);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "usb_serial_jtag_driver_install failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    // console output now goes through the same driver queue as the frames
+    usb_serial_jtag_vfs_use_driver();
+
+    if (xTaskCreate(command_task, "serial_cmd", 2048, NULL, 2, NULL) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Serial telemetry ready (send \"ct start\" on the USB console)");
+    return ESP_OK;
+}
+
+esp_err_t serial_telemetry_start(uint32_t period_ms)
+{
+    if (period_ms < SERIAL_TELEMETRY_MIN_PERIOD_MS || period_ms > SERIAL_TELEMETRY_MAX_PERIOD_MS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!usb_serial_jtag_is_driver_installed()) return ESP_ERR_INVALID_STATE;
+
+    s_period_ms = period_ms;
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.period_ms = period_ms;
+    portEXIT_CRITICAL(&s_stats_lock);
+    if (s_running) return ESP_OK;       // period change only
+
+    s_running = true;
+    if (xTaskCreate(stream_task, "serial_tel", 3072, NULL, 4, &s_stream_task) != pdPASS) {
+        s_running = false;
+        return ESP_ERR_NO_MEM;
+    }
+    s_stats.enabled = true;
+    telemetry_notify_change();          // keep the pressure reading fresh
+    return ESP_OK;
+}
+
+void serial_telemetry_stop(void)
+{
+    if (!s_running) return;
+
+    s_running = false;
+    while (s_stream_task) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    s_stats.enabled = false;
+}
+
+bool serial_telemetry_active(void)
+{
+    return s_running;
+}
+
+void serial_telemetry_get_stats(SerialTelemetryStats *out)
+{
+    if (!out) return;
+
+    portENTER_CRITICAL(&s_stats_lock);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_stats_lock);
+    out->period_ms = s_period_ms;
+}
@@ -0,0 +1,67 @@
+// serial_telemetry.h
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Binary telemetry over the USB-Serial-JTAG console for bench rigs without
+// Wi-Fi. Samples go out at up to 100 Hz (one tick), output edges carry the
+// executor's own write timestamps, and phase changes are sent as events.
+// Log text keeps flowing on the same port; frames are delimited so a
+// decoder can tell the two apart.
+// Decoder: tools/serial_telemetry_rx.py   pty stand-in: tools/serial_telemetry_standin.py
+//
+// Host control (one text line on the serial port):
+//   "ct start [period_ms]\n"   "ct stop\n"
+//
+// Framing: 0x00, COBS(frame), 0x00. Frame (little endian, version 1):
+//   off len
+//    0   1  type
+//    1   2  sequence number (+1 per frame, all types; gaps = frames dropped on the device)
+//    3   4  device time (µs, wraps)
+//    7   n  body
+//   7+n  2  CRC-16/CCITT-FALSE of bytes 0..6+n
+//
+// Bodies:
+//   SAMPLE  (1): rpm f32, pressure Hz f32, outputs u16 (bit i = pin i, 1 = OFF),
+//                phase index u8 (1-based, 0 idle), flags u8 (bit0 running, bit1 alarm,
+//                bit2 pressure updated since the previous sample)
+//   EDGE    (2): changed u16, outputs u16 (same bit order); time is the register write
+//   PHASE   (3): event u8 (0 cycle start, 1 phase start, 2 cycle end, 3 alarm),
+//                index u8, total u8, name length u8, name
+//   STATUS  (4): version u8, period ms u16, dropped frames u32, lost edges u32,
+//                pin count u8, GPIO number of pin i (u8 each); sent once a second
+
+#define SERIAL_TELEMETRY_VERSION            1
+#define SERIAL_TELEMETRY_DEFAULT_PERIOD_MS  10
+#define SERIAL_TELEMETRY_MIN_PERIOD_MS      10      // one FreeRTOS tick
+#define SERIAL_TELEMETRY_MAX_PERIOD_MS      1000
+#define SERIAL_TELEMETRY_TX_BUFFER          4096    // driver ring; a full ring drops frames
+#define SERIAL_TELEMETRY_NAME_MAX           32
+
+typedef enum {
+    SERIAL_FRAME_SAMPLE = 1,
+    SERIAL_FRAME_EDGE   = 2,
+    SERIAL_FRAME_PHASE  = 3,
+    SERIAL_FRAME_STATUS = 4,
+} SerialFrameType;
+
+typedef struct {
+    bool     enabled;
+    uint32_t period_ms;
+    uint32_t frames;        // frames written
+    uint32_t bytes;
+    uint32_t dropped;       // frames not accepted by the driver (host not reading)
+    uint32_t lost_edges;    // edges overwritten in the executor log before being read
+} SerialTelemetryStats;
+
+// Install the USB-Serial-JTAG driver and listen for "ct" commands (stream stays off)
+esp_err_t serial_telemetry_init(void);
+
+esp_err_t serial_telemetry_start(uint32_t period_ms);
+void serial_telemetry_stop(void);
+bool serial_telemetry_active(void);
+
+void serial_telemetry_get_stats(SerialTelemetryStats *out);
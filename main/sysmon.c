@@ -0,0 +1,211 @@
+// sysmon.c
+#include "sysmon.h"
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include "sdkconfig.h"
+
+#if !CONFIG_FREERTOS_USE_TRACE_FACILITY || !CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+#error "sysmon needs CONFIG_FREERTOS_USE_TRACE_FACILITY and CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS"
+#endif
+
+static const char *TAG = "sysmon";
+
+// Per-task history, matched across samples by xTaskNumber
+typedef struct {
+    bool        used;
+    bool        seen;                           // present in the current sample
+    UBaseType_t task_number;
+    uint32_t    last_counter;
+    uint32_t    deltas[SYSMON_LONG_WINDOW];     // run-time counter deltas, ring
+} TaskHistory;
+
+static TaskHistory s_hist[SYSMON_MAX_TASKS];
+static uint32_t s_total_deltas[SYSMON_LONG_WINDOW];
+static uint32_t s_last_total = 0;
+static size_t s_ring_pos = 0;
+static size_t s_samples = 0;       // samples in the ring (0 until the baseline is taken)
+static bool s_baseline = false;
+
+static TaskStatus_t s_status[SYSMON_MAX_TASKS];
+static SysmonSnapshot s_latest;
+static bool s_have_latest = false;
+static SemaphoreHandle_t s_mutex = NULL;
+
+static sysmon_callback_t s_callback = NULL;
+static uint32_t s_publish_ms = 5000;
+
+static TaskHistory *history_for(UBaseType_t task_number, uint32_t counter)
+{
+    TaskHistory *free_slot = NULL;
+    for (size_t i = 0; i < SYSMON_MAX_TASKS; i++) {
+        if (s_hist[i].used && s_hist[i].task_number == task_number) return &s_hist[i];
+        if (!s_hist[i].used && !free_slot) free_slot = &s_hist[i];
+    }
+    if (!free_slot) return NULL;
+
+    // new task: its first delta counts from now
+    memset(free_slot, 0, sizeof(*free_slot));
+    free_slot->used = true;
+    free_slot->task_number = task_number;
+    free_slot->last_counter = counter;
+    return free_slot;
+}
+
+static uint32_t window_sum(const uint32_t *ring, size_t n)
+{
+    uint32_t sum = 0;
+    for (size_t i = 0; i < n; i++) sum += ring[i];
+    return sum;
+}
+
+static char state_char(eTaskState st)
+{
+    switch (st) {
+        case eRunning:   return 'R';
+        case eReady:     return 'r';
+        case eBlocked:   return 'B';
+        case eSuspended: return 'S';
+        default:         return 'D';
+    }
+}
+
+// Returns false while only the counter baselines are being recorded
+static bool take_sample(SysmonSnapshot *snap)
+{
+    uint32_t total = 0;
+    UBaseType_t n = uxTaskGetSystemState(s_status, SYSMON_MAX_TASKS, &total);
+    if (n == 0) {
+        ESP_LOGW(TAG, "More than %d tasks, sample skipped", SYSMON_MAX_TASKS);
+        return false;
+    }
+
+    if (!s_baseline) {
+        s_last_total = total;
+        for (UBaseType_t i = 0; i < n; i++) {
+            history_for(s_status[i].xTaskNumber, s_status[i].ulRunTimeCounter);
+        }
+        s_baseline = true;
+        return false;
+    }
+
+    // counters are 32-bit µs and wrap every ~71 min; unsigned deltas handle that
+    uint32_t total_delta = total - s_last_total;
+    s_last_total = total;
+    s_total_deltas[s_ring_pos] = total_delta;
+    size_t window = (s_samples + 1 < SYSMON_LONG_WINDOW) ? s_samples + 1 : SYSMON_LONG_WINDOW;
+    uint32_t total_long = window_sum(s_total_deltas, window);
+
+    for (size_t i = 0; i < SYSMON_MAX_TASKS; i++) s_hist[i].seen = false;
+
+    memset(snap, 0, sizeof(*snap));
+    snap->timestamp_ms = esp_timer_get_time() / 1000;
+    float idle_pct = 0, idle_pct_long = 0;
+
+    for (UBaseType_t i = 0; i < n; i++) {
+        const TaskStatus_t *ts = &s_status[i];
+        TaskHistory *h = history_for(ts->xTaskNumber, ts->ulRunTimeCounter);
+        if (!h) continue;
+        h->seen = true;
+
+        h->deltas[s_ring_pos] = ts->ulRunTimeCounter - h->last_counter;
+        h->last_counter = ts->ulRunTimeCounter;
+
+        SysmonTask *out = &snap->tasks[snap->num_tasks++];
+        strncpy(out->name, ts->pcTaskName, sizeof(out->name) - 1);
+        out->priority = ts->uxCurrentPriority;
+        out->stack_free_min = ts->usStackHighWaterMark;   // bytes on ESP-IDF
+        out->state = state_char(ts->eCurrentState);
+        out->cpu_pct = total_delta ? 100.0f * h->deltas[s_ring_pos] / total_delta : 0;
+        out->cpu_pct_long = total_long ? 100.0f * window_sum(h->deltas, window) / total_long : 0;
+
+        if (strncmp(ts->pcTaskName, "IDLE", 4) == 0) {
+            idle_pct += out->cpu_pct;
+            idle_pct_long += out->cpu_pct_long;
+        }
+    }
+
+    // forget tasks that were deleted
+    for (size_t i = 0; i < SYSMON_MAX_TASKS; i++) {
+        if (s_hist[i].used && !s_hist[i].seen) s_hist[i].used = false;
+    }
+
+    snap->cpu_busy_pct = 100.0f - idle_pct;
+    snap->cpu_busy_pct_long = 100.0f - idle_pct_long;
+    snap->free_heap = esp_get_free_heap_size();
+    snap->min_free_heap = esp_get_minimum_free_heap_size();
+
+    s_ring_pos = (s_ring_pos + 1) % SYSMON_LONG_WINDOW;
+    s_samples++;
+    return true;
+}
+
+static void sysmon_task(void *arg)
+{
+    static SysmonSnapshot snap;
+    uint32_t since_publish_ms = 0;
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (1) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(SYSMON_SAMPLE_MS));
+        if (!take_sample(&snap)) continue;
+
+        if (xSemaphoreTake(s_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            s_latest = snap;
+            s_have_latest = true;
+            xSemaphoreGive(s_mutex);
+        }
+
+        since_publish_ms += SYSMON_SAMPLE_MS;
+        if (s_callback && since_publish_ms >= s_publish_ms) {
+            since_publish_ms = 0;
+            s_callback(&snap);
+        }
+    }
+}
+
+void sysmon_init(void)
+{
+    if (s_mutex) return;
+
+    s_mutex = xSemaphoreCreateMutex();
+    if (!s_mutex) {
+        ESP_LOGE(TAG, "Failed to create sysmon mutex");
+        return;
+    }
+
+    // lowest useful priority: sampling must not disturb what it measures
+    if (xTaskCreate(sysmon_task, "sysmon", 3072, NULL, 1, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create sysmon task");
+        return;
+    }
+    ESP_LOGI(TAG, "Runtime stats collector started (sample %d ms, long window %d s)",
+             SYSMON_SAMPLE_MS, SYSMON_LONG_WINDOW * SYSMON_SAMPLE_MS / 1000);
+}
+
+bool sysmon_get_latest(SysmonSnapshot *out)
+{
+    if (!s_mutex) return false;
+
+    bool ok = false;
+    if (xSemaphoreTake(s_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        if (s_have_latest) {
+            *out = s_latest;
+            ok = true;
+        }
+        xSemaphoreGive(s_mutex);
+    }
+    return ok;
+}
+
+void sysmon_set_callback(sysmon_callback_t callback, uint32_t publish_ms)
+{
+    s_publish_ms = publish_ms;
+    s_callback = callback;
+    ESP_LOGI(TAG, "Sysmon publishing %s (every %lu ms)", callback ? "enabled" : "disabled",
+             (unsigned long)publish_ms);
+}
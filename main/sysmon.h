@@ -0,0 +1,45 @@
+// sysmon.h
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Runtime statistics collector: samples FreeRTOS run-time counters once per
+// second and keeps per-task CPU% over a short (last sample) and a long
+// (SYSMON_LONG_WINDOW samples) sliding window, plus stack high-water marks.
+// Needs CONFIG_FREERTOS_USE_TRACE_FACILITY and CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS.
+
+#define SYSMON_MAX_TASKS      20
+#define SYSMON_SAMPLE_MS      1000
+#define SYSMON_LONG_WINDOW    10    // samples in the long window (10 s)
+
+typedef struct {
+    char     name[configMAX_TASK_NAME_LEN];
+    uint32_t priority;
+    uint32_t stack_free_min;    // stack high-water mark (bytes never used)
+    float    cpu_pct;           // last sample
+    float    cpu_pct_long;      // long window
+    char     state;             // R(unning) r(eady) B(locked) S(uspended) D(eleted)
+} SysmonTask;
+
+typedef struct {
+    uint64_t   timestamp_ms;
+    uint8_t    num_tasks;
+    SysmonTask tasks[SYSMON_MAX_TASKS];
+    float      cpu_busy_pct;        // 100 - IDLE, last sample
+    float      cpu_busy_pct_long;   // 100 - IDLE, long window
+    uint32_t   free_heap;
+    uint32_t   min_free_heap;
+} SysmonSnapshot;
+
+// Start the sampling task (low priority)
+void sysmon_init(void);
+
+// Latest snapshot (safe from any task); false until the first full sample
+bool sysmon_get_latest(SysmonSnapshot *out);
+
+// Called from the sysmon task every publish_ms with a fresh snapshot (NULL disables)
+typedef void (*sysmon_callback_t)(const SysmonSnapshot *snap);
+void sysmon_set_callback(sysmon_callback_t callback, uint32_t publish_ms);
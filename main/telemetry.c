@@ -1,8 +1,15 @@
 // telemetry.c
 #include "telemetry.h"
 #include "cycle.h"
+#include "executor.h"
+#include "motor_mon.h"
+#include "imbalance.h"
+#include "flow_meter.h"
 #include "rpm_sensor.h"
 #include "pressure_sensor.h"
+#include "serial_telemetry.h"
+#include <math.h>
+#include <string.h>
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "driver/gpio.h"
@@ -20,6 +27,18 @@ static telemetry_callback_t g_telemetry_callback = NULL;
 static uint32_t g_update_interval_ms = 100;
 static bool g_telemetry_running = false;
 
+// Demand / adaptive rate
+static telemetry_subscribers_fn_t g_subscribers_fn = NULL;
+static volatile int64_t g_fast_until_us = 0;    // fast rate held until (esp_timer µs)
+static TelemetryStats g_stats = {0};
+static uint64_t g_publish_us_total = 0;
+static int64_t g_start_us = 0;
+
+// Sensor movement below this counts as stable when idle
+#define TELEMETRY_RPM_DELTA          10.0f
+#define TELEMETRY_PRESS_DELTA_HZ     5.0f
+#define TELEMETRY_STABLE_SAMPLES     3       // unchanged wakeups before backing off to idle rate
+
 // GPIO pin list (from cycle.h)
 extern const gpio_num_t all_pins[NUM_COMPONENTS];
 extern int gpio_shadow[NUM_COMPONENTS];
@@ -39,6 +58,7 @@ extern Phase g_phases[MAX_PHASES];
  */
 static void gather_gpio_telemetry(GpioTelemetry *gpio_tel)
 {
+    executor_sync_shadow();
     gpio_tel->num_pins = NUM_COMPONENTS;
     gpio_tel->timestamp_ms = esp_timer_get_time() / 1000;
 
@@ -58,6 +78,14 @@ static void gather_sensor_telemetry(SensorTelemetry *sensor_tel)
     
     // Read pressure frequency (Hz) from the pressure_sensor module
     sensor_tel->pressure_freq = pressure_sensor_read_frequency();
+
+    // Spin imbalance (cheap unless half a window of new tach intervals arrived)
+    ImbalanceResult ir;
+    imbalance_get(&ir);
+    sensor_tel->imbalance_valid = ir.valid;
+    sensor_tel->imbalance_pm = ir.valid ? ir.imbalance_pm : 0;
+
+    sensor_tel->flow_lpm = flow_meter_rate_lpm();
     
     sensor_tel->sensor_error = false;
     sensor_tel->timestamp_ms = esp_timer_get_time() / 1000;
@@ -84,46 +112,193 @@ static void gather_cycle_telemetry(CycleTelemetry *cycle_tel)
     
     // Use phase-relative time for timestamp (0 = start of phase)
     cycle_tel->timestamp_ms = elapsed_us / 1000;
+
+    // Deadline monitor (current or last cycle)
+    DeadlineStats ds;
+    executor_deadline_stats(&ds);
+    cycle_tel->deadline_alarm = ds.safe_tripped;
+    cycle_tel->alarm_pin = ds.trip_pin;
+    cycle_tel->alarm_late_us = ds.trip_late_us;
+    cycle_tel->deadline_misses = ds.misses[DEADLINE_CLASS_NORMAL] + ds.misses[DEADLINE_CLASS_CRITICAL];
+
+    MotorMonStats mm;
+    motor_mon_stats(&mm);
+    cycle_tel->motor_fault = (uint8_t)mm.fault;
+    cycle_tel->motor_fault_late_us = mm.fault_late_us;
+    cycle_tel->phase_volume_ml = cycle_phase_volume_ml(0);
+
+    // Per-track state for concurrent tracks
+    cycle_tel->num_tracks = 0;
+    for (size_t t = 0; cycle_running && t < g_num_tracks && t < MAX_TELEMETRY_TRACKS; t++) {
+        TrackRun *tr = executor_track(t);
+        TrackTelemetry *tt = &cycle_tel->tracks[t];
+        tt->track_id = g_tracks[t].id ? g_tracks[t].id : "main";
+        tt->active = tr->active;
+        tt->phase_index = (tr->phase_index >= 0) ? (uint32_t)tr->phase_index + 1 : 0;
+        tt->phase_name = (tr->phase_index >= 0 && g_phases[tr->phase_index].id) ? g_phases[tr->phase_index].id : "N/A";
+        tt->phase_elapsed_ms = (tr->active && now_us >= tr->phase_start_us) ? (now_us - tr->phase_start_us) / 1000 : 0;
+        cycle_tel->num_tracks++;
+    }
 }
 
 // NOTE: Sensor trigger logic has been moved to cycle.c (check_phase_sensor_trigger)
 // This keeps cycle control logic in the cycle task, making it independent of telemetry
 
+// ====================== ADAPTIVE RATE ======================
+
+/**
+ * Fill/spin style phase: sensor trigger pending or motor driven
+ */
+static bool phase_is_dynamic(int idx)
+{
+    if (idx < 0 || (size_t)idx >= g_num_phases) return false;
+    const Phase *ph = &g_phases[idx];
+    if (ph->sensor_trigger) return true;
+    for (size_t c = 0; c < ph->num_components; c++) {
+        if (ph->components[c].has_motor) return true;
+    }
+    return false;
+}
+
+/**
+ * Did anything a client would want to see promptly change since the last wakeup?
+ * Sensors are only compared when both packets sampled them.
+ */
+static bool packet_changed(const TelemetryPacket *prev, const TelemetryPacket *cur, bool compare_sensors)
+{
+    if (prev->cycle.cycle_running != cur->cycle.cycle_running ||
+        prev->cycle.current_phase_index != cur->cycle.current_phase_index ||
+        prev->cycle.deadline_alarm != cur->cycle.deadline_alarm ||
+        prev->cycle.motor_fault != cur->cycle.motor_fault ||
+        prev->cycle.num_tracks != cur->cycle.num_tracks) {
+        return true;
+    }
+    for (int i = 0; i < cur->gpio.num_pins && i < MAX_GPIO_PINS; i++) {
+        if (prev->gpio.pins[i].state != cur->gpio.pins[i].state) return true;
+    }
+    for (int t = 0; t < cur->cycle.num_tracks; t++) {
+        if (prev->cycle.tracks[t].phase_index != cur->cycle.tracks[t].phase_index) return true;
+    }
+    if (compare_sensors) {
+        if (fabsf(prev->sensors.rpm - cur->sensors.rpm) > TELEMETRY_RPM_DELTA ||
+            fabsf(prev->sensors.pressure_freq - cur->sensors.pressure_freq) > TELEMETRY_PRESS_DELTA_HZ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static TelemetryRate choose_rate(const TelemetryPacket *packet, uint32_t subscribers, uint32_t stable_count)
+{
+    if (subscribers == 0) return TELEMETRY_RATE_IDLE;
+    if (esp_timer_get_time() < g_fast_until_us) return TELEMETRY_RATE_FAST;
+
+    if (packet->cycle.cycle_running) {
+        for (size_t t = 0; t < g_num_tracks; t++) {
+            TrackRun *tr = executor_track(t);
+            if (tr->active && phase_is_dynamic(tr->phase_index)) return TELEMETRY_RATE_FAST;
+        }
+        return TELEMETRY_RATE_BASE;
+    }
+
+    return (stable_count >= TELEMETRY_STABLE_SAMPLES) ? TELEMETRY_RATE_IDLE : TELEMETRY_RATE_BASE;
+}
+
+static uint32_t rate_interval_ms(TelemetryRate rate)
+{
+    switch (rate) {
+    case TELEMETRY_RATE_FAST:
+        return (g_update_interval_ms < TELEMETRY_FAST_INTERVAL_MS) ? g_update_interval_ms : TELEMETRY_FAST_INTERVAL_MS;
+    case TELEMETRY_RATE_IDLE:
+        return (g_update_interval_ms > TELEMETRY_IDLE_INTERVAL_MS) ? g_update_interval_ms : TELEMETRY_IDLE_INTERVAL_MS;
+    default:
+        return g_update_interval_ms;
+    }
+}
+
 // ====================== BACKGROUND TASK ======================
 
 /**
- * The telemetry gathering task runs at regular intervals
- * Collects GPIO, sensor, and cycle data into a single packet
+ * The telemetry gathering task runs at an adaptive interval
+ * Collects GPIO, sensor, and cycle data into a single packet; the sensor reads
+ * (pressure blocks for ~100 ms+) and the callback only run when someone listens
  */
 static void telemetry_task(void *pvParameter)
 {
     ESP_LOGI(TAG, "Telemetry task started (update interval: %u ms)", g_update_interval_ms);
+    TickType_t last_wake = xTaskGetTickCount();
+    static TelemetryPacket prev = {0};
+    bool prev_has_sensors = false;
+    uint32_t stable_count = 0;
 
     while (g_telemetry_running) {
+        uint32_t subscribers = g_subscribers_fn ? g_subscribers_fn() : 1;
+
         // Gather all telemetry
         TelemetryPacket packet = {0};
         packet.packet_timestamp_ms = esp_timer_get_time() / 1000;
 
         gather_gpio_telemetry(&packet.gpio);
-        gather_sensor_telemetry(&packet.sensors);
         gather_cycle_telemetry(&packet.cycle);
 
         // NOTE: Sensor trigger logic has been moved to cycle.c for robustness
         // Telemetry now only gathers and reports data, cycle task handles control logic
 
+        int64_t t0 = esp_timer_get_time();
+        if (subscribers > 0) {
+            gather_sensor_telemetry(&packet.sensors);
+        } else {
+            packet.sensors = prev.sensors;  // last sampled values, not re-read
+        }
+
         // Update the latest snapshot (thread-safe)
         if (xSemaphoreTake(telemetry_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
             g_telemetry_latest = packet;
             xSemaphoreGive(telemetry_mutex);
         }
 
-        // Call user callback if registered
-        if (g_telemetry_callback) {
+        // Call user callback if registered (nobody to serialize for otherwise)
+        if (subscribers > 0 && g_telemetry_callback) {
             g_telemetry_callback(&packet);
         }
 
-        // Log to console only when cycle is running (GPIO states, cycle info, RPM, pressure frequency)
-        if (packet.cycle.cycle_running) {
+        bool published = (subscribers > 0);
+        if (published) {
+            g_publish_us_total += (uint64_t)(esp_timer_get_time() - t0);
+        }
+
+        if (packet_changed(&prev, &packet, published && prev_has_sensors)) {
+            g_fast_until_us = esp_timer_get_time() + (int64_t)TELEMETRY_TRANSITION_HOLD_MS * 1000;
+            stable_count = 0;
+        } else {
+            stable_count++;
+        }
+        prev = packet;
+        prev_has_sensors = published;
+
+        TelemetryRate rate = choose_rate(&packet, subscribers, stable_count);
+        uint32_t interval_ms = rate_interval_ms(rate);
+
+        if (xSemaphoreTake(telemetry_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            g_stats.wakeups++;
+            if (published) {
+                g_stats.published++;
+                g_stats.avg_publish_us = (uint32_t)(g_publish_us_total / g_stats.published);
+            } else {
+                g_stats.skipped++;
+            }
+            if (rate != g_stats.rate) {
+                ESP_LOGD(TAG, "rate -> %lu ms (%lu subscriber(s))", (unsigned long)interval_ms, (unsigned long)subscribers);
+            }
+            g_stats.rate = rate;
+            g_stats.interval_ms = interval_ms;
+            g_stats.subscribers = subscribers;
+            xSemaphoreGive(telemetry_mutex);
+        }
+
+        // Log to console only when cycle is running (GPIO states, cycle info, RPM, pressure frequency);
+        // the binary serial stream replaces these lines while it is on
+        if (published && packet.cycle.cycle_running && !serial_telemetry_active()) {
             printf("[%lu ms] GPIO: ", packet.cycle.phase_elapsed_ms);
             for (int i = 0; i < packet.gpio.num_pins; i++) {
                 printf("%d:%d ", packet.gpio.pins[i].pin_number, packet.gpio.pins[i].state);
@@ -136,9 +311,11 @@ static void telemetry_task(void *pvParameter)
                    packet.sensors.pressure_freq);
         }
 
-        // Wait for next update interval, yielding to allow other tasks (especially IDLE watchdog)
-        vTaskDelay(pdMS_TO_TICKS(g_update_interval_ms));
-        taskYIELD();  // Explicitly yield to prevent starving IDLE task
+        // Wait for the next update; telemetry_notify_change() cuts the wait short
+        TickType_t interval = pdMS_TO_TICKS(interval_ms);
+        TickType_t elapsed = xTaskGetTickCount() - last_wake;
+        ulTaskNotifyTake(pdTRUE, (elapsed < interval) ? interval - elapsed : 0);
+        last_wake = xTaskGetTickCount();
     }
 
     ESP_LOGI(TAG, "Telemetry task stopped");
@@ -156,6 +333,7 @@ void telemetry_init(uint32_t update_interval_ms)
 
     g_update_interval_ms = update_interval_ms;
     g_telemetry_running = true;
+    g_start_us = esp_timer_get_time();
 
     // Create mutex for thread-safe access to g_telemetry_latest
     telemetry_mutex = xSemaphoreCreateMutex();
@@ -185,6 +363,7 @@ void telemetry_stop(void)
     }
 
     g_telemetry_running = false;
+    xTaskNotifyGive(telemetry_task_handle);  // don't wait out an idle interval
     vTaskDelay(pdMS_TO_TICKS(200));  // give task time to exit
     telemetry_task_handle = NULL;
 
@@ -216,6 +395,38 @@ void telemetry_set_callback(telemetry_callback_t callback)
     ESP_LOGI(TAG, "Telemetry callback %s", callback ? "registered" : "unregistered");
 }
 
+void telemetry_set_subscriber_fn(telemetry_subscribers_fn_t fn)
+{
+    g_subscribers_fn = fn;
+}
+
+void telemetry_notify_change(void)
+{
+    g_fast_until_us = esp_timer_get_time() + (int64_t)TELEMETRY_TRANSITION_HOLD_MS * 1000;
+    if (telemetry_task_handle) {
+        xTaskNotifyGive(telemetry_task_handle);
+    }
+}
+
+void telemetry_get_stats(TelemetryStats *out)
+{
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (!telemetry_mutex) return;
+
+    if (xSemaphoreTake(telemetry_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        *out = g_stats;
+        xSemaphoreGive(telemetry_mutex);
+    }
+
+    // What publishing every packet at the fixed base interval would have cost
+    uint64_t up_ms = (uint64_t)(esp_timer_get_time() - g_start_us) / 1000;
+    out->base_wakeups = g_update_interval_ms ? (uint32_t)(up_ms / g_update_interval_ms) : 0;
+    if (out->base_wakeups > out->published) {
+        out->saved_ms = (uint32_t)((uint64_t)(out->base_wakeups - out->published) * out->avg_publish_us / 1000);
+    }
+}
+
 void telemetry_update_sensor(const SensorTelemetry *sensor_data)
 {
     if (!sensor_data || !telemetry_mutex) return;
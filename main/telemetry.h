@@ -26,9 +26,23 @@ typedef struct {
     float rpm;              // motor RPM from rpm_sensor
     float pressure_freq;    // pressure frequency (Hz) from pressure_sensor
     bool sensor_error;
+    bool imbalance_valid;   // a steady spin window was analysed
+    uint16_t imbalance_pm;  // drum-frequency speed ripple, per-mille
+    float flow_lpm;         // water flow from the flow meter (L/min)
     uint64_t timestamp_ms;
 } SensorTelemetry;
 
+// Per-track phase state (only meaningful when a cycle has several tracks)
+#define MAX_TELEMETRY_TRACKS 3
+
+typedef struct {
+    const char *track_id;
+    uint32_t phase_index;           // 1-based, 0 when the track is idle
+    const char *phase_name;
+    uint32_t phase_elapsed_ms;
+    bool active;
+} TrackTelemetry;
+
 // Current cycle and phase information
 typedef struct {
     bool cycle_running;
@@ -39,6 +53,15 @@ typedef struct {
     uint32_t phase_total_duration_ms;
     uint64_t cycle_start_time_ms;
     uint64_t timestamp_ms;
+    TrackTelemetry tracks[MAX_TELEMETRY_TRACKS];
+    uint8_t num_tracks;
+    bool deadline_alarm;            // a critical deadline was missed, outputs forced OFF
+    int alarm_pin;                  // GPIO that tripped it (-1 if none)
+    int32_t alarm_late_us;
+    uint32_t deadline_misses;       // all classes, current/last cycle
+    uint8_t motor_fault;            // MotorFault of the current/last cycle (0 = none)
+    uint32_t motor_fault_late_us;   // detection - window expiry
+    uint32_t phase_volume_ml;       // water metered since the main track's phase started
 } CycleTelemetry;
 
 // Unified telemetry packet (all data in one snapshot)
@@ -49,6 +72,32 @@ typedef struct {
     uint64_t packet_timestamp_ms;
 } TelemetryPacket;
 
+// Adaptive rate: fast around phase transitions and in fill/spin phases (sensor
+// trigger or motor), the base interval otherwise, and backed off while idle and
+// stable. With no subscribers only cycle/GPIO state is refreshed - no sensor
+// reads, no callback - at the idle interval.
+#define TELEMETRY_FAST_INTERVAL_MS      250
+#define TELEMETRY_IDLE_INTERVAL_MS      5000
+#define TELEMETRY_TRANSITION_HOLD_MS    3000    // stay fast this long after a change
+
+typedef enum {
+    TELEMETRY_RATE_IDLE,
+    TELEMETRY_RATE_BASE,
+    TELEMETRY_RATE_FAST
+} TelemetryRate;
+
+typedef struct {
+    TelemetryRate rate;
+    uint32_t interval_ms;           // current interval
+    uint32_t subscribers;           // at the last wakeup
+    uint32_t wakeups;               // task wakeups since init
+    uint32_t base_wakeups;          // wakeups a fixed base interval would have made
+    uint32_t published;             // packets handed to the callback
+    uint32_t skipped;               // wakeups with no subscriber (no sensor read, no callback)
+    uint32_t avg_publish_us;        // sensor read + callback per published packet
+    uint32_t saved_ms;              // estimate: time not spent publishing (skipped + fewer wakeups)
+} TelemetryStats;
+
 // ====================== API ======================
 
 /**
@@ -78,6 +127,24 @@ TelemetryPacket telemetry_get_latest(void);
 typedef void (*telemetry_callback_t)(const TelemetryPacket *packet);
 void telemetry_set_callback(telemetry_callback_t callback);
 
+/**
+ * Register the function that reports how many clients want telemetry
+ * Without one every wakeup publishes
+ */
+typedef uint32_t (*telemetry_subscribers_fn_t)(void);
+void telemetry_set_subscriber_fn(telemetry_subscribers_fn_t fn);
+
+/**
+ * Wake the telemetry task now and hold the fast rate for a while
+ * (phase transitions, cycle start/stop, new client). Safe from any task
+ */
+void telemetry_notify_change(void);
+
+/**
+ * Rate and publish counters since init
+ */
+void telemetry_get_stats(TelemetryStats *out);
+
 /**
  * For manual sensor updates (e.g., from an ADC reading task)
  * Thread-safe
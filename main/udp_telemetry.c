@@ -0,0 +1,180 @@
+// udp_telemetry.c
+#include "udp_telemetry.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "lwip/sockets.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "udp_tel";
+
+static SemaphoreHandle_t s_lock = NULL;     // socket + status (httpd task vs telemetry task)
+static int s_sock = -1;
+static struct sockaddr_in s_dest;
+static UdpTelemetryStatus s_status = {0};
+static uint8_t s_device_id[6];
+
+static inline void put_u16(uint8_t *p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+static inline void put_u32(uint8_t *p, uint32_t v) { p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24; }
+static inline void put_f32(uint8_t *p, float f) { uint32_t v; memcpy(&v, &f, 4); put_u32(p, v); }
+
+static size_t encode_packet(const TelemetryPacket *pkt, uint32_t seq, uint8_t *buf)
+{
+    const CycleTelemetry *cy = &pkt->cycle;
+    uint8_t num_pins = pkt->gpio.num_pins > MAX_GPIO_PINS ? MAX_GPIO_PINS : pkt->gpio.num_pins;
+    uint8_t num_tracks = cy->num_tracks > MAX_TELEMETRY_TRACKS ? MAX_TELEMETRY_TRACKS : cy->num_tracks;
+    const char *name = cy->current_phase_name ? cy->current_phase_name : "";
+    size_t name_len = strnlen(name, UDP_TELEMETRY_NAME_MAX);
+
+    uint16_t states = 0;
+    for (int i = 0; i < num_pins; i++) {
+        if (pkt->gpio.pins[i].state) states |= (uint16_t)(1u << i);
+    }
+
+    buf[0] = 'C';
+    buf[1] = 'T';
+    buf[2] = UDP_TELEMETRY_VERSION;
+    buf[3] = (cy->cycle_running ? 0x01 : 0) | (cy->deadline_alarm ? 0x02 : 0) | (pkt->sensors.sensor_error ? 0x04 : 0) |
+             (cy->motor_fault ? 0x08 : 0);
+    put_u32(&buf[4], seq);
+    put_u32(&buf[8], (uint32_t)pkt->packet_timestamp_ms);
+    memcpy(&buf[12], s_device_id, 6);
+    buf[18] = num_pins;
+    buf[19] = num_tracks;
+    put_u16(&buf[20], states);
+    put_f32(&buf[22], pkt->sensors.rpm);
+    put_f32(&buf[26], pkt->sensors.pressure_freq);
+    put_u16(&buf[30], (uint16_t)cy->current_phase_index);
+    put_u16(&buf[32], (uint16_t)cy->total_phases);
+    put_u32(&buf[34], cy->phase_elapsed_ms);
+    put_u16(&buf[38], cy->deadline_misses > UINT16_MAX ? UINT16_MAX : (uint16_t)cy->deadline_misses);
+    buf[40] = (uint8_t)(int8_t)(cy->deadline_alarm ? cy->alarm_pin : -1);
+    buf[41] = (uint8_t)name_len;
+
+    size_t off = UDP_TELEMETRY_HDR_LEN;
+    for (int i = 0; i < num_pins; i++) {
+        buf[off++] = pkt->gpio.pins[i].pin_number;
+    }
+    for (int t = 0; t < num_tracks; t++) {
+        const TrackTelemetry *tt = &cy->tracks[t];
+        buf[off++] = (uint8_t)tt->phase_index;
+        buf[off++] = tt->active ? 1 : 0;
+        put_u32(&buf[off], tt->phase_elapsed_ms);
+        off += 4;
+    }
+    memcpy(&buf[off], name, name_len);
+    return off + name_len;
+}
+
+static void close_socket(void)
+{
+    if (s_sock >= 0) {
+        close(s_sock);
+        s_sock = -1;
+    }
+    s_status.enabled = false;
+}
+
+esp_err_t udp_telemetry_start(const char *addr, uint16_t port, uint8_t ttl)
+{
+    if (!addr) addr = UDP_TELEMETRY_DEFAULT_ADDR;
+    if (port == 0) port = UDP_TELEMETRY_DEFAULT_PORT;
+
+    struct sockaddr_in dest = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+    };
+    if (inet_aton(addr, &dest.sin_addr) == 0) {
+        ESP_LOGE(TAG, "invalid address: %s", addr);
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint8_t first_octet = ntohl(dest.sin_addr.s_addr) >> 24;
+    bool multicast = (first_octet >= 224 && first_octet <= 239);
+
+    if (!s_lock) {
+        s_lock = xSemaphoreCreateMutex();
+        if (!s_lock) return ESP_ERR_NO_MEM;
+        esp_read_mac(s_device_id, ESP_MAC_WIFI_STA);
+    }
+
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "socket() failed: errno %d", errno);
+        return ESP_FAIL;
+    }
+    if (multicast) {
+        uint8_t mttl = ttl;
+        setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, &mttl, sizeof(mttl));
+    } else {
+        int on = 1;
+        setsockopt(sock, SOL_SOCKET, SO_BROADCAST, &on, sizeof(on));
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    close_socket();
+    s_sock = sock;
+    s_dest = dest;
+    s_status.enabled = true;
+    s_status.multicast = multicast;
+    snprintf(s_status.addr, sizeof(s_status.addr), "%s", addr);
+    s_status.port = port;
+    s_status.ttl = ttl;
+    xSemaphoreGive(s_lock);
+
+    ESP_LOGI(TAG, "Publishing telemetry to %s:%u (%s, ttl %u)", addr, port,
+             multicast ? "multicast" : "broadcast/unicast", ttl);
+    return ESP_OK;
+}
+
+void udp_telemetry_stop(void)
+{
+    if (!s_lock) return;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    close_socket();
+    xSemaphoreGive(s_lock);
+    ESP_LOGI(TAG, "UDP telemetry stopped");
+}
+
+bool udp_telemetry_active(void)
+{
+    return s_status.enabled;
+}
+
+void udp_telemetry_publish(const TelemetryPacket *packet)
+{
+    if (!packet || !s_status.enabled || !s_lock) return;
+
+    uint8_t buf[UDP_TELEMETRY_MAX_LEN];
+    if (xSemaphoreTake(s_lock, pdMS_TO_TICKS(100)) != pdTRUE) return;
+
+    if (s_sock >= 0) {
+        uint32_t seq = s_status.seq + 1;
+        size_t len = encode_packet(packet, seq, buf);
+        if (sendto(s_sock, buf, len, 0, (struct sockaddr *)&s_dest, sizeof(s_dest)) == (int)len) {
+            s_status.sent++;
+        } else {
+            s_status.send_errors++;     // listeners see the gap in seq
+        }
+        s_status.seq = seq;
+        s_status.last_len = len;
+    }
+
+    xSemaphoreGive(s_lock);
+}
+
+void udp_telemetry_get_status(UdpTelemetryStatus *out)
+{
+    if (!out) return;
+    if (!s_lock) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *out = s_status;
+    xSemaphoreGive(s_lock);
+}
@@ -0,0 +1,68 @@
+// udp_telemetry.h
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "telemetry.h"
+
+// Optional telemetry publisher: one compact binary datagram per telemetry
+// packet, sent to a multicast group or a broadcast address. Any number of
+// passive listeners on the LAN cost the device a single send, unlike
+// WebSocket clients, which each take a socket and per-client send time.
+// Decoder: tools/udp_telemetry_rx.py
+//
+// Datagram (little endian, version 1):
+//   off len
+//    0   2  magic "CT"
+//    2   1  version
+//    3   1  flags: bit0 cycle running, bit1 deadline alarm, bit2 sensor error, bit3 motor fault
+//    4   4  sequence number (+1 per datagram, gaps = loss)
+//    8   4  device time (ms, wraps)
+//   12   6  device id (Wi-Fi STA MAC)
+//   18   1  number of pins (P)
+//   19   1  number of tracks (T)
+//   20   2  output states, bit i = state of pin i (1 = OFF, active-low)
+//   22   4  rpm (float)
+//   26   4  pressure frequency Hz (float)
+//   30   2  current phase index (1-based)
+//   32   2  total phases
+//   34   4  phase elapsed ms
+//   38   2  deadline misses (saturating)
+//   40   1  alarm pin (int8, -1 none)
+//   41   1  phase name length (N, <= UDP_TELEMETRY_NAME_MAX)
+//   42   P  GPIO number of pin i
+//   ..  6T  per track: phase index (u8), active (u8), phase elapsed ms (u32)
+//   ..   N  current phase name (not NUL-terminated)
+
+#define UDP_TELEMETRY_DEFAULT_ADDR  "239.255.67.84"
+#define UDP_TELEMETRY_DEFAULT_PORT  5684
+#define UDP_TELEMETRY_DEFAULT_TTL   1       // stay on the local segment
+#define UDP_TELEMETRY_VERSION       1
+#define UDP_TELEMETRY_HDR_LEN       42
+#define UDP_TELEMETRY_NAME_MAX      32
+#define UDP_TELEMETRY_MAX_LEN       (UDP_TELEMETRY_HDR_LEN + MAX_GPIO_PINS + 6 * MAX_TELEMETRY_TRACKS + UDP_TELEMETRY_NAME_MAX)
+
+typedef struct {
+    bool     enabled;
+    bool     multicast;
+    char     addr[16];
+    uint16_t port;
+    uint8_t  ttl;
+    uint32_t seq;           // last sequence number sent
+    uint32_t sent;
+    uint32_t send_errors;
+    uint32_t last_len;      // bytes in the last datagram
+} UdpTelemetryStatus;
+
+// Open the socket and start publishing to addr:port (IPv4 multicast group,
+// broadcast or unicast address). Restarts if already running.
+esp_err_t udp_telemetry_start(const char *addr, uint16_t port, uint8_t ttl);
+void udp_telemetry_stop(void);
+bool udp_telemetry_active(void);
+
+// Encode and send one packet (telemetry task); no-op when stopped
+void udp_telemetry_publish(const TelemetryPacket *packet);
+
+void udp_telemetry_get_status(UdpTelemetryStatus *out);
@@ -1,10 +1,15 @@
 #include "ws_cycle.h"
 
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <unistd.h>       // close() in the session close hook
 
+#include "sdkconfig.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "esp_http_server.h"
+#include "esp_heap_caps.h"
 #include "esp_https_server.h"
 #include "esp_netif.h"
 #include "esp_wifi.h"
@@ -13,9 +18,21 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
-#include "fs.h"           // fs_write_file(...)
+#include "fs.h"           // fs_write_file_scheduled(...)
 #include "cycle.h"        // cycle_load_from_json_str(...), cycle_run_loaded_cycle(...)
+#include "executor.h"     // executor_set_output(), executor mode + latency trace
 #include "telemetry.h"    // TelemetryPacket, telemetry_set_callback()
+#include "sysmon.h"       // SysmonSnapshot, sysmon_set_callback()
+#include "power.h"        // PowerStats
+#include "wscomp.h"       // LZ77 codec for compressed binary frames
+#include "wstok.h"        // in-place tokenizer for the command fast path
+#include "udp_telemetry.h" // binary datagram publisher for passive listeners
+#include "mqtt_pub.h"     // MQTT publisher with store-and-forward queue
+#include "serial_telemetry.h" // binary frames on the USB-Serial-JTAG console
+#include "actuator.h"     // actuator self-test and latency compensation
+#include "motor_mon.h"    // motor/tach fault detector
+#include "imbalance.h"    // spin ripple analysis
+#include "flow_meter.h"   // flow meter rate and calibration
 
 static const char *TAG = "ws_cycle";
 
@@ -23,6 +40,496 @@ static httpd_handle_t s_server = NULL;
 
 static uint16_t s_server_port = 0;  // Store port for external logging
 
+// Heap held while one telemetry packet is built and serialized (cJSON tree + string)
+static uint32_t s_tel_packet_heap = 0;
+static uint32_t s_tel_packet_bytes = 0;
+
+// Static cache for cycle_data structure (only updated when cycle loads, not every telemetry)
+static char *g_cycle_data_cache = NULL;
+static size_t g_cycle_data_cache_len = 0;
+
+// ====================== CLIENT KEEPALIVE ======================
+// Sockets are scarce, so a dashboard that went away without closing (laptop lid
+// shut, phone out of range) must not keep one. Every client that has been
+// silent for a ping interval gets a WS ping; browsers answer on their own. A
+// client that stays silent past WS_DEAD_AFTER_MS is closed. A client that has
+// not answered its latest ping is skipped by the broadcasts. When every session
+// is in use, httpd's LRU purge closes the least recently heard one for the
+// newcomer. Pongs refresh that order, so live idle clients are the last to go.
+// lwIP socket budget (CONFIG_LWIP_MAX_SOCKETS = 12): httpd takes these sessions
+// plus 3 internal sockets, leaving one each for the MQTT client and UDP telemetry.
+#define WS_MAX_SESSIONS          7       // max_open_sockets
+#define WS_KEEPALIVE_TICK_MS     1000
+#define WS_PING_INTERVAL_MS      4000    // ping a client silent this long (and not pinged since)
+#define WS_PONG_GRACE_MS         2000    // silent past interval + grace: skipped by broadcasts
+#define WS_DEAD_AFTER_MS         12000   // silent this long: closed
+
+typedef enum {
+    WS_CLOSE_NONE,              // not closed by us or by a client CLOSE frame
+    WS_CLOSE_REAPED,            // no frame (pong) for WS_DEAD_AFTER_MS
+    WS_CLOSE_CLIENT,            // client sent CLOSE
+    WS_CLOSE_REFUSED,           // frame refused by admission control before it was read
+} WsCloseReason;
+
+typedef struct {
+    int      fd;                // -1 when free
+    int64_t  opened_us;
+    int64_t  last_rx_us;        // last frame of any kind from the client
+    int64_t  last_ping_us;
+    uint32_t pings;             // pings sent since the last frame from the client
+    uint8_t  close_reason;      // WsCloseReason
+} WsPeer;
+
+typedef struct {
+    uint32_t opened;
+    uint32_t reaped;
+    uint32_t evicted;           // closed by the LRU purge to admit a new session
+    uint32_t client_closed;
+    uint32_t refused;
+    uint32_t dropped;           // socket error / reset by the peer
+    uint32_t pings_sent;
+    uint32_t closed;
+    uint64_t held_total_ms;     // over closed sessions
+    uint32_t held_max_ms;
+} WsPeerStats;
+
+static WsPeer s_peers[WS_MAX_SESSIONS];
+static WsPeerStats s_peer_stats;
+static portMUX_TYPE s_peer_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t s_keepalive_timer = NULL;
+
+static int peer_find(int fd)
+{
+    for (int i = 0; i < WS_MAX_SESSIONS; i++) {
+        if (s_peers[i].fd == fd) return i;
+    }
+    return -1;
+}
+
+static bool peer_live(const WsPeer *p, int64_t now)
+{
+    return now - p->last_rx_us < (int64_t)(WS_PING_INTERVAL_MS + WS_PONG_GRACE_MS) * 1000;
+}
+
+// WebSocket handshake done: start tracking the session
+static void ws_peer_open(int fd)
+{
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_peer_lock);
+    int i = peer_find(fd);
+    if (i < 0) i = peer_find(-1);
+    if (i >= 0) {
+        s_peers[i] = (WsPeer){ .fd = fd, .opened_us = now, .last_rx_us = now, .last_ping_us = now };
+        s_peer_stats.opened++;
+    }
+    portEXIT_CRITICAL(&s_peer_lock);
+}
+
+// Any frame from the client (data, ping, pong) proves it is alive
+static void ws_peer_seen(int fd)
+{
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_peer_lock);
+    int i = peer_find(fd);
+    if (i >= 0) {
+        s_peers[i].last_rx_us = now;
+        s_peers[i].pings = 0;
+    }
+    portEXIT_CRITICAL(&s_peer_lock);
+}
+
+static void ws_peer_set_reason(int fd, WsCloseReason reason)
+{
+    portENTER_CRITICAL(&s_peer_lock);
+    int i = peer_find(fd);
+    if (i >= 0 && s_peers[i].close_reason == WS_CLOSE_NONE) s_peers[i].close_reason = reason;
+    portEXIT_CRITICAL(&s_peer_lock);
+}
+
+// Session close hook (httpd task). full: every session slot was in use, so a close
+// we did not ask for is the LRU purge making room.
+static void ws_peer_closed(int fd, bool full)
+{
+    int64_t now = esp_timer_get_time();
+    uint32_t held_ms = 0;
+    uint8_t reason = WS_CLOSE_NONE;
+    bool found = false;
+
+    portENTER_CRITICAL(&s_peer_lock);
+    int i = peer_find(fd);
+    if (i >= 0) {
+        found = true;
+        reason = s_peers[i].close_reason;
+        held_ms = (uint32_t)((now - s_peers[i].opened_us) / 1000);
+        s_peers[i].fd = -1;
+
+        WsPeerStats *st = &s_peer_stats;
+        if (reason == WS_CLOSE_REAPED) st->reaped++;
+        else if (reason == WS_CLOSE_CLIENT) st->client_closed++;
+        else if (reason == WS_CLOSE_REFUSED) st->refused++;
+        else if (full) st->evicted++;
+        else st->dropped++;
+        st->closed++;
+        st->held_total_ms += held_ms;
+        if (held_ms > st->held_max_ms) st->held_max_ms = held_ms;
+    }
+    portEXIT_CRITICAL(&s_peer_lock);
+
+    if (found) {
+        static const char *names[] = { "dropped", "reaped", "closed by client", "refused a frame" };
+        ESP_LOGI(TAG, "WebSocket client fd %d %s after %lu s", fd,
+                 (reason == WS_CLOSE_NONE && full) ? "evicted" : names[reason],
+                 (unsigned long)(held_ms / 1000));
+    }
+}
+
+// Live WebSocket clients (answered their latest ping); returns the count
+static size_t ws_live_fds(int *fds)
+{
+    int64_t now = esp_timer_get_time();
+    size_t n = 0;
+    portENTER_CRITICAL(&s_peer_lock);
+    for (int i = 0; i < WS_MAX_SESSIONS; i++) {
+        if (s_peers[i].fd >= 0 && peer_live(&s_peers[i], now)) fds[n++] = s_peers[i].fd;
+    }
+    portEXIT_CRITICAL(&s_peer_lock);
+    return n;
+}
+
+// Per-client liveness and session metrics; caller frees the returned string
+static char *ws_clients_to_json(void)
+{
+    WsPeer peers[WS_MAX_SESSIONS];
+    WsPeerStats st;
+    portENTER_CRITICAL(&s_peer_lock);
+    memcpy(peers, s_peers, sizeof(peers));
+    st = s_peer_stats;
+    portEXIT_CRITICAL(&s_peer_lock);
+    int64_t now = esp_timer_get_time();
+
+    cJSON *root = cJSON_CreateObject();
+    if (!root) return NULL;
+
+    cJSON_AddStringToObject(root, "type", "ws_clients");
+    cJSON_AddNumberToObject(root, "max_sessions", WS_MAX_SESSIONS);
+    cJSON_AddNumberToObject(root, "ping_interval_ms", WS_PING_INTERVAL_MS);
+    cJSON_AddNumberToObject(root, "dead_after_ms", WS_DEAD_AFTER_MS);
+
+    cJSON *clients = cJSON_AddArrayToObject(root, "clients");
+    for (int i = 0; i < WS_MAX_SESSIONS; i++) {
+        if (peers[i].fd < 0) continue;
+        cJSON *c = cJSON_CreateObject();
+        cJSON_AddNumberToObject(c, "fd", peers[i].fd);
+        cJSON_AddNumberToObject(c, "held_s", (double)((now - peers[i].opened_us) / 1000000));
+        cJSON_AddNumberToObject(c, "idle_ms", (double)((now - peers[i].last_rx_us) / 1000));
+        cJSON_AddNumberToObject(c, "unanswered_pings", peers[i].pings);
+        cJSON_AddBoolToObject(c, "live", peer_live(&peers[i], now));
+        cJSON_AddItemToArray(clients, c);
+    }
+
+    cJSON_AddNumberToObject(root, "opened", st.opened);
+    cJSON_AddNumberToObject(root, "reaped", st.reaped);
+    cJSON_AddNumberToObject(root, "evicted", st.evicted);
+    cJSON_AddNumberToObject(root, "client_closed", st.client_closed);
+    cJSON_AddNumberToObject(root, "refused", st.refused);
+    cJSON_AddNumberToObject(root, "dropped", st.dropped);
+    cJSON_AddNumberToObject(root, "pings_sent", st.pings_sent);
+    cJSON_AddNumberToObject(root, "held_avg_s", st.closed ? (double)(st.held_total_ms / st.closed) / 1000.0 : 0);
+    cJSON_AddNumberToObject(root, "held_max_s", st.held_max_ms / 1000.0);
+
+    char *json_str = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    return json_str;
+}
+
+// Runs in the httpd task (queued by the keepalive timer): ping idle clients, close dead ones
+static void ws_keepalive_work(void *arg)
+{
+    int ping[WS_MAX_SESSIONS], reap[WS_MAX_SESSIONS];
+    size_t num_ping = 0, num_reap = 0;
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&s_peer_lock);
+    for (int i = 0; i < WS_MAX_SESSIONS; i++) {
+        WsPeer *p = &s_peers[i];
+        if (p->fd < 0 || p->close_reason != WS_CLOSE_NONE) continue;
+        int64_t idle_us = now - p->last_rx_us;
+        if (idle_us >= (int64_t)WS_DEAD_AFTER_MS * 1000) {
+            p->close_reason = WS_CLOSE_REAPED;
+            reap[num_reap++] = p->fd;
+        } else if (idle_us >= (int64_t)WS_PING_INTERVAL_MS * 1000 &&
+                   now - p->last_ping_us >= (int64_t)WS_PING_INTERVAL_MS * 1000) {
+            p->last_ping_us = now;
+            p->pings++;
+            ping[num_ping++] = p->fd;
+        }
+    }
+    s_peer_stats.pings_sent += num_ping;
+    portEXIT_CRITICAL(&s_peer_lock);
+
+    httpd_ws_frame_t pkt = {
+        .final = true,
+        .type = HTTPD_WS_TYPE_PING,
+        .payload = NULL,
+        .len = 0,
+    };
+    for (size_t i = 0; i < num_ping; i++) {
+        httpd_ws_send_frame_async(s_server, ping[i], &pkt);
+    }
+    for (size_t i = 0; i < num_reap; i++) {
+        ESP_LOGW(TAG, "WebSocket client fd %d silent for %d s, closing", reap[i], WS_DEAD_AFTER_MS / 1000);
+        httpd_sess_trigger_close(s_server, reap[i]);
+    }
+}
+
+static void ws_keepalive_timer_cb(void *arg)
+{
+    if (s_server) httpd_queue_work(s_server, ws_keepalive_work, NULL);
+}
+
+// ====================== COMPRESSED FRAMES ======================
+// httpd cannot negotiate permessage-deflate (fixed handshake, no RSV1), so
+// clients opt in with set_compression and then receive binary frames:
+//   [kind][0][seq lo][seq hi][raw length, 4 bytes LE][wscomp stream]
+// Telemetry deltas are coded against the previous telemetry packet, which every
+// compressed client already holds - one shared dictionary for all of them.
+#define WS_COMP_HDR_LEN          8
+#define WS_COMP_TELEMETRY_KEY    1       // coded without dictionary
+#define WS_COMP_TELEMETRY_DELTA  2       // coded against the previous telemetry packet
+#define WS_COMP_DOCUMENT         3       // command upload / cycle_data download, no dictionary
+#define WS_COMP_KEY_INTERVAL     30      // periodic key frame so a client that lost one recovers
+#define WS_COMP_MAX_CLIENTS      WS_MAX_SESSIONS
+#define WS_COMP_PREV_MAX         1536    // longer telemetry packets are always sent as key frames
+#define WS_COMP_MAX_DOC          (64 * 1024)
+
+typedef struct {
+    int  fd;            // -1 when free
+    bool need_key;      // next telemetry frame must be a key frame
+} CompClient;
+
+typedef struct {
+    uint32_t frames;
+    uint64_t raw_bytes;
+    uint64_t comp_bytes;
+    uint64_t comp_us;
+} CompStat;
+
+static CompClient s_comp_clients[WS_COMP_MAX_CLIENTS];
+static portMUX_TYPE s_comp_lock = portMUX_INITIALIZER_UNLOCKED;
+static CompStat s_comp_stats[3];            // indexed by kind - 1
+
+static WsCompCtx s_tel_ctx;                 // telemetry task only
+static uint8_t s_tel_prev[WS_COMP_PREV_MAX];
+static size_t s_tel_prev_len = 0;           // 0: no dictionary, next frame is a key frame
+static uint16_t s_tel_seq = 0;
+
+static int comp_find(const CompClient *list, int fd)
+{
+    for (int i = 0; i < WS_COMP_MAX_CLIENTS; i++) {
+        if (list[i].fd == fd) return i;
+    }
+    return -1;
+}
+
+static bool comp_set_client(int fd, bool enable)
+{
+    bool ok = true;
+    portENTER_CRITICAL(&s_comp_lock);
+    int i = comp_find(s_comp_clients, fd);
+    if (enable) {
+        if (i < 0) i = comp_find(s_comp_clients, -1);
+        if (i >= 0) {
+            s_comp_clients[i].fd = fd;
+            s_comp_clients[i].need_key = true;
+        } else {
+            ok = false;
+        }
+    } else if (i >= 0) {
+        s_comp_clients[i].fd = -1;
+    }
+    portEXIT_CRITICAL(&s_comp_lock);
+    return ok;
+}
+
+// Session close hook: a reused fd must not inherit the compression opt-in or liveness
+static void ws_close_fn(httpd_handle_t hd, int sockfd)
+{
+    size_t num_fds = CONFIG_LWIP_MAX_SOCKETS;
+    int fds[CONFIG_LWIP_MAX_SOCKETS];
+    bool full = httpd_get_client_list(hd, &num_fds, fds) == ESP_OK && num_fds >= WS_MAX_SESSIONS;
+
+    comp_set_client(sockfd, false);
+    ws_peer_closed(sockfd, full);
+    close(sockfd);
+}
+
+// Build one compressed frame; caller frees *out. Returns the frame length, 0 on failure.
+static size_t comp_encode(WsCompCtx *ctx, uint8_t kind, uint16_t seq,
+                          const uint8_t *dict, size_t dict_len,
+                          const uint8_t *src, size_t src_len, uint8_t **out)
+{
+    *out = NULL;
+    uint8_t *frame = malloc(WS_COMP_HDR_LEN + WSCOMP_BOUND(src_len));
+    if (!frame) return 0;
+
+    int64_t t0 = esp_timer_get_time();
+    size_t n = wscomp_compress(ctx, dict, dict_len, src, src_len,
+                               frame + WS_COMP_HDR_LEN, WSCOMP_BOUND(src_len));
+    uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    if (n == 0) {
+        free(frame);
+        return 0;
+    }
+
+    frame[0] = kind;
+    frame[1] = 0;
+    frame[2] = (uint8_t)(seq & 0xff);
+    frame[3] = (uint8_t)(seq >> 8);
+    for (int b = 0; b < 4; b++) {
+        frame[4 + b] = (uint8_t)(src_len >> (8 * b));
+    }
+
+    portENTER_CRITICAL(&s_comp_lock);
+    CompStat *st = &s_comp_stats[kind - 1];
+    st->frames++;
+    st->raw_bytes += src_len;
+    st->comp_bytes += WS_COMP_HDR_LEN + n;
+    st->comp_us += us;
+    portEXIT_CRITICAL(&s_comp_lock);
+
+    *out = frame;
+    return WS_COMP_HDR_LEN + n;
+}
+
+// Inflated size announced by a WS_COMP_DOCUMENT frame, 0 if it is not one or too large
+static size_t comp_document_len(const uint8_t *frame, size_t len)
+{
+    if (len < WS_COMP_HDR_LEN || frame[0] != WS_COMP_DOCUMENT) return 0;
+
+    size_t raw_len = (size_t)frame[4] | ((size_t)frame[5] << 8) |
+                     ((size_t)frame[6] << 16) | ((size_t)frame[7] << 24);
+    return (raw_len <= WS_COMP_MAX_DOC) ? raw_len : 0;
+}
+
+// Inflate a WS_COMP_DOCUMENT frame into a NUL-terminated buffer (caller frees)
+static char *comp_decode_document(const uint8_t *frame, size_t len, size_t *out_len)
+{
+    size_t raw_len = comp_document_len(frame, len);
+    if (raw_len == 0) return NULL;
+
+    char *raw = malloc(raw_len + 1);
+    if (!raw) return NULL;
+    if (wscomp_decompress(NULL, 0, frame + WS_COMP_HDR_LEN, len - WS_COMP_HDR_LEN,
+                          (uint8_t *)raw, raw_len) != raw_len) {
+        free(raw);
+        return NULL;
+    }
+    raw[raw_len] = '\0';
+    *out_len = raw_len;
+    return raw;
+}
+
+static void ws_send_binary_async(int fd, const uint8_t *data, size_t len)
+{
+    httpd_ws_frame_t ws_pkt = {
+        .final = true,
+        .fragmented = false,
+        .type = HTTPD_WS_TYPE_BINARY,
+        .payload = (uint8_t *)data,
+        .len = len,
+    };
+    httpd_ws_send_frame_async(s_server, fd, &ws_pkt);
+}
+
+// Send a telemetry packet: text to plain clients, key or delta frame to compressed ones
+static void ws_broadcast_telemetry(const char *json)
+{
+    if (!s_server) return;
+
+    CompClient comp[WS_COMP_MAX_CLIENTS];
+    int num_comp = 0;
+    bool any_need_key = false;
+    portENTER_CRITICAL(&s_comp_lock);
+    memcpy(comp, s_comp_clients, sizeof(comp));
+    portEXIT_CRITICAL(&s_comp_lock);
+    for (int i = 0; i < WS_COMP_MAX_CLIENTS; i++) {
+        if (comp[i].fd < 0) continue;
+        num_comp++;
+        any_need_key |= comp[i].need_key;
+    }
+
+    size_t len = strlen(json);
+    if (num_comp == 0) {
+        ws_broadcast_text(json);
+        s_tel_prev_len = 0;
+        return;
+    }
+
+    uint16_t seq = ++s_tel_seq;
+    bool key_for_all = (s_tel_prev_len == 0) || (seq % WS_COMP_KEY_INTERVAL == 0);
+
+    uint8_t *delta = NULL;
+    size_t delta_len = 0;
+    if (!key_for_all) {
+        delta_len = comp_encode(&s_tel_ctx, WS_COMP_TELEMETRY_DELTA, seq, s_tel_prev, s_tel_prev_len,
+                                (const uint8_t *)json, len, &delta);
+        key_for_all = (delta_len == 0);
+    }
+    uint8_t *key = NULL;
+    size_t key_len = 0;
+    if (key_for_all || any_need_key) {
+        key_len = comp_encode(&s_tel_ctx, WS_COMP_TELEMETRY_KEY, seq, NULL, 0,
+                              (const uint8_t *)json, len, &key);
+    }
+
+    int fds[WS_MAX_SESSIONS];
+    size_t num_fds = ws_live_fds(fds);
+    httpd_ws_frame_t text = {
+        .final = true,
+        .type = HTTPD_WS_TYPE_TEXT,
+        .payload = (uint8_t *)json,
+        .len = len,
+    };
+    bool reached[WS_COMP_MAX_CLIENTS] = { false };
+    for (size_t f = 0; f < num_fds; f++) {
+        int i = comp_find(comp, fds[f]);
+        if (i >= 0) reached[i] = true;
+        if (i < 0) {
+            httpd_ws_send_frame_async(s_server, fds[f], &text);
+        } else if ((key_for_all || comp[i].need_key) && key_len) {
+            ws_send_binary_async(fds[f], key, key_len);
+            comp[i].need_key = false;
+        } else if (!key_for_all && !comp[i].need_key) {
+            ws_send_binary_async(fds[f], delta, delta_len);
+        }
+        // else: key frame failed to build - the client keeps waiting for one
+    }
+
+    // Clear need_key for clients that got their key frame (and are still the same session).
+    // A client skipped as unresponsive missed this delta and needs a key frame next.
+    portENTER_CRITICAL(&s_comp_lock);
+    for (int i = 0; i < WS_COMP_MAX_CLIENTS; i++) {
+        if (comp[i].fd < 0 || s_comp_clients[i].fd != comp[i].fd) continue;
+        if (!reached[i]) {
+            s_comp_clients[i].need_key = true;
+        } else if (!comp[i].need_key) {
+            s_comp_clients[i].need_key = false;
+        }
+    }
+    portEXIT_CRITICAL(&s_comp_lock);
+
+    // This packet is the dictionary for the next delta
+    if (len <= sizeof(s_tel_prev)) {
+        memcpy(s_tel_prev, json, len);
+        s_tel_prev_len = len;
+    } else {
+        s_tel_prev_len = 0;
+    }
+
+    free(delta);
+    free(key);
+}
+
 // Structure for passing JSON data to processing task
 typedef struct {
     char *json_data;
@@ -51,15 +558,31 @@ void ws_broadcast_text(const char *msg)
         .len = strlen(msg),
     };
 
-    // Use the synchronous send to all connected clients
-    // This iterates through all file descriptors and sends to WebSocket clients
-    for (int fd = 0; fd < FD_SETSIZE; fd++) {
-        if (httpd_ws_send_frame_async(s_server, fd, &ws_pkt) == ESP_OK) {
-            // Frame sent successfully to this client
-        }
+    // Live clients only: one that stopped answering pings would just stall the sender
+    int fds[WS_MAX_SESSIONS];
+    size_t num_fds = ws_live_fds(fds);
+    for (size_t i = 0; i < num_fds; i++) {
+        httpd_ws_send_frame_async(s_server, fds[i], &ws_pkt);
     }
 }
 
+// Number of live WebSocket clients (telemetry subscribers)
+static uint32_t ws_client_count(void)
+{
+    if (!s_server) return 0;
+
+    int fds[WS_MAX_SESSIONS];
+    return (uint32_t)ws_live_fds(fds);
+}
+
+// Telemetry demand: WebSocket clients plus the UDP stream, the MQTT publisher and
+// the serial stream (one sink each, however many listeners are behind them)
+static uint32_t telemetry_subscribers(void)
+{
+    return ws_client_count() + (udp_telemetry_active() ? 1 : 0) + (mqtt_pub_active() ? 1 : 0) +
+           (serial_telemetry_active() ? 1 : 0);
+}
+
 // optional: helper to send a small text reply
 static void ws_send_text(httpd_req_t *req, const char *msg)
 {
@@ -73,13 +596,390 @@ static void ws_send_text(httpd_req_t *req, const char *msg)
     httpd_ws_send_frame(req, &out_frame);
 }
 
+// Optional gpio bitmask field: absent = 0; must be a whole number that fits 32 bits
+static bool parse_mask(const cJSON *item, uint32_t *out)
+{
+    *out = 0;
+    if (!item) return true;
+    if (!cJSON_IsNumber(item) || item->valuedouble < 0 || item->valuedouble > 4294967295.0 ||
+        item->valuedouble != (double)(uint32_t)item->valuedouble) {
+        return false;
+    }
+    *out = (uint32_t)item->valuedouble;
+    return true;
+}
+
+static void udp_status_reply(httpd_req_t *req)
+{
+    UdpTelemetryStatus us;
+    udp_telemetry_get_status(&us);
+
+    char response[256];
+    snprintf(response, sizeof(response),
+             "{\"type\":\"udp_telemetry\",\"enabled\":%s,\"multicast\":%s,\"addr\":\"%s\",\"port\":%u,"
+             "\"ttl\":%u,\"seq\":%lu,\"sent\":%lu,\"send_errors\":%lu,\"datagram_bytes\":%lu}",
+             us.enabled ? "true" : "false", us.multicast ? "true" : "false", us.addr, us.port, us.ttl,
+             (unsigned long)us.seq, (unsigned long)us.sent, (unsigned long)us.send_errors,
+             (unsigned long)us.last_len);
+    ws_send_text(req, response);
+}
+
+static void mqtt_stats_reply(httpd_req_t *req)
+{
+    MqttPubStats ms;
+    mqtt_pub_get_stats(&ms);
+
+    char response[512];
+    snprintf(response, sizeof(response),
+             "{\"type\":\"mqtt_stats\",\"enabled\":%s,\"connected\":%s,\"uri\":\"%s\",\"qos\":%u,"
+             "\"queue_depth\":%lu,\"queue_bytes\":%lu,\"max_queue_depth\":%lu,\"segments\":%lu,"
+             "\"inflight\":%lu,\"enqueued\":%lu,\"published\":%lu,\"replayed\":%lu,\"spilled\":%lu,"
+             "\"dropped\":%lu,\"reconnects\":%lu,\"bytes_published\":%lu,\"msgs_per_s\":%.2f}",
+             ms.enabled ? "true" : "false", ms.connected ? "true" : "false", ms.uri, ms.qos,
+             (unsigned long)ms.queue_depth, (unsigned long)ms.queue_bytes, (unsigned long)ms.max_queue_depth,
+             (unsigned long)ms.segments, (unsigned long)ms.inflight, (unsigned long)ms.enqueued,
+             (unsigned long)ms.published, (unsigned long)ms.replayed, (unsigned long)ms.spilled,
+             (unsigned long)ms.dropped, (unsigned long)ms.reconnects, (unsigned long)ms.bytes_published,
+             ms.msgs_per_s);
+    ws_send_text(req, response);
+}
+
+static void serial_status_reply(httpd_req_t *req)
+{
+    SerialTelemetryStats ss;
+    serial_telemetry_get_stats(&ss);
+
+    char response[200];
+    snprintf(response, sizeof(response),
+             "{\"type\":\"serial_telemetry\",\"enabled\":%s,\"period_ms\":%lu,\"frames\":%lu,"
+             "\"bytes\":%lu,\"dropped\":%lu,\"lost_edges\":%lu}",
+             ss.enabled ? "true" : "false", (unsigned long)ss.period_ms, (unsigned long)ss.frames,
+             (unsigned long)ss.bytes, (unsigned long)ss.dropped, (unsigned long)ss.lost_edges);
+    ws_send_text(req, response);
+}
+
+// Serialize a runtime stats snapshot; caller frees the returned string
+static char *sysmon_to_json(const SysmonSnapshot *snap)
+{
+    cJSON *root = cJSON_CreateObject();
+    if (!root) return NULL;
+
+    cJSON_AddStringToObject(root, "type", "sysmon");
+    cJSON_AddNumberToObject(root, "timestamp_ms", snap->timestamp_ms);
+    cJSON_AddNumberToObject(root, "cpu_busy_pct", snap->cpu_busy_pct);
+    cJSON_AddNumberToObject(root, "cpu_busy_pct_10s", snap->cpu_busy_pct_long);
+    cJSON_AddNumberToObject(root, "free_heap", snap->free_heap);
+    cJSON_AddNumberToObject(root, "min_free_heap", snap->min_free_heap);
+
+    cJSON *tasks = cJSON_AddArrayToObject(root, "tasks");
+    for (int i = 0; i < snap->num_tasks; i++) {
+        const SysmonTask *t = &snap->tasks[i];
+        char state[2] = { t->state, '\0' };
+        cJSON *task_obj = cJSON_CreateObject();
+        cJSON_AddStringToObject(task_obj, "name", t->name);
+        cJSON_AddNumberToObject(task_obj, "prio", t->priority);
+        cJSON_AddStringToObject(task_obj, "state", state);
+        cJSON_AddNumberToObject(task_obj, "cpu_pct", t->cpu_pct);
+        cJSON_AddNumberToObject(task_obj, "cpu_pct_10s", t->cpu_pct_long);
+        cJSON_AddNumberToObject(task_obj, "stack_free_min", t->stack_free_min);
+        cJSON_AddItemToArray(tasks, task_obj);
+    }
 
+    char *json_str = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    return json_str;
+}
+
+static void sysmon_callback(const SysmonSnapshot *snap)
+{
+    char *json_str = sysmon_to_json(snap);
+    if (json_str) {
+        ws_broadcast_text(json_str);
+        free(json_str);
+    }
+}
+
+// ====================== COMMAND HANDLERS ======================
+// Commands with plain arguments, shared by the in-place fast path and the cJSON path
+
+// The actuator self-test owns the outputs while it runs
+static bool outputs_busy(httpd_req_t *req)
+{
+    if (!actuator_char_running()) return false;
+    ws_send_text(req, "error: actuator self-test running");
+    return true;
+}
+
+static void cmd_start_cycle(httpd_req_t *req)
+{
+    if (cycle_is_running()) {
+        ws_send_text(req, "error: cycle already running");
+    } else if (!outputs_busy(req)) {
+        ws_send_text(req, "ok: starting cycle");
+        cycle_run_loaded_cycle();
+    }
+}
+
+static void cmd_stop_cycle(httpd_req_t *req)
+{
+    actuator_char_abort();
+    cycle_stop();
+    ws_send_text(req, "ok: cycle stopped");
+}
+
+static void cmd_skip_phase(httpd_req_t *req)
+{
+    cycle_skip_current_phase(true);
+    ws_send_text(req, "ok: phase skipped");
+}
+
+static void cmd_skip_to_phase(httpd_req_t *req, int phase_index)
+{
+    cycle_skip_to_phase((size_t)phase_index);
+    ws_send_text(req, "ok: skipping to phase");
+}
+
+static void cmd_toggle_gpio(httpd_req_t *req, int pin_num, int pin_state)
+{
+    if (outputs_busy(req)) return;
+
+    // Set GPIO state through the executor (also updates gpio_shadow[] for telemetry)
+    executor_set_output((gpio_num_t)pin_num, pin_state);
+
+    char response[100];
+    snprintf(response, sizeof(response), "ok: GPIO %d set to %d", pin_num, pin_state);
+    ws_send_text(req, response);
+    ESP_LOGI(TAG, "GPIO %d toggled to %d", pin_num, pin_state);
+}
+
+// set_outputs, mask form (at least one mask non-zero)
+static void cmd_set_outputs(httpd_req_t *req, uint32_t set_mask, uint32_t clr_mask)
+{
+    if (outputs_busy(req)) return;
+
+    int64_t t0 = esp_timer_get_time();
+    esp_err_t err = executor_write_outputs(set_mask, clr_mask);
+    int64_t apply_us = esp_timer_get_time() - t0;
+    if (err != ESP_OK) {
+        ws_send_text(req, "error: masks name a non-output pin or overlap");
+        return;
+    }
+
+    char response[160];
+    snprintf(response, sizeof(response),
+             "{\"type\":\"outputs\",\"set\":%lu,\"clear\":%lu,\"levels\":%lu,\"apply_us\":%ld}",
+             (unsigned long)set_mask, (unsigned long)clr_mask,
+             (unsigned long)executor_output_levels(), (long)apply_us);
+    ws_send_text(req, response);
+    ESP_LOGD(TAG, "outputs set 0x%lx clear 0x%lx", (unsigned long)set_mask, (unsigned long)clr_mask);
+}
+
+// ====================== FAST COMMAND PATH ======================
+// Every frame but an upload fits a static buffer. Control commands are
+// tokenized in place there and dispatched without touching the heap: no
+// frame malloc, no cJSON tree, no brace-count pass and no INFO logging.
+// Anything the fast path does not recognise or is unsure about goes to the
+// cJSON path unchanged, so replies are identical either way. That includes
+// escapes, non-integer numbers and set_outputs steps. The cJSON path parses
+// straight from the same buffer. ws_handler only runs in the httpd task, so
+// one buffer is enough.
+#define WS_CMD_BUF_LEN      1024    // largest non-upload command (set_outputs steps) is ~700 bytes
+#define WS_CMD_MAX_TOKENS   32
+
+typedef enum {
+    CMD_PATH_FAST,
+    CMD_PATH_PARSED,
+    CMD_PATH_COUNT
+} CmdPath;
+
+typedef struct {
+    uint32_t commands;
+    uint64_t total_us;      // frame received -> reply sent
+    uint32_t max_us;
+} CmdPathStat;
+
+static char s_cmd_buf[WS_CMD_BUF_LEN + 1];
+static WsTok s_cmd_tok[WS_CMD_MAX_TOKENS];
+static CmdPathStat s_cmd_stats[CMD_PATH_COUNT];     // httpd task only
+
+static void cmd_stat_add(CmdPath path, int64_t t0)
+{
+    uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    CmdPathStat *st = &s_cmd_stats[path];
+    st->commands++;
+    st->total_us += us;
+    if (us > st->max_us) st->max_us = us;
+}
+
+// Optional mask field for the fast path: absent = 0, else a plain integer that fits 32 bits
+static bool fast_mask(const WsTokDoc *doc, const char *key, uint32_t *out)
+{
+    int64_t v = 0;
+    int t = wstok_get(doc, 0, key);
+    if (t >= 0 && !wstok_int(doc, t, 0, UINT32_MAX, &v)) return false;
+    *out = (uint32_t)v;
+    return true;
+}
+
+// Returns true if the command was handled (reply sent)
+static bool ws_fast_dispatch(httpd_req_t *req, const char *js, size_t len)
+{
+    WsTokDoc doc;
+    if (wstok_parse(js, len, s_cmd_tok, WS_CMD_MAX_TOKENS, &doc) <= 0 ||
+        s_cmd_tok[0].type != WSTOK_OBJECT || doc.escaped) {
+        return false;
+    }
+
+    int action = wstok_get(&doc, 0, "action");
+    int64_t a, b;
+
+    if (wstok_eq(&doc, action, "stop_cycle")) {
+        cmd_stop_cycle(req);
+    } else if (wstok_eq(&doc, action, "start_cycle")) {
+        cmd_start_cycle(req);
+    } else if (wstok_eq(&doc, action, "skip_phase")) {
+        cmd_skip_phase(req);
+    } else if (wstok_eq(&doc, action, "skip_to_phase")) {
+        if (!wstok_int(&doc, wstok_get(&doc, 0, "index"), INT32_MIN, INT32_MAX, &a)) return false;
+        cmd_skip_to_phase(req, (int)a);
+    } else if (wstok_eq(&doc, action, "toggle_gpio")) {
+        if (!wstok_int(&doc, wstok_get(&doc, 0, "pin"), INT32_MIN, INT32_MAX, &a) ||
+            !wstok_int(&doc, wstok_get(&doc, 0, "state"), INT32_MIN, INT32_MAX, &b)) {
+            return false;
+        }
+        cmd_toggle_gpio(req, (int)a, (int)b);
+    } else if (wstok_eq(&doc, action, "set_outputs")) {
+        uint32_t set_mask, clr_mask;
+        if (wstok_get(&doc, 0, "steps") >= 0 || !fast_mask(&doc, "set", &set_mask) ||
+            !fast_mask(&doc, "clear", &clr_mask) || !(set_mask | clr_mask)) {
+            return false;
+        }
+        cmd_set_outputs(req, set_mask, clr_mask);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// ====================== FRAME ADMISSION ======================
+// The client announces a frame's length before any of it is read. Frames up
+// to WS_CMD_BUF_LEN go to the static buffer. Anything larger can only be a
+// cycle upload, so it has to pass admission before the heap is touched:
+//   1. length <= WS_UPLOAD_MAX_BYTES, else refused unread (close 1009)
+//   2. frame + its SPIFFS copy must fit above WS_HEAP_RESERVE_BYTES in one
+//      block, else refused unread (close 1013, try again later)
+//   3. once received, the cJSON tree is projected from the node count and
+//      refused before cJSON_Parse if it would dip into the reserve
+// An unread payload cannot be skipped, so a refusal before reading ends the
+// session. A refusal after reading just replies with an error.
+// Per-action budgets: only write_json may exceed WS_CMD_BUF_LEN (checked
+// after parsing, for heap frames and inflated documents).
+#define WS_UPLOAD_MAX_BYTES     WS_COMP_MAX_DOC     // same cap as an inflated compressed document
+#define WS_HEAP_RESERVE_BYTES   (32 * 1024)         // telemetry packets, SPIFFS writer, httpd, timers
+#define WS_CJSON_NODE_BYTES     44                  // sizeof(cJSON) + allocator overhead
+
+#define WS_CLOSE_MESSAGE_TOO_BIG    1009
+#define WS_CLOSE_TRY_AGAIN_LATER    1013
+
+typedef struct {
+    uint32_t admitted;          // heap frames / documents admitted
+    uint32_t too_large;         // refused unread: above WS_UPLOAD_MAX_BYTES
+    uint32_t low_memory;        // refused: projected heap below the reserve
+    uint32_t over_budget;       // parsed, but larger than its action allows
+    uint32_t largest_admitted;
+    uint32_t min_headroom;      // smallest projected heap margin above the reserve (UINT32_MAX: none yet)
+} WsAdmissionStats;
+
+static WsAdmissionStats s_admission = { .min_headroom = UINT32_MAX };  // httpd task only
+
+static const struct {
+    const char *action;
+    size_t      max_bytes;
+} s_action_budget[] = {
+    { "write_json", WS_UPLOAD_MAX_BYTES },
+};
+
+static size_t action_budget(const char *action)
+{
+    for (size_t i = 0; i < sizeof(s_action_budget) / sizeof(s_action_budget[0]); i++) {
+        if (strcmp(action, s_action_budget[i].action) == 0) return s_action_budget[i].max_bytes;
+    }
+    return WS_CMD_BUF_LEN;
+}
+
+// Would `need` more bytes of heap (largest single allocation `block`) keep the reserve?
+static bool admit_heap(size_t need, size_t block)
+{
+    size_t free_now = esp_get_free_heap_size();
+    if (block + 1 > heap_caps_get_largest_free_block(MALLOC_CAP_8BIT) ||
+        free_now < need + WS_HEAP_RESERVE_BYTES) {
+        s_admission.low_memory++;
+        ESP_LOGW(TAG, "upload refused: needs %zu bytes, %zu free, reserve %d", need, free_now,
+                 WS_HEAP_RESERVE_BYTES);
+        return false;
+    }
+    uint32_t headroom = (uint32_t)(free_now - need - WS_HEAP_RESERVE_BYTES);
+    if (headroom < s_admission.min_headroom) s_admission.min_headroom = headroom;
+    return true;
+}
+
+// Steps 1 and 2 for a frame too large for the static buffer; false: refused, session closing
+static bool admit_frame(httpd_req_t *req, int fd, size_t len)
+{
+    uint16_t code = 0;
+    if (len > WS_UPLOAD_MAX_BYTES) {
+        s_admission.too_large++;
+        ESP_LOGW(TAG, "frame of %zu bytes refused (max %d)", len, WS_UPLOAD_MAX_BYTES);
+        ws_send_text(req, "error: frame too large");
+        code = WS_CLOSE_MESSAGE_TOO_BIG;
+    } else if (!admit_heap(2 * len, len)) {
+        ws_send_text(req, "error: not enough memory for this upload now");
+        code = WS_CLOSE_TRY_AGAIN_LATER;
+    } else {
+        return true;
+    }
+
+    uint8_t status[2] = { (uint8_t)(code >> 8), (uint8_t)(code & 0xff) };
+    httpd_ws_frame_t close_frame = {
+        .final = true,
+        .type = HTTPD_WS_TYPE_CLOSE,
+        .payload = status,
+        .len = sizeof(status),
+    };
+    httpd_ws_send_frame(req, &close_frame);
+    ws_peer_set_reason(fd, WS_CLOSE_REFUSED);
+    httpd_sess_trigger_close(req->handle, fd);
+    return false;
+}
+
+// Step 3: project the cJSON tree of a received document before parsing it
+static bool admit_document(const char *json, size_t len)
+{
+    size_t nodes = 1;
+    for (size_t i = 0; i < len; i++) {
+        if (json[i] == ',' || json[i] == '{' || json[i] == '[') nodes++;
+    }
+    // tree nodes + key/string copies (bounded by the text) + the SPIFFS serialization
+    if (!admit_heap(nodes * WS_CJSON_NODE_BYTES + 2 * len, len)) return false;
+
+    s_admission.admitted++;
+    if (len > s_admission.largest_admitted) s_admission.largest_admitted = (uint32_t)len;
+    return true;
+}
+
+// Frames live in the static buffer unless they went through admission
+static void ws_free_frame(char *buf)
+{
+    if (buf != s_cmd_buf) free(buf);
+}
 
 esp_err_t ws_handler(httpd_req_t *req)
 {
     if (req->method == HTTP_GET) {
         // Initial WebSocket handshake (GET request)
         ESP_LOGI(TAG, "WebSocket client connected");
+        ws_peer_open(httpd_req_to_sockfd(req));
+        telemetry_notify_change();  // first snapshot now, not at the next idle wakeup
         return ESP_OK;
     }
 
@@ -95,47 +995,109 @@ esp_err_t ws_handler(httpd_req_t *req)
         return ret;
     }
 
+    int fd = httpd_req_to_sockfd(req);
+    ws_peer_seen(fd);
+
+    // Control frames reach the handler (handle_ws_control_frames) so pongs count as liveness
+    if (ws_pkt.type == HTTPD_WS_TYPE_PING || ws_pkt.type == HTTPD_WS_TYPE_PONG ||
+        ws_pkt.type == HTTPD_WS_TYPE_CLOSE) {
+        uint8_t ctl[125];                   // control payloads are at most 125 bytes
+        if (ws_pkt.len > sizeof(ctl)) return ESP_FAIL;
+        if (ws_pkt.len) {
+            ws_pkt.payload = ctl;
+            ret = httpd_ws_recv_frame(req, &ws_pkt, ws_pkt.len);
+            if (ret != ESP_OK) return ret;
+        }
+        if (ws_pkt.type == HTTPD_WS_TYPE_PING) {
+            ws_pkt.type = HTTPD_WS_TYPE_PONG;           // echo the payload
+            httpd_ws_send_frame(req, &ws_pkt);
+        } else if (ws_pkt.type == HTTPD_WS_TYPE_CLOSE) {
+            ws_peer_set_reason(fd, WS_CLOSE_CLIENT);
+            ws_pkt.len = ws_pkt.len >= 2 ? 2 : 0;       // echo the status code
+            httpd_ws_send_frame(req, &ws_pkt);
+            httpd_sess_trigger_close(req->handle, fd);
+        }
+        return ESP_OK;
+    }
+
     if (ws_pkt.len == 0) {
-        // Empty frame or control frame
+        // Empty data frame
         return ESP_OK;
     }
 
-    ESP_LOGI(TAG, "WebSocket frame size: %zu bytes", ws_pkt.len);
+    int64_t t_frame = esp_timer_get_time();
+    char *buf;
+
+    if (ws_pkt.len <= WS_CMD_BUF_LEN) {
+        // Step 2a: static buffer; control commands take the in-place fast path
+        ws_pkt.payload = (uint8_t *)s_cmd_buf;
+        ret = httpd_ws_recv_frame(req, &ws_pkt, ws_pkt.len);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "ws_recv_frame failed: %s", esp_err_to_name(ret));
+            return ret;
+        }
+        if (ws_pkt.type == HTTPD_WS_TYPE_TEXT && ws_fast_dispatch(req, s_cmd_buf, ws_pkt.len)) {
+            cmd_stat_add(CMD_PATH_FAST, t_frame);
+            ESP_LOGD(TAG, "WS fast command (%zu bytes): %.*s", ws_pkt.len, (int)ws_pkt.len, s_cmd_buf);
+            return ESP_OK;
+        }
+        buf = s_cmd_buf;
+    } else {
+        ESP_LOGI(TAG, "WebSocket frame size: %zu bytes", ws_pkt.len);
+        if (!admit_frame(req, fd, ws_pkt.len)) return ESP_OK;
+
+        // Step 2b: upload - allocate buffer and read the actual frame
+        buf = malloc(ws_pkt.len + 1);
+        if (!buf) {
+            ESP_LOGE(TAG, "malloc failed for WS frame (size: %zu bytes)", ws_pkt.len);
+            return ESP_ERR_NO_MEM;
+        }
 
-    // Step 2: allocate buffer and read the actual frame
-    char *buf = malloc(ws_pkt.len + 1);
-    if (!buf) {
-        ESP_LOGE(TAG, "malloc failed for WS frame (size: %zu bytes)", ws_pkt.len);
-        return ESP_ERR_NO_MEM;
+        ws_pkt.payload = (uint8_t *)buf;
+        ret = httpd_ws_recv_frame(req, &ws_pkt, ws_pkt.len);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "ws_recv_frame failed: %s", esp_err_to_name(ret));
+            ws_free_frame(buf);
+            return ret;
+        }
     }
 
-    ws_pkt.payload = (uint8_t *)buf;
-    ret = httpd_ws_recv_frame(req, &ws_pkt, ws_pkt.len);
-    if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "ws_recv_frame failed: %s", esp_err_to_name(ret));
-        free(buf);
-        return ret;
+    // Compressed command (binary frame): inflate and handle it like a text frame
+    if (ws_pkt.type == HTTPD_WS_TYPE_BINARY) {
+        size_t raw_len = comp_document_len((const uint8_t *)buf, ws_pkt.len);
+        if (raw_len > WS_CMD_BUF_LEN && !admit_heap(raw_len, raw_len)) {
+            ws_free_frame(buf);
+            ws_send_text(req, "error: not enough memory for this upload now");
+            return ESP_OK;
+        }
+        char *raw = comp_decode_document((const uint8_t *)buf, ws_pkt.len, &raw_len);
+        ws_free_frame(buf);
+        if (!raw) {
+            ws_send_text(req, "error: bad compressed frame");
+            return ESP_OK;
+        }
+        ESP_LOGI(TAG, "Compressed frame: %zu -> %zu bytes", ws_pkt.len, raw_len);
+        buf = raw;
+        ws_pkt.len = raw_len;
     }
 
     buf[ws_pkt.len] = '\0';
     ESP_LOGI(TAG, "WS recv (%zu bytes): %.100s%s", ws_pkt.len, buf, 
              ws_pkt.len > 100 ? "..." : "");  // Show first 100 chars + ...
     
-    // Verify JSON completeness
-    size_t open_braces = 0, close_braces = 0;
-    for (size_t i = 0; i < ws_pkt.len; i++) {
-        if (buf[i] == '{') open_braces++;
-        if (buf[i] == '}') close_braces++;
+    // Uploads: the parse tree must fit above the reserve too
+    if (ws_pkt.len > WS_CMD_BUF_LEN && !admit_document(buf, ws_pkt.len)) {
+        ws_send_text(req, "error: not enough memory for this upload now");
+        ws_free_frame(buf);
+        return ESP_OK;
     }
-    ESP_LOGI(TAG, "JSON structure check - Open braces: %zu, Close braces: %zu", 
-             open_braces, close_braces);
 
     // Parse JSON command
     cJSON *root = cJSON_Parse(buf);
     if (!root) {
         ESP_LOGW(TAG, "invalid JSON");
         ws_send_text(req, "error: invalid json");
-        free(buf);
+        ws_free_frame(buf);
         return ESP_OK;
     }
 
@@ -143,7 +1105,16 @@ esp_err_t ws_handler(httpd_req_t *req)
     if (!action || !cJSON_IsString(action)) {
         ws_send_text(req, "error: missing action");
         cJSON_Delete(root);
-        free(buf);
+        ws_free_frame(buf);
+        return ESP_OK;
+    }
+
+    if (ws_pkt.len > action_budget(action->valuestring)) {
+        s_admission.over_budget++;
+        ESP_LOGW(TAG, "%s frame of %zu bytes over its budget", action->valuestring, ws_pkt.len);
+        ws_send_text(req, "error: frame too large for this action");
+        cJSON_Delete(root);
+        ws_free_frame(buf);
         return ESP_OK;
     }
 
@@ -153,7 +1124,7 @@ esp_err_t ws_handler(httpd_req_t *req)
         if (!data) {
             ws_send_text(req, "error: missing data for write_json");
             cJSON_Delete(root);
-            free(buf);
+            ws_free_frame(buf);
             return ESP_OK;
         }
 
@@ -168,22 +1139,26 @@ esp_err_t ws_handler(httpd_req_t *req)
         if (!cJSON_IsObject(data)) {
             ws_send_text(req, "error: data field must be an object");
             cJSON_Delete(root);
-            free(buf);
+            ws_free_frame(buf);
             return ESP_OK;
         }
         
         cJSON *phases = cJSON_GetObjectItem(data, "phases");
-        if (!phases || !cJSON_IsArray(phases)) {
+        cJSON *tracks = cJSON_GetObjectItem(data, "tracks");
+        if (!cJSON_IsArray(phases) && !cJSON_IsArray(tracks)) {
             ws_send_text(req, "error: data.phases must be an array");
             cJSON_Delete(root);
-            free(buf);
+            ws_free_frame(buf);
             return ESP_OK;
         }
 
         // ===== OPTIMIZED PATH: Load directly from cJSON tree =====
         // Skip serialization and re-parsing. This avoids heap fragmentation.
-        // Pass the data object (which contains "phases") so cycle.c can store it
-        // and keep string pointers alive for the lifetime of the cycle.
+        // Detach the data object (which contains "phases") so cycle.c can own it
+        // and keep string pointers alive for the lifetime of the cycle; the rest
+        // of the frame (action and any extra members) is freed now.
+        cJSON_DetachItemViaPointer(root, data);
+        cJSON_Delete(root);
         ESP_LOGI(TAG, "Loading cycle directly from parsed JSON tree (optimized)...");
         esp_err_t load_result = load_cycle_from_cjson(data);
 
@@ -194,16 +1169,16 @@ esp_err_t ws_handler(httpd_req_t *req)
             // This is now a lower-priority operation and doesn't block the load
             ESP_LOGI(TAG, "Writing cycle to SPIFFS for persistence...");
             
-            // Try to serialize and write, but don't fail if it doesn't work
+            // Try to serialize and write, but don't fail if it doesn't work.
+            // The writer owns json_str and flashes it between output events.
             char *json_str = cJSON_PrintUnformatted(data);
             if (json_str) {
                 size_t json_len = strlen(json_str);
-                if (fs_write_file("/spiffs/cycle.json", json_str, json_len) == ESP_OK) {
-                    ESP_LOGI(TAG, "cycle.json saved to SPIFFS (%zu bytes) for backup", json_len);
+                if (fs_write_file_scheduled("/spiffs/cycle.json", json_str, json_len) == ESP_OK) {
+                    ESP_LOGI(TAG, "cycle.json queued for SPIFFS (%zu bytes) for backup", json_len);
                 } else {
-                    ESP_LOGW(TAG, "Failed to write to SPIFFS (non-fatal, cycle already loaded)");
+                    ESP_LOGW(TAG, "Failed to queue SPIFFS write (non-fatal, cycle already loaded)");
                 }
-                free(json_str);
             } else {
                 ESP_LOGW(TAG, "Could not serialize for SPIFFS backup (non-fatal, cycle already loaded)");
             }
@@ -212,31 +1187,25 @@ esp_err_t ws_handler(httpd_req_t *req)
         } else {
             ESP_LOGE(TAG, "Cycle load failed with error: %d", load_result);
             ws_send_text(req, "error: failed to load cycle");
+            cJSON_Delete(data);     // not adopted by cycle.c
         }
 
-        // NOTE: Do NOT free the root here! cycle.c has stored the data object in g_loaded_cycle_json
+        // NOTE: on success do NOT free data here! cycle.c has stored it in g_loaded_cycle_json
         // It will be freed when cycle_unload() is called (e.g., when a new cycle loads)
-        free(buf);
+        ws_free_frame(buf);
         return ESP_OK;
     }
     // ========== COMMAND: start_cycle ==========
     else if (strcmp(action->valuestring, "start_cycle") == 0) {
-        if (cycle_is_running()) {
-            ws_send_text(req, "error: cycle already running");
-        } else {
-            ws_send_text(req, "ok: starting cycle");
-            cycle_run_loaded_cycle();
-        }
+        cmd_start_cycle(req);
     }
     // ========== COMMAND: stop_cycle ==========
     else if (strcmp(action->valuestring, "stop_cycle") == 0) {
-        cycle_stop();
-        ws_send_text(req, "ok: cycle stopped");
+        cmd_stop_cycle(req);
     }
     // ========== COMMAND: skip_phase ==========
     else if (strcmp(action->valuestring, "skip_phase") == 0) {
-        cycle_skip_current_phase(true);
-        ws_send_text(req, "ok: phase skipped");
+        cmd_skip_phase(req);
     }
     // ========== COMMAND: skip_to_phase ==========
     else if (strcmp(action->valuestring, "skip_to_phase") == 0) {
@@ -244,9 +1213,7 @@ esp_err_t ws_handler(httpd_req_t *req)
         if (!index || !cJSON_IsNumber(index)) {
             ws_send_text(req, "error: missing or invalid index for skip_to_phase");
         } else {
-            int phase_index = index->valueint;
-            cycle_skip_to_phase((size_t)phase_index);
-            ws_send_text(req, "ok: skipping to phase");
+            cmd_skip_to_phase(req, index->valueint);
         }
     }
     // ========== COMMAND: toggle_gpio ==========
@@ -259,26 +1226,557 @@ esp_err_t ws_handler(httpd_req_t *req)
         } else if (!state || !cJSON_IsNumber(state)) {
             ws_send_text(req, "error: missing or invalid state (0 or 1)");
         } else {
-            int pin_num = pin->valueint;
-            int pin_state = state->valueint;
-            
-            // Set GPIO state
-            gpio_set_level((gpio_num_t)pin_num, pin_state);
-            
-            // Also update gpio_shadow[] so telemetry reflects the change
-            extern int gpio_shadow[NUM_COMPONENTS];
-            extern const gpio_num_t all_pins[NUM_COMPONENTS];
-            for (int i = 0; i < NUM_COMPONENTS; i++) {
-                if (all_pins[i] == pin_num) {
-                    gpio_shadow[i] = pin_state;
-                    break;
-                }
+            cmd_toggle_gpio(req, pin->valueint, state->valueint);
+        }
+    }
+    // ========== COMMAND: set_outputs ==========
+    // Several outputs in one executor write, or a short timed sequence of masks,
+    // answered with one reply (toggle_gpio costs a message per pin)
+    else if (strcmp(action->valuestring, "set_outputs") == 0) {
+        cJSON *steps = cJSON_GetObjectItem(root, "steps");
+        char response[160];
+
+        if (outputs_busy(req)) {
+            // reply sent
+        } else if (steps) {
+            ExecutorOutputStep seq[EXECUTOR_SEQ_MAX_STEPS];
+            int n = cJSON_IsArray(steps) ? cJSON_GetArraySize(steps) : 0;
+            bool ok = (n > 0 && n <= EXECUTOR_SEQ_MAX_STEPS);
+            int i = 0;
+            cJSON *st;
+            cJSON_ArrayForEach(st, steps) {
+                if (!ok || i >= n) break;
+                cJSON *at = cJSON_GetObjectItem(st, "at_ms");
+                ok = parse_mask(cJSON_GetObjectItem(st, "set"), &seq[i].set_mask) &&
+                     parse_mask(cJSON_GetObjectItem(st, "clear"), &seq[i].clr_mask) &&
+                     (!at || (cJSON_IsNumber(at) && at->valuedouble >= 0));
+                seq[i].at_ms = at ? (uint32_t)at->valuedouble : 0;
+                i++;
             }
-            
-            char response[100];
-            snprintf(response, sizeof(response), "ok: GPIO %d set to %d", pin_num, pin_state);
+            esp_err_t err = ok ? executor_run_output_sequence(seq, n) : ESP_ERR_INVALID_ARG;
+            if (err == ESP_ERR_INVALID_STATE) {
+                ws_send_text(req, "error: cycle or another sequence is running");
+            } else if (err != ESP_OK) {
+                ws_send_text(req, "error: steps must be 1-16 of {at_ms, set, clear}, output pins only, at_ms rising to 10000");
+            } else {
+                snprintf(response, sizeof(response),
+                         "{\"type\":\"outputs\",\"steps\":%d,\"duration_ms\":%lu,\"levels\":%lu}",
+                         n, (unsigned long)seq[n - 1].at_ms, (unsigned long)executor_output_levels());
+                ws_send_text(req, response);
+            }
+        } else {
+            uint32_t set_mask, clr_mask;
+            if (!parse_mask(cJSON_GetObjectItem(root, "set"), &set_mask) ||
+                !parse_mask(cJSON_GetObjectItem(root, "clear"), &clr_mask) || !(set_mask | clr_mask)) {
+                ws_send_text(req, "error: set/clear must be gpio bitmasks");
+            } else {
+                cmd_set_outputs(req, set_mask, clr_mask);
+            }
+        }
+    }
+    // ========== COMMAND: set_exec_mode ==========
+    else if (strcmp(action->valuestring, "set_exec_mode") == 0) {
+        cJSON *mode = cJSON_GetObjectItem(root, "mode");
+        if (!mode || !cJSON_IsString(mode) ||
+            (strcmp(mode->valuestring, "task") != 0 && strcmp(mode->valuestring, "isr") != 0)) {
+            ws_send_text(req, "error: mode must be \"task\" or \"isr\"");
+        } else if (cycle_is_running()) {
+            ws_send_text(req, "error: cannot change executor mode while cycle is running");
+        } else {
+            ExecutorMode m = (strcmp(mode->valuestring, "isr") == 0) ? EXECUTOR_MODE_ISR : EXECUTOR_MODE_TASK;
+            if (executor_set_mode(m) == ESP_OK) {
+                ws_send_text(req, m == EXECUTOR_MODE_ISR ? "ok: executor mode isr" : "ok: executor mode task");
+            } else {
+                ws_send_text(req, "error: failed to change executor mode");
+            }
+        }
+    }
+    // ========== COMMAND: get_exec_trace ==========
+    else if (strcmp(action->valuestring, "get_exec_trace") == 0) {
+        ExecutorTraceStats st;
+        executor_trace_stats(&st);
+
+        char response[240];
+        snprintf(response, sizeof(response),
+                 "{\"type\":\"exec_trace\",\"mode\":\"%s\",\"total\":%lu,\"samples\":%u,"
+                 "\"min_us\":%ld,\"p50_us\":%ld,\"p99_us\":%ld,\"max_us\":%ld,\"start_latency_us\":%lld}",
+                 executor_mode_name(st.mode), (unsigned long)st.total, (unsigned)st.samples,
+                 (long)st.min_us, (long)st.p50_us, (long)st.p99_us, (long)st.max_us,
+                 (long long)cycle_start_latency_us());
+        ws_send_text(req, response);
+
+        if (cJSON_IsTrue(cJSON_GetObjectItem(root, "reset"))) {
+            executor_trace_reset();
+        }
+    }
+    // ========== COMMAND: flash_stress ==========
+    // Write a filler file to SPIFFS (cache disabled during each flash op) and
+    // report the output latency seen meanwhile - run it during a motor phase.
+    else if (strcmp(action->valuestring, "flash_stress") == 0) {
+        cJSON *kb = cJSON_GetObjectItem(root, "kb");
+        int size_kb = (kb && cJSON_IsNumber(kb)) ? kb->valueint : 64;
+        if (size_kb < 1 || size_kb > 256) {
+            ws_send_text(req, "error: kb must be 1-256");
+        } else {
+            executor_trace_reset();
+            int64_t t0 = esp_timer_get_time();
+            esp_err_t err = fs_write_filler("/spiffs/stress.bin", (size_t)size_kb * 1024);
+            int64_t write_ms = (esp_timer_get_time() - t0) / 1000;
+            remove("/spiffs/stress.bin");
+
+            ExecutorTraceStats st;
+            executor_trace_stats(&st);
+
+            char response[220];
+            snprintf(response, sizeof(response),
+                     "{\"type\":\"flash_stress\",\"ok\":%s,\"kb\":%d,\"write_ms\":%ld,\"mode\":\"%s\","
+                     "\"samples\":%u,\"p50_us\":%ld,\"p99_us\":%ld,\"max_us\":%ld}",
+                     err == ESP_OK ? "true" : "false", size_kb, (long)write_ms,
+                     executor_mode_name(st.mode), (unsigned)st.samples,
+                     (long)st.p50_us, (long)st.p99_us, (long)st.max_us);
             ws_send_text(req, response);
-            ESP_LOGI(TAG, "GPIO %d toggled to %d", pin_num, pin_state);
+        }
+    }
+    // ========== COMMAND: get_storage_stats ==========
+    else if (strcmp(action->valuestring, "get_storage_stats") == 0) {
+        FsWriteStats st;
+        fs_get_write_stats(&st);
+
+        char response[320];
+        snprintf(response, sizeof(response),
+                 "{\"type\":\"storage_stats\",\"jobs\":%lu,\"failed_jobs\":%lu,\"dropped_jobs\":%lu,"
+                 "\"bytes\":%lu,\"ops\":%lu,\"deferred_ops\":%lu,\"forced_ops\":%lu,"
+                 "\"conflicts\":%lu,\"total_defer_ms\":%lu,\"worst_op_us\":%lu}",
+                 (unsigned long)st.jobs, (unsigned long)st.failed_jobs, (unsigned long)st.dropped_jobs,
+                 (unsigned long)st.bytes, (unsigned long)st.ops, (unsigned long)st.deferred_ops,
+                 (unsigned long)st.forced_ops, (unsigned long)st.conflicts,
+                 (unsigned long)st.total_defer_ms, (unsigned long)st.worst_op_us);
+        ws_send_text(req, response);
+    }
+    // ========== COMMAND: get_sysmon ==========
+    else if (strcmp(action->valuestring, "get_sysmon") == 0) {
+        SysmonSnapshot *snap = malloc(sizeof(SysmonSnapshot));
+        char *json_str = NULL;
+        if (snap && sysmon_get_latest(snap)) {
+            json_str = sysmon_to_json(snap);
+        }
+        ws_send_text(req, json_str ? json_str : "error: no runtime stats yet");
+        free(json_str);
+        free(snap);
+    }
+    // ========== COMMAND: set_sysmon ==========
+    else if (strcmp(action->valuestring, "set_sysmon") == 0) {
+        cJSON *enable = cJSON_GetObjectItem(root, "enable");
+        cJSON *interval = cJSON_GetObjectItem(root, "interval_ms");
+        uint32_t interval_ms = (interval && cJSON_IsNumber(interval)) ? (uint32_t)interval->valuedouble : 5000;
+        if (!cJSON_IsBool(enable)) {
+            ws_send_text(req, "error: missing enable (true/false)");
+        } else if (interval_ms < SYSMON_SAMPLE_MS) {
+            ws_send_text(req, "error: interval_ms must be >= 1000");
+        } else {
+            sysmon_set_callback(cJSON_IsTrue(enable) ? sysmon_callback : NULL, interval_ms);
+            ws_send_text(req, cJSON_IsTrue(enable) ? "ok: sysmon broadcast enabled" : "ok: sysmon broadcast disabled");
+        }
+    }
+    // ========== COMMAND: set_compression ==========
+    else if (strcmp(action->valuestring, "set_compression") == 0) {
+        cJSON *enable = cJSON_GetObjectItem(root, "enable");
+        if (!cJSON_IsBool(enable)) {
+            ws_send_text(req, "error: missing enable (true/false)");
+        } else if (!comp_set_client(fd, cJSON_IsTrue(enable))) {
+            ws_send_text(req, "error: too many compressed clients");
+        } else {
+            ws_send_text(req, cJSON_IsTrue(enable) ? "ok: compression enabled" : "ok: compression disabled");
+        }
+    }
+    // ========== COMMAND: get_cycle_data ==========
+    else if (strcmp(action->valuestring, "get_cycle_data") == 0) {
+        if (!g_cycle_data_cache) {
+            ws_send_text(req, "error: no cycle loaded");
+        } else {
+            static const char prefix[] = "{\"type\":\"cycle_data\",\"phases\":";
+            size_t doc_len = sizeof(prefix) - 1 + g_cycle_data_cache_len + 1;
+            char *doc = malloc(doc_len + 1);
+            if (!doc) {
+                ws_send_text(req, "error: out of memory");
+            } else {
+                memcpy(doc, prefix, sizeof(prefix) - 1);
+                memcpy(doc + sizeof(prefix) - 1, g_cycle_data_cache, g_cycle_data_cache_len);
+                doc[doc_len - 1] = '}';
+                doc[doc_len] = '\0';
+
+                portENTER_CRITICAL(&s_comp_lock);
+                bool compressed = comp_find(s_comp_clients, fd) >= 0;
+                portEXIT_CRITICAL(&s_comp_lock);
+
+                WsCompCtx *ctx = compressed ? malloc(sizeof(WsCompCtx)) : NULL;
+                uint8_t *frame = NULL;
+                size_t frame_len = ctx ? comp_encode(ctx, WS_COMP_DOCUMENT, 0, NULL, 0,
+                                                     (const uint8_t *)doc, doc_len, &frame) : 0;
+                if (frame_len) {
+                    httpd_ws_frame_t out_frame = {
+                        .final = true,
+                        .type = HTTPD_WS_TYPE_BINARY,
+                        .payload = frame,
+                        .len = frame_len,
+                    };
+                    httpd_ws_send_frame(req, &out_frame);
+                } else {
+                    ws_send_text(req, doc);
+                }
+                free(frame);
+                free(ctx);
+                free(doc);
+            }
+        }
+    }
+    // ========== COMMAND: get_compression_stats ==========
+    else if (strcmp(action->valuestring, "get_compression_stats") == 0) {
+        static const char *kind_names[] = { "key", "delta", "document" };
+        CompStat st[3];
+        int clients = 0;
+        portENTER_CRITICAL(&s_comp_lock);
+        memcpy(st, s_comp_stats, sizeof(st));
+        for (int i = 0; i < WS_COMP_MAX_CLIENTS; i++) {
+            if (s_comp_clients[i].fd >= 0) clients++;
+        }
+        portEXIT_CRITICAL(&s_comp_lock);
+
+        char response[480];
+        int n = snprintf(response, sizeof(response), "{\"type\":\"compression_stats\",\"clients\":%d", clients);
+        for (int k = 0; k < 3 && n < (int)sizeof(response); k++) {
+            n += snprintf(response + n, sizeof(response) - n,
+                          ",\"%s\":{\"frames\":%lu,\"raw_bytes\":%llu,\"comp_bytes\":%llu,\"ratio_pct\":%.1f,\"avg_us\":%lu}",
+                          kind_names[k], (unsigned long)st[k].frames,
+                          (unsigned long long)st[k].raw_bytes, (unsigned long long)st[k].comp_bytes,
+                          st[k].raw_bytes ? 100.0 * st[k].comp_bytes / st[k].raw_bytes : 0.0,
+                          (unsigned long)(st[k].frames ? st[k].comp_us / st[k].frames : 0));
+        }
+        if (n < (int)sizeof(response)) {
+            snprintf(response + n, sizeof(response) - n, "}");
+        }
+        ws_send_text(req, response);
+    }
+    // ========== COMMAND: set_udp_telemetry ==========
+    else if (strcmp(action->valuestring, "set_udp_telemetry") == 0) {
+        cJSON *enable = cJSON_GetObjectItem(root, "enable");
+        cJSON *addr = cJSON_GetObjectItem(root, "addr");
+        cJSON *port = cJSON_GetObjectItem(root, "port");
+        cJSON *ttl = cJSON_GetObjectItem(root, "ttl");
+        if (!cJSON_IsBool(enable)) {
+            ws_send_text(req, "error: missing enable (true/false)");
+        } else if (!cJSON_IsTrue(enable)) {
+            udp_telemetry_stop();
+            udp_status_reply(req);
+        } else if ((port && (!cJSON_IsNumber(port) || port->valuedouble < 1 || port->valuedouble > 65535)) ||
+                   (ttl && (!cJSON_IsNumber(ttl) || ttl->valuedouble < 1 || ttl->valuedouble > 255))) {
+            ws_send_text(req, "error: port must be 1-65535, ttl 1-255");
+        } else if (udp_telemetry_start(cJSON_IsString(addr) ? addr->valuestring : UDP_TELEMETRY_DEFAULT_ADDR,
+                                       port ? (uint16_t)port->valuedouble : UDP_TELEMETRY_DEFAULT_PORT,
+                                       ttl ? (uint8_t)ttl->valuedouble : UDP_TELEMETRY_DEFAULT_TTL) != ESP_OK) {
+            ws_send_text(req, "error: could not start UDP telemetry (bad addr?)");
+        } else {
+            telemetry_notify_change();  // first datagram now
+            udp_status_reply(req);
+        }
+    }
+    // ========== COMMAND: get_udp_telemetry ==========
+    else if (strcmp(action->valuestring, "get_udp_telemetry") == 0) {
+        udp_status_reply(req);
+    }
+    // ========== COMMAND: set_mqtt ==========
+    else if (strcmp(action->valuestring, "set_mqtt") == 0) {
+        cJSON *enable = cJSON_GetObjectItem(root, "enable");
+        cJSON *uri = cJSON_GetObjectItem(root, "uri");
+        cJSON *qos = cJSON_GetObjectItem(root, "qos");
+        if (!cJSON_IsBool(enable)) {
+            ws_send_text(req, "error: missing enable (true/false)");
+        } else if (!cJSON_IsTrue(enable)) {
+            mqtt_pub_stop();
+            mqtt_stats_reply(req);
+        } else if (!cJSON_IsString(uri) || strncmp(uri->valuestring, "mqtt://", 7) != 0) {
+            ws_send_text(req, "error: missing uri (mqtt://host:port)");
+        } else if (qos && (!cJSON_IsNumber(qos) || qos->valuedouble < 0 || qos->valuedouble > 2)) {
+            ws_send_text(req, "error: qos must be 0, 1 or 2");
+        } else if (mqtt_pub_start(uri->valuestring, qos ? (uint8_t)qos->valuedouble : MQTT_PUB_DEFAULT_QOS) != ESP_OK) {
+            ws_send_text(req, "error: could not start MQTT publisher");
+        } else {
+            telemetry_notify_change();
+            mqtt_stats_reply(req);
+        }
+    }
+    // ========== COMMAND: get_mqtt_stats ==========
+    else if (strcmp(action->valuestring, "get_mqtt_stats") == 0) {
+        mqtt_stats_reply(req);
+    }
+    // ========== COMMAND: set_serial_telemetry ==========
+    else if (strcmp(action->valuestring, "set_serial_telemetry") == 0) {
+        cJSON *enable = cJSON_GetObjectItem(root, "enable");
+        cJSON *period = cJSON_GetObjectItem(root, "period_ms");
+        if (!cJSON_IsBool(enable)) {
+            ws_send_text(req, "error: missing enable (true/false)");
+        } else if (!cJSON_IsTrue(enable)) {
+            serial_telemetry_stop();
+            serial_status_reply(req);
+        } else if (period && !cJSON_IsNumber(period)) {
+            ws_send_text(req, "error: period_ms must be a number");
+        } else if (serial_telemetry_start(period ? (uint32_t)period->valuedouble
+                                                 : SERIAL_TELEMETRY_DEFAULT_PERIOD_MS) != ESP_OK) {
+            ws_send_text(req, "error: period_ms must be 10-1000 (and the USB driver installed)");
+        } else {
+            serial_status_reply(req);
+        }
+    }
+    // ========== COMMAND: get_serial_telemetry ==========
+    else if (strcmp(action->valuestring, "get_serial_telemetry") == 0) {
+        serial_status_reply(req);
+    }
+    // ========== COMMAND: get_ws_clients ==========
+    else if (strcmp(action->valuestring, "get_ws_clients") == 0) {
+        char *json_str = ws_clients_to_json();
+        ws_send_text(req, json_str ? json_str : "error: out of memory");
+        free(json_str);
+    }
+    // ========== COMMAND: get_cmd_stats ==========
+    else if (strcmp(action->valuestring, "get_cmd_stats") == 0) {
+        static const char *path_names[] = { "fast", "parsed" };
+        char response[420];
+        int n = snprintf(response, sizeof(response), "{\"type\":\"cmd_stats\",\"buffer_bytes\":%d", WS_CMD_BUF_LEN);
+        for (int p = 0; p < CMD_PATH_COUNT; p++) {
+            const CmdPathStat *st = &s_cmd_stats[p];
+            n += snprintf(response + n, sizeof(response) - n,
+                          ",\"%s\":{\"commands\":%lu,\"avg_us\":%lu,\"max_us\":%lu}", path_names[p],
+                          (unsigned long)st->commands,
+                          (unsigned long)(st->commands ? st->total_us / st->commands : 0),
+                          (unsigned long)st->max_us);
+        }
+        const WsAdmissionStats *ad = &s_admission;
+        snprintf(response + n, sizeof(response) - n,
+                 ",\"admission\":{\"admitted\":%lu,\"too_large\":%lu,\"low_memory\":%lu,"
+                 "\"over_budget\":%lu,\"largest_admitted\":%lu,\"min_headroom\":%ld,"
+                 "\"reserve_bytes\":%d,\"max_upload_bytes\":%d}}",
+                 (unsigned long)ad->admitted, (unsigned long)ad->too_large, (unsigned long)ad->low_memory,
+                 (unsigned long)ad->over_budget, (unsigned long)ad->largest_admitted,
+                 ad->min_headroom == UINT32_MAX ? -1L : (long)ad->min_headroom,
+                 WS_HEAP_RESERVE_BYTES, WS_UPLOAD_MAX_BYTES);
+        ws_send_text(req, response);
+    }
+    // ========== COMMAND: get_telemetry_stats ==========
+    else if (strcmp(action->valuestring, "get_telemetry_stats") == 0) {
+        static const char *rate_names[] = { "idle", "base", "fast" };
+        TelemetryStats ts;
+        telemetry_get_stats(&ts);
+
+        char response[360];
+        snprintf(response, sizeof(response),
+                 "{\"type\":\"telemetry_stats\",\"rate\":\"%s\",\"interval_ms\":%lu,\"subscribers\":%lu,"
+                 "\"wakeups\":%lu,\"base_wakeups\":%lu,\"published\":%lu,\"skipped\":%lu,"
+                 "\"avg_publish_us\":%lu,\"cpu_saved_ms\":%lu,\"packet_heap_bytes\":%lu,\"packet_json_bytes\":%lu,"
+                 "\"heap_churn_saved_kb\":%lu}",
+                 rate_names[ts.rate], (unsigned long)ts.interval_ms, (unsigned long)ts.subscribers,
+                 (unsigned long)ts.wakeups, (unsigned long)ts.base_wakeups, (unsigned long)ts.published,
+                 (unsigned long)ts.skipped, (unsigned long)ts.avg_publish_us, (unsigned long)ts.saved_ms,
+                 (unsigned long)s_tel_packet_heap, (unsigned long)s_tel_packet_bytes,
+                 (unsigned long)((ts.base_wakeups > ts.published ? (uint64_t)(ts.base_wakeups - ts.published) : 0)
+                                 * s_tel_packet_heap / 1024));
+        ws_send_text(req, response);
+    }
+    // ========== COMMAND: get_power_stats ==========
+    else if (strcmp(action->valuestring, "get_power_stats") == 0) {
+        PowerStats ps;
+        power_get_stats(&ps);
+
+        char response[260];
+        snprintf(response, sizeof(response),
+                 "{\"type\":\"power_stats\",\"light_sleep\":%s,\"window_ms\":%lu,\"sleeps\":%lu,"
+                 "\"asleep_ms\":%lu,\"wakeups_per_s\":%.2f,\"asleep_pct\":%.1f,"
+                 "\"total_sleeps\":%lu,\"total_asleep_ms\":%llu}",
+                 ps.light_sleep ? "true" : "false", (unsigned long)ps.window_ms, (unsigned long)ps.sleeps,
+                 (unsigned long)ps.asleep_ms, ps.wakeups_per_s, ps.asleep_pct,
+                 (unsigned long)ps.total_sleeps, (unsigned long long)ps.total_asleep_ms);
+        ws_send_text(req, response);
+    }
+    // ========== COMMAND: get_deadline_stats ==========
+    else if (strcmp(action->valuestring, "get_deadline_stats") == 0) {
+        DeadlineStats ds;
+        executor_deadline_stats(&ds);
+
+        char response[360];
+        snprintf(response, sizeof(response),
+                 "{\"type\":\"deadline_stats\",\"safe_tripped\":%s,\"trip_pin\":%d,\"trip_late_us\":%ld,"
+                 "\"dropped\":%lu,"
+                 "\"critical\":{\"budget_us\":%lu,\"events\":%lu,\"misses\":%lu,\"worst_late_us\":%ld},"
+                 "\"normal\":{\"budget_us\":%lu,\"events\":%lu,\"misses\":%lu,\"worst_late_us\":%ld}}",
+                 ds.safe_tripped ? "true" : "false", ds.trip_pin, (long)ds.trip_late_us,
+                 (unsigned long)ds.dropped,
+                 (unsigned long)executor_get_deadline_budget(DEADLINE_CLASS_CRITICAL),
+                 (unsigned long)ds.events[DEADLINE_CLASS_CRITICAL], (unsigned long)ds.misses[DEADLINE_CLASS_CRITICAL],
+                 (long)ds.worst_late_us[DEADLINE_CLASS_CRITICAL],
+                 (unsigned long)executor_get_deadline_budget(DEADLINE_CLASS_NORMAL),
+                 (unsigned long)ds.events[DEADLINE_CLASS_NORMAL], (unsigned long)ds.misses[DEADLINE_CLASS_NORMAL],
+                 (long)ds.worst_late_us[DEADLINE_CLASS_NORMAL]);
+        ws_send_text(req, response);
+    }
+    // ========== COMMAND: set_deadline_budget ==========
+    else if (strcmp(action->valuestring, "set_deadline_budget") == 0) {
+        cJSON *cls = cJSON_GetObjectItem(root, "class");
+        cJSON *budget = cJSON_GetObjectItem(root, "budget_us");
+        if (!cls || !cJSON_IsString(cls) ||
+            (strcmp(cls->valuestring, "critical") != 0 && strcmp(cls->valuestring, "normal") != 0)) {
+            ws_send_text(req, "error: class must be \"critical\" or \"normal\"");
+        } else if (!budget || !cJSON_IsNumber(budget) || budget->valuedouble < 1000) {
+            ws_send_text(req, "error: budget_us must be a number >= 1000");
+        } else {
+            DeadlineClass c = (strcmp(cls->valuestring, "critical") == 0) ? DEADLINE_CLASS_CRITICAL : DEADLINE_CLASS_NORMAL;
+            executor_set_deadline_budget(c, (uint32_t)budget->valuedouble);
+            ws_send_text(req, "ok: deadline budget set");
+        }
+    }
+    // ========== COMMAND: actuator_char ==========
+    // Self-test: measure valve/motor/drain response latencies (outputs really switch)
+    else if (strcmp(action->valuestring, "actuator_char") == 0) {
+        cJSON *delta = cJSON_GetObjectItem(root, "press_delta_hz");
+        cJSON *rpm = cJSON_GetObjectItem(root, "rpm_threshold");
+        if (cJSON_IsTrue(cJSON_GetObjectItem(root, "stop"))) {
+            actuator_char_abort();
+            ws_send_text(req, "ok: actuator self-test stopping");
+        } else if ((delta && !cJSON_IsNumber(delta)) || (rpm && !cJSON_IsNumber(rpm))) {
+            ws_send_text(req, "error: press_delta_hz and rpm_threshold must be numbers");
+        } else {
+            ActuatorCharConfig cfg = {
+                .press_delta_hz = delta ? (float)delta->valuedouble : 0,
+                .rpm_threshold = rpm ? (float)rpm->valuedouble : 0,
+            };
+            esp_err_t err = actuator_char_start(&cfg);
+            if (err == ESP_ERR_INVALID_STATE) {
+                ws_send_text(req, "error: cycle, output sequence or self-test running");
+            } else if (err == ESP_ERR_INVALID_ARG) {
+                ws_send_text(req, "error: thresholds must not be negative");
+            } else if (err != ESP_OK) {
+                ws_send_text(req, "error: could not start actuator self-test");
+            } else {
+                ws_send_text(req, "ok: actuator self-test started");
+            }
+        }
+    }
+    // ========== COMMAND: get_actuator_char ==========
+    else if (strcmp(action->valuestring, "get_actuator_char") == 0) {
+        char *json_str = actuator_to_json(cJSON_IsTrue(cJSON_GetObjectItem(root, "trace")));
+        ws_send_text(req, json_str ? json_str : "error: out of memory");
+        free(json_str);
+    }
+    // ========== COMMAND: set_actuator_comp ==========
+    else if (strcmp(action->valuestring, "set_actuator_comp") == 0) {
+        cJSON *enabled = cJSON_GetObjectItem(root, "enabled");
+        if (!cJSON_IsBool(enabled)) {
+            ws_send_text(req, "error: enabled must be true or false");
+        } else if (actuator_set_compensation(cJSON_IsTrue(enabled)) != ESP_OK) {
+            ws_send_text(req, "error: compensation set but not stored in NVS");
+        } else {
+            ws_send_text(req, cJSON_IsTrue(enabled) ? "ok: OFF compensation on" : "ok: OFF compensation off");
+        }
+    }
+    // ========== COMMAND: get_motor_mon ==========
+    else if (strcmp(action->valuestring, "get_motor_mon") == 0) {
+        MotorMonStats mm;
+        motor_mon_stats(&mm);
+
+        char response[480];
+        snprintf(response, sizeof(response),
+                 "{\"type\":\"motor_mon\",\"mode\":\"%s\",\"active\":%s,\"period_us\":%d,"
+                 "\"start_window_ms\":%lu,\"stop_window_ms\":%lu,\"stall_min_ms\":%lu,"
+                 "\"fault\":\"%s\",\"fault_late_us\":%lu,\"last_fault\":\"%s\",\"cycle_faults\":%lu,"
+                 "\"checks\":%lu,\"avg_ns\":%lu,\"max_ns\":%lu,"
+                 "\"edges_lost\":%lu,\"faults\":{\"no_spin\":%lu,\"run_on\":%lu,\"stall\":%lu}}",
+                 motor_mon_mode_name(mm.cfg.mode), mm.active ? "true" : "false", MOTOR_MON_PERIOD_US,
+                 (unsigned long)mm.start_window_ms, (unsigned long)mm.stop_window_ms,
+                 (unsigned long)(mm.cfg.stall_min_ms ? mm.cfg.stall_min_ms : MOTOR_MON_DEFAULT_STALL_MS),
+                 motor_mon_fault_name(mm.fault), (unsigned long)mm.fault_late_us,
+                 motor_mon_fault_name(mm.last_fault), (unsigned long)mm.cycle_faults, (unsigned long)mm.checks,
+                 (unsigned long)mm.avg_ns, (unsigned long)mm.max_ns, (unsigned long)mm.edges_lost,
+                 (unsigned long)mm.faults[MOTOR_FAULT_NO_SPIN], (unsigned long)mm.faults[MOTOR_FAULT_RUN_ON],
+                 (unsigned long)mm.faults[MOTOR_FAULT_STALL]);
+        ws_send_text(req, response);
+    }
+    // ========== COMMAND: set_motor_mon ==========
+    // Omitted fields keep their value; a window of 0 goes back to automatic
+    else if (strcmp(action->valuestring, "set_motor_mon") == 0) {
+        static const char *const window_keys[] = { "start_window_ms", "stop_window_ms", "stall_min_ms" };
+        MotorMonConfig cfg;
+        motor_mon_get_config(&cfg);
+        uint32_t *windows[] = { &cfg.start_window_ms, &cfg.stop_window_ms, &cfg.stall_min_ms };
+
+        const char *err_msg = NULL;
+        cJSON *mode = cJSON_GetObjectItem(root, "mode");
+        if (mode) {
+            if (!cJSON_IsString(mode)) err_msg = "error: mode must be \"off\", \"alarm\" or \"abort\"";
+            else if (strcmp(mode->valuestring, "off") == 0) cfg.mode = MOTOR_MON_OFF;
+            else if (strcmp(mode->valuestring, "alarm") == 0) cfg.mode = MOTOR_MON_ALARM;
+            else if (strcmp(mode->valuestring, "abort") == 0) cfg.mode = MOTOR_MON_ABORT;
+            else err_msg = "error: mode must be \"off\", \"alarm\" or \"abort\"";
+        }
+        for (size_t i = 0; !err_msg && i < sizeof(window_keys) / sizeof(window_keys[0]); i++) {
+            cJSON *w = cJSON_GetObjectItem(root, window_keys[i]);
+            if (!w) continue;
+            if (!cJSON_IsNumber(w) || w->valuedouble < 0) {
+                err_msg = "error: windows must be numbers (ms)";
+            } else {
+                *windows[i] = (uint32_t)w->valuedouble;
+            }
+        }
+        if (!err_msg && motor_mon_configure(&cfg) != ESP_OK) {
+            err_msg = "error: windows must be 0 (auto) or 100-60000 ms";
+        }
+        ws_send_text(req, err_msg ? err_msg : "ok: motor monitor set (applies from the next cycle)");
+    }
+    // ========== COMMAND: get_imbalance ==========
+    else if (strcmp(action->valuestring, "get_imbalance") == 0) {
+        ImbalanceResult ir;
+        imbalance_get(&ir);
+
+        char response[360];
+        snprintf(response, sizeof(response),
+                 "{\"type\":\"imbalance\",\"valid\":%s,\"pulses_per_rev\":%lu,\"auto_ppr\":%s,\"samples\":%lu,"
+                 "\"rpm\":%.1f,\"mean_interval_us\":%lu,\"imbalance_pm\":%u,\"ripple_pm\":[%u,%u,%u],"
+                 "\"age_ms\":%lld,\"windows\":%lu,\"last_ns\":%lu,\"max_ns\":%lu}",
+                 ir.valid ? "true" : "false", (unsigned long)ir.pulses_per_rev,
+                 imbalance_get_pulses_per_rev() ? "false" : "true", (unsigned long)ir.samples,
+                 ir.rpm, (unsigned long)ir.mean_interval_us, ir.imbalance_pm,
+                 ir.ripple_pm[0], ir.ripple_pm[1], ir.ripple_pm[2],
+                 ir.time_us ? (long long)((esp_timer_get_time() - ir.time_us) / 1000) : -1LL,
+                 (unsigned long)ir.windows, (unsigned long)ir.last_ns, (unsigned long)ir.max_ns);
+        ws_send_text(req, response);
+    }
+    // ========== COMMAND: set_imbalance ==========
+    else if (strcmp(action->valuestring, "set_imbalance") == 0) {
+        cJSON *ppr = cJSON_GetObjectItem(root, "pulses_per_rev");
+        if (!cJSON_IsNumber(ppr) || ppr->valuedouble < 0 ||
+            imbalance_set_pulses_per_rev((uint32_t)ppr->valuedouble) != ESP_OK) {
+            ws_send_text(req, "error: pulses_per_rev must be 0 (auto) or 3-64");
+        } else {
+            ws_send_text(req, "ok: imbalance pulses per revolution set");
+        }
+    }
+    // ========== COMMAND: get_flow ==========
+    else if (strcmp(action->valuestring, "get_flow") == 0) {
+        uint32_t count = flow_meter_count();
+        char response[256];
+        snprintf(response, sizeof(response),
+                 "{\"type\":\"flow\",\"pulses_per_litre\":%.1f,\"pulses\":%lu,\"total_l\":%.3f,"
+                 "\"flow_lpm\":%.2f,\"phase_volume_ml\":[%lu,%lu,%lu]}",
+                 flow_meter_get_pulses_per_litre(), (unsigned long)count,
+                 (double)count / flow_meter_get_pulses_per_litre(), flow_meter_rate_lpm(),
+                 (unsigned long)cycle_phase_volume_ml(0), (unsigned long)cycle_phase_volume_ml(1),
+                 (unsigned long)cycle_phase_volume_ml(2));
+        ws_send_text(req, response);
+    }
+    // ========== COMMAND: set_flow ==========
+    else if (strcmp(action->valuestring, "set_flow") == 0) {
+        cJSON *ppl = cJSON_GetObjectItem(root, "pulses_per_litre");
+        if (!cJSON_IsNumber(ppl) || flow_meter_set_pulses_per_litre((float)ppl->valuedouble) != ESP_OK) {
+            ws_send_text(req, "error: pulses_per_litre must be a number > 0");
+        } else {
+            ws_send_text(req, "ok: flow meter calibration set");
         }
     }
     else {
@@ -286,16 +1784,13 @@ esp_err_t ws_handler(httpd_req_t *req)
     }
 
     cJSON_Delete(root);
-    free(buf);
+    ws_free_frame(buf);
+    cmd_stat_add(CMD_PATH_PARSED, t_frame);
     return ESP_OK;
 }
 
 // ====================== TELEMETRY CALLBACK ======================
 
-// Static cache for cycle_data structure (only updated when cycle loads, not every telemetry)
-static char *g_cycle_data_cache = NULL;
-static size_t g_cycle_data_cache_len = 0;
-
 /**
  * Update the cached cycle_data JSON (called only when a new cycle is loaded)
  * This prevents recreating the same structure 600 times per minute
@@ -356,6 +1851,13 @@ static void telemetry_callback(const TelemetryPacket *packet)
 {
     if (!packet) return;
 
+    // Datagram first: it costs one send however many listeners there are
+    udp_telemetry_publish(packet);
+    mqtt_pub_on_telemetry(packet);  // copies into the RAM queue, never waits on the network
+    if (ws_client_count() == 0) return;
+
+    size_t heap_before = esp_get_free_heap_size();
+
     // Build JSON object with ONLY live telemetry data (no cycle_data to reduce allocations)
     cJSON *root = cJSON_CreateObject();
     if (!root) return;
@@ -377,6 +1879,10 @@ static void telemetry_callback(const TelemetryPacket *packet)
     cJSON_AddNumberToObject(sensors, "rpm", packet->sensors.rpm);
     cJSON_AddNumberToObject(sensors, "pressure_freq", packet->sensors.pressure_freq);
     cJSON_AddBoolToObject(sensors, "sensor_error", packet->sensors.sensor_error);
+    if (packet->sensors.imbalance_valid) {
+        cJSON_AddNumberToObject(sensors, "imbalance_pm", packet->sensors.imbalance_pm);
+    }
+    cJSON_AddNumberToObject(sensors, "flow_lpm", packet->sensors.flow_lpm);
 
     // Cycle data (current execution state only - not static structure)
     cJSON *cycle = cJSON_AddObjectToObject(root, "cycle");
@@ -386,10 +1892,42 @@ static void telemetry_callback(const TelemetryPacket *packet)
     cJSON_AddNumberToObject(cycle, "total_phases", packet->cycle.total_phases);
     cJSON_AddNumberToObject(cycle, "phase_elapsed_ms", packet->cycle.phase_elapsed_ms);
 
+    cJSON_AddNumberToObject(cycle, "deadline_misses", packet->cycle.deadline_misses);
+    cJSON_AddNumberToObject(cycle, "phase_volume_ml", packet->cycle.phase_volume_ml);
+    if (packet->cycle.deadline_alarm) {
+        cJSON *alarm = cJSON_AddObjectToObject(cycle, "alarm");
+        cJSON_AddStringToObject(alarm, "type", "deadline_miss");
+        cJSON_AddNumberToObject(alarm, "pin", packet->cycle.alarm_pin);
+        cJSON_AddNumberToObject(alarm, "late_us", packet->cycle.alarm_late_us);
+    } else if (packet->cycle.motor_fault != MOTOR_FAULT_NONE) {
+        cJSON *alarm = cJSON_AddObjectToObject(cycle, "alarm");
+        cJSON_AddStringToObject(alarm, "type", "motor_fault");
+        cJSON_AddStringToObject(alarm, "fault", motor_mon_fault_name((MotorFault)packet->cycle.motor_fault));
+        cJSON_AddNumberToObject(alarm, "late_us", packet->cycle.motor_fault_late_us);
+    }
+
+    // Per-track state, only when the cycle runs concurrent tracks
+    if (packet->cycle.num_tracks > 1) {
+        cJSON *tracks = cJSON_AddArrayToObject(cycle, "tracks");
+        for (int t = 0; t < packet->cycle.num_tracks; t++) {
+            const TrackTelemetry *tt = &packet->cycle.tracks[t];
+            cJSON *track_obj = cJSON_CreateObject();
+            cJSON_AddStringToObject(track_obj, "id", tt->track_id);
+            cJSON_AddBoolToObject(track_obj, "active", tt->active);
+            cJSON_AddNumberToObject(track_obj, "phase_index", tt->phase_index);
+            cJSON_AddStringToObject(track_obj, "phase_name", tt->phase_name);
+            cJSON_AddNumberToObject(track_obj, "phase_elapsed_ms", tt->phase_elapsed_ms);
+            cJSON_AddItemToArray(tracks, track_obj);
+        }
+    }
+
     // Serialize to JSON string
     char *json_str = cJSON_PrintUnformatted(root);
     if (json_str) {
-        ws_broadcast_text(json_str);
+        size_t heap_now = esp_get_free_heap_size();
+        s_tel_packet_heap = (heap_before > heap_now) ? (uint32_t)(heap_before - heap_now) : 0;
+        s_tel_packet_bytes = strlen(json_str);
+        ws_broadcast_telemetry(json_str);
         free(json_str);
     }
 
@@ -405,13 +1943,22 @@ esp_err_t ws_cycle_start(void)
     
     // Increase WebSocket limits for large JSON messages
     cfg.max_uri_handlers = 16;          // Default: 8
-    cfg.max_open_sockets = 7;           // Max allowed: 7 (3 used internally, 4 available)
+    cfg.max_open_sockets = WS_MAX_SESSIONS; // Max allowed: 7 (3 used internally, 4 available)
+    cfg.lru_purge_enable = true;        // all in use: close the least recently heard session
     cfg.send_wait_timeout = 10;         // Default: 5
     cfg.recv_wait_timeout = 10;         // Default: 5
     cfg.stack_size = 8192;              // Default: 4096 - increase for JSON parsing
     
+    cfg.close_fn = ws_close_fn;         // drop per-client state (compression) with the session
     s_server_port = cfg.server_port;  
 
+    for (int i = 0; i < WS_COMP_MAX_CLIENTS; i++) {
+        s_comp_clients[i].fd = -1;
+    }
+    for (int i = 0; i < WS_MAX_SESSIONS; i++) {
+        s_peers[i].fd = -1;
+    }
+
     esp_err_t ret = httpd_start(&s_server, &cfg);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "httpd_start failed: %s", esp_err_to_name(ret));
@@ -423,10 +1970,21 @@ esp_err_t ws_cycle_start(void)
         .method = HTTP_GET,
         .handler = ws_handler,
         .is_websocket = true,
+        .handle_ws_control_frames = true,   // pongs refresh client liveness
         .user_ctx = NULL
     };
     httpd_register_uri_handler(s_server, &ws);
 
+    const esp_timer_create_args_t ka_args = {
+        .callback = ws_keepalive_timer_cb,
+        .name = "ws_keepalive",
+    };
+    if (esp_timer_create(&ka_args, &s_keepalive_timer) == ESP_OK) {
+        esp_timer_start_periodic(s_keepalive_timer, (uint64_t)WS_KEEPALIVE_TICK_MS * 1000);
+    } else {
+        ESP_LOGW(TAG, "keepalive timer not created; stale clients are only closed by the LRU purge");
+    }
+
     // Log WebSocket endpoint with IP address
     esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
     if (netif) {
@@ -449,5 +2007,6 @@ esp_err_t ws_cycle_start(void)
 void ws_register_telemetry_callback(void)
 {
     telemetry_set_callback(telemetry_callback);
+    telemetry_set_subscriber_fn(telemetry_subscribers);
     ESP_LOGI(TAG, "Telemetry callback registered for WebSocket broadcast");
 }
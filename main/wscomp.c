@@ -0,0 +1,134 @@
+// wscomp.c
+#include "wscomp.h"
+#include <string.h>
+
+#define HASH_NONE   UINT32_MAX
+
+// Byte at position pos of the virtual buffer dict || src
+static inline uint8_t byte_at(const uint8_t *dict, size_t dict_len, const uint8_t *src, size_t pos)
+{
+    return (pos < dict_len) ? dict[pos] : src[pos - dict_len];
+}
+
+static inline uint32_t hash3(const uint8_t *dict, size_t dict_len, const uint8_t *src, size_t pos)
+{
+    uint32_t v = (uint32_t)byte_at(dict, dict_len, src, pos)
+               | ((uint32_t)byte_at(dict, dict_len, src, pos + 1) << 8)
+               | ((uint32_t)byte_at(dict, dict_len, src, pos + 2) << 16);
+    return (v * 2654435761u) >> (32 - WSCOMP_HASH_BITS);
+}
+
+size_t wscomp_compress(WsCompCtx *ctx, const uint8_t *dict, size_t dict_len,
+                       const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_cap)
+{
+    if (!ctx || !src || !dst) return 0;
+    if (!dict) dict_len = 0;
+
+    memset(ctx->head, 0xff, sizeof(ctx->head));
+
+    // Only the tail of the dictionary is reachable
+    size_t seed = (dict_len > WSCOMP_WINDOW) ? dict_len - WSCOMP_WINDOW : 0;
+    for (size_t p = seed; p + WSCOMP_MIN_MATCH <= dict_len; p++) {
+        ctx->head[hash3(dict, dict_len, src, p)] = (uint32_t)p;
+    }
+
+    size_t end = dict_len + src_len;
+    size_t pos = dict_len;
+    size_t out = 0;
+    size_t flag_at = 0;
+    int flag_bit = 8;
+
+    while (pos < end) {
+        if (flag_bit == 8) {
+            if (out >= dst_cap) return 0;
+            flag_at = out;
+            dst[out++] = 0;
+            flag_bit = 0;
+        }
+
+        size_t best_len = 0;
+        size_t best_dist = 0;
+        if (pos + WSCOMP_MIN_MATCH <= end) {
+            uint32_t h = hash3(dict, dict_len, src, pos);
+            uint32_t cand = ctx->head[h];
+            ctx->head[h] = (uint32_t)pos;
+            if (cand != HASH_NONE && pos - cand <= WSCOMP_WINDOW) {
+                size_t max = end - pos;
+                if (max > WSCOMP_MAX_MATCH) max = WSCOMP_MAX_MATCH;
+                size_t len = 0;
+                while (len < max &&
+                       byte_at(dict, dict_len, src, cand + len) == byte_at(dict, dict_len, src, pos + len)) {
+                    len++;
+                }
+                if (len >= WSCOMP_MIN_MATCH) {
+                    best_len = len;
+                    best_dist = pos - cand;
+                }
+            }
+        }
+
+        if (best_len) {
+            size_t code = best_len - WSCOMP_MIN_MATCH;
+            size_t need = (code >= 15) ? 3 : 2;
+            if (out + need > dst_cap) return 0;
+            dst[flag_at] |= (uint8_t)(1u << flag_bit);
+            dst[out++] = (uint8_t)((best_dist - 1) & 0xff);
+            dst[out++] = (uint8_t)((((best_dist - 1) >> 8) << 4) | (code >= 15 ? 15 : code));
+            if (code >= 15) dst[out++] = (uint8_t)(code - 15);
+
+            // Index the skipped positions so later matches can start inside this one
+            for (size_t p = pos + 1; p < pos + best_len && p + WSCOMP_MIN_MATCH <= end; p++) {
+                ctx->head[hash3(dict, dict_len, src, p)] = (uint32_t)p;
+            }
+            pos += best_len;
+        } else {
+            if (out >= dst_cap) return 0;
+            dst[out++] = byte_at(dict, dict_len, src, pos);
+            pos++;
+        }
+        flag_bit++;
+    }
+
+    return out;
+}
+
+size_t wscomp_decompress(const uint8_t *dict, size_t dict_len,
+                         const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_len)
+{
+    if (!src || !dst) return 0;
+    if (!dict) dict_len = 0;
+
+    size_t in = 0;
+    size_t out = 0;
+
+    while (out < dst_len) {
+        if (in >= src_len) return 0;
+        uint8_t flags = src[in++];
+
+        for (int bit = 0; bit < 8 && out < dst_len; bit++) {
+            if (!(flags & (1u << bit))) {
+                if (in >= src_len) return 0;
+                dst[out++] = src[in++];
+                continue;
+            }
+
+            if (in + 2 > src_len) return 0;
+            size_t dist = ((size_t)src[in] | ((size_t)(src[in + 1] >> 4) << 8)) + 1;
+            size_t len = (src[in + 1] & 0x0f) + WSCOMP_MIN_MATCH;
+            in += 2;
+            if (len == WSCOMP_MIN_MATCH + 15) {
+                if (in >= src_len) return 0;
+                len += src[in++];
+            }
+            if (dist > dict_len + out || out + len > dst_len) return 0;
+
+            // Byte-wise: the source may overlap the bytes being written
+            for (size_t i = 0; i < len; i++, out++) {
+                size_t from = dict_len + out - dist;
+                dst[out] = (from < dict_len) ? dict[from] : dst[from - dict_len];
+            }
+        }
+    }
+
+    return out;
+}
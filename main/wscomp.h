@@ -0,0 +1,40 @@
+// wscomp.h
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Small LZ77 codec for WebSocket payloads (telemetry, cycle documents).
+// Matches may reach back into an optional dictionary that precedes the input,
+// so a telemetry packet coded against the previous one shrinks to a few
+// dozen bytes. Fixed memory: one WsCompCtx (4 KB) per concurrent compressor,
+// no heap. Decoding needs no context at all.
+//
+// Stream format: a flag byte introduces up to 8 tokens, LSB first.
+//   bit 0 - literal: 1 byte
+//   bit 1 - match:   2 bytes  [dist-1 low 8] [(dist-1) >> 8 << 4 | (len-3)]
+//                    len nibble 15 is followed by one extra length byte (len 18..273)
+// dist counts back from the current position through the output and then the
+// dictionary (dist <= WSCOMP_WINDOW).
+
+#define WSCOMP_WINDOW       4096
+#define WSCOMP_MIN_MATCH    3
+#define WSCOMP_MAX_MATCH    (WSCOMP_MIN_MATCH + 15 + 255)
+#define WSCOMP_HASH_BITS    10
+
+typedef struct {
+    uint32_t head[1 << WSCOMP_HASH_BITS];   // last position per hash bucket
+} WsCompCtx;
+
+// Worst-case compressed size for src_len bytes (all literals)
+#define WSCOMP_BOUND(src_len)   ((src_len) + ((src_len) + 7) / 8)
+
+// Compress src (coded after dict, which may be NULL/0) into dst.
+// Returns the compressed size, or 0 if it does not fit in dst_cap.
+size_t wscomp_compress(WsCompCtx *ctx, const uint8_t *dict, size_t dict_len,
+                       const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_cap);
+
+// Decompress exactly dst_len bytes with the same dict the sender used.
+// Returns dst_len, or 0 on a malformed or truncated stream.
+size_t wscomp_decompress(const uint8_t *dict, size_t dict_len,
+                         const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_len);
@@ -0,0 +1,212 @@
+// wstok.c
+#include "wstok.h"
+#include <ctype.h>
+#include <string.h>
+
+// What the next non-blank byte may be
+typedef enum {
+    WANT_VALUE,
+    WANT_VALUE_OR_CLOSE,    // just after '['
+    WANT_KEY,
+    WANT_KEY_OR_CLOSE,      // just after '{'
+    WANT_COLON,
+    WANT_COMMA,             // after a value inside a container
+    WANT_END,               // top-level value complete
+} Want;
+
+static bool is_blank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Length of the number at p (JSON grammar), 0 if there is none
+static size_t number_len(const char *p, size_t n)
+{
+    size_t i = 0;
+    if (i < n && p[i] == '-') i++;
+    if (i >= n || !isdigit((unsigned char)p[i])) return 0;
+    if (p[i] == '0') {
+        i++;
+    } else {
+        while (i < n && isdigit((unsigned char)p[i])) i++;
+    }
+    if (i < n && p[i] == '.') {
+        i++;
+        if (i >= n || !isdigit((unsigned char)p[i])) return 0;
+        while (i < n && isdigit((unsigned char)p[i])) i++;
+    }
+    if (i < n && (p[i] == 'e' || p[i] == 'E')) {
+        i++;
+        if (i < n && (p[i] == '+' || p[i] == '-')) i++;
+        if (i >= n || !isdigit((unsigned char)p[i])) return 0;
+        while (i < n && isdigit((unsigned char)p[i])) i++;
+    }
+    return i;
+}
+
+// Length of the primitive at p, 0 if it is not one
+static size_t primitive_len(const char *p, size_t n)
+{
+    static const char *words[] = { "true", "false", "null" };
+    for (size_t w = 0; w < sizeof(words) / sizeof(words[0]); w++) {
+        size_t wl = strlen(words[w]);
+        if (n >= wl && memcmp(p, words[w], wl) == 0) return wl;
+    }
+    return number_len(p, n);
+}
+
+// Scan the string whose opening quote is at js[i]; returns the offset of the closing quote or -1
+static int scan_string(const char *js, size_t len, size_t i, bool *escaped)
+{
+    for (size_t p = i + 1; p < len; p++) {
+        unsigned char c = (unsigned char)js[p];
+        if (c == '"') return (int)p;
+        if (c < 0x20) return -1;
+        if (c == '\\') {
+            *escaped = true;
+            if (++p >= len) return -1;
+            if (js[p] == 'u') {
+                for (int h = 0; h < 4; h++) {
+                    if (++p >= len || !isxdigit((unsigned char)js[p])) return -1;
+                }
+            } else if (!strchr("\"\\/bfnrt", js[p])) {
+                return -1;
+            }
+        }
+    }
+    return -1;
+}
+
+int wstok_parse(const char *js, size_t len, WsTok *tok, int max_tok, WsTokDoc *doc)
+{
+    int stack[WSTOK_MAX_DEPTH];     // open containers (token index)
+    int depth = 0;
+    int count = 0;
+    Want want = WANT_VALUE;
+    bool escaped = false;
+
+    if (len > UINT16_MAX) return WSTOK_ERR_NOMEM;
+
+    for (size_t i = 0; i < len; i++) {
+        char c = js[i];
+        if (is_blank(c)) continue;
+
+        if (c == ':') {
+            if (want != WANT_COLON) return WSTOK_ERR_INVAL;
+            want = WANT_VALUE;
+            continue;
+        }
+        if (c == ',') {
+            if (want != WANT_COMMA) return WSTOK_ERR_INVAL;
+            want = (tok[stack[depth - 1]].type == WSTOK_OBJECT) ? WANT_KEY : WANT_VALUE;
+            continue;
+        }
+        if (c == '}' || c == ']') {
+            WsTokType type = (c == '}') ? WSTOK_OBJECT : WSTOK_ARRAY;
+            Want empty = (c == '}') ? WANT_KEY_OR_CLOSE : WANT_VALUE_OR_CLOSE;
+            if (depth == 0 || tok[stack[depth - 1]].type != type ||
+                (want != WANT_COMMA && want != empty)) {
+                return WSTOK_ERR_INVAL;
+            }
+            tok[stack[--depth]].end = (uint16_t)(i + 1);
+            want = depth ? WANT_COMMA : WANT_END;
+            continue;
+        }
+
+        // Everything else starts a token
+        bool is_key = (c == '"' && (want == WANT_KEY || want == WANT_KEY_OR_CLOSE));
+        if (!is_key && want != WANT_VALUE && want != WANT_VALUE_OR_CLOSE) return WSTOK_ERR_INVAL;
+        if (count >= max_tok) return WSTOK_ERR_NOMEM;
+        WsTok *t = &tok[count];
+
+        if (c == '{' || c == '[') {
+            if (depth >= WSTOK_MAX_DEPTH) return WSTOK_ERR_INVAL;
+            t->type = (c == '{') ? WSTOK_OBJECT : WSTOK_ARRAY;
+            t->start = (uint16_t)i;
+            t->end = 0;
+            stack[depth++] = count++;
+            want = (c == '{') ? WANT_KEY_OR_CLOSE : WANT_VALUE_OR_CLOSE;
+            continue;
+        }
+
+        if (c == '"') {
+            int close = scan_string(js, len, i, &escaped);
+            if (close < 0) return WSTOK_ERR_PART;
+            t->type = WSTOK_STRING;
+            t->start = (uint16_t)(i + 1);
+            t->end = (uint16_t)close;
+            i = (size_t)close;
+        } else {
+            size_t n = primitive_len(js + i, len - i);
+            if (n == 0) return WSTOK_ERR_INVAL;
+            t->type = WSTOK_PRIMITIVE;
+            t->start = (uint16_t)i;
+            t->end = (uint16_t)(i + n);
+            i += n - 1;
+        }
+        count++;
+        want = is_key ? WANT_COLON : (depth ? WANT_COMMA : WANT_END);
+    }
+
+    if (want != WANT_END) return (count == 0) ? WSTOK_ERR_INVAL : WSTOK_ERR_PART;
+
+    doc->js = js;
+    doc->tok = tok;
+    doc->count = count;
+    doc->escaped = escaped;
+    return count;
+}
+
+// Index of the first token after t and everything nested in it
+static int skip(const WsTokDoc *doc, int t)
+{
+    int end = doc->tok[t].end;
+    int j = t + 1;
+    while (j < doc->count && doc->tok[j].start < end) j++;
+    return j;
+}
+
+int wstok_get(const WsTokDoc *doc, int obj, const char *key)
+{
+    if (obj < 0 || obj >= doc->count || doc->tok[obj].type != WSTOK_OBJECT) return -1;
+
+    size_t key_len = strlen(key);
+    int j = obj + 1;
+    while (j + 1 < doc->count && doc->tok[j].start < doc->tok[obj].end) {
+        const WsTok *k = &doc->tok[j];
+        if ((size_t)(k->end - k->start) == key_len &&
+            strncasecmp(doc->js + k->start, key, key_len) == 0) {
+            return j + 1;
+        }
+        j = skip(doc, j + 1);
+    }
+    return -1;
+}
+
+bool wstok_eq(const WsTokDoc *doc, int t, const char *s)
+{
+    if (t < 0 || doc->tok[t].type != WSTOK_STRING) return false;
+    size_t n = doc->tok[t].end - doc->tok[t].start;
+    return strlen(s) == n && memcmp(doc->js + doc->tok[t].start, s, n) == 0;
+}
+
+bool wstok_int(const WsTokDoc *doc, int t, int64_t min, int64_t max, int64_t *out)
+{
+    if (t < 0 || doc->tok[t].type != WSTOK_PRIMITIVE) return false;
+
+    const char *p = doc->js + doc->tok[t].start;
+    const char *end = doc->js + doc->tok[t].end;
+    bool neg = (*p == '-');
+    if (neg) p++;
+    if (p == end || end - p > 10) return false;     // also rejects true/false/null below
+
+    int64_t v = 0;
+    for (; p < end; p++) {
+        if (!isdigit((unsigned char)*p)) return false;
+        v = v * 10 + (*p - '0');
+    }
+    if (neg) v = -v;
+    if (v < min || v > max) return false;
+    *out = v;
+    return true;
+}
@@ -0,0 +1,55 @@
+// wstok.h
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// In-place JSON tokenizer for small command frames (jsmn style). One pass
+// over the text fills a caller-supplied token array with offsets into it;
+// nothing is copied, decoded or allocated, and the work is bounded by the
+// frame length. The grammar check is strict: anything cJSON_Parse would
+// reject is rejected here too, so a caller can hand every failure to the
+// cJSON path and get the same reply it always did.
+//
+// Tokens are in document order. A container's children are the tokens that
+// follow it and start before its end; object members are key, value pairs.
+
+#define WSTOK_MAX_DEPTH     8
+
+typedef enum {
+    WSTOK_OBJECT,
+    WSTOK_ARRAY,
+    WSTOK_STRING,       // start/end exclude the quotes
+    WSTOK_PRIMITIVE,    // number, true, false, null
+} WsTokType;
+
+typedef struct {
+    uint8_t  type;      // WsTokType
+    uint16_t start;     // offset of the first byte
+    uint16_t end;       // offset past the last byte
+} WsTok;
+
+typedef struct {
+    const char *js;
+    const WsTok *tok;
+    int         count;
+    bool        escaped;    // some string holds a backslash escape (raw bytes != decoded value)
+} WsTokDoc;
+
+#define WSTOK_ERR_NOMEM     (-1)    // more tokens than the array holds
+#define WSTOK_ERR_INVAL     (-2)    // not valid JSON (or nested deeper than WSTOK_MAX_DEPTH)
+#define WSTOK_ERR_PART      (-3)    // text ends inside a value
+
+// Tokenize js[0..len) (len < 65536). Returns the token count or a WSTOK_ERR_* code.
+int wstok_parse(const char *js, size_t len, WsTok *tok, int max_tok, WsTokDoc *doc);
+
+// Value token of key in the object at index obj (first match, ASCII case-insensitive
+// like cJSON_GetObjectItem), or -1
+int wstok_get(const WsTokDoc *doc, int obj, const char *key);
+
+// String token equals s exactly
+bool wstok_eq(const WsTokDoc *doc, int t, const char *s);
+
+// Plain integer primitive (no fraction or exponent) within [min, max]
+bool wstok_int(const WsTokDoc *doc, int t, int64_t min, int64_t max, int64_t *out);
@@ -0,0 +1,158 @@
+// complexity_test.c
+// Loader growth check. cJSON arrays are linked lists, so indexing one with
+// cJSON_GetArrayItem(arr, i) inside a loop is O(n^2); the loaders walk them
+// with cJSON_ArrayForEach instead. This times cycle_load_from_json_str() on
+// documents whose motor pattern, components per phase or phase count is n, 2n
+// and 4n, and fails when the time grows as n^e with e well above 1 (taken over
+// the whole n..4n span, where a quadratic walk stands out from the linear
+// parse far better than in a single doubling). The real
+// ws_update_cycle_data_cache() is linked in, so the cache rebuild after a load
+// is timed too.
+//
+// Each size takes the best of COMPLEXITY_ROUNDS loads, which drops scheduler
+// noise; the fixed per-load cost (pool reset) only pulls the ratios down.
+#include <math.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fuzz_common.h"
+#include "fuzz_stubs.h"
+#include "cycle.h"
+
+#define COMPLEXITY_ROUNDS      15
+#define COMPLEXITY_MAX_EXP     1.3      // growth exponent: linear is ~1, a quadratic walk ~1.6+
+#define COMPLEXITY_SIZES       3        // n, 2n, 4n
+
+typedef struct {
+    char  *buf;
+    size_t len;
+    size_t cap;
+} Doc;
+
+static void doc_add(Doc *d, const char *fmt, ...)
+{
+    va_list ap;
+    for (;;) {
+        va_start(ap, fmt);
+        int n = vsnprintf(d->buf + d->len, d->cap - d->len, fmt, ap);
+        va_end(ap);
+        if (n < 0) abort();
+        if ((size_t)n < d->cap - d->len) {
+            d->len += (size_t)n;
+            return;
+        }
+        d->cap = (d->cap + (size_t)n) * 2;
+        d->buf = realloc(d->buf, d->cap);
+        if (!d->buf) abort();
+    }
+}
+
+static void doc_component(Doc *d, int phase, int comp, int steps)
+{
+    doc_add(d, "%s{\"id\":\"c%d_%d\",\"label\":\"Component\",\"compId\":\"%s\",\"start\":%d,\"duration\":1000",
+            comp ? "," : "", phase, comp, steps ? "Motor" : "Cold Valve", comp * 100);
+    if (steps) {
+        doc_add(d, ",\"motorConfig\":{\"repeatTimes\":1,\"runningStyle\":\"Toggle Direction\",\"pattern\":[");
+        for (int s = 0; s < steps; s++) {
+            doc_add(d, "%s{\"stepTime\":%d,\"pauseTime\":%d,\"direction\":\"%s\"}",
+                    s ? "," : "", 300 + s % 7, 100 + s % 5, (s & 1) ? "ccw" : "cw");
+        }
+        doc_add(d, "]}");
+    }
+    doc_add(d, "}");
+}
+
+static void doc_cycle(Doc *d, int phases, int comps, int steps)
+{
+    d->len = 0;
+    doc_add(d, "{\"phases\":[");
+    for (int p = 0; p < phases; p++) {
+        doc_add(d, "%s{\"id\":\"p%d\",\"name\":\"phase%d\",\"color\":\"4ADE80\",\"startTime\":0,\"components\":[",
+                p ? "," : "", p, p);
+        for (int c = 0; c < comps; c++) {
+            doc_component(d, p, c, (p == 0 && c == 0) ? steps : 0);
+        }
+        doc_add(d, "]}");
+    }
+    doc_add(d, "]}");
+}
+
+typedef struct {
+    const char *what;
+    int         n0;
+    int         phases, comps, steps;   // document shape
+    int        *axis;                   // the shape field set to n0, 2*n0, 4*n0
+} Series;
+
+// Load the document and check that all of it was taken, so a truncating
+// loader cannot pass as a linear one
+static bool load_checked(const char *json, const Series *s)
+{
+    if (cycle_load_from_json_str(json) != ESP_OK) return false;
+    if (g_num_phases != (size_t)s->phases) return false;
+    for (size_t p = 0; p < g_num_phases; p++) {
+        if (g_phases[p].num_components != (size_t)s->comps) return false;
+    }
+    const PhaseComponent *c = &g_phases[0].components[0];
+    if (s->steps && (!c->has_motor || c->motor_cfg->pattern_len != (size_t)s->steps)) return false;
+    return true;
+}
+
+static bool run_series(Series *s, Doc *d)
+{
+    int64_t best[COMPLEXITY_SIZES];
+
+    printf("%s:\n", s->what);
+    for (int k = 0; k < COMPLEXITY_SIZES; k++) {
+        *s->axis = s->n0 << k;
+        doc_cycle(d, s->phases, s->comps, s->steps);
+
+        best[k] = INT64_MAX;
+        for (int r = 0; r < COMPLEXITY_ROUNDS; r++) {
+            fuzz_stubs_reset();
+            int64_t t0 = fuzz_now_us();
+            bool loaded = load_checked(d->buf, s);
+            int64_t us = fuzz_now_us() - t0;
+            if (!loaded) {
+                printf("  n=%-5d load failed or truncated (%zu bytes)\n", *s->axis, d->len);
+                return false;
+            }
+            if (us < best[k]) best[k] = us;
+        }
+
+        printf("  n=%-5d %8lld us  %7zu bytes", *s->axis, (long long)best[k], d->len);
+        if (k) printf("  x%.2f", (double)best[k] / (double)(best[k - 1] ? best[k - 1] : 1));
+        printf("\n");
+    }
+
+    // t ~ n^e over n..4n
+    double e = log2((double)best[COMPLEXITY_SIZES - 1] / (double)(best[0] ? best[0] : 1)) / (COMPLEXITY_SIZES - 1);
+    bool ok = e <= COMPLEXITY_MAX_EXP;
+    printf("  growth n^%.2f%s\n", e, ok ? "" : "  SUPERLINEAR");
+    return ok;
+}
+
+int main(void)
+{
+    Doc d = { 0 };
+    Series series[3] = {
+        { .what = "motor pattern steps", .n0 = MAX_MOTOR_STEPS / 4, .phases = 1, .comps = 1 },
+        { .what = "components per phase", .n0 = 1, .phases = MAX_PHASES, .steps = 200 },
+        { .what = "phases", .n0 = MAX_PHASES / 4, .comps = MAX_COMPONENTS_PER_PHASE, .steps = 200 },
+    };
+    series[0].axis = &series[0].steps;
+    series[1].axis = &series[1].comps;
+    series[2].axis = &series[2].phases;
+
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(series) / sizeof(series[0]); i++) {
+        if (!run_series(&series[i], &d)) ok = false;
+    }
+    cycle_unload();
+    free(d.buf);
+
+    printf("%s\n", ok ? "loader growth is linear" : "FAIL: loader growth is superlinear");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+// deadline_test.c
+// Deadline monitor at a phase start. The cycle task anchors each phase at its
+// planned start, which is already in the past when the phase is queued, so a
+// phase opening with a critical edge at 0 ms must not count the time it spent
+// behind plan against that edge's budget. The edge is still a miss when it
+// goes late after the phase was queued. The executor runs in ISR mode; the
+// stub gptimer alarm is fired by hand.
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "fuzz_common.h"
+#include "fuzz_stubs.h"
+#include "cycle.h"
+#include "executor.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+
+#define BEHIND_PLAN_US  30000   // over DEADLINE_BUDGET_CRITICAL_US, under the old 50 ms catch-up
+
+static int s_failed = 0;
+
+static void check(bool ok, const char *what)
+{
+    printf("  %-58s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok) s_failed++;
+}
+
+// One track, one phase: cold valve ON at 0 ms, OFF at 10 s (keeps the phase open)
+static void queue_phase(uint64_t start_us)
+{
+    g_num_tracks = 1;
+    g_tracks[0].max_phase_events = 2;
+    executor_start(NULL);
+
+    TrackRun *tr = executor_track(0);
+    memset(tr->events, 0, 2 * sizeof(TimelineEvent));
+    tr->events[0] = (TimelineEvent){ .fire_time_us = 0, .type = EVENT_ON, .pin = COLD_VALVE_PIN, .level = 0 };
+    tr->events[1] = (TimelineEvent){ .fire_time_us = 10000000, .type = EVENT_OFF, .pin = COLD_VALVE_PIN,
+                                     .level = 1, .seq = 1 };
+    executor_begin_phase(0, 0, 2, start_us);
+}
+
+static bool cold_valve_on(void)
+{
+    return !(REG_READ(GPIO_OUT_REG) & (1UL << COLD_VALVE_PIN));     // active-low
+}
+
+static void test_late_start(void)
+{
+    DeadlineStats ds;
+
+    printf("phase queued %d ms behind plan:\n", BEHIND_PLAN_US / 1000);
+    queue_phase((uint64_t)fuzz_now_us() - BEHIND_PLAN_US);
+
+    executor_check_deadlines();     // cycle task pass before the alarm runs
+    executor_deadline_stats(&ds);
+    check(ds.misses[DEADLINE_CLASS_CRITICAL] == 0, "pending 0 ms edge not counted as missed");
+
+    fuzz_gptimer_fire();
+    executor_deadline_stats(&ds);
+    check(ds.events[DEADLINE_CLASS_CRITICAL] == 1, "0 ms edge applied");
+    check(ds.misses[DEADLINE_CLASS_CRITICAL] == 0, "no critical miss");
+    check(!ds.safe_tripped && !executor_safe_tripped(), "no safe state");
+    check(cold_valve_on(), "cold valve ON");
+    check(executor_track_active(0), "phase still running");
+    executor_stop();
+}
+
+static void test_late_dispatch(void)
+{
+    DeadlineStats ds;
+
+    printf("phase queued on time, alarm %d ms late:\n", BEHIND_PLAN_US / 1000);
+    queue_phase((uint64_t)fuzz_now_us());
+    usleep(BEHIND_PLAN_US);
+
+    fuzz_gptimer_fire();
+    executor_deadline_stats(&ds);
+    check(ds.misses[DEADLINE_CLASS_CRITICAL] == 1, "critical miss counted");
+    check(ds.safe_tripped && ds.trip_pin == COLD_VALVE_PIN, "safe state tripped by the cold valve");
+    check(ds.trip_late_us >= BEHIND_PLAN_US, "lateness measured from the due time");
+    check(!cold_valve_on(), "cold valve OFF");
+    executor_stop();
+}
+
+int main(void)
+{
+    init_all_gpio();
+    executor_init();
+    if (executor_get_mode() != EXECUTOR_MODE_ISR) {
+        printf("executor not in ISR mode\n");
+        return 1;
+    }
+
+    test_late_start();
+    test_late_dispatch();
+
+    printf("%s\n", s_failed ? "FAIL" : "deadline checks passed");
+    return s_failed ? 1 : 0;
+}
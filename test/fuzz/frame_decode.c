@@ -0,0 +1,91 @@
+// frame_decode.c
+#include "frame_decode.h"
+
+#include <string.h>
+
+#define SERIAL_HDR_LEN  7
+#define UDP_HDR_LEN     42
+#define UDP_MAGIC0      'C'
+#define UDP_MAGIC1      'T'
+#define UDP_VERSION     1
+
+static uint16_t get_u16(const uint8_t *p) { return (uint16_t)(p[0] | p[1] << 8); }
+static uint32_t get_u32(const uint8_t *p) { return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24; }
+static float get_f32(const uint8_t *p) { uint32_t v = get_u32(p); float f; memcpy(&f, &v, 4); return f; }
+
+static uint16_t crc16_ccitt(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+int cobs_decode(const uint8_t *in, size_t len, uint8_t *out)
+{
+    size_t i = 0, o = 0;
+    while (i < len) {
+        uint8_t code = in[i];
+        if (code == 0 || i + code > len) return -1;
+        memcpy(&out[o], &in[i + 1], code - 1);
+        o += code - 1;
+        i += code;
+        if (code < 0xFF && i < len) out[o++] = 0;
+    }
+    return (int)o;
+}
+
+bool serial_frame_decode(const uint8_t *chunk, size_t len, uint8_t *buf, SerialFrame *out)
+{
+    int n = cobs_decode(chunk, len, buf);
+    if (n < SERIAL_HDR_LEN + 2) return false;
+    if (get_u16(&buf[n - 2]) != crc16_ccitt(buf, (size_t)n - 2)) return false;
+
+    out->type = buf[0];
+    out->seq = get_u16(&buf[1]);
+    out->time_us = get_u32(&buf[3]);
+    out->body = &buf[SERIAL_HDR_LEN];
+    out->body_len = (size_t)n - SERIAL_HDR_LEN - 2;
+    return true;
+}
+
+bool udp_datagram_decode(const uint8_t *data, size_t len, UdpDatagram *out)
+{
+    if (len < UDP_HDR_LEN) return false;
+    if (data[0] != UDP_MAGIC0 || data[1] != UDP_MAGIC1 || data[2] != UDP_VERSION) return false;
+
+    out->flags = data[3];
+    out->seq = get_u32(&data[4]);
+    out->device_ms = get_u32(&data[8]);
+    memcpy(out->device_id, &data[12], 6);
+    out->num_pins = data[18];
+    out->num_tracks = data[19];
+    out->states = get_u16(&data[20]);
+    out->rpm = get_f32(&data[22]);
+    out->pressure_freq = get_f32(&data[26]);
+    out->phase_index = get_u16(&data[30]);
+    out->total_phases = get_u16(&data[32]);
+    out->phase_elapsed_ms = get_u32(&data[34]);
+    out->deadline_misses = get_u16(&data[38]);
+    out->alarm_pin = (int8_t)data[40];
+    out->name_len = data[41];
+
+    size_t off = UDP_HDR_LEN;
+    size_t need = off + out->num_pins + 6u * out->num_tracks + out->name_len;
+    if (len < need) return false;
+
+    memcpy(out->pins, &data[off], out->num_pins);
+    off += out->num_pins;
+    for (int t = 0; t < out->num_tracks; t++) {
+        out->tracks[t].phase_index = data[off];
+        out->tracks[t].active = data[off + 1] != 0;
+        out->tracks[t].phase_elapsed_ms = get_u32(&data[off + 2]);
+        off += 6;
+    }
+    out->name = &data[off];
+    return true;
+}
@@ -0,0 +1,56 @@
+// frame_decode.h
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// C mirrors of the host decoders for the binary telemetry formats:
+// tools/serial_telemetry_rx.py (COBS frames on the serial console) and
+// tools/udp_telemetry_rx.py (UDP datagrams). The fuzz targets feed them the
+// firmware encoders' output, and arbitrary bytes; they must reject anything
+// malformed without reading past the input.
+
+// COBS-decode in[0..len) (no delimiters) into out (at least len bytes).
+// Returns the decoded length, or -1 on a bad code.
+int cobs_decode(const uint8_t *in, size_t len, uint8_t *out);
+
+typedef struct {
+    uint8_t        type;
+    uint16_t       seq;
+    uint32_t       time_us;
+    const uint8_t *body;        // points into the decoded buffer
+    size_t         body_len;
+} SerialFrame;
+
+// Decode one serial frame (the bytes between two 0x00 delimiters) into buf
+// (at least len bytes); false on bad COBS, short frame or CRC mismatch.
+bool serial_frame_decode(const uint8_t *chunk, size_t len, uint8_t *buf, SerialFrame *out);
+
+typedef struct {
+    uint8_t  flags;
+    uint32_t seq;
+    uint32_t device_ms;
+    uint8_t  device_id[6];
+    uint8_t  num_pins;
+    uint8_t  num_tracks;
+    uint16_t states;
+    float    rpm;
+    float    pressure_freq;
+    uint16_t phase_index;
+    uint16_t total_phases;
+    uint32_t phase_elapsed_ms;
+    uint16_t deadline_misses;
+    int8_t   alarm_pin;
+    uint8_t  pins[255];
+    struct {
+        uint8_t  phase_index;
+        bool     active;
+        uint32_t phase_elapsed_ms;
+    } tracks[255];
+    const uint8_t *name;        // points into the datagram
+    uint8_t  name_len;
+} UdpDatagram;
+
+// Decode one telemetry datagram; false if it is short, truncated or not one.
+bool udp_datagram_decode(const uint8_t *data, size_t len, UdpDatagram *out);
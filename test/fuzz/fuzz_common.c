@@ -0,0 +1,93 @@
+// fuzz_common.c
+#include "fuzz_common.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct {
+    const char *target;
+    uint32_t    budget_us;
+    uint64_t    inputs;
+    uint64_t    total_us;
+    uint64_t    max_us;
+    size_t      max_size;       // size of the slowest input
+    uint32_t    slow;
+} FuzzTiming;
+
+static FuzzTiming s_timing;
+static bool s_registered = false;
+
+int64_t fuzz_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+uint32_t fuzz_slow_inputs(void)
+{
+    return s_timing.slow;
+}
+
+static void print_timing(void)
+{
+    if (!s_timing.inputs) return;
+    fprintf(stderr, "[%s] %llu inputs, mean %llu us, max %llu us (%zu bytes), %u over %u us\n",
+            s_timing.target, (unsigned long long)s_timing.inputs,
+            (unsigned long long)(s_timing.total_us / s_timing.inputs),
+            (unsigned long long)s_timing.max_us, s_timing.max_size, s_timing.slow, s_timing.budget_us);
+}
+
+static uint64_t fnv1a64(const uint8_t *data, size_t size)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; i++) {
+        h = (h ^ data[i]) * 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static void report_slow(const uint8_t *data, size_t size, uint64_t us)
+{
+    uint64_t h = fnv1a64(data, size);
+    const char *dir = getenv("FUZZ_SLOW_DIR");
+    char path[512];
+    snprintf(path, sizeof(path), "%s/slow-%s-%016llx", dir ? dir : ".", s_timing.target, (unsigned long long)h);
+
+    fprintf(stderr, "[%s] SLOW input: %llu us > %u us budget, %zu bytes, saved %s\n",
+            s_timing.target, (unsigned long long)us, s_timing.budget_us, size, path);
+    FILE *f = fopen(path, "wb");
+    if (f) {
+        fwrite(data, 1, size, f);
+        fclose(f);
+    }
+    if (getenv("FUZZ_SLOW_ABORT") && atoi(getenv("FUZZ_SLOW_ABORT"))) abort();
+}
+
+void fuzz_timed(const char *target, uint32_t budget_us, fuzz_fn_t fn, const uint8_t *data, size_t size)
+{
+    if (!s_registered) {
+        const char *env = getenv("FUZZ_SLOW_US");
+        s_timing.target = target;
+        s_timing.budget_us = env ? (uint32_t)strtoul(env, NULL, 10) : budget_us;
+        atexit(print_timing);
+        s_registered = true;
+    }
+
+    int64_t t0 = fuzz_now_us();
+    fn(data, size);
+    uint64_t us = (uint64_t)(fuzz_now_us() - t0);
+
+    s_timing.inputs++;
+    s_timing.total_us += us;
+    if (us > s_timing.max_us) {
+        s_timing.max_us = us;
+        s_timing.max_size = size;
+    }
+    if (us > s_timing.budget_us) {
+        s_timing.slow++;
+        report_slow(data, size, us);
+    }
+}
@@ -0,0 +1,32 @@
+// fuzz_common.h
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Per-input timing shared by every target. Each LLVMFuzzerTestOneInput runs
+// its body through fuzz_timed(), which measures the input's wall time and
+// keeps count/mean/max per target (printed at exit). An input slower than
+// the target's budget is reported on stderr with its size and hash and saved
+// as slow-<target>-<hash> in FUZZ_SLOW_DIR (default: the working directory),
+// so pathological slow paths surface next to crashes.
+//
+// Environment:
+//   FUZZ_SLOW_US=<us>    override every target's budget
+//   FUZZ_SLOW_ABORT=1    abort() on a slow input (libFuzzer then keeps it as a crash)
+//   FUZZ_LOG=1           let the firmware's ESP_LOGx output through
+//
+// Built without libFuzzer (FUZZ_ENGINE=standalone) the same targets link
+// fuzz_main.c instead, which replays files/directories and can mutate them.
+
+typedef void (*fuzz_fn_t)(const uint8_t *data, size_t size);
+
+void fuzz_timed(const char *target, uint32_t budget_us, fuzz_fn_t fn, const uint8_t *data, size_t size);
+
+// Monotonic microseconds (also the stub esp_timer_get_time)
+int64_t fuzz_now_us(void);
+
+// Inputs that went over budget so far (standalone driver exit status)
+uint32_t fuzz_slow_inputs(void);
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
@@ -0,0 +1,38 @@
+// fuzz_cycle_loader.c
+// Cycle documents through both loaders: the parsed tree a write_json upload
+// hands to load_cycle_from_cjson(), and the text path used for cycle.json at
+// boot (cycle_load_from_json_str). Both end in compile_phase_list() and the
+// program bound check, so repeat/call nesting is covered as well.
+#include <stdlib.h>
+#include <string.h>
+#include "fuzz_common.h"
+#include "fuzz_stubs.h"
+#include "cycle.h"
+
+#define CYCLE_LOADER_BUDGET_US  50000
+
+static void run(const uint8_t *data, size_t size)
+{
+    char *json = malloc(size + 1);
+    if (!json) return;
+    memcpy(json, data, size);
+    json[size] = '\0';
+
+    // upload path: cycle.c adopts the tree on success
+    cJSON *root = cJSON_Parse(json);
+    if (root && load_cycle_from_cjson(root) != ESP_OK) {
+        cJSON_Delete(root);
+    }
+
+    // boot path: parses the text itself
+    cycle_load_from_json_str(json);
+
+    free(json);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    fuzz_stubs_reset();
+    fuzz_timed("cycle_loader", CYCLE_LOADER_BUDGET_US, run, data, size);
+    return 0;
+}
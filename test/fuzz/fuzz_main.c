@@ -0,0 +1,147 @@
+// fuzz_main.c
+// Standalone driver for compilers without libFuzzer (gcc): runs every file
+// named on the command line (directories are walked one level) through the
+// target once, then optionally feeds it -mutate=N randomly mutated copies of
+// each. Exit status is non-zero if any input went over the time budget.
+//
+//   fuzz_cycle_loader corpus/cycle_loader -mutate=2000 -seed=7
+#include "fuzz_common.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define MUTATE_MAX_LEN  (128 * 1024)
+
+static uint64_t s_rng = 0x9e3779b97f4a7c15ULL;
+
+static uint32_t rnd(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 7;
+    s_rng ^= s_rng << 17;
+    return (uint32_t)(s_rng >> 16);
+}
+
+static uint8_t *read_file(const char *path, size_t *size)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *buf = malloc(n > 0 ? (size_t)n : 1);
+    if (buf && n > 0 && fread(buf, 1, (size_t)n, f) != (size_t)n) {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    *size = n > 0 ? (size_t)n : 0;
+    return buf;
+}
+
+// Byte flips, interesting values, inserts, deletes and block copies
+static size_t mutate(uint8_t *buf, size_t len, size_t cap)
+{
+    static const uint8_t interesting[] = { 0x00, 0x01, 0x7f, 0x80, 0xff, '"', '\\', '{', '}', '[', ']', ',', ':', '-', '9' };
+    int steps = 1 + rnd() % 4;
+
+    for (int s = 0; s < steps; s++) {
+        size_t pos = len ? rnd() % len : 0;
+        switch (rnd() % 5) {
+        case 0:
+            if (len) buf[pos] ^= (uint8_t)(1u << (rnd() % 8));
+            break;
+        case 1:
+            if (len) buf[pos] = interesting[rnd() % sizeof(interesting)];
+            break;
+        case 2:
+            if (len < cap) {
+                memmove(&buf[pos + 1], &buf[pos], len - pos);
+                buf[pos] = interesting[rnd() % sizeof(interesting)];
+                len++;
+            }
+            break;
+        case 3:
+            if (len) {
+                size_t n = 1 + rnd() % (len - pos);
+                memmove(&buf[pos], &buf[pos + n], len - pos - n);
+                len -= n;
+            }
+            break;
+        default:
+            if (len) {
+                size_t from = rnd() % len;
+                size_t n = 1 + rnd() % (len - from);
+                if (len + n <= cap) {
+                    memmove(&buf[pos + n], &buf[pos], len - pos);
+                    memmove(&buf[pos], &buf[from < pos ? from : from + n], n);
+                    len += n;
+                }
+            }
+            break;
+        }
+    }
+    return len;
+}
+
+static void run_file(const char *path, unsigned mutations)
+{
+    size_t size;
+    uint8_t *data = read_file(path, &size);
+    if (!data) {
+        fprintf(stderr, "cannot read %s\n", path);
+        return;
+    }
+    LLVMFuzzerTestOneInput(data, size);
+
+    if (mutations && size <= MUTATE_MAX_LEN) {
+        uint8_t *buf = malloc(MUTATE_MAX_LEN);
+        for (unsigned i = 0; buf && i < mutations; i++) {
+            memcpy(buf, data, size);
+            size_t len = mutate(buf, size, MUTATE_MAX_LEN);
+            LLVMFuzzerTestOneInput(buf, len);
+        }
+        free(buf);
+    }
+    free(data);
+}
+
+static void run_path(const char *path, unsigned mutations)
+{
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        fprintf(stderr, "cannot stat %s\n", path);
+        return;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        run_file(path, mutations);
+        return;
+    }
+
+    DIR *dir = opendir(path);
+    struct dirent *ent;
+    while (dir && (ent = readdir(dir)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        char file[1024];
+        snprintf(file, sizeof(file), "%s/%s", path, ent->d_name);
+        if (stat(file, &st) == 0 && S_ISREG(st.st_mode)) run_file(file, mutations);
+    }
+    if (dir) closedir(dir);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned mutations = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "-mutate=", 8) == 0) mutations = (unsigned)strtoul(argv[i] + 8, NULL, 10);
+        if (strncmp(argv[i], "-seed=", 6) == 0) s_rng ^= strtoull(argv[i] + 6, NULL, 10) * 0x2545f4914f6cdd1dULL;
+    }
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] != '-') run_path(argv[i], mutations);
+    }
+    return fuzz_slow_inputs() ? 1 : 0;
+}
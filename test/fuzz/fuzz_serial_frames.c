@@ -0,0 +1,96 @@
+// fuzz_serial_frames.c
+// Serial telemetry framing (serial_telemetry.c is included for its static
+// encoder and command parser). The first byte picks the mode:
+//   0  frame of any type with the rest as body -> send_frame -> wire capture,
+//      decoded again: one delimited frame, same type/time/body, valid CRC
+//   1  PHASE event with the rest as the phase name (clamped to the name limit)
+//   2  host command line ("ct start 20") through handle_command
+//   3  arbitrary bytes through the host-side frame decoder
+#include "../../main/serial_telemetry.c"
+
+#include "fuzz_common.h"
+#include "fuzz_stubs.h"
+#include "frame_decode.h"
+
+#define SERIAL_FRAMES_BUDGET_US 2000
+
+// The capture must hold exactly one delimited frame whose body matches
+static void check_wire(uint8_t type, const uint8_t *body, size_t body_len)
+{
+    size_t n;
+    const uint8_t *wire = fuzz_serial_output(&n);
+    if (n < 2 || n > FRAME_MAX_WIRE || wire[0] != 0 || wire[n - 1] != 0) abort();
+    if (memchr(&wire[1], 0, n - 2)) abort();           // COBS left a zero inside the frame
+
+    uint8_t buf[FRAME_MAX_WIRE];
+    SerialFrame f;
+    if (!serial_frame_decode(&wire[1], n - 2, buf, &f)) abort();
+    if (f.type != type || f.body_len != body_len || memcmp(f.body, body, body_len) != 0) abort();
+}
+
+static void run(const uint8_t *data, size_t size)
+{
+    if (size < 1) return;
+    const uint8_t *in = data + 1;
+    size_t len = size - 1;
+
+    switch (data[0] & 3) {
+    case 0: {
+        uint8_t raw[FRAME_MAX_RAW];
+        if (len < 1) return;
+        size_t body_len = len - 1 > FRAME_MAX_BODY ? FRAME_MAX_BODY : len - 1;
+        memcpy(&raw[FRAME_HDR_LEN], &in[1], body_len);
+        send_frame((SerialFrameType)in[0], 0x12345678, raw, body_len);
+        check_wire(in[0], &in[1], body_len);
+        break;
+    }
+    case 1: {
+        char name[64];
+        size_t n = len < sizeof(name) - 1 ? len : sizeof(name) - 1;
+        memcpy(name, in, n);
+        name[n] = '\0';
+        current_phase_name = name;
+        send_phase(0, PHASE_EVT_PHASE_START);
+        current_phase_name = NULL;
+
+        size_t wire_len;
+        const uint8_t *wire = fuzz_serial_output(&wire_len);
+        uint8_t buf[FRAME_MAX_WIRE];
+        SerialFrame f;
+        if (wire_len < 2 || !serial_frame_decode(&wire[1], wire_len - 2, buf, &f)) abort();
+        if (f.body_len < 4 || f.body[3] > SERIAL_TELEMETRY_NAME_MAX || f.body_len != 4u + f.body[3]) abort();
+        if (memcmp(&f.body[4], name, f.body[3]) != 0) abort();
+        break;
+    }
+    case 2: {
+        char line[32];                                  // command_task's line buffer
+        size_t n = len < sizeof(line) - 1 ? len : sizeof(line) - 1;
+        memcpy(line, in, n);
+        line[n] = '\0';
+        handle_command(line);
+        serial_telemetry_stop();
+        break;
+    }
+    default: {
+        // split on delimiters like the host reader does
+        uint8_t *buf = malloc(len + 1);
+        size_t start = 0;
+        for (size_t i = 0; buf && i <= len; i++) {
+            if (i == len || in[i] == 0) {
+                SerialFrame f;
+                if (i > start) serial_frame_decode(&in[start], i - start, buf, &f);
+                start = i + 1;
+            }
+        }
+        free(buf);
+        break;
+    }
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    fuzz_stubs_reset();
+    fuzz_timed("serial_frames", SERIAL_FRAMES_BUDGET_US, run, data, size);
+    return 0;
+}
@@ -0,0 +1,28 @@
+// fuzz_stubs.h
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_http_server.h"
+
+// Harness side of the host stubs (stubs/esp_stubs.c, stubs/firmware_stubs.c).
+// ESP-IDF and FreeRTOS calls never block and never run callbacks: tasks and
+// timers are created but not started, so a fuzzed command can arm a cycle but
+// not run it. Firmware modules that are not part of a target are replaced by
+// weak no-op definitions; a target that compiles the real module overrides them.
+
+#define FUZZ_HTTPD_HANDLE   ((httpd_handle_t)0x1)
+
+// Frame the next httpd_ws_recv_frame() calls hand to ws_handler()
+void fuzz_ws_set_frame(httpd_ws_type_t type, const uint8_t *payload, size_t len);
+
+// Bytes written to the USB-Serial-JTAG console since the last reset
+const uint8_t *fuzz_serial_output(size_t *len);
+
+// Run the alarm callback of the last gptimer that registered one, as if its
+// alarm fired now. False if there is none.
+bool fuzz_gptimer_fire(void);
+
+// Clear per-input stub state (pending frame, serial capture)
+void fuzz_stubs_reset(void);
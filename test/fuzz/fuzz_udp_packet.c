@@ -0,0 +1,110 @@
+// fuzz_udp_packet.c
+// UDP telemetry datagrams (udp_telemetry.c is included for its static
+// encoder). Odd first byte: the rest fills a TelemetryPacket (counts and the
+// phase name are fuzzed past their limits), encode_packet writes it into a
+// buffer of exactly UDP_TELEMETRY_MAX_LEN, and the host-side decoder must
+// read back the same fields. Even: arbitrary bytes through the decoder.
+#include "../../main/udp_telemetry.c"
+
+#include <stdlib.h>
+#include "fuzz_common.h"
+#include "fuzz_stubs.h"
+#include "frame_decode.h"
+
+#define UDP_PACKET_BUDGET_US    2000
+
+typedef struct {
+    const uint8_t *p;
+    size_t         left;
+} Reader;
+
+static void take(Reader *r, void *out, size_t n)
+{
+    memset(out, 0, n);
+    size_t k = n < r->left ? n : r->left;
+    memcpy(out, r->p, k);
+    r->p += k;
+    r->left -= k;
+}
+
+static void check_roundtrip(const uint8_t *data, size_t size)
+{
+    Reader r = { data, size };
+    TelemetryPacket pkt;
+    memset(&pkt, 0, sizeof(pkt));
+
+    take(&r, &pkt.gpio.num_pins, 1);
+    for (int i = 0; i < MAX_GPIO_PINS; i++) {
+        take(&r, &pkt.gpio.pins[i].pin_number, 1);
+        take(&r, &pkt.gpio.pins[i].state, 1);
+    }
+    uint8_t flags;
+    take(&r, &flags, 1);
+    pkt.cycle.cycle_running = flags & 1;
+    pkt.cycle.deadline_alarm = flags & 2;
+    pkt.sensors.sensor_error = flags & 4;
+    pkt.cycle.motor_fault = flags >> 3;
+    take(&r, &pkt.cycle.num_tracks, 1);
+    for (int t = 0; t < MAX_TELEMETRY_TRACKS; t++) {
+        take(&r, &pkt.cycle.tracks[t].phase_index, 4);
+        take(&r, &pkt.cycle.tracks[t].phase_elapsed_ms, 4);
+        pkt.cycle.tracks[t].active = pkt.cycle.tracks[t].phase_index & 1;
+    }
+    take(&r, &pkt.sensors.rpm, 4);
+    take(&r, &pkt.sensors.pressure_freq, 4);
+    take(&r, &pkt.cycle.current_phase_index, 4);
+    take(&r, &pkt.cycle.total_phases, 4);
+    take(&r, &pkt.cycle.phase_elapsed_ms, 4);
+    take(&r, &pkt.cycle.deadline_misses, 4);
+    take(&r, &pkt.cycle.alarm_pin, 4);
+    take(&r, &pkt.packet_timestamp_ms, 8);
+    uint32_t seq;
+    take(&r, &seq, 4);
+
+    // what remains is the phase name, without terminator if it is long enough
+    char *name = malloc(r.left + 1);
+    if (!name) return;
+    memcpy(name, r.p, r.left);
+    name[r.left] = '\0';
+    pkt.cycle.current_phase_name = name;
+
+    uint8_t *buf = malloc(UDP_TELEMETRY_MAX_LEN);
+    size_t n = encode_packet(&pkt, seq, buf);
+    if (n > UDP_TELEMETRY_MAX_LEN) abort();
+
+    UdpDatagram d;
+    uint8_t pins = pkt.gpio.num_pins > MAX_GPIO_PINS ? MAX_GPIO_PINS : pkt.gpio.num_pins;
+    uint8_t tracks = pkt.cycle.num_tracks > MAX_TELEMETRY_TRACKS ? MAX_TELEMETRY_TRACKS : pkt.cycle.num_tracks;
+    size_t name_len = strnlen(name, UDP_TELEMETRY_NAME_MAX);
+    if (!udp_datagram_decode(buf, n, &d)) abort();
+    if (d.seq != seq || d.num_pins != pins || d.num_tracks != tracks || d.name_len != name_len ||
+        memcmp(d.name, name, name_len) != 0 || d.phase_elapsed_ms != pkt.cycle.phase_elapsed_ms) {
+        abort();
+    }
+    for (int i = 0; i < pins; i++) {
+        if (d.pins[i] != pkt.gpio.pins[i].pin_number) abort();
+        if (((d.states >> i) & 1) != (pkt.gpio.pins[i].state != 0)) abort();
+    }
+    for (int t = 0; t < tracks; t++) {
+        if (d.tracks[t].phase_elapsed_ms != pkt.cycle.tracks[t].phase_elapsed_ms) abort();
+    }
+    free(buf);
+    free(name);
+}
+
+static void run(const uint8_t *data, size_t size)
+{
+    if (size < 1) return;
+    if (data[0] & 1) {
+        check_roundtrip(data + 1, size - 1);
+    } else {
+        UdpDatagram d;
+        udp_datagram_decode(data + 1, size - 1, &d);
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    fuzz_timed("udp_packet", UDP_PACKET_BUDGET_US, run, data, size);
+    return 0;
+}
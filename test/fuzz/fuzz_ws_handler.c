@@ -0,0 +1,72 @@
+// fuzz_ws_handler.c
+// One WebSocket frame per input through ws_handler(), exactly as httpd
+// delivers it. The first byte picks how the rest is sent:
+//   0  text frame: wstok_parse + ws_fast_dispatch, then the cJSON command path
+//   1  binary frame as received: comp_decode_document / wscomp_decompress
+//   2  text compressed into a WS_COMP_DOCUMENT frame, so valid documents
+//      reach the command path through the inflate step
+//   3  control frame (ping/pong/close, by the second byte)
+// ws_cycle.c is included so its static helpers are built into this target.
+#include "../../main/ws_cycle.c"
+
+#include "fuzz_common.h"
+#include "fuzz_stubs.h"
+
+#define WS_HANDLER_BUDGET_US    50000
+
+static void send_frame(httpd_ws_type_t type, const uint8_t *payload, size_t len)
+{
+    httpd_req_t req = { .handle = FUZZ_HTTPD_HANDLE, .method = HTTP_POST };
+    fuzz_ws_set_frame(type, payload, len);
+    ws_handler(&req);
+}
+
+static void send_compressed(const uint8_t *text, size_t len)
+{
+    static WsCompCtx ctx;
+    uint8_t *frame = malloc(WS_COMP_HDR_LEN + WSCOMP_BOUND(len) + 1);
+    if (!frame) return;
+
+    size_t n = wscomp_compress(&ctx, NULL, 0, text, len, frame + WS_COMP_HDR_LEN, WSCOMP_BOUND(len) + 1);
+    frame[0] = WS_COMP_DOCUMENT;
+    frame[1] = 0;
+    frame[2] = 0;
+    frame[3] = 0;
+    for (int b = 0; b < 4; b++) {
+        frame[4 + b] = (uint8_t)(len >> (8 * b));
+    }
+    if (n) send_frame(HTTPD_WS_TYPE_BINARY, frame, WS_COMP_HDR_LEN + n);
+    free(frame);
+}
+
+static void run(const uint8_t *data, size_t size)
+{
+    if (size < 1) return;
+    const uint8_t *payload = data + 1;
+    size_t len = size - 1;
+
+    switch (data[0] & 3) {
+    case 0:
+        send_frame(HTTPD_WS_TYPE_TEXT, payload, len);
+        break;
+    case 1:
+        send_frame(HTTPD_WS_TYPE_BINARY, payload, len);
+        break;
+    case 2:
+        send_compressed(payload, len);
+        break;
+    default: {
+        static const httpd_ws_type_t ctl[] = { HTTPD_WS_TYPE_PING, HTTPD_WS_TYPE_PONG, HTTPD_WS_TYPE_CLOSE };
+        if (len < 1) return;
+        send_frame(ctl[payload[0] % 3], payload + 1, len - 1);
+        break;
+    }
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    fuzz_stubs_reset();
+    fuzz_timed("ws_handler", WS_HANDLER_BUDGET_US, run, data, size);
+    return 0;
+}
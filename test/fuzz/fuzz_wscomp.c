@@ -0,0 +1,54 @@
+// fuzz_wscomp.c
+// The LZ77 codec on its own. Every input is decoded as a compressed stream
+// (against a dictionary taken from its head, as delta telemetry frames are)
+// and must fail cleanly or fill exactly the requested length; it is then
+// compressed and must decode back to itself.
+#include <stdlib.h>
+#include <string.h>
+#include "fuzz_common.h"
+#include "wscomp.h"
+
+#define WSCOMP_BUDGET_US    10000
+#define WSCOMP_MAX_OUT      (64 * 1024)
+
+static void run(const uint8_t *data, size_t size)
+{
+    static WsCompCtx ctx;
+    if (size < 3) return;
+
+    // header: dictionary length (0..255 bytes of the input) and output length
+    size_t dict_len = data[0];
+    size_t out_len = ((size_t)data[1] << 8 | data[2]) % WSCOMP_MAX_OUT;
+    data += 3;
+    size -= 3;
+    if (dict_len > size) dict_len = size;
+    const uint8_t *dict = data;
+    const uint8_t *src = data + dict_len;
+    size_t src_len = size - dict_len;
+
+    uint8_t *out = malloc(out_len ? out_len : 1);
+    if (!out) return;
+    size_t n = wscomp_decompress(dict, dict_len, src, src_len, out, out_len);
+    if (n != 0 && n != out_len) abort();
+    free(out);
+
+    // round trip
+    uint8_t *comp = malloc(WSCOMP_BOUND(src_len) + 1);
+    uint8_t *back = malloc(src_len ? src_len : 1);
+    if (comp && back) {
+        size_t c = wscomp_compress(&ctx, dict, dict_len, src, src_len, comp, WSCOMP_BOUND(src_len));
+        if (src_len && c == 0) abort();                     // WSCOMP_BOUND must always fit
+        if (c && (wscomp_decompress(dict, dict_len, comp, c, back, src_len) != src_len ||
+                  memcmp(back, src, src_len) != 0)) {
+            abort();
+        }
+    }
+    free(comp);
+    free(back);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    fuzz_timed("wscomp", WSCOMP_BUDGET_US, run, data, size);
+    return 0;
+}
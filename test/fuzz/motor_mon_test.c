@@ -0,0 +1,178 @@
+// motor_mon_test.c
+// Motor monitor windows on scripted tach pulses (motor_mon.c is included for
+// its check state and evaluate()). A drum coasting down after a spin must not
+// count as run-on however long it pulses past the stop window; one held at
+// speed after OFF must. In alarm mode checking goes on after a fault, each
+// expired window is reported once, and a later fault still shows up.
+#include "../../main/motor_mon.c"
+
+#include <stdio.h>
+#include "fuzz_common.h"
+#include "fuzz_stubs.h"
+
+#define MAX_PULSES  1024
+
+static int64_t  s_pulses[MAX_PULSES];       // scripted tach pulse times
+static uint32_t s_num_pulses = 0;
+static int s_failed = 0;
+
+// ---------------- tach / actuator stand-ins ----------------
+void rpm_sensor_last_pulse(uint64_t *pulse_us, uint32_t *period_us)
+{
+    *pulse_us = s_num_pulses ? (uint64_t)s_pulses[s_num_pulses - 1] : 0;
+    *period_us = (s_num_pulses > 1) ? (uint32_t)(s_pulses[s_num_pulses - 1] - s_pulses[s_num_pulses - 2]) : 0;
+}
+
+uint32_t rpm_sensor_read_intervals(uint32_t *out, uint32_t n)
+{
+    uint32_t avail = s_num_pulses ? s_num_pulses - 1 : 0;
+    if (n > avail) n = avail;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t p = s_num_pulses - n + i;
+        out[i] = (uint32_t)(s_pulses[p] - s_pulses[p - 1]);
+    }
+    return n;
+}
+
+ActuatorLatency actuator_latency(ActuatorId id)
+{
+    return (ActuatorLatency){ .valid = false };
+}
+
+// ---------------- helpers ----------------
+static void check(bool ok, const char *what)
+{
+    printf("  %-62s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok) s_failed++;
+}
+
+// Pulses from first_us on, period growing by growth_ppm per pulse, up to end_us
+static void script_pulses(int64_t first_us, uint32_t period_us, uint32_t growth_ppm, int64_t end_us)
+{
+    s_num_pulses = 0;
+    double period = period_us;
+    for (int64_t t = first_us; t <= end_us && s_num_pulses < MAX_PULSES; t += (int64_t)period) {
+        s_pulses[s_num_pulses++] = t;
+        period += period * growth_ppm / 1e6;
+    }
+}
+
+// Start a cycle in mode with the motor OFF since off_ago_us
+static void start(MotorMonMode mode, int64_t now_us, int64_t off_ago_us)
+{
+    MotorMonConfig cfg = { .mode = mode };
+    motor_mon_configure(&cfg);
+    motor_mon_start();
+    s_motor_on = false;
+    s_off_since_us = now_us - off_ago_us;
+}
+
+// Evaluate until end_us as if checked every MOTOR_MON_PERIOD_US on the pulses so far
+static MotorFault evaluate_until(int64_t from_us, int64_t end_us)
+{
+    uint32_t all = s_num_pulses;
+    MotorFault seen = MOTOR_FAULT_NONE;
+    for (int64_t now = from_us; now <= end_us && seen == MOTOR_FAULT_NONE; now += MOTOR_MON_PERIOD_US) {
+        s_num_pulses = 0;
+        while (s_num_pulses < all && s_pulses[s_num_pulses] <= now) s_num_pulses++;
+        int64_t expired_us;
+        seen = evaluate(now, &expired_us);
+    }
+    s_num_pulses = all;
+    return seen;
+}
+
+// ---------------- cases ----------------
+static void test_coast_down(void)
+{
+    printf("coast-down after a spin (60 ms period, +2%% per pulse, 12 s):\n");
+    int64_t now = fuzz_now_us();
+    int64_t off = now - 20000000;
+    start(MOTOR_MON_ALARM, now, now - off);
+    script_pulses(off, 60000, 20000, off + 12000000);
+    check(s_pulses[s_num_pulses - 1] > off + s_stop_window_us, "still pulsing past the stop window");
+    check(evaluate_until(off, off + 13000000) == MOTOR_FAULT_NONE, "no run-on");
+
+    printf("slow coast (1 s period, +0.5%% per pulse, 12 s):\n");
+    start(MOTOR_MON_ALARM, now, now - off);
+    script_pulses(off, 1000000, 5000, off + 12000000);
+    check(evaluate_until(off, off + 13000000) == MOTOR_FAULT_NONE, "no run-on");
+}
+
+static void test_run_on(void)
+{
+    printf("drum held at speed after OFF (60 ms period):\n");
+    int64_t now = fuzz_now_us();
+    int64_t off = now - 20000000;
+    start(MOTOR_MON_ALARM, now, now - off);
+    script_pulses(off, 60000, 0, off + 12000000);
+    check(evaluate_until(off, off + s_stop_window_us) == MOTOR_FAULT_NONE, "nothing within the stop window");
+    check(evaluate_until(off, off + 13000000) == MOTOR_FAULT_RUN_ON, "run-on after the stop window");
+
+    printf("drum speeding up after OFF:\n");
+    start(MOTOR_MON_ALARM, now, now - off);
+    script_pulses(off, 120000, 0, off);     // one pulse at OFF, then 1% faster each
+    for (int64_t t = off, p = 120000; t < off + 12000000 && s_num_pulses < MAX_PULSES; p -= p / 100) {
+        t += p;
+        s_pulses[s_num_pulses++] = t;
+    }
+    check(evaluate_until(off, off + 13000000) == MOTOR_FAULT_RUN_ON, "run-on after the stop window");
+}
+
+static void test_alarm_keeps_checking(void)
+{
+    MotorMonStats st;
+
+    printf("alarm mode:\n");
+    int64_t now = fuzz_now_us();
+    start(MOTOR_MON_ALARM, now, 10000000);
+    script_pulses(now - 10000000, 60000, 0, now);
+    motor_mon_check(NULL);
+    motor_mon_check(NULL);
+    motor_mon_stats(&st);
+    check(st.fault == MOTOR_FAULT_RUN_ON && st.cycle_faults == 1, "run-on reported once for its window");
+
+    // later in the same cycle: motor ON 5 s ago, no tach pulse since
+    now = fuzz_now_us();
+    script_pulses(now - 12000000, 60000, 0, now - 6000000);
+    s_motor_on = true;
+    s_on_since_us = now - 5000000;
+    s_dir_since_us = s_on_since_us;
+    motor_mon_check(NULL);
+    motor_mon_stats(&st);
+    check(st.last_fault == MOTOR_FAULT_NO_SPIN && st.cycle_faults == 2, "later no-spin still reported");
+    check(st.fault == MOTOR_FAULT_RUN_ON, "first fault kept");
+    motor_mon_stop();
+
+    printf("abort mode:\n");
+    now = fuzz_now_us();
+    start(MOTOR_MON_ABORT, now, 10000000);
+    script_pulses(now - 10000000, 60000, 0, now);
+    motor_mon_check(NULL);
+    now = fuzz_now_us();
+    script_pulses(now - 12000000, 60000, 0, now - 6000000);
+    s_motor_on = true;
+    s_on_since_us = now - 5000000;
+    motor_mon_check(NULL);
+    motor_mon_stats(&st);
+    check(st.fault == MOTOR_FAULT_RUN_ON && st.cycle_faults == 1, "stops at the first fault");
+    check(executor_safe_tripped(), "safe state forced");
+    motor_mon_stop();
+}
+
+int main(void)
+{
+    init_all_gpio();
+    executor_init();
+    g_num_tracks = 1;
+    g_tracks[0].max_phase_events = 1;
+    executor_start(NULL);
+
+    test_coast_down();
+    test_run_on();
+    test_alarm_keeps_checking();
+
+    executor_stop();
+    printf("%s\n", s_failed ? "FAIL" : "motor monitor checks passed");
+    return s_failed ? 1 : 0;
+}
@@ -0,0 +1,298 @@
+// esp_stubs.c
+// ESP-IDF, FreeRTOS and driver calls for the host build. Nothing blocks and
+// nothing runs asynchronously: tasks, esp_timers and gptimers are accepted
+// and never started; a test can fire a gptimer's alarm by hand with
+// fuzz_gptimer_fire(). GPIO output levels live in a register variable so the
+// executor's edge log and the serial/UDP encoders see consistent pins.
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fuzz_common.h"
+#include "fuzz_stubs.h"
+
+#include "esp_cpu.h"
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "esp_http_server.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_netif.h"
+#include "esp_random.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "driver/gptimer.h"
+#include "driver/usb_serial_jtag.h"
+#include "driver/usb_serial_jtag_vfs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+
+#define HOST_FREE_HEAP      (200 * 1024)
+#define HOST_LARGEST_BLOCK  (96 * 1024)
+#define SERIAL_CAPTURE_MAX  4096
+
+// ---------------- harness state ----------------
+static struct {
+    httpd_ws_type_t type;
+    const uint8_t  *payload;
+    size_t          len;
+} s_ws_frame;
+
+static uint8_t s_serial[SERIAL_CAPTURE_MAX];
+static size_t s_serial_len;
+static uint32_t s_gpio_out = 0xffffffff;    // reset: outputs read back high (OFF)
+
+void fuzz_ws_set_frame(httpd_ws_type_t type, const uint8_t *payload, size_t len)
+{
+    s_ws_frame.type = type;
+    s_ws_frame.payload = payload;
+    s_ws_frame.len = len;
+}
+
+const uint8_t *fuzz_serial_output(size_t *len)
+{
+    *len = s_serial_len;
+    return s_serial;
+}
+
+void fuzz_stubs_reset(void)
+{
+    memset(&s_ws_frame, 0, sizeof(s_ws_frame));
+    s_serial_len = 0;
+}
+
+// ---------------- log / err / system ----------------
+void fuzz_log(const char *level, const char *tag, const char *fmt, ...)
+{
+    static int enabled = -1;
+    if (enabled < 0) enabled = getenv("FUZZ_LOG") && atoi(getenv("FUZZ_LOG"));
+    if (!enabled) return;
+
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "%s (%s) ", level, tag);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+    case ESP_OK:                return "ESP_OK";
+    case ESP_FAIL:              return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:        return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:   return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_NOT_FOUND:     return "ESP_ERR_NOT_FOUND";
+    default:                    return "ESP_ERR";
+    }
+}
+
+size_t esp_get_free_heap_size(void) { return HOST_FREE_HEAP; }
+size_t esp_get_minimum_free_heap_size(void) { return HOST_FREE_HEAP; }
+size_t heap_caps_get_free_size(uint32_t caps) { return HOST_FREE_HEAP; }
+size_t heap_caps_get_largest_free_block(uint32_t caps) { return HOST_LARGEST_BLOCK; }
+void esp_restart(void) {}
+uint32_t esp_random(void) { return (uint32_t)rand(); }
+
+esp_err_t esp_read_mac(uint8_t *mac, esp_mac_type_t type)
+{
+    static const uint8_t host_mac[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+    memcpy(mac, host_mac, sizeof(host_mac));
+    return ESP_OK;
+}
+
+esp_netif_t *esp_netif_get_handle_from_ifkey(const char *key) { return NULL; }
+esp_err_t esp_netif_get_ip_info(esp_netif_t *netif, esp_netif_ip_info_t *info) { return ESP_FAIL; }
+
+// ---------------- clocks ----------------
+int64_t esp_timer_get_time(void) { return fuzz_now_us(); }
+int64_t esp_timer_get_next_alarm(void) { return INT64_MAX; }
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void) { return (esp_cpu_cycle_count_t)(fuzz_now_us() * 160); }
+uint32_t esp_rom_get_cpu_ticks_per_us(void) { return 160; }
+void esp_rom_delay_us(uint32_t us) {}
+
+// ---------------- esp_timer / gptimer: created, never fire ----------------
+struct esp_timer { bool active; };
+struct gptimer_t {
+    gptimer_alarm_cb_t on_alarm;
+    void              *arg;
+};
+static gptimer_handle_t s_last_gptimer = NULL;     // fuzz_gptimer_fire() target
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out)
+{
+    *out = calloc(1, sizeof(struct esp_timer));
+    return *out ? ESP_OK : ESP_ERR_NO_MEM;
+}
+esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t us) { t->active = true; return ESP_OK; }
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t t, uint64_t us) { t->active = true; return ESP_OK; }
+esp_err_t esp_timer_stop(esp_timer_handle_t t)
+{
+    if (!t->active) return ESP_ERR_INVALID_STATE;
+    t->active = false;
+    return ESP_OK;
+}
+esp_err_t esp_timer_delete(esp_timer_handle_t t) { free(t); return ESP_OK; }
+bool esp_timer_is_active(esp_timer_handle_t t) { return t && t->active; }
+
+esp_err_t gptimer_new_timer(const gptimer_config_t *cfg, gptimer_handle_t *out)
+{
+    *out = calloc(1, sizeof(struct gptimer_t));
+    return *out ? ESP_OK : ESP_ERR_NO_MEM;
+}
+esp_err_t gptimer_del_timer(gptimer_handle_t t)
+{
+    if (t == s_last_gptimer) s_last_gptimer = NULL;
+    free(t);
+    return ESP_OK;
+}
+
+esp_err_t gptimer_register_event_callbacks(gptimer_handle_t t, const gptimer_event_callbacks_t *cbs, void *arg)
+{
+    t->on_alarm = cbs->on_alarm;
+    t->arg = arg;
+    s_last_gptimer = t;
+    return ESP_OK;
+}
+
+bool fuzz_gptimer_fire(void)
+{
+    if (!s_last_gptimer || !s_last_gptimer->on_alarm) return false;
+    gptimer_alarm_event_data_t edata = { .count_value = (uint64_t)fuzz_now_us() };
+    s_last_gptimer->on_alarm(s_last_gptimer, &edata, s_last_gptimer->arg);
+    return true;
+}
+esp_err_t gptimer_enable(gptimer_handle_t t) { return ESP_OK; }
+esp_err_t gptimer_disable(gptimer_handle_t t) { return ESP_OK; }
+esp_err_t gptimer_start(gptimer_handle_t t) { return ESP_OK; }
+esp_err_t gptimer_stop(gptimer_handle_t t) { return ESP_OK; }
+esp_err_t gptimer_set_raw_count(gptimer_handle_t t, uint64_t value) { return ESP_OK; }
+esp_err_t gptimer_get_raw_count(gptimer_handle_t t, uint64_t *value) { *value = 0; return ESP_OK; }
+esp_err_t gptimer_set_alarm_action(gptimer_handle_t t, const gptimer_alarm_config_t *cfg) { return ESP_OK; }
+
+// ---------------- GPIO ----------------
+uint32_t host_reg_read(uint32_t reg)
+{
+    return reg == GPIO_OUT_REG ? s_gpio_out : 0;
+}
+
+void host_reg_write(uint32_t reg, uint32_t value)
+{
+    if (reg == GPIO_OUT_REG) s_gpio_out = value;
+    else if (reg == GPIO_OUT_W1TS_REG) s_gpio_out |= value;
+    else if (reg == GPIO_OUT_W1TC_REG) s_gpio_out &= ~value;
+}
+
+esp_err_t gpio_config(const gpio_config_t *cfg) { return ESP_OK; }
+esp_err_t gpio_reset_pin(gpio_num_t pin) { return ESP_OK; }
+esp_err_t gpio_set_direction(gpio_num_t pin, gpio_mode_t mode) { return ESP_OK; }
+esp_err_t gpio_install_isr_service(int flags) { return ESP_OK; }
+esp_err_t gpio_isr_handler_add(gpio_num_t pin, gpio_isr_t isr, void *arg) { return ESP_OK; }
+
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level)
+{
+    if (pin < 0 || pin >= GPIO_NUM_MAX) return ESP_ERR_INVALID_ARG;
+    host_reg_write(level ? GPIO_OUT_W1TS_REG : GPIO_OUT_W1TC_REG, 1UL << pin);
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t pin)
+{
+    return (pin >= 0 && pin < GPIO_NUM_MAX) ? (int)((s_gpio_out >> pin) & 1) : 0;
+}
+
+// ---------------- USB-Serial-JTAG: writes are captured ----------------
+static bool s_usj_installed;
+
+esp_err_t usb_serial_jtag_driver_install(usb_serial_jtag_driver_config_t *cfg) { s_usj_installed = true; return ESP_OK; }
+bool usb_serial_jtag_is_driver_installed(void) { return s_usj_installed; }
+void usb_serial_jtag_vfs_use_driver(void) {}
+int usb_serial_jtag_read_bytes(void *buf, uint32_t length, TickType_t ticks) { return 0; }
+
+int usb_serial_jtag_write_bytes(const void *src, size_t size, TickType_t ticks)
+{
+    if (size > sizeof(s_serial) - s_serial_len) return 0;      // ring full: frame dropped
+    memcpy(&s_serial[s_serial_len], src, size);
+    s_serial_len += size;
+    return (int)size;
+}
+
+// ---------------- httpd: one scripted WebSocket frame per input ----------------
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config) { *handle = FUZZ_HTTPD_HANDLE; return ESP_OK; }
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri) { return ESP_OK; }
+int httpd_req_to_sockfd(httpd_req_t *req) { return 3; }
+esp_err_t httpd_sess_trigger_close(httpd_handle_t handle, int sockfd) { return ESP_OK; }
+esp_err_t httpd_ws_send_frame(httpd_req_t *req, httpd_ws_frame_t *pkt) { return ESP_OK; }
+esp_err_t httpd_ws_send_frame_async(httpd_handle_t handle, int fd, httpd_ws_frame_t *pkt) { return ESP_OK; }
+httpd_ws_client_info_t httpd_ws_get_fd_info(httpd_handle_t handle, int sockfd) { return HTTPD_WS_CLIENT_WEBSOCKET; }
+
+esp_err_t httpd_get_client_list(httpd_handle_t handle, size_t *fds, int *client_fds)
+{
+    if (*fds < 1) return ESP_ERR_INVALID_ARG;
+    client_fds[0] = 3;
+    *fds = 1;
+    return ESP_OK;
+}
+
+// Work items run inline: they only format and send replies
+esp_err_t httpd_queue_work(httpd_handle_t handle, httpd_work_fn_t work, void *arg)
+{
+    work(arg);
+    return ESP_OK;
+}
+
+// max_len 0 asks for the frame header only, like the real server
+esp_err_t httpd_ws_recv_frame(httpd_req_t *req, httpd_ws_frame_t *pkt, size_t max_len)
+{
+    pkt->type = s_ws_frame.type;
+    pkt->final = true;
+    pkt->len = s_ws_frame.len;
+    if (max_len == 0) return ESP_OK;
+    if (!pkt->payload || max_len < s_ws_frame.len) return ESP_ERR_INVALID_SIZE;
+    memcpy(pkt->payload, s_ws_frame.payload, s_ws_frame.len);
+    return ESP_OK;
+}
+
+// ---------------- FreeRTOS: single thread, nothing blocks ----------------
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                       UBaseType_t prio, TaskHandle_t *out)
+{
+    static int task_handle;
+    if (out) *out = &task_handle;
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                                   UBaseType_t prio, TaskHandle_t *out, BaseType_t core)
+{
+    return xTaskCreate(fn, name, stack, arg, prio, out);
+}
+
+void vTaskDelete(TaskHandle_t task) {}
+void vTaskDelay(TickType_t ticks) {}
+void vTaskDelayUntil(TickType_t *prev, TickType_t ticks) { *prev += ticks; }
+TickType_t xTaskGetTickCount(void) { return (TickType_t)(fuzz_now_us() / (1000 * portTICK_PERIOD_MS)); }
+TaskHandle_t xTaskGetCurrentTaskHandle(void) { static int self; return &self; }
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) { return 0; }
+BaseType_t xTaskNotifyGive(TaskHandle_t task) { return pdPASS; }
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken) {}
+UBaseType_t uxTaskGetNumberOfTasks(void) { return 1; }
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *out, UBaseType_t max, uint32_t *total_runtime)
+{
+    if (total_runtime) *total_runtime = 0;
+    return 0;
+}
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) { return 1024; }
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) { static int mutex; return &mutex; }
+SemaphoreHandle_t xSemaphoreCreateBinary(void) { static int binary; return &binary; }
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) { return pdTRUE; }
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) { return pdTRUE; }
+void vSemaphoreDelete(SemaphoreHandle_t sem) {}
@@ -0,0 +1,110 @@
+// firmware_stubs.c
+// Weak stand-ins for the firmware modules a target does not compile: sensor
+// drivers, monitors, publishers and storage. They report "idle / nothing
+// measured" and accept every setting. Ownership rules of the real functions
+// are kept (fs_write_file_scheduled frees its buffer), so LeakSanitizer only
+// reports leaks in the code under test.
+#include <stdlib.h>
+#include <string.h>
+
+#include "actuator.h"
+#include "flow_meter.h"
+#include "fs.h"
+#include "imbalance.h"
+#include "motor_mon.h"
+#include "mqtt_pub.h"
+#include "power.h"
+#include "pressure_sensor.h"
+#include "rpm_sensor.h"
+#include "serial_telemetry.h"
+#include "sysmon.h"
+#include "telemetry.h"
+#include "udp_telemetry.h"
+#include "ws_cycle.h"
+
+#define WEAK __attribute__((weak))
+
+// ---------------- sensors ----------------
+WEAK float rpm_sensor_get_rpm(void) { return 0.0f; }
+WEAK void rpm_sensor_reset(void) {}
+WEAK float pressure_sensor_read_frequency(void) { return 0.0f; }
+WEAK void pressure_sensor_reset(void) {}
+WEAK void pressure_sensor_set_tub_empty(bool empty) {}
+
+WEAK uint32_t flow_meter_count(void) { return 0; }
+WEAK float flow_meter_rate_lpm(void) { return 0.0f; }
+WEAK float flow_meter_get_pulses_per_litre(void) { return FLOW_DEFAULT_PULSES_PER_L; }
+WEAK esp_err_t flow_meter_set_pulses_per_litre(float ppl) { return ppl > 0.0f ? ESP_OK : ESP_ERR_INVALID_ARG; }
+WEAK uint32_t flow_meter_pulses_to_ml(uint32_t pulses) { return (uint32_t)(pulses * 1000.0f / FLOW_DEFAULT_PULSES_PER_L); }
+WEAK uint32_t flow_meter_ml_to_pulses(uint32_t ml) { return (uint32_t)(ml * FLOW_DEFAULT_PULSES_PER_L / 1000.0f) + 1; }
+WEAK void flow_meter_arm(size_t slot, uint32_t target_count, TaskHandle_t task) {}
+WEAK void flow_meter_disarm(size_t slot) {}
+WEAK void flow_meter_disarm_all(void) {}
+
+WEAK void imbalance_get(ImbalanceResult *out) { memset(out, 0, sizeof(*out)); }
+WEAK esp_err_t imbalance_set_pulses_per_rev(uint32_t ppr) { return ESP_OK; }
+WEAK uint32_t imbalance_get_pulses_per_rev(void) { return 0; }
+
+// ---------------- monitors / actuators ----------------
+WEAK void motor_mon_start(void) {}
+WEAK void motor_mon_stop(void) {}
+WEAK MotorFault motor_mon_fault(void) { return MOTOR_FAULT_NONE; }
+WEAK const char *motor_mon_fault_name(MotorFault fault) { return "none"; }
+WEAK const char *motor_mon_mode_name(MotorMonMode mode) { return "off"; }
+WEAK void motor_mon_stats(MotorMonStats *out) { memset(out, 0, sizeof(*out)); }
+WEAK void motor_mon_get_config(MotorMonConfig *out) { memset(out, 0, sizeof(*out)); }
+WEAK esp_err_t motor_mon_configure(const MotorMonConfig *cfg) { return ESP_OK; }
+
+WEAK uint32_t actuator_off_lead_ms(gpio_num_t pin, uint32_t on_ms) { return 0; }
+WEAK esp_err_t actuator_char_start(const ActuatorCharConfig *cfg) { return ESP_ERR_INVALID_STATE; }
+WEAK bool actuator_char_running(void) { return false; }
+WEAK void actuator_char_abort(void) {}
+WEAK esp_err_t actuator_set_compensation(bool enabled) { return ESP_OK; }
+WEAK char *actuator_to_json(bool with_trace) { return strdup("{}"); }
+
+WEAK void power_cycle_active(bool active) {}
+WEAK void power_get_stats(PowerStats *out) { memset(out, 0, sizeof(*out)); }
+
+// ---------------- telemetry / publishers ----------------
+WEAK void telemetry_notify_change(void) {}
+WEAK void telemetry_set_callback(telemetry_callback_t callback) {}
+WEAK void telemetry_set_subscriber_fn(telemetry_subscribers_fn_t fn) {}
+WEAK void telemetry_get_stats(TelemetryStats *out) { memset(out, 0, sizeof(*out)); }
+
+WEAK TelemetryPacket telemetry_get_latest(void)
+{
+    TelemetryPacket pkt;
+    memset(&pkt, 0, sizeof(pkt));
+    return pkt;
+}
+
+WEAK void sysmon_set_callback(sysmon_callback_t callback, uint32_t publish_ms) {}
+WEAK bool sysmon_get_latest(SysmonSnapshot *out) { memset(out, 0, sizeof(*out)); return false; }
+
+WEAK esp_err_t udp_telemetry_start(const char *addr, uint16_t port, uint8_t ttl) { return ESP_OK; }
+WEAK void udp_telemetry_stop(void) {}
+WEAK bool udp_telemetry_active(void) { return false; }
+WEAK void udp_telemetry_publish(const TelemetryPacket *packet) {}
+WEAK void udp_telemetry_get_status(UdpTelemetryStatus *out) { memset(out, 0, sizeof(*out)); }
+
+WEAK esp_err_t mqtt_pub_start(const char *uri, uint8_t qos) { return ESP_OK; }
+WEAK void mqtt_pub_stop(void) {}
+WEAK bool mqtt_pub_active(void) { return false; }
+WEAK void mqtt_pub_on_telemetry(const TelemetryPacket *packet) {}
+WEAK void mqtt_pub_get_stats(MqttPubStats *out) { memset(out, 0, sizeof(*out)); }
+
+WEAK esp_err_t serial_telemetry_start(uint32_t period_ms) { return ESP_OK; }
+WEAK void serial_telemetry_stop(void) {}
+WEAK bool serial_telemetry_active(void) { return false; }
+WEAK void serial_telemetry_get_stats(SerialTelemetryStats *out) { memset(out, 0, sizeof(*out)); }
+
+// ---------------- storage / WebSocket ----------------
+WEAK esp_err_t fs_write_file_scheduled(const char *path, char *data, size_t len)
+{
+    free(data);     // the writer owns the buffer
+    return ESP_OK;
+}
+WEAK esp_err_t fs_write_filler(const char *path, size_t len) { return ESP_OK; }
+WEAK void fs_get_write_stats(FsWriteStats *out) { memset(out, 0, sizeof(*out)); }
+
+WEAK void ws_update_cycle_data_cache(void) {}
@@ -0,0 +1,4 @@
+// driver/usb_serial_jtag_vfs.h - host stub
+#pragma once
+
+void usb_serial_jtag_vfs_use_driver(void);
@@ -0,0 +1,7 @@
+// esp_attr.h - host stub: placement attributes are meaningless off target
+#pragma once
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define NOINIT_ATTR
@@ -0,0 +1,29 @@
+// esp_err.h - host stub
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK                          0
+#define ESP_FAIL                        (-1)
+#define ESP_ERR_NO_MEM                  0x101
+#define ESP_ERR_INVALID_ARG             0x102
+#define ESP_ERR_INVALID_STATE           0x103
+#define ESP_ERR_INVALID_SIZE            0x104
+#define ESP_ERR_NOT_FOUND               0x105
+#define ESP_ERR_NOT_SUPPORTED           0x106
+#define ESP_ERR_TIMEOUT                 0x107
+#define ESP_ERR_NVS_NO_FREE_PAGES       0x110d
+#define ESP_ERR_NVS_NOT_FOUND           0x1102
+#define ESP_ERR_NVS_NEW_VERSION_FOUND   0x1110
+
+#define ESP_ERROR_CHECK(x)              ((void)(x))
+
+const char *esp_err_to_name(esp_err_t code);
+
+// esp_system.h on the target; declared here so either include works
+size_t esp_get_free_heap_size(void);
+size_t esp_get_minimum_free_heap_size(void);
+void esp_restart(void);
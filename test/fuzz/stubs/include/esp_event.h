@@ -0,0 +1,9 @@
+// esp_event.h - host stub
+#pragma once
+
+#include <stdint.h>
+
+typedef const char *esp_event_base_t;
+typedef void (*esp_event_handler_t)(void *arg, esp_event_base_t base, int32_t id, void *data);
+
+#define ESP_EVENT_ANY_ID    (-1)
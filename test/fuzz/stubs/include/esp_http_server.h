@@ -0,0 +1,105 @@
+// esp_http_server.h - host stub: frames come from and go to fuzz_stubs.h
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "esp_err.h"
+
+typedef void *httpd_handle_t;
+
+typedef enum {
+    HTTP_DELETE = 0,
+    HTTP_GET    = 1,
+    HTTP_HEAD   = 2,
+    HTTP_POST   = 3,
+} httpd_method_t;
+
+typedef struct httpd_req {
+    httpd_handle_t handle;
+    int            method;
+    const char     uri[32];
+    size_t         content_len;
+    void          *aux;
+    void          *user_ctx;
+    void          *sess_ctx;
+} httpd_req_t;
+
+typedef enum {
+    HTTPD_WS_TYPE_CONTINUE = 0x0,
+    HTTPD_WS_TYPE_TEXT     = 0x1,
+    HTTPD_WS_TYPE_BINARY   = 0x2,
+    HTTPD_WS_TYPE_CLOSE    = 0x8,
+    HTTPD_WS_TYPE_PING     = 0x9,
+    HTTPD_WS_TYPE_PONG     = 0xA,
+} httpd_ws_type_t;
+
+typedef struct {
+    bool            final;
+    bool            fragmented;
+    httpd_ws_type_t type;
+    uint8_t        *payload;
+    size_t          len;
+} httpd_ws_frame_t;
+
+typedef enum {
+    HTTPD_WS_CLIENT_INVALID   = 0,
+    HTTPD_WS_CLIENT_HTTP      = 1,
+    HTTPD_WS_CLIENT_WEBSOCKET = 2,
+} httpd_ws_client_info_t;
+
+typedef void (*httpd_work_fn_t)(void *arg);
+typedef esp_err_t (*httpd_open_func_t)(httpd_handle_t hd, int sockfd);
+typedef void (*httpd_close_func_t)(httpd_handle_t hd, int sockfd);
+
+typedef struct {
+    unsigned           task_priority;
+    size_t             stack_size;
+    int                core_id;
+    uint16_t           server_port;
+    uint16_t           ctrl_port;
+    uint16_t           max_open_sockets;
+    uint16_t           max_uri_handlers;
+    uint16_t           max_resp_headers;
+    uint16_t           backlog_conn;
+    bool               lru_purge_enable;
+    uint16_t           recv_wait_timeout;
+    uint16_t           send_wait_timeout;
+    void              *global_user_ctx;
+    httpd_open_func_t  open_fn;
+    httpd_close_func_t close_fn;
+} httpd_config_t;
+
+#define HTTPD_DEFAULT_CONFIG() {        \
+        .task_priority    = 5,          \
+        .stack_size       = 4096,       \
+        .core_id          = 0x7fffffff, \
+        .server_port      = 80,         \
+        .ctrl_port        = 32768,      \
+        .max_open_sockets = 7,          \
+        .max_uri_handlers = 8,          \
+        .max_resp_headers = 8,          \
+        .backlog_conn     = 5,          \
+    }
+
+typedef struct {
+    const char     *uri;
+    httpd_method_t  method;
+    esp_err_t     (*handler)(httpd_req_t *req);
+    void           *user_ctx;
+    bool            is_websocket;
+    bool            handle_ws_control_frames;
+    const char     *supported_subprotocol;
+} httpd_uri_t;
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config);
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri);
+int httpd_req_to_sockfd(httpd_req_t *req);
+esp_err_t httpd_get_client_list(httpd_handle_t handle, size_t *fds, int *client_fds);
+esp_err_t httpd_sess_trigger_close(httpd_handle_t handle, int sockfd);
+esp_err_t httpd_queue_work(httpd_handle_t handle, httpd_work_fn_t work, void *arg);
+httpd_ws_client_info_t httpd_ws_get_fd_info(httpd_handle_t handle, int sockfd);
+esp_err_t httpd_ws_recv_frame(httpd_req_t *req, httpd_ws_frame_t *pkt, size_t max_len);
+esp_err_t httpd_ws_send_frame(httpd_req_t *req, httpd_ws_frame_t *pkt);
+esp_err_t httpd_ws_send_frame_async(httpd_handle_t handle, int fd, httpd_ws_frame_t *pkt);
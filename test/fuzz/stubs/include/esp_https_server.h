@@ -0,0 +1,4 @@
+// esp_https_server.h - host stub
+#pragma once
+
+#include "esp_http_server.h"
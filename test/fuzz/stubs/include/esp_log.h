@@ -0,0 +1,19 @@
+// esp_log.h - host stub
+#pragma once
+
+#include "esp_err.h"
+
+// Logging is off by default: a fuzzer runs millions of inputs and the
+// firmware logs on every upload. FUZZ_LOG=1 in the environment turns it on.
+void fuzz_log(const char *level, const char *tag, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+#define ESP_LOGE(tag, fmt, ...)         fuzz_log("E", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...)         fuzz_log("W", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...)         fuzz_log("I", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...)         fuzz_log("D", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...)         fuzz_log("V", tag, fmt, ##__VA_ARGS__)
+#define ESP_EARLY_LOGE(tag, fmt, ...)   fuzz_log("E", tag, fmt, ##__VA_ARGS__)
+#define ESP_EARLY_LOGW(tag, fmt, ...)   fuzz_log("W", tag, fmt, ##__VA_ARGS__)
+#define ESP_DRAM_LOGE(tag, fmt, ...)    fuzz_log("E", tag, fmt, ##__VA_ARGS__)
+#define ESP_DRAM_LOGW(tag, fmt, ...)    fuzz_log("W", tag, fmt, ##__VA_ARGS__)
@@ -0,0 +1,6 @@
+// esp_random.h - host stub
+#pragma once
+
+#include <stdint.h>
+
+uint32_t esp_random(void);
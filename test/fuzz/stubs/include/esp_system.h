@@ -0,0 +1,4 @@
+// esp_system.h - host stub
+#pragma once
+
+#include "esp_err.h"
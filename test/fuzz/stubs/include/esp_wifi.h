@@ -0,0 +1,2 @@
+// esp_wifi.h - host stub (nothing in the fuzzed sources uses it)
+#pragma once
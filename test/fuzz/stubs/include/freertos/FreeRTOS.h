@@ -0,0 +1,38 @@
+// freertos/FreeRTOS.h - host stub: single-threaded, nothing ever blocks
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_attr.h"
+#include "esp_err.h"
+
+typedef int      BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE                  1
+#define pdFALSE                 0
+#define pdPASS                  pdTRUE
+#define pdFAIL                  pdFALSE
+#define portMAX_DELAY           ((TickType_t)0xffffffffu)
+#define configTICK_RATE_HZ      100
+#define portTICK_PERIOD_MS      (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)((uint64_t)(ms) * configTICK_RATE_HZ / 1000))
+#define pdTICKS_TO_MS(t)        ((uint32_t)(t) * portTICK_PERIOD_MS)
+#define configMAX_TASK_NAME_LEN 16
+#define configASSERT(x)         ((void)0)
+
+typedef struct {
+    int owner;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    { 0 }
+
+#define portENTER_CRITICAL(mux)         ((void)(mux))
+#define portEXIT_CRITICAL(mux)          ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux)     ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux)      ((void)(mux))
+#define portENTER_CRITICAL_SAFE(mux)    ((void)(mux))
+#define portEXIT_CRITICAL_SAFE(mux)     ((void)(mux))
+#define portYIELD_FROM_ISR(...)         ((void)0)
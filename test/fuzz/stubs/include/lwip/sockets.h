@@ -0,0 +1,8 @@
+// lwip/sockets.h - host stub: the host BSD socket API
+#pragma once
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
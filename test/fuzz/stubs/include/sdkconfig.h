@@ -0,0 +1,9 @@
+// sdkconfig.h - host stub: the options the fuzzed sources test, as in /sdkconfig
+#pragma once
+
+#define CONFIG_ESP_TIMER_IN_IRAM                    1
+#define CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS     1
+#define CONFIG_FREERTOS_USE_TRACE_FACILITY          1
+#define CONFIG_GPTIMER_CTRL_FUNC_IN_IRAM            1
+#define CONFIG_GPTIMER_ISR_CACHE_SAFE               1
+#define CONFIG_LWIP_MAX_SOCKETS                     12
@@ -0,0 +1,6 @@
+// soc/gpio_reg.h - host stub: register offsets into the stub register file (soc/soc.h)
+#pragma once
+
+#define GPIO_OUT_REG        0
+#define GPIO_OUT_W1TS_REG   1
+#define GPIO_OUT_W1TC_REG   2
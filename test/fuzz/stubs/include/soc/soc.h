@@ -0,0 +1,10 @@
+// soc/soc.h - host stub: GPIO output registers backed by a variable
+#pragma once
+
+#include <stdint.h>
+
+uint32_t host_reg_read(uint32_t reg);
+void host_reg_write(uint32_t reg, uint32_t value);
+
+#define REG_READ(reg)           host_reg_read(reg)
+#define REG_WRITE(reg, value)   host_reg_write((reg), (value))
@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+"""Minimal MQTT 3.1.1 broker for exercising the device publisher (see main/mqtt_pub.h).
+
+Accepts any client, acknowledges QoS 1/2 publishes, forwards them to
+subscribers, keeps retained messages, and prints every publish. It also
+tracks the per-device "seq" field to report duplicates (expected after a
+reconnect, delivery is at-least-once) and gaps (messages dropped on the
+device). Not a real broker: no auth, no persistence, no QoS to subscribers.
+
+Usage:
+    python3 tools/mqtt_broker_standin.py                    # listen on 0.0.0.0:1883
+    python3 tools/mqtt_broker_standin.py --outage 60:20     # every 60 s drop clients, refuse for 20 s
+    python3 tools/mqtt_broker_standin.py --quiet            # only the summary lines
+
+Point the device at it with:
+    {"action": "set_mqtt", "enable": true, "uri": "mqtt://<host>:1883"}
+"""
+import argparse
+import asyncio
+import json
+import sys
+import time
+
+CONNECT, CONNACK, PUBLISH, PUBACK, PUBREC, PUBREL, PUBCOMP = 1, 2, 3, 4, 5, 6, 7
+SUBSCRIBE, SUBACK, UNSUBSCRIBE, UNSUBACK, PINGREQ, PINGRESP, DISCONNECT = 8, 9, 10, 11, 12, 13, 14
+
+
+def encode_len(n):
+    out = bytearray()
+    while True:
+        b = n % 128
+        n //= 128
+        out.append(b | 0x80 if n else b)
+        if not n:
+            return bytes(out)
+
+
+def packet(ptype, flags, body):
+    return bytes([(ptype << 4) | flags]) + encode_len(len(body)) + body
+
+
+def mqtt_str(s):
+    b = s.encode()
+    return len(b).to_bytes(2, "big") + b
+
+
+def read_str(buf, off):
+    n = int.from_bytes(buf[off:off + 2], "big")
+    return buf[off + 2:off + 2 + n].decode("utf-8", "replace"), off + 2 + n
+
+
+def topic_matches(flt, topic):
+    f, t = flt.split("/"), topic.split("/")
+    for i, part in enumerate(f):
+        if part == "#":
+            return True
+        if i >= len(t) or (part != "+" and part != t[i]):
+            return False
+    return len(f) == len(t)
+
+
+class SeqTracker:
+    """Per (device, boot) sequence bookkeeping across all topics."""
+
+    def __init__(self):
+        self.seen = {}
+        self.dups = {}
+
+    def update(self, payload):
+        try:
+            msg = json.loads(payload)
+            key, seq = (msg["device"], msg.get("boot", 0)), int(msg["seq"])
+        except (ValueError, KeyError, TypeError):
+            return None
+        seen = self.seen.setdefault(key, set())
+        if seq in seen:
+            self.dups[key] = self.dups.get(key, 0) + 1
+            return "duplicate seq %d" % seq
+        seen.add(seq)
+        return None
+
+    def summary(self):
+        for (dev, boot), seen in sorted(self.seen.items()):
+            hi = max(seen)
+            gaps = hi - len(seen)
+            print("%s boot %s: %d unique (seq 1..%d), %d missing, %d duplicate(s)"
+                  % (dev, boot, len(seen), hi, gaps, self.dups.get((dev, boot), 0)), file=sys.stderr)
+
+
+class Broker:
+    def __init__(self, quiet):
+        self.quiet = quiet
+        self.clients = {}           # writer -> list of subscription filters
+        self.retained = {}
+        self.refusing = False
+        self.tracker = SeqTracker()
+        self.count = 0
+
+    def log(self, msg):
+        print("[%s] %s" % (time.strftime("%H:%M:%S"), msg), file=sys.stderr, flush=True)
+
+    async def handle(self, reader, writer):
+        peer = writer.get_extra_info("peername")
+        if self.refusing:
+            writer.close()
+            return
+        self.clients[writer] = []
+        client_id = "?"
+        try:
+            while True:
+                head = await reader.readexactly(1)
+                n, mult = 0, 1
+                while True:
+                    b = (await reader.readexactly(1))[0]
+                    n += (b & 0x7F) * mult
+                    mult *= 128
+                    if not b & 0x80:
+                        break
+                body = await reader.readexactly(n)
+                ptype, flags = head[0] >> 4, head[0] & 0x0F
+
+                if ptype == CONNECT:
+                    off = 2 + int.from_bytes(body[0:2], "big") + 1     # protocol name, level
+                    connect_flags = body[off]
+                    client_id, _ = read_str(body, off + 3)
+                    writer.write(packet(CONNACK, 0, b"\x00\x00"))
+                    self.log("%s connected from %s:%d (will: %s)"
+                             % (client_id, peer[0], peer[1], "yes" if connect_flags & 0x04 else "no"))
+                elif ptype == PUBLISH:
+                    qos, retain = (flags >> 1) & 3, flags & 1
+                    topic, off = read_str(body, 0)
+                    if qos:
+                        pid = body[off:off + 2]
+                        off += 2
+                        writer.write(packet(PUBACK if qos == 1 else PUBREC, 0, pid))
+                    self.on_publish(topic, body[off:], retain)
+                elif ptype == PUBREL:
+                    writer.write(packet(PUBCOMP, 0, body[0:2]))
+                elif ptype == SUBSCRIBE:
+                    pid, off, granted = body[0:2], 2, bytearray()
+                    while off < len(body):
+                        flt, off = read_str(body, off)
+                        off += 1
+                        self.clients[writer].append(flt)
+                        granted.append(0)
+                        for topic, payload in self.retained.items():
+                            if topic_matches(flt, topic):
+                                writer.write(packet(PUBLISH, 1, mqtt_str(topic) + payload))
+                    writer.write(packet(SUBACK, 0, pid + bytes(granted)))
+                elif ptype == UNSUBSCRIBE:
+                    writer.write(packet(UNSUBACK, 0, body[0:2]))
+                elif ptype == PINGREQ:
+                    writer.write(packet(PINGRESP, 0, b""))
+                elif ptype == DISCONNECT:
+                    break
+                await writer.drain()
+        except (asyncio.IncompleteReadError, ConnectionError):
+            pass
+        finally:
+            self.clients.pop(writer, None)
+            writer.close()
+            self.log("%s disconnected" % client_id)
+
+    def on_publish(self, topic, payload, retain):
+        self.count += 1
+        if retain:
+            self.retained[topic] = payload
+        text = payload.decode("utf-8", "replace")
+        note = self.tracker.update(text)
+        if note:
+            self.log("%s: %s" % (topic, note))
+        if not self.quiet:
+            print("%s %s" % (topic, text), flush=True)
+        for w, filters in self.clients.items():
+            if any(topic_matches(f, topic) for f in filters):
+                w.write(packet(PUBLISH, 0, mqtt_str(topic) + payload))
+
+    async def outages(self, period, duration):
+        while True:
+            await asyncio.sleep(period)
+            self.log("outage: dropping %d client(s) for %d s" % (len(self.clients), duration))
+            self.refusing = True
+            for w in list(self.clients):
+                w.transport.abort()
+            await asyncio.sleep(duration)
+            self.refusing = False
+            self.log("outage over")
+
+
+async def run(args):
+    broker = Broker(args.quiet)
+    server = await asyncio.start_server(broker.handle, args.host, args.port)
+    broker.log("listening on %s:%d" % (args.host, args.port))
+    tasks = [asyncio.ensure_future(server.serve_forever())]
+    if args.outage:
+        period, duration = (int(x) for x in args.outage.split(":"))
+        tasks.append(asyncio.ensure_future(broker.outages(period, duration)))
+    try:
+        await asyncio.gather(*tasks)
+    finally:
+        print("%d publish(es) received" % broker.count, file=sys.stderr)
+        broker.tracker.summary()
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--host", default="0.0.0.0")
+    ap.add_argument("--port", type=int, default=1883)
+    ap.add_argument("--outage", metavar="PERIOD:DURATION", help="periodically drop and refuse clients (seconds)")
+    ap.add_argument("--quiet", action="store_true", help="do not print each publish")
+    args = ap.parse_args()
+    try:
+        asyncio.run(run(args))
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,274 @@
+#!/usr/bin/env python3
+"""Decode the binary serial telemetry stream (see main/serial_telemetry.h).
+
+Usage:
+    python3 tools/serial_telemetry_rx.py /dev/ttyACM0                  # human-readable lines
+    python3 tools/serial_telemetry_rx.py /dev/ttyACM0 --period 20      # 50 Hz samples
+    python3 tools/serial_telemetry_rx.py /dev/ttyACM0 --csv run1       # run1_samples.csv, run1_edges.csv, run1_phases.csv
+    python3 tools/serial_telemetry_rx.py /dev/ttyACM0 --json           # one JSON object per frame (pipe into tools)
+    python3 tools/serial_telemetry_rx.py /dev/pts/5                    # pty from serial_telemetry_standin.py
+
+The stream is started with "ct start <period>" when the port is opened and
+stopped with "ct stop" on exit. Log text on the same port is passed through
+to stderr with --log.
+"""
+import argparse
+import binascii
+import csv
+import json
+import os
+import select
+import struct
+import sys
+import termios
+import time
+import tty
+
+VERSION = 1
+SAMPLE, EDGE, PHASE, STATUS = 1, 2, 3, 4
+HDR = struct.Struct("<BHI")
+SAMPLE_BODY = struct.Struct("<ffHBB")
+EDGE_BODY = struct.Struct("<HH")
+PHASE_BODY = struct.Struct("<BBBB")
+STATUS_BODY = struct.Struct("<BHIIB")
+PHASE_EVENTS = {0: "cycle_start", 1: "phase_start", 2: "cycle_end", 3: "alarm"}
+
+
+def crc16(data):
+    return binascii.crc_hqx(data, 0xFFFF)
+
+
+def cobs_encode(data):
+    out, block = bytearray(), bytearray()
+    for b in data:
+        if b == 0:
+            out.append(len(block) + 1)
+            out += block
+            block = bytearray()
+        else:
+            block.append(b)
+            if len(block) == 254:
+                out.append(255)
+                out += block
+                block = bytearray()
+    out.append(len(block) + 1)
+    out += block
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out, i = bytearray(), 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            raise ValueError("bad COBS code")
+        out += data[i + 1:i + code]
+        i += code
+        if code < 255 and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def encode_frame(ftype, seq, time_us, body):
+    """Build one wire frame (also used by the pty stand-in)."""
+    raw = HDR.pack(ftype, seq & 0xFFFF, time_us & 0xFFFFFFFF) + body
+    raw += struct.pack("<H", crc16(raw))
+    return b"\x00" + cobs_encode(raw) + b"\x00"
+
+
+def decode_frame(chunk):
+    raw = cobs_decode(chunk)
+    if len(raw) < HDR.size + 2:
+        raise ValueError("short frame")
+    if struct.unpack_from("<H", raw, len(raw) - 2)[0] != crc16(raw[:-2]):
+        raise ValueError("CRC mismatch")
+    ftype, seq, time_us = HDR.unpack_from(raw)
+    body = raw[HDR.size:-2]
+    f = {"type": ftype, "seq": seq, "device_us": time_us}
+
+    if ftype == SAMPLE:
+        rpm, press, outputs, phase, flags = SAMPLE_BODY.unpack_from(body)
+        f.update(kind="sample", rpm=rpm, pressure_freq=press, outputs=outputs, phase_index=phase,
+                 cycle_running=bool(flags & 1), deadline_alarm=bool(flags & 2), pressure_new=bool(flags & 4))
+    elif ftype == EDGE:
+        changed, outputs = EDGE_BODY.unpack_from(body)
+        f.update(kind="edge", changed=changed, outputs=outputs)
+    elif ftype == PHASE:
+        event, index, total, name_len = PHASE_BODY.unpack_from(body)
+        name = body[PHASE_BODY.size:PHASE_BODY.size + name_len].decode("utf-8", "replace")
+        f.update(kind="phase", event=PHASE_EVENTS.get(event, str(event)), phase_index=index,
+                 total_phases=total, phase_name=name)
+    elif ftype == STATUS:
+        version, period, dropped, lost_edges, npins = STATUS_BODY.unpack_from(body)
+        pins = list(body[STATUS_BODY.size:STATUS_BODY.size + npins])
+        f.update(kind="status", version=version, period_ms=period, dropped=dropped,
+                 lost_edges=lost_edges, pins=pins)
+    else:
+        f.update(kind="unknown")
+    return f
+
+
+class Decoder:
+    """Splits the byte stream on 0x00, decodes frames, tracks seq gaps and unwraps device time."""
+
+    def __init__(self):
+        self.buf = bytearray()
+        self.last_seq = None
+        self.lost = 0
+        self.bad = 0
+        self.frames = 0
+        self.wraps = 0
+        self.last_us = None
+        self.text = []
+
+    def feed(self, data):
+        self.buf += data
+        frames = []
+        while True:
+            i = self.buf.find(b"\x00")
+            if i < 0:
+                break
+            chunk, self.buf = bytes(self.buf[:i]), self.buf[i + 1:]
+            if not chunk:
+                continue
+            try:
+                f = decode_frame(chunk)
+            except (ValueError, struct.error):
+                if all(32 <= c < 127 or c in (9, 10, 13, 27) for c in chunk):
+                    self.text.append(chunk.decode("ascii", "replace"))
+                else:
+                    self.bad += 1
+                continue
+            self.track(f)
+            frames.append(f)
+        return frames
+
+    def track(self, f):
+        self.frames += 1
+        if self.last_seq is not None:
+            gap = (f["seq"] - self.last_seq - 1) & 0xFFFF
+            if gap < 0x8000:
+                self.lost += gap
+                f["lost_before"] = gap
+        self.last_seq = f["seq"]
+
+        t = f["device_us"]
+        if self.last_us is not None and t < self.last_us and self.last_us - t > 0x80000000:
+            self.wraps += 1
+        self.last_us = t
+        f["time_s"] = (self.wraps * 0x100000000 + t) / 1e6
+
+
+def open_port(path):
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    if os.isatty(fd):
+        tty.setraw(fd)
+        attrs = termios.tcgetattr(fd)
+        attrs[3] &= ~termios.ECHO
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+def fmt_pins(mask, pins):
+    return " ".join("%d:%d" % (p, (mask >> i) & 1) for i, p in enumerate(pins)) if pins else "0x%04x" % mask
+
+
+class CsvSink:
+    def __init__(self, prefix):
+        self.files = {}
+        self.writers = {}
+        for kind, cols in (("samples", ["time_s", "seq", "rpm", "pressure_freq", "outputs", "phase_index",
+                                        "cycle_running", "deadline_alarm", "pressure_new"]),
+                           ("edges", ["time_s", "seq", "changed", "outputs"]),
+                           ("phases", ["time_s", "seq", "event", "phase_index", "total_phases", "phase_name"])):
+            fh = open("%s_%s.csv" % (prefix, kind), "w", newline="")
+            w = csv.DictWriter(fh, fieldnames=cols, extrasaction="ignore")
+            w.writeheader()
+            self.files[kind], self.writers[kind] = fh, w
+
+    def write(self, f):
+        kind = {"sample": "samples", "edge": "edges", "phase": "phases"}.get(f["kind"])
+        if kind:
+            self.writers[kind].writerow(f)
+
+    def close(self):
+        for fh in self.files.values():
+            fh.close()
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("port", help="serial device (/dev/ttyACM0) or pty path")
+    ap.add_argument("--period", type=int, default=10, help="sample period in ms (10-1000)")
+    ap.add_argument("--csv", metavar="PREFIX", help="write PREFIX_samples/_edges/_phases.csv")
+    ap.add_argument("--json", action="store_true", help="print one JSON object per frame")
+    ap.add_argument("--log", action="store_true", help="pass device log text through to stderr")
+    ap.add_argument("--count", type=int, default=0, help="exit after N frames")
+    ap.add_argument("--no-start", action="store_true", help="do not send ct start/stop")
+    args = ap.parse_args()
+
+    fd = open_port(args.port)
+    if not args.no_start:
+        os.write(fd, b"ct start %d\n" % args.period)
+    dec = Decoder()
+    sink = CsvSink(args.csv) if args.csv else None
+    pins = []
+    t0 = time.time()
+
+    try:
+        while not args.count or dec.frames < args.count:
+            r, _, _ = select.select([fd], [], [], 1.0)
+            if not r:
+                continue
+            data = os.read(fd, 4096)
+            if not data:
+                break
+            for f in dec.feed(data):
+                if f.get("lost_before"):
+                    print("lost %d frame(s) before #%d" % (f["lost_before"], f["seq"]), file=sys.stderr)
+                if f["kind"] == "status":
+                    pins = f["pins"]
+                if sink:
+                    sink.write(f)
+                if args.json:
+                    print(json.dumps(f), flush=True)
+                elif not sink:
+                    print(format_frame(f, pins), flush=True)
+            if args.log:
+                for line in dec.text:
+                    sys.stderr.write(line)
+            dec.text.clear()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if not args.no_start:
+            os.write(fd, b"ct stop\n")
+        os.close(fd)
+        if sink:
+            sink.close()
+
+    secs = max(time.time() - t0, 1e-6)
+    print("%d frames (%.0f/s), %d lost, %d bad" % (dec.frames, dec.frames / secs, dec.lost, dec.bad), file=sys.stderr)
+
+
+def format_frame(f, pins):
+    k = f["kind"]
+    if k == "sample":
+        return "%10.4f  %s %2d | RPM %5.0f | P %8.2f Hz%s | %s%s" % (
+            f["time_s"], "RUN " if f["cycle_running"] else "IDLE", f["phase_index"], f["rpm"],
+            f["pressure_freq"], "*" if f["pressure_new"] else " ", fmt_pins(f["outputs"], pins),
+            " | ALARM" if f["deadline_alarm"] else "")
+    if k == "edge":
+        changed = [p for i, p in enumerate(pins) if (f["changed"] >> i) & 1] if pins else ["0x%04x" % f["changed"]]
+        return "%10.6f  EDGE %s -> %s" % (f["time_s"], ",".join(str(c) for c in changed), fmt_pins(f["outputs"], pins))
+    if k == "phase":
+        return "%10.4f  %s %d/%d %s" % (f["time_s"], f["event"].upper(), f["phase_index"], f["total_phases"],
+                                        f["phase_name"])
+    if k == "status":
+        return "%10.4f  STATUS v%d period %d ms, device dropped %d, lost edges %d" % (
+            f["time_s"], f["version"], f["period_ms"], f["dropped"], f["lost_edges"])
+    return "%10.4f  frame type %d" % (f["time_s"], f["type"])
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+"""pty stand-in for the device's serial telemetry stream (no hardware needed).
+
+Opens a pseudo-terminal, prints its path, and behaves like the firmware on
+the USB-Serial-JTAG console: it waits for "ct start [period_ms]", then
+emits framed SAMPLE / EDGE / PHASE / STATUS frames for a synthetic cycle,
+with ESP-IDF style log lines in between. "ct stop" pauses it.
+
+Usage:
+    python3 tools/serial_telemetry_standin.py                   # prints e.g. /dev/pts/5
+    python3 tools/serial_telemetry_rx.py /dev/pts/5 --log       # in another terminal
+    python3 tools/serial_telemetry_standin.py --corrupt 0.01    # flip a byte in 1% of frames
+    python3 tools/serial_telemetry_standin.py --drop 0.01       # skip 1% of frames (seq gaps)
+"""
+import argparse
+import math
+import os
+import random
+import select
+import struct
+import sys
+import time
+import tty
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from serial_telemetry_rx import (EDGE, PHASE, SAMPLE, STATUS, VERSION, EDGE_BODY,   # noqa: E402
+                                 PHASE_BODY, SAMPLE_BODY, STATUS_BODY, encode_frame)
+
+PINS = [5, 6, 7, 8, 9, 10, 20, 21]
+PHASES = [("Fill", 4.0, 0b00000100), ("Wash", 6.0, 0b01000000), ("Drain", 3.0, 0b00001000),
+          ("Spin", 5.0, 0b11001000)]
+
+
+class StandIn:
+    def __init__(self, fd, args):
+        self.fd, self.args = fd, args
+        self.seq = 0
+        self.t0 = time.monotonic()
+        self.outputs = 0xFF            # active-low: all OFF
+        self.sent = self.dropped = 0
+
+    def now_us(self):
+        return int((time.monotonic() - self.t0) * 1e6)
+
+    def send(self, ftype, body, time_us=None):
+        frame = encode_frame(ftype, self.seq, self.now_us() if time_us is None else time_us, body)
+        self.seq += 1
+        if random.random() < self.args.drop:
+            self.dropped += 1
+            return
+        if random.random() < self.args.corrupt:
+            b = bytearray(frame)
+            i = random.randrange(1, len(b) - 1)
+            b[i] = (b[i] ^ 0x5A) or 1           # keep it non-zero: framing stays intact
+            frame = bytes(b)
+        os.write(self.fd, frame)
+        self.sent += 1
+
+    def log(self, text):
+        os.write(self.fd, ("I (%d) standin: %s\n" % (self.now_us() // 1000, text)).encode())
+
+    def set_outputs(self, on_mask):
+        new = 0xFF & ~on_mask
+        changed = new ^ self.outputs
+        if changed:
+            self.outputs = new
+            self.send(EDGE, EDGE_BODY.pack(changed, new), self.now_us() - random.randrange(0, 5000))
+
+    def run(self, period_ms):
+        cycle_start = time.monotonic()
+        last_phase = -1
+        next_status = 0.0
+        next_log = time.monotonic() + 0.5
+        self.send(PHASE, PHASE_BODY.pack(0, 1, len(PHASES), 0))
+        while True:
+            t = time.monotonic() - cycle_start
+            total = sum(p[1] for p in PHASES)
+            running = t < total
+            idx, acc = len(PHASES) - 1, 0.0
+            for i, (_, dur, _) in enumerate(PHASES):
+                if t < acc + dur:
+                    idx = i
+                    break
+                acc += dur
+
+            if running and idx != last_phase:
+                name = PHASES[idx][0].encode()
+                self.send(PHASE, PHASE_BODY.pack(1, idx + 1, len(PHASES), len(name)) + name)
+                self.set_outputs(PHASES[idx][2])
+                last_phase = idx
+            if not running and last_phase >= 0:
+                self.set_outputs(0)
+                self.send(PHASE, PHASE_BODY.pack(2, last_phase + 1, len(PHASES), 0))
+                last_phase = -1
+
+            rpm = (300 + 80 * math.sin(t * 7)) if running and idx in (1, 3) else 0.0
+            press = 26000.0 - (400 * min(t, 4.0) if running else 0)
+            flags = (1 if running else 0) | (4 if int(t * 4) != int((t - period_ms / 1000) * 4) else 0)
+            self.send(SAMPLE, SAMPLE_BODY.pack(rpm, press, self.outputs, idx + 1 if running else 0, flags))
+
+            if time.monotonic() >= next_status:
+                self.send(STATUS, STATUS_BODY.pack(VERSION, period_ms, self.dropped, 0, len(PINS)) + bytes(PINS))
+                next_status = time.monotonic() + 1.0
+            if time.monotonic() >= next_log:
+                self.log("heap %d" % random.randrange(140000, 150000))
+                next_log = time.monotonic() + 0.5
+
+            cmd = poll_command(self.fd, period_ms / 1000.0)
+            if cmd and cmd[0] == "stop":
+                return
+            if cmd and cmd[0] == "start" and len(cmd) > 1:
+                period_ms = int(cmd[1])
+            if not running and t > total + 2:
+                cycle_start = time.monotonic()
+                self.send(PHASE, PHASE_BODY.pack(0, 1, len(PHASES), 0))
+
+
+_line = bytearray()
+
+
+def poll_command(fd, timeout):
+    """Return ["start", "10"] / ["stop"] when a full "ct ..." line arrives within timeout."""
+    deadline = time.monotonic() + timeout
+    while True:
+        left = deadline - time.monotonic()
+        r, _, _ = select.select([fd], [], [], max(left, 0))
+        if not r:
+            return None
+        for b in os.read(fd, 256):
+            if b in (10, 13):
+                words = _line.decode("ascii", "replace").split()
+                _line.clear()
+                if len(words) >= 2 and words[0] == "ct":
+                    return words[1:]
+            else:
+                _line.append(b)
+        if left <= 0:
+            return None
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--corrupt", type=float, default=0.0, help="fraction of frames with a flipped byte")
+    ap.add_argument("--drop", type=float, default=0.0, help="fraction of frames skipped")
+    ap.add_argument("--autostart", type=int, metavar="PERIOD_MS", help="stream without waiting for ct start")
+    args = ap.parse_args()
+
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    print(os.ttyname(slave), flush=True)
+
+    dev = StandIn(master, args)
+    period = args.autostart
+    try:
+        while True:
+            if period is None:
+                cmd = poll_command(master, 1.0)
+                if cmd and cmd[0] == "start":
+                    period = int(cmd[1]) if len(cmd) > 1 else 10
+                continue
+            print("streaming, period %d ms" % period, file=sys.stderr, flush=True)
+            dev.run(period)
+            print("stopped (%d frames sent, %d dropped)" % (dev.sent, dev.dropped), file=sys.stderr, flush=True)
+            period = None
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
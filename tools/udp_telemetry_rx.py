@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+"""Receive and decode the UDP telemetry stream (see main/udp_telemetry.h).
+
+Usage:
+    python3 tools/udp_telemetry_rx.py                       # default group 239.255.67.84:5684
+    python3 tools/udp_telemetry_rx.py --group 239.1.2.3 --port 6000
+    python3 tools/udp_telemetry_rx.py --group ""            # broadcast / unicast, no group join
+    python3 tools/udp_telemetry_rx.py --json                # one JSON object per datagram
+
+Enable the stream on the device with:
+    {"action": "set_udp_telemetry", "enable": true}
+"""
+import argparse
+import json
+import socket
+import struct
+import sys
+import time
+
+MAGIC = b"CT"
+VERSION = 1
+HDR = struct.Struct("<2sBBII6sBBHffHHIHbB")   # 42 bytes
+TRACK = struct.Struct("<BBI")
+
+
+def decode(data):
+    if len(data) < HDR.size:
+        raise ValueError("short datagram (%d bytes)" % len(data))
+    (magic, version, flags, seq, dev_ms, dev_id, num_pins, num_tracks, states,
+     rpm, press, phase, total, elapsed, misses, alarm_pin, name_len) = HDR.unpack_from(data)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("not a telemetry datagram (magic %r, version %d)" % (magic, version))
+
+    off = HDR.size
+    need = off + num_pins + TRACK.size * num_tracks + name_len
+    if len(data) < need:
+        raise ValueError("truncated datagram (%d < %d bytes)" % (len(data), need))
+
+    pins = list(data[off:off + num_pins])
+    off += num_pins
+    tracks = []
+    for _ in range(num_tracks):
+        idx, active, t_elapsed = TRACK.unpack_from(data, off)
+        tracks.append({"phase_index": idx, "active": bool(active), "phase_elapsed_ms": t_elapsed})
+        off += TRACK.size
+    name = data[off:off + name_len].decode("utf-8", "replace")
+
+    return {
+        "device": dev_id.hex(":"),
+        "seq": seq,
+        "device_ms": dev_ms,
+        "cycle_running": bool(flags & 0x01),
+        "deadline_alarm": bool(flags & 0x02),
+        "sensor_error": bool(flags & 0x04),
+        "motor_fault": bool(flags & 0x08),
+        "gpio": [{"pin": p, "state": (states >> i) & 1} for i, p in enumerate(pins)],
+        "rpm": rpm,
+        "pressure_freq": press,
+        "phase_index": phase,
+        "total_phases": total,
+        "phase_name": name,
+        "phase_elapsed_ms": elapsed,
+        "deadline_misses": misses,
+        "alarm_pin": alarm_pin,
+        "tracks": tracks,
+    }
+
+
+def open_socket(group, port, iface):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    if hasattr(socket, "SO_REUSEPORT"):
+        sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEPORT, 1)
+    sock.bind(("", port))
+    if group:
+        mreq = socket.inet_aton(group) + socket.inet_aton(iface)
+        sock.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP, mreq)
+    return sock
+
+
+class LossTracker:
+    """Per-device sequence tracking: gaps are lost datagrams, a drop to a low seq is a restart."""
+
+    def __init__(self):
+        self.last = {}
+        self.received = {}
+        self.lost = {}
+
+    def update(self, device, seq):
+        self.received[device] = self.received.get(device, 0) + 1
+        self.lost.setdefault(device, 0)
+        prev = self.last.get(device)
+        gap = 0
+        if prev is not None:
+            if seq > prev:
+                gap = seq - prev - 1
+            elif seq < prev:
+                print("[%s] stream restarted (seq %d -> %d)" % (device, prev, seq), file=sys.stderr)
+        self.lost[device] += gap
+        self.last[device] = seq
+        return gap
+
+    def summary(self):
+        for dev in sorted(self.received):
+            got, lost = self.received[dev], self.lost[dev]
+            pct = 100.0 * lost / (got + lost) if got + lost else 0.0
+            print("%s: %d received, %d lost (%.2f%%)" % (dev, got, lost, pct), file=sys.stderr)
+
+
+def format_line(t):
+    outs = " ".join("%d:%d" % (g["pin"], g["state"]) for g in t["gpio"])
+    line = "[%s #%d] %s %d/%d %-12s %6.1fs | RPM %5.0f | P %8.2f Hz | %s" % (
+        t["device"][-8:], t["seq"], "RUN " if t["cycle_running"] else "IDLE",
+        t["phase_index"], t["total_phases"], t["phase_name"], t["phase_elapsed_ms"] / 1000.0,
+        t["rpm"], t["pressure_freq"], outs)
+    if t["deadline_alarm"]:
+        line += " | ALARM pin %d" % t["alarm_pin"]
+    if t["motor_fault"]:
+        line += " | MOTOR FAULT"
+    return line
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--group", default="239.255.67.84", help='multicast group ("" for broadcast/unicast)')
+    ap.add_argument("--port", type=int, default=5684)
+    ap.add_argument("--iface", default="0.0.0.0", help="local interface address for the group join")
+    ap.add_argument("--json", action="store_true", help="print one JSON object per datagram")
+    ap.add_argument("--count", type=int, default=0, help="exit after N datagrams")
+    args = ap.parse_args()
+
+    sock = open_socket(args.group, args.port, args.iface)
+    loss = LossTracker()
+    print("listening on %s:%d" % (args.group or "*", args.port), file=sys.stderr)
+
+    n = 0
+    try:
+        while not args.count or n < args.count:
+            data, addr = sock.recvfrom(2048)
+            try:
+                t = decode(data)
+            except ValueError as e:
+                print("%s: %s" % (addr[0], e), file=sys.stderr)
+                continue
+            gap = loss.update(t["device"], t["seq"])
+            if gap:
+                print("[%s] lost %d datagram(s) before #%d" % (t["device"], gap, t["seq"]), file=sys.stderr)
+            t["rx_time"] = time.time()
+            print(json.dumps(t) if args.json else format_line(t), flush=True)
+            n += 1
+    except KeyboardInterrupt:
+        pass
+    loss.summary()
+
+
+if __name__ == "__main__":
+    main()
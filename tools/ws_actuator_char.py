@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""Run the actuator latency self-test and print the measured table.
+
+Usage:
+    python3 tools/ws_actuator_char.py ws://192.168.1.100:8080/ws
+    python3 tools/ws_actuator_char.py ws://192.168.1.100:8080/ws --csv trace.csv --compensate
+
+The outputs really switch: each valve fills briefly, the motor spins and the
+drain pump empties the tub. Needs the machine idle (no cycle running).
+--csv writes every captured sample (actuator, after, t_ms, value) for plotting.
+Needs: pip install websockets
+"""
+import argparse
+import asyncio
+import csv
+import json
+
+import websockets
+
+
+def is_broadcast(reply):
+    """Telemetry/sysmon pushes arrive on the same socket; they are not replies."""
+    if isinstance(reply, bytes):
+        return True
+    return reply.startswith("{") and any('"type":"%s"' % t in reply for t in ("telemetry", "sysmon"))
+
+
+async def request(ws, msg):
+    await ws.send(json.dumps(msg))
+    while True:
+        reply = await ws.recv()
+        if not is_broadcast(reply):
+            return reply
+
+
+async def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("uri")
+    ap.add_argument("--press-delta", type=float, default=20.0, help="pressure response threshold (Hz)")
+    ap.add_argument("--rpm", type=float, default=30.0, help="motor response threshold (RPM)")
+    ap.add_argument("--csv", help="write the captured samples here")
+    ap.add_argument("--compensate", action="store_true", help="enable valve OFF compensation afterwards")
+    args = ap.parse_args()
+
+    async with websockets.connect(args.uri, max_size=None) as ws:
+        reply = await request(ws, {"action": "actuator_char",
+                                   "press_delta_hz": args.press_delta, "rpm_threshold": args.rpm})
+        if not reply.startswith("ok"):
+            raise RuntimeError(reply)
+        print(reply)
+
+        try:
+            while True:
+                await asyncio.sleep(2)
+                st = json.loads(await request(ws, {"action": "get_actuator_char"}))
+                if st["state"] != "running":
+                    break
+                print("  running... %d samples" % st["samples"])
+        except (KeyboardInterrupt, asyncio.CancelledError):
+            await request(ws, {"action": "actuator_char", "stop": True})
+            raise
+
+        st = json.loads(await request(ws, {"action": "get_actuator_char", "trace": bool(args.csv)}))
+        print("self-test %s in %.1f s, %d samples%s, stored: %s"
+              % (st["state"], st["run_ms"] / 1000, st["samples"],
+                 " (trace truncated)" if st["trace_truncated"] else "", st["stored"]))
+        print("%-16s %-8s %8s %8s  %s" % ("actuator", "sensor", "on_ms", "off_ms", "last run"))
+        rows = []
+        for a in st["actuators"]:
+            last = a.get("last", {})
+            run = ("on %d / off %d ms, baseline %.1f peak %.1f" % (last["on_ms"], last["off_ms"], last["baseline"], last["peak"])
+                   if last.get("responded") else "no response")
+            print("%-16s %-8s %8s %8s  %s" % (a["name"], a["sensor"],
+                                              a["on_ms"] if a["valid"] else "-", a["off_ms"] if a["valid"] else "-", run))
+            for t_ms, after, value in last.get("trace", []):
+                rows.append((a["name"], "off" if after else "on", t_ms, value))
+
+        if args.csv:
+            with open(args.csv, "w", newline="") as f:
+                w = csv.writer(f)
+                w.writerow(("actuator", "after", "t_ms", "value"))
+                w.writerows(rows)
+            print("%d samples written to %s" % (len(rows), args.csv))
+
+        if args.compensate:
+            print(await request(ws, {"action": "set_actuator_comp", "enabled": True}))
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""Measure stop_cycle round-trip latency on the in-place fast path vs the cJSON path.
+
+Usage:
+    python3 tools/ws_cmd_latency.py ws://192.168.1.100:8080/ws
+    python3 tools/ws_cmd_latency.py ws://192.168.1.100:8080/ws --count 500 --action skip_phase
+
+Both paths are exercised on the same firmware. The plain command takes the
+fast path. The same command with an escaped character in an extra string
+(the fast path compares raw bytes, so it declines escapes) takes the cJSON
+path. Device-side handler times come from get_cmd_stats before and after.
+Heap allocations per command: 0 on the fast path; on the cJSON path the cJSON
+nodes and strings (4 for {"action":"stop_cycle"}; the frame stays in a static buffer).
+Needs: pip install websockets
+"""
+import argparse
+import asyncio
+import json
+import statistics
+import time
+
+import websockets
+
+
+def is_broadcast(reply):
+    """Telemetry/sysmon pushes arrive on the same socket; they are not replies."""
+    if isinstance(reply, bytes):
+        return True
+    return reply.startswith("{") and any('"type":"%s"' % t in reply for t in ("telemetry", "sysmon"))
+
+
+async def request(ws, text):
+    await ws.send(text)
+    while True:
+        reply = await ws.recv()
+        if not is_broadcast(reply):
+            return reply
+
+
+async def cmd_stats(ws):
+    return json.loads(await request(ws, json.dumps({"action": "get_cmd_stats"})))
+
+
+async def bench(ws, text, count, path):
+    before = (await cmd_stats(ws))[path]
+    rtt = []
+    for _ in range(count):
+        t0 = time.perf_counter()
+        reply = await request(ws, text)
+        rtt.append((time.perf_counter() - t0) * 1e6)
+        if reply.startswith("error"):
+            raise RuntimeError(reply)
+    after = (await cmd_stats(ws))[path]
+
+    handled = after["commands"] - before["commands"]     # parsed also counts the first get_cmd_stats
+    total_us = after["avg_us"] * after["commands"] - before["avg_us"] * before["commands"]
+    avg_us = total_us / handled if handled else 0
+    rtt.sort()
+    p99 = rtt[min(len(rtt) - 1, int(len(rtt) * 0.99))]
+    print("%-7s %5d cmds  rtt p50 %7.0f us  p99 %7.0f us  max %7.0f us | device: %d handled, avg %.0f us, max %d us"
+          % (path, count, statistics.median(rtt), p99, rtt[-1], handled, avg_us, after["max_us"]))
+    return statistics.median(rtt)
+
+
+async def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("uri")
+    ap.add_argument("--count", type=int, default=200)
+    ap.add_argument("--action", default="stop_cycle", help="stop_cycle or skip_phase (repeatable, argument-free)")
+    args = ap.parse_args()
+
+    fast = json.dumps({"action": args.action}, separators=(",", ":"))
+    parsed = '{"action":"%s","via":"cjson\\/"}' % args.action
+
+    async with websockets.connect(args.uri, max_size=None) as ws:
+        t_fast = await bench(ws, fast, args.count, "fast")
+        t_parsed = await bench(ws, parsed, args.count, "parsed")
+        print("fast path p50 round trip: %.0f us less than the cJSON path (%.1fx)"
+              % (t_parsed - t_fast, t_parsed / t_fast))
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""Compare output-command throughput: toggle_gpio (one pin per message) vs set_outputs (one mask).
+
+Usage:
+    python3 tools/ws_output_bench.py ws://192.168.1.100:8080/ws
+    python3 tools/ws_output_bench.py ws://192.168.1.100:8080/ws --patterns 200 --pins 7,8,5,9
+
+Each pattern switches every listed pin, then switches them back. With
+toggle_gpio that takes one request/reply per pin; with set_outputs one per
+pattern. Run it with no cycle running: the pins really switch.
+Needs: pip install websockets
+"""
+import argparse
+import asyncio
+import json
+import statistics
+import time
+
+import websockets
+
+
+def is_broadcast(reply):
+    """Telemetry/sysmon pushes arrive on the same socket; they are not replies."""
+    if isinstance(reply, bytes):
+        return True
+    return reply.startswith("{") and any('"type":"%s"' % t in reply for t in ("telemetry", "sysmon"))
+
+
+async def request(ws, msg):
+    await ws.send(json.dumps(msg))
+    while True:
+        reply = await ws.recv()
+        if not is_broadcast(reply):
+            return reply
+
+
+async def bench_toggle(ws, pins, patterns):
+    t0 = time.perf_counter()
+    n = 0
+    for i in range(patterns):
+        state = i & 1
+        for p in pins:
+            reply = await request(ws, {"action": "toggle_gpio", "pin": p, "state": state})
+            if not reply.startswith("ok"):
+                raise RuntimeError("toggle_gpio: %s" % reply)
+            n += 1
+    return n, time.perf_counter() - t0, []
+
+
+async def bench_mask(ws, pins, patterns):
+    mask = sum(1 << p for p in pins)
+    apply_us = []
+    t0 = time.perf_counter()
+    for i in range(patterns):
+        msg = {"action": "set_outputs", "set": mask} if i & 1 else {"action": "set_outputs", "clear": mask}
+        reply = json.loads(await request(ws, msg))
+        if reply.get("type") != "outputs":
+            raise RuntimeError("set_outputs: %s" % reply)
+        apply_us.append(reply["apply_us"])
+    return patterns, time.perf_counter() - t0, apply_us
+
+
+async def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("uri")
+    ap.add_argument("--pins", default="7,8,5,9", help="comma separated output GPIOs")
+    ap.add_argument("--patterns", type=int, default=100)
+    args = ap.parse_args()
+    pins = [int(p) for p in args.pins.split(",")]
+
+    async with websockets.connect(args.uri, max_size=None) as ws:
+        results = {}
+        for name, fn in (("toggle_gpio", bench_toggle), ("set_outputs", bench_mask)):
+            cmds, secs, apply_us = await fn(ws, pins, args.patterns)
+            results[name] = (cmds, secs)
+            line = "%-12s %5d commands in %6.2f s: %7.1f commands/s, %7.1f patterns/s, %8.1f pin changes/s" % (
+                name, cmds, secs, cmds / secs, args.patterns / secs, args.patterns * len(pins) / secs)
+            if apply_us:
+                line += ", apply p50 %d us max %d us" % (statistics.median(apply_us), max(apply_us))
+            print(line)
+
+        t_toggle = results["toggle_gpio"][1]
+        t_mask = results["set_outputs"][1]
+        print("set_outputs: %.1fx the pattern rate of toggle_gpio, and all %d pins switch in one write"
+              % (t_toggle / t_mask, len(pins)))
+        await request(ws, {"action": "set_outputs", "set": sum(1 << p for p in pins)})   # leave OFF
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+"""Measure start_cycle latency: command to reply, and command to the first output write.
+
+Usage:
+    python3 tools/ws_start_latency.py ws://192.168.1.100:8080/ws
+    python3 tools/ws_start_latency.py ws://192.168.1.100:8080/ws --runs 20 --hold 1.0
+
+Needs a cycle already loaded (write_json) whose first phase switches an
+output at 0 ms. Each run sends start_cycle, waits --hold seconds, reads
+start_latency_us from get_exec_trace and stops the cycle. The outputs really
+switch: run it with the machine empty.
+Needs: pip install websockets
+"""
+import argparse
+import asyncio
+import json
+import statistics
+import time
+
+import websockets
+
+
+def is_broadcast(reply):
+    """Telemetry/sysmon pushes arrive on the same socket; they are not replies."""
+    if isinstance(reply, bytes):
+        return True
+    return reply.startswith("{") and any('"type":"%s"' % t in reply for t in ("telemetry", "sysmon"))
+
+
+async def request(ws, msg):
+    await ws.send(json.dumps(msg))
+    while True:
+        reply = await ws.recv()
+        if not is_broadcast(reply):
+            return reply
+
+
+async def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("uri")
+    ap.add_argument("--runs", type=int, default=10)
+    ap.add_argument("--hold", type=float, default=0.5, help="seconds to let each cycle run")
+    args = ap.parse_args()
+
+    reply_ms, first_ms = [], []
+    async with websockets.connect(args.uri, max_size=None) as ws:
+        for i in range(args.runs):
+            t0 = time.perf_counter()
+            reply = await request(ws, {"action": "start_cycle"})
+            reply_ms.append((time.perf_counter() - t0) * 1000)
+            if not reply.startswith("ok"):
+                raise RuntimeError("start_cycle: %s" % reply)
+
+            await asyncio.sleep(args.hold)
+            trace = json.loads(await request(ws, {"action": "get_exec_trace"}))
+            await request(ws, {"action": "stop_cycle"})
+            if trace["start_latency_us"] < 0:
+                raise RuntimeError("no output written within %.1f s - does the cycle open with an output?" % args.hold)
+            first_ms.append(trace["start_latency_us"] / 1000)
+            print("run %2d: reply %6.1f ms, first output %6.1f ms" % (i + 1, reply_ms[-1], first_ms[-1]))
+            await asyncio.sleep(0.2)
+
+    print("start_cycle reply: p50 %.1f ms max %.1f ms | first output: p50 %.1f ms max %.1f ms"
+          % (statistics.median(reply_ms), max(reply_ms), statistics.median(first_ms), max(first_ms)))
+
+
+if __name__ == "__main__":
+    asyncio.run(main())